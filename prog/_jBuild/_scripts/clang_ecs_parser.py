@@ -114,6 +114,13 @@ def get_param_is_optional_initializer(arg):
     return
 
 
+def get_param_has_default(arg):
+    for c in arg.get_tokens():
+        if (c.spelling == '='):
+            return True
+    return False
+
+
 def get_param_base_type(arg_type):
     if arg_type.kind in [clang.cindex.TypeKind.POINTER, clang.cindex.TypeKind.LVALUEREFERENCE,
                          clang.cindex.TypeKind.INCOMPLETEARRAY, clang.cindex.TypeKind.CONSTANTARRAY]:
@@ -182,6 +189,8 @@ def get_params_info(node, call_params):
         #    print 'ref'
         # print (node.type.get_ref_qualifier())#full type name
         call_param['mutable'] = True if (is_mut_ref(node.type)) else False
+        call_param['pointer'] = node.type.kind == clang.cindex.TypeKind.POINTER
+        call_param['has_default'] = get_param_has_default(node)
         # print (node.type.get_canonical().spelling)#full type name
         # print (get_param_base_type(node.type).get_canonical().spelling)#full type name
         # print (get_param_base_type(node.type).spelling)#full type name
@@ -27,6 +27,7 @@ ecs_query_suffix = "_ecs_query"
 global_input_file_name = ""
 reserved_components_name = {"_worker_id_" : "components.getWorkerId()", "manager" : "components.manager()"}
 reserved_components_types = {"_worker_id_" : "int", "manager" : "ecs::EntityManager"}
+chunk_span_count_types = ["uint32_t", "unsigned int", "unsigned", "int"]
 def verify_reserved_type(name, tp):
   if name in reserved_components_types:
     if reserved_components_types[name] != tp:
@@ -68,6 +69,7 @@ class ESFunction:
     self.annotatedTracked = []
     self.isOptional = False
     self.breakable = False
+    self.chunkSpan = False
     self.params_array = {'ro': {}, 'rw': {}, 'rq': {}, 'no': {}}
     self.eventList = []
 
@@ -160,6 +162,16 @@ def es_function_from_parsed_function(fun):
   esFun.annotations = fun.annotations
   esFun.functionDeclAnnotation = fun.functionDeclAnnotation
   esFun.result_type = fun.result_type
+  # ECS_CHUNK_SPAN: es is called once per chunk with entities count and restrict pointers to component spans
+  esFun.chunkSpan = "@chunk_span" in fun.annotations
+  if esFun.chunkSpan:
+    if not fun.funcName.endswith("_es") or fun.isEvent or len(esFun.annotatedEvents) > 0 or len(esFun.annotatedTracked) > 0:
+      print("ECS_CHUNK_SPAN is supported only for update es, {fun} in {file}".format(fun = fun.funcName, file = global_input_file_name))
+      exit(1)
+    if len(fun.call_params) < 2 or fun.call_params[1].get("type") not in chunk_span_count_types:
+      print("ECS_CHUNK_SPAN es {fun} in {file} should have entities count (uint32_t) as second parameter".format(fun = fun.funcName, file = global_input_file_name))
+      exit(1)
+    firstCallParam = 2
 
 # assert len(fun.call_params) > firstCallParam or len(esFun.annotatedRequirements) or len(esFun.annotatedRequirementNots), "es_Function {name} hasn't parsed correctly or has zero parameters (do nothing)".format(name=fun.funcName)
   for fid in range(firstCallParam, len(fun.call_params)):
@@ -175,7 +187,15 @@ def es_function_from_parsed_function(fun):
     if i["type"].endswith("RW"):  # legacy for ecs20 compatibility
       i["param_type"] = "rw"  # legacy for ecs20 compatibility
 
-    if (fi["optional"] is False):
+    if esFun.chunkSpan and fi["name"] not in reserved_components_name:
+      if not fi.get("pointer") or is_flag_type(i["type"]):
+        print("ECS_CHUNK_SPAN es {fun} in {file}: <{name}> should be pointer to components span (T *__restrict {name})".format(fun = fun.funcName, file = global_input_file_name, name = fi["name"]))
+        exit(1)
+      if fi.get("has_default"): # pointer params are optional components otherwise, here they are spans and never null
+        print("ECS_CHUNK_SPAN es {fun} in {file}: <{name}> can't be optional or have default value".format(fun = fun.funcName, file = global_input_file_name, name = fi["name"]))
+        exit(1)
+      i["optional"] = False
+    elif (fi["optional"] is False):
       i["optional"] = False
     elif (fi["optional"] == 'NULL' or fi["optional"] == 'nullptr'):
       i["optional"] = 'ptr'
@@ -215,7 +235,13 @@ def es_function_from_parsed_function(fun):
       name = name[1:]
     while (type_name.endswith('&') or type_name.endswith(' ')):
       type_name = type_name[:len(type_name) - 1]
+    if esFun.chunkSpan and optional is not False:
+      print("ECS_CHUNK_SPAN es {fun} can't have optional requirements ({reqs})".format(fun = fun.funcName, reqs = reqs))
+      exit(1)
     if is_flag_type(type_name):
+      if esFun.chunkSpan:
+        print("ECS_CHUNK_SPAN es {fun} can't have flag conditions ({reqs})".format(fun = fun.funcName, reqs = reqs))
+        exit(1)
       i = {"name": name, "type": "bool", "param_type": "ro", "optional": optional, "flag_type": type_name}
       if optional == 'val':
         i['defVal'] = defVal
@@ -389,6 +415,8 @@ def gen_getter(esFunction, i):
   suffix = 'RW' if i['param_type'] == 'rw' else 'RO'
   if (i['name'] not in esFunction.params_array['ro']):
     suffix = 'RW'
+  if esFunction.chunkSpan:
+    return 'ECS_' + suffix + '_COMP_SPAN(' + compsName + ', "' + i['name'].replace("_dot_", dot_suffix) + '", ' + i['type'] + ')'
   ecs_getter = 'ECS_' + suffix + '_COMP'
   if (i['optional'] == 'ptr') or (i['type'] == 'const_string'):
     ecs_getter += '_PTR'
@@ -440,7 +468,7 @@ def gen_es_simd(esFunction):
   simdFuncName = getSimdFuncName(esFunction.funcName)
   genCode = 'static void ' + simdFuncName + '(const ecs::UpdateStageInfo &__restrict info, const ecs::QueryView & __restrict components)\n{\n'
   indent = '  '
-  if not esFunction.hasComponents:
+  if not esFunction.hasComponents and not esFunction.chunkSpan:
     genCode += '  G_UNUSED(components);\n'
   for index in range(0, len(esFunction.stagesTypes)):
     if (len(esFunction.stagesTypes) > 1):
@@ -461,13 +489,14 @@ def gen_es_simd(esFunction):
 
     preBodyIndent = indent2
     preForIndent = indent2
-    if esFunction.hasComponents:
+    if esFunction.hasComponents and not esFunction.chunkSpan:
       preForIndent = indent2
       genCode += indent2 + 'auto comp = components.begin(), compE = components.end(); G_ASSERT(comp!=compE);\n' + indent2 + 'do\n'
     if len(esFunction.condition):
       genCode += indent2 + '{\n'
 
-    indent2 += '  '
+    if not esFunction.chunkSpan:
+      indent2 += '  '
     if len(esFunction.condition):
       genCode += indent2 + 'if ( !(' + gen_condition(esFunction, esFunction.condition) + ') )\n' + indent2 + '  continue;\n'
 
@@ -476,12 +505,14 @@ def gen_es_simd(esFunction):
     genCode += infoCasted
     if (esFunction.contextsTypes[index] != ''):
       genCode += ", ctx"
+    if esFunction.chunkSpan:
+      genCode += ", components.getEntitiesCount()"
     genCode += '\n' + gen_call_params(esFunction, indent2, esFunction.stagesCalls[index]) if len(esFunction.stagesCalls[index]) else ');\n'
 
     if len(esFunction.condition):
       genCode += preForIndent + '}\n'
 
-    if esFunction.hasComponents:
+    if esFunction.hasComponents and not esFunction.chunkSpan:
       genCode += preForIndent + 'while (++comp != compE);\n'
 
     if (len(esFunction.stagesTypes) > 1):
@@ -686,6 +717,9 @@ def check_tags(srcFunction, addFunction, src, add, name):
 
 
 def combine_two_func(srcFunction, addFunction):
+  if srcFunction.chunkSpan != addFunction.chunkSpan:
+    print("es {name} is declared both with and without ECS_CHUNK_SPAN".format(name = srcFunction.funcName))
+    exit(1)
   check_tags(srcFunction, addFunction, srcFunction.annotatedTags, addFunction.annotatedTags, "tags")
   check_tags(srcFunction, addFunction, srcFunction.annotatedAfter, addFunction.annotatedAfter, "after")
   check_tags(srcFunction, addFunction, srcFunction.annotatedBefore, addFunction.annotatedBefore, "before")
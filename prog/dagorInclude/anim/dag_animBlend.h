@@ -251,7 +251,11 @@ public:
   {
     struct BlendSrc
     {
-      KEY *k;
+      union
+      {
+        KEY *k;
+        intptr_t packedIdx; // index in TlsContext::packedVal for packed tracks
+      };
       real t;
       real w;
       int interp() { return *(int *)&t; }
@@ -350,6 +354,9 @@ public:
     // list of post-blend controllers and their current weight
     dag::Span<real> pbcWt;
 
+    // values sampled from packed tracks during blend
+    Tab<vec4f> packedVal;
+
     intptr_t (*irq)(int, intptr_t, intptr_t, intptr_t, void *) = nullptr;
     void *irqArg = nullptr;
 
@@ -367,6 +374,7 @@ public:
       bnlCT.reset();
       readyMark.reset();
       pbcWt.reset();
+      clear_and_shrink(packedVal);
       if (dataPtr)
       {
         midmem->free(dataPtr);
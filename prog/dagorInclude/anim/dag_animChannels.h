@@ -58,23 +58,25 @@ struct AnimChan
   PatchablePtr<KEY> key;
   PatchablePtr<uint16_t> keyTime16;
   int keyNum;
-  int _resv;
+  int keyFmt; // KEYFMT_HERMITE or KEYFMT_PACKED16
 
   int keyTimeFirst() const { return unsigned(keyTime16[0]) << TIME_SubdivExp; }
   int keyTimeLast() const { return unsigned(keyTime16[keyNum - 1]) << TIME_SubdivExp; }
   int keyTime(int idx) const { return unsigned(keyTime16[idx]) << TIME_SubdivExp; }
+  bool isPacked() const { return keyFmt != KEYFMT_HERMITE; }
 
-  __forceinline KEY *findKey(int t32, float *out_t) const
+  // returns index of key to be interpolated with next one using *out_t (when it is not 0); valid for any key format
+  __forceinline int findKeyIdx(int t32, float *out_t) const
   {
     if (keyNum == 1 || t32 <= keyTimeFirst())
     {
       *out_t = 0;
-      return &key[0];
+      return 0;
     }
     if (t32 >= keyTimeLast())
     {
       *out_t = 0;
-      return &key[keyNum - 1];
+      return keyNum - 1;
     }
 
     int t = t32 >> TIME_SubdivExp, a = 0, b = keyNum - 1;
@@ -86,10 +88,10 @@ struct AnimChan
         if (keyTime(c) == t32)
         {
           *out_t = 0;
-          return &key[c];
+          return c;
         }
         *out_t = float(t32 - (t << TIME_SubdivExp)) / float((keyTime16[c + 1] - t) << TIME_SubdivExp);
-        return &key[c];
+        return c;
       }
       else if (keyTime16[c] < t)
         a = c;
@@ -97,22 +99,22 @@ struct AnimChan
         b = c;
     }
     *out_t = float(t32 - keyTime(a)) / float(keyTime(b) - keyTime(a));
-    return &key[a];
+    return a;
   }
 
-  __forceinline KEY *findKeyEx(int t32, float *out_t, int &dkeys) const
+  __forceinline int findKeyIdxEx(int t32, float *out_t, int &dkeys) const
   {
     if (keyNum == 1 || t32 <= keyTimeFirst())
     {
       dkeys = 0;
       *out_t = 0;
-      return &key[0];
+      return 0;
     }
     if (t32 >= keyTimeLast())
     {
       dkeys = 0;
       *out_t = 0;
-      return &key[keyNum - 1];
+      return keyNum - 1;
     }
 
     int t = t32 >> TIME_SubdivExp, a = 0, b = keyNum - 1;
@@ -125,11 +127,11 @@ struct AnimChan
         {
           dkeys = (c < keyNum - 1) ? (keyTime16[c + 1] - keyTime16[c]) : 0;
           *out_t = 0;
-          return &key[c];
+          return c;
         }
         dkeys = keyTime16[c + 1] - keyTime16[c];
         *out_t = float(t32 - (t << TIME_SubdivExp)) / float((keyTime16[c + 1] - t) << TIME_SubdivExp);
-        return &key[c];
+        return c;
       }
       else if (keyTime16[c] < t)
         a = c;
@@ -138,8 +140,12 @@ struct AnimChan
     }
     dkeys = keyTime16[b] - keyTime16[a];
     *out_t = float(t32 - keyTime(a)) / float(keyTime(b) - keyTime(a));
-    return &key[a];
+    return a;
   }
+
+  // Hermite keys only (!isPacked())
+  __forceinline KEY *findKey(int t32, float *out_t) const { return &key[findKeyIdx(t32, out_t)]; }
+  __forceinline KEY *findKeyEx(int t32, float *out_t, int &dkeys) const { return &key[findKeyIdxEx(t32, out_t, dkeys)]; }
 };
 
 typedef AnimChan<AnimKeyPoint3> AnimChanPoint3;
@@ -7,6 +7,7 @@
 
 #include <vecmath/dag_vecMath.h>
 #include <anim/dag_animKeys.h>
+#include <anim/dag_animChannels.h>
 
 namespace AnimV20Math
 {
@@ -24,4 +25,94 @@ __forceinline vec4f interp_key(const AnimV20::AnimKeyQuat &a, const AnimV20::Ani
   return v_quat_qsquad(t, a.p, a.b0, a.b1, b.p);
 }
 
+// Packed keys (KEYFMT_PACKED16)
+static constexpr float PACKED_QUAT_COMP_MAX = 0.70710678f; // components other than largest are in [-1/sqrt2, 1/sqrt2]
+static constexpr float PACKED_QUAT_COMP_SCALE = 2 * PACKED_QUAT_COMP_MAX / 65535.f;
+
+__forceinline vec3f decode_packed_key(const AnimV20::AnimPackedKeyRange &r, const AnimV20::AnimPackedKey &k)
+{
+  return v_madd(v_cvti_vec4f(v_lduush(k.v)), r.scale, r.ofs);
+}
+
+__forceinline quat4f decode_packed_key(const AnimV20::AnimPackedKey &k)
+{
+  vec4f c = v_madd(v_cvti_vec4f(v_lduush(k.v)), v_splats(PACKED_QUAT_COMP_SCALE), v_splats(-PACKED_QUAT_COMP_MAX));
+  c = v_perm_ayzw(c, v_zero());
+  // c=(q[i], q[i+1], q[i+2], q[i+3]) where i is index of largest component, restored from unit length
+  c = v_perm_ayzw(c, v_sqrt4(v_max(v_sub(V_C_ONE, v_dot4(c, c)), v_zero())));
+  switch (k.v[0] & 3)
+  {
+    case 1: return v_rot_3(c);
+    case 2: return v_rot_2(c);
+    case 3: return v_rot_1(c);
+    default: return c;
+  }
+}
+
+// inverse of decode_packed_key() (used by exporters); decoded components differ from source by at most half of quantization step
+inline AnimV20::AnimPackedKey encode_packed_key(const AnimV20::AnimPackedKeyRange &r, vec3f v)
+{
+  alignas(16) float p[4], ofs[4], scale[4];
+  v_st(p, v);
+  v_st(ofs, r.ofs);
+  v_st(scale, r.scale);
+  AnimV20::AnimPackedKey k;
+  for (int c = 0; c < 3; c++)
+    k.v[c] = scale[c] > 0 ? clamp(int(floorf((p[c] - ofs[c]) / scale[c] + 0.5f)), 0, 65535) : 0;
+  k.v[3] = 0;
+  return k;
+}
+
+inline AnimV20::AnimPackedKey encode_packed_key(quat4f q)
+{
+  alignas(16) float c[4];
+  v_st(c, v_norm4(q));
+  int largest = 0;
+  for (int i = 1; i < 4; i++)
+    if (fabsf(c[i]) > fabsf(c[largest]))
+      largest = i;
+  float sgn = c[largest] < 0 ? -1.f : 1.f; // q and -q are the same rotation, so largest component is stored as positive
+  AnimV20::AnimPackedKey k;
+  k.v[0] = largest;
+  for (int i = 1; i < 4; i++)
+  {
+    float v = (sgn * c[(largest + i) & 3] + PACKED_QUAT_COMP_MAX) / PACKED_QUAT_COMP_SCALE;
+    k.v[i] = clamp(int(floorf(v + 0.5f)), 0, 65535);
+  }
+  return k;
+}
+
+// Channel sampling for key found with findKeyIdx(); handles both key formats
+
+__forceinline vec3f interp_chan_key(const AnimV20::AnimChanPoint3 &ch, int idx, float t)
+{
+  if (ch.isPacked())
+  {
+    const AnimV20::AnimPackedKeyRange &r = *(const AnimV20::AnimPackedKeyRange *)ch.key.get();
+    const AnimV20::AnimPackedKey *k = (const AnimV20::AnimPackedKey *)(&r + 1) + idx;
+    vec3f v = decode_packed_key(r, k[0]);
+    return (t != 0.f) ? v_lerp_vec4f(v_splats(t), v, decode_packed_key(r, k[1])) : v;
+  }
+  return (t != 0.f) ? interp_key(ch.key[idx], v_splats(t)) : ch.key[idx].p;
+}
+
+__forceinline quat4f interp_chan_key(const AnimV20::AnimChanQuat &ch, int idx, float t)
+{
+  if (ch.isPacked())
+  {
+    const AnimV20::AnimPackedKey *k = (const AnimV20::AnimPackedKey *)ch.key.get() + idx;
+    quat4f v = decode_packed_key(k[0]);
+    return (t != 0.f) ? v_quat_qslerp(t, v, decode_packed_key(k[1])) : v;
+  }
+  return (t != 0.f) ? interp_key(ch.key[idx], ch.key[idx + 1], t) : ch.key[idx].p;
+}
+
+template <class CHAN>
+__forceinline vec4f sample_chan(const CHAN &ch, int t32)
+{
+  float t;
+  int idx = ch.findKeyIdx(t32, &t);
+  return interp_chan_key(ch, idx, t);
+}
+
 } // end of namespace AnimV20Math
@@ -6,6 +6,7 @@
 #pragma once
 
 #include <vecmath/dag_vecMathDecl.h>
+#include <util/dag_stdint.h>
 
 namespace AnimV20
 {
@@ -22,4 +23,23 @@ struct AnimKeyQuat
 {
   quat4f p, b0, b1;
 };
+
+// Key formats of AnimChan
+enum
+{
+  KEYFMT_HERMITE = 0,  // AnimKeyPoint3[keyNum] or AnimKeyQuat[keyNum]
+  KEYFMT_PACKED16 = 1, // (AnimPackedKeyRange for point3 only) + AnimPackedKey[keyNum], linear interpolation between keys
+};
+
+// Packed point3 key value is ofs + v[0..2] * scale
+struct AnimPackedKeyRange
+{
+  vec3f ofs, scale;
+};
+// Packed point3 key: v[0..2] are range-quantized components, v[3]=0
+// Packed quat key: v[0] is index of largest component (that is positive), v[1..3] are next components in cyclic order
+struct AnimPackedKey
+{
+  uint16_t v[4];
+};
 } // end of namespace AnimV20
@@ -109,6 +109,13 @@ public:
 
   int getSize() const { return data_size(val); }
 
+  // hash of state that determines blend result (time params are quantized with time_quant when > 0)
+  uint64_t calcBlendStateHash(float time_quant) const;
+  // raw copy of all param values (getSize() bytes); used to share blend results between holders of the same graph
+  void copyValuesTo(void *dst) const { memcpy(dst, val.data(), data_size(val)); }
+  // restores values saved with copyValuesTo() (possibly from other holder of the same graph), keeps PT_InlinePtrCTZ data
+  void copyValuesFrom(const void *src);
+
   // store/restore routines
   void saveState(IGenSave &cb) const;
   void loadState(IGenLoad &cb);
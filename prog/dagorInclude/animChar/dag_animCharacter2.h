@@ -248,6 +248,24 @@ public:
   void setTraceContext(intptr_t ctx) { traceContext = ctx; }
   void setAlwaysUpdateAnimMode(bool on) { forceAnimUpdate = on; }
 
+  // animation update LOD flags (usually set by LOD scheduler depending on distance to viewer and visibility)
+  enum
+  {
+    ULF_SKIP_POST_BLEND = 1 << 0, //< don't run post-blend controllers of anim graph
+    ULF_INTERP_POSE = 1 << 1,     //< keep 2 last evaluated poses, interpolatePose() blends them between reduced-rate updates
+    ULF_SHARE_POSE = 1 << 2,      //< reuse pose blended for other animchar with equal graph state in current sharing pass
+                                  //< (skips blend irqs and post-blend controllers when pose is reused)
+  };
+  void setUpdateLodFlags(unsigned flags);
+  unsigned getUpdateLodFlags() const { return updateLodFlags; }
+
+  //! applies pose interpolated between 2 last evaluated poses (t=0 - previous, t=1 - latest) and recalcs WTMs;
+  //! latest evaluated pose is shown with 1 update delay this way; without ULF_INTERP_POSE works as recalcWtm()
+  void interpolatePose(float t);
+
+  //! starts new pose sharing pass (poses shared in previous pass are dropped); time params are compared with time_quant precision
+  static void resetSharedPoses(float time_quant = 1.f / 30.f);
+
   static intptr_t irq(int type, intptr_t p1, intptr_t p2, intptr_t p3, void *arg);
 
   const AnimV20::AnimBlender::CharNodeModif *getCharDepModif() const
@@ -288,6 +306,7 @@ protected:
 
   Tab<AnimMap> animMap;
   Tab<vec4f> animMapPRS;
+  SmallTab<vec4f, MidmemAlloc> poseHist; // 2 x animMap.size() x PRS of last evaluated poses, for ULF_INTERP_POSE
 
   AnimBlender::CharNodeModif node0;
   float charDepBasePYofs;
@@ -296,6 +315,7 @@ protected:
   static constexpr unsigned MAGIC_BITS = 13, MAGIC_VALUE = 1511;
   G_STATIC_ASSERT(MAGIC_VALUE < (1 << MAGIC_BITS));
   uint16_t magic : MAGIC_BITS;
+  uint8_t updateLodFlags = 0;
   intptr_t traceContext = 0;
   real totalDeltaTime;
   real centerNodeBsphRad;
@@ -328,6 +348,8 @@ protected:
   void postRecalcWtm();
   void calcAnimWtm(bool may_calc_anim);
   void recalcHelpers();
+  void capturePoseHistory();
+  void applyPoseHistory(float t);
   real getSqDistanceToViewerLegacy() const;
 
   void setupAnim();
@@ -32,6 +32,10 @@ KRNLIMP void debug_enable_thread_ids(bool en_tid);
 KRNLIMP void debug_set_thread_name(const char *persistent_thread_name_ptr);
 KRNLIMP void debug_override_log_timestamp_format(debug_override_timestamp_cb_t);
 KRNLIMP debug_log_callback_t debug_set_log_callback(debug_log_callback_t cb);
+// Asynchronous logging: threads put formatted records to own lock-free rings, which are written by background thread (PC only).
+// When ring is full, debug records are dropped (and counted) if drop_on_overflow, otherwise thread waits for writer; errors and
+// warnings always wait. Fatal errors and flush_debug_file() (also called on crash) write all queued records synchronously.
+KRNLIMP void debug_enable_async_log(bool enable, int ring_size_kb = 256, bool drop_on_overflow = true);
 #else
 inline const char *get_log_directory() { return ""; }
 inline const char *get_log_filename() { return ""; }
@@ -45,6 +49,7 @@ inline void debug_enable_thread_ids(bool) {}
 inline void debug_set_thread_name(const char *) {}
 inline void debug_override_log_timestamp_format(debug_override_timestamp_cb_t) {}
 inline debug_log_callback_t debug_set_log_callback(debug_log_callback_t) { return NULL; }
+inline void debug_enable_async_log(bool, int = 0, bool = true) {}
 #endif
 
 #include <supp/dag_undef_COREIMP.h>
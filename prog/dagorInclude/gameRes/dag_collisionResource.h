@@ -532,6 +532,14 @@ private:
   VECTORCALL DAGOR_NOINLINE static bool traceRayMeshNodeLocalAllHits_AVX256(const CollisionNode &node, const vec4f &v_local_from,
     const vec4f &v_local_dir, float in_t, bool calc_normal, bool no_cull, all_nodes_ret_t &ret_array);
 
+  // packets of 4 rays (transposed, lane per ray, unused lanes have zero t), return bit mask of rays which hit node
+  template <bool check_bounding>
+  VECTORCALL DAGOR_NOINLINE static int traceRay4MeshNodeLocalCullCCW(const CollisionNode &node, const mat43f &v_local_from,
+    const mat43f &v_local_dir, vec4f &in_out_t, vec4f *v_out_norm);
+  template <bool check_bounding>
+  VECTORCALL DAGOR_NOINLINE static int traceRay4MeshNodeLocalAllHits(const CollisionNode &node, const mat43f &v_local_from,
+    const mat43f &v_local_dir, vec4f in_t, bool calc_normal, bool no_cull, all_nodes_ret_t *ret_arrays);
+
   template <bool check_bounding>
   VECTORCALL DAGOR_NOINLINE static bool rayHitMeshNodeLocalCullCCW(const CollisionNode &node, const vec4f &v_local_from,
     const vec4f &v_local_dir, float in_t);
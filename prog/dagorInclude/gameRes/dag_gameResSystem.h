@@ -157,3 +157,8 @@ int get_gameres_sys_ver();
 void reset_gameres_available_files_list();
 //! adds files scanned in 'root_dir' (recursively) to list of available files; enables usage of that list
 void add_gameres_available_files_list(const char *root_dir);
+
+//! sets how many GRPs ahead preload_all_required_res() reads (and prepares descriptors of) on threadpool workers
+//! while resources of current GRP are being created; 0 disables pipelined loading (default);
+//! max_data_kb limits size of data read ahead and not yet consumed
+void set_gameres_pack_prefetch_depth(int depth, int max_data_kb = 64 << 10);
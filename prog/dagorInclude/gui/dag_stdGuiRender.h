@@ -336,6 +336,31 @@ struct ExtState // aliased to specific structure
   uint8_t data[64];
 };
 
+// quads recorded with GuiContext::beginRecording()/endRecording() along with states they were rendered with;
+// can be rendered again (with offset) by GuiContext::replay() without repeating the code that produced them
+struct GuiCommandBuffer
+{
+  struct Batch
+  {
+    GuiState state;
+    ExtState extState;
+    float viewport[4]; // left, top, width, height
+    int firstQuad, numQuads;
+  };
+  Tab<GuiVertex> verts; // 4 per quad
+  Tab<Batch> batches;
+  short fontAtlasGeneration = -1;
+  bool replayable = false; // false when something that can't be replayed was rendered during recording
+
+  void clear()
+  {
+    verts.clear();
+    batches.clear();
+    replayable = false;
+  }
+  bool canReplay() const { return replayable && fontAtlasGeneration == dyn_font_atlas_reset_generation; }
+};
+
 struct CallBackState
 {
   GuiState *guiState;
@@ -497,6 +522,10 @@ private:
   GuiVertexTransform vertexTransformInverse;
   BBox2 preTranformViewport;
 
+  GuiCommandBuffer *cmdRec;
+  void recordQuads(const void *verts, int num_quads);
+  void recordStateBlock();
+
 public:
   GuiContext();
   ~GuiContext();
@@ -519,6 +548,17 @@ public:
   // set external rendering command handler
   // CallBackState is provided to cb() function
   void setRenderCallback(RenderCallBack cb, uintptr_t data);
+
+  // commands recording
+  // quads rendered between beginRecording() and endRecording() are copied to buf (and rendered as usual);
+  // callbacks, buffers other than default one, raw layer draws and missing glyphs make recording not replayable
+  void beginRecording(GuiCommandBuffer &buf);
+  void endRecording();
+  bool isRecording() const { return cmdRec != NULL; }
+  // called by rendering code that produces output which may change without notice (e.g. picture is still loading)
+  void invalidateRecording();
+  // render recorded quads (and viewports set during recording) shifted by offset (in gui coords)
+  void replay(const GuiCommandBuffer &buf, const Point2 &offset);
   RecorderCallback *getRenderCallback() const { return recCb; }
 
   // execute cb handler
@@ -1029,6 +1069,19 @@ void after_device_reset();
 // to be called from scene::act() to perform pending font rasterisation and other tasks
 void update_internals_per_act();
 
+struct FontCacheStats
+{
+  uint64_t strBoxTests, strBoxHits;                   // string bbox cache (get_str_bbox_u() and similar for dynamic fonts)
+  uint64_t strBoxLayoutCount, strBoxLayoutUsec;       // strings shaped to compute bbox on cache miss and time spent
+  uint64_t shapedStrTests, shapedStrHits;             // shaped strings cache (draw_str_scaled_u() for dynamic fonts)
+  uint64_t shapedStrLayoutCount, shapedStrLayoutUsec; // strings shaped and rendered on cache miss and time spent
+  int shapedStrCount;                                 // strings currently cached
+  int atlasEvictions, atlasResets;                    // dynamic font atlas pages evicted (LRU) and full resets (all pages in use)
+};
+//! returns cumulative statistics of string caches and dynamic font atlas (since init or last reset_font_cache_stats())
+void get_font_cache_stats(FontCacheStats &out_stats);
+void reset_font_cache_stats();
+
 
 // ************************************************************************
 // * single-threaded legacy wrapper over stdgui_context
@@ -65,6 +65,8 @@ enum class ReadFlag : uint8_t
 using ReadFlags = BitFlagsMask<ReadFlag>;
 BITMASK_DECLARE_FLAGS_OPERATORS(ReadFlag);
 
+class SchemaBase;
+
 template <typename Cb>
 static inline void iterate_child_blocks(const DataBlock &db, Cb cb);
 template <typename Cb>
@@ -560,6 +562,7 @@ protected:
   DataBlockOwned *data = nullptr;
 
   friend struct DbUtils;
+  friend class dblk::SchemaBase;
   friend class DataBlockParser;
   template <typename Cb>
   friend void dblk::iterate_child_blocks(const DataBlock &db, Cb cb);
@@ -749,6 +752,12 @@ namespace dblk
 /// Load BLK from specified file
 KRNLIMP bool load(DataBlock &blk, const char *fname, ReadFlags flg = ReadFlags(), DataBlock::IFileNotify *fnotify = nullptr);
 
+/// Load many BLK files concurrently on threadpool workers, each file into corresponding DataBlock (as dblk::load() does);
+/// files included by several BLKs are read once per call; fnotify is called on calling thread after all loads, in order of fnames.
+/// Returns number of successfully loaded BLKs; out_ok (when not null) receives result for each file
+KRNLIMP int load_many(dag::ConstSpan<DataBlock *> blks, dag::ConstSpan<const char *> fnames, ReadFlags flg = ReadFlags(),
+  DataBlock::IFileNotify *fnotify = nullptr, bool *out_ok = nullptr);
+
 /// Load BLK from text (fname is used only for error reporting)
 KRNLIMP bool load_text(DataBlock &blk, dag::ConstSpan<char> text, ReadFlags flg = ReadFlags(), const char *fname = nullptr,
   DataBlock::IFileNotify *fnotify = nullptr);
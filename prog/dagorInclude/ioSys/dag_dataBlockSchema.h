@@ -0,0 +1,119 @@
+//
+// Dagor Engine 6.5
+// Copyright (C) 2023  Gaijin Games KFT.  All rights reserved
+// (for conditions of use see prog/license.txt)
+//
+#pragma once
+
+#include <ioSys/dag_dataBlock.h>
+#include <osApiWrappers/dag_spinlock.h>
+#include <dag/dag_vector.h>
+#include <EASTL/initializer_list.h>
+
+#include <supp/dag_define_COREIMP.h>
+
+namespace dblk
+{
+/// Result of SchemaBase::read(); bit i of masks corresponds to i-th field of schema.
+struct SchemaReadReport
+{
+  uint64_t readMask = 0;    ///< fields that were read from BLK
+  uint64_t missingMask = 0; ///< required fields not present in BLK
+  uint64_t badTypeMask = 0; ///< fields present in BLK with type other than in schema (left unchanged)
+  int unknownCount = 0;     ///< params of block not described by schema
+
+  bool ok() const { return !missingMask && !badTypeMask; }
+};
+
+/// Declarative mapping of struct fields to params of one DataBlock.
+///
+/// Name ids are resolved once per BLK name map (and re-resolved only when it gets new names or is reset),
+/// so read() fills all fields in single pass over params of block, instead of getNameId()+findParam() per field.
+/// Only the first param with given name is used (as in DataBlock::getXXX(name, def)); absent fields keep their values.
+/// Schema may be shared by threads reading different BLKs.
+class SchemaBase
+{
+public:
+  static constexpr int MAX_FIELDS = 64;
+
+  SchemaBase() = default;
+  SchemaBase(const SchemaBase &) = delete;
+  SchemaBase &operator=(const SchemaBase &) = delete;
+
+  /// fills fields at dst from params of blk; returns false when required fields are missing or have bad type
+  KRNLIMP bool read(const DataBlock &blk, void *dst, SchemaReadReport *report = nullptr) const;
+  /// logs unknown params, missing and bad-typed fields (slow path, intended for diagnostics after read())
+  KRNLIMP void logReport(const DataBlock &blk, const SchemaReadReport &report, bool as_error = true) const;
+
+  int fieldCount() const { return (int)fields.size(); }
+  const char *getFieldName(int i) const { return fields[i].name; }
+
+protected:
+  struct Field
+  {
+    const char *name;
+    uint32_t ofs;
+    uint8_t type;
+    bool required;
+  };
+  struct BoundNames
+  {
+    uint32_t namesUid = 0, nameCount = 0;
+    int keyCount = -1;
+  };
+  static constexpr int CACHE_SIZE = 4;
+
+  dag::Vector<Field> fields;
+  uint64_t requiredMask = 0;
+
+  mutable OSSpinlock cacheLock;
+  mutable BoundNames cache[CACHE_SIZE];
+  mutable dag::Vector<uint64_t> cacheKeys; // CACHE_SIZE x fields.size(), (nameId << 32 | field) sorted by nameId
+  mutable uint32_t cacheNext = 0;
+
+  KRNLIMP void addField(const char *name, uint32_t ofs, int type, bool required);
+  int bindNames(const DataBlockShared &shared, uint64_t *out_keys) const;
+};
+
+/// Typed schema, e.g.
+///   static const dblk::Schema<WeaponProps> schema{{"damage", &WeaponProps::damage, true}, {"range", &WeaponProps::range}};
+///   schema.read(blk, props);
+template <class T>
+class Schema : public SchemaBase
+{
+public:
+  struct FieldDesc
+  {
+    const char *name;
+    uint32_t ofs;
+    int type;
+    bool required;
+
+    template <class F>
+    FieldDesc(const char *n, F T::*member, bool req = false) :
+      name(n), ofs(member_offset(member)), type(DataBlock::TypeOf<F>::type), required(req)
+    {
+      static_assert(DataBlock::TypeOf<F>::type != DataBlock::TYPE_NONE, "field type is not supported by DataBlock");
+    }
+  };
+
+  Schema(std::initializer_list<FieldDesc> desc)
+  {
+    fields.reserve(desc.size());
+    for (const FieldDesc &d : desc)
+      addField(d.name, d.ofs, d.type, d.required);
+  }
+
+  bool read(const DataBlock &blk, T &dst, SchemaReadReport *report = nullptr) const { return SchemaBase::read(blk, &dst, report); }
+
+private:
+  template <class F>
+  static uint32_t member_offset(F T::*member)
+  {
+    alignas(T) static const char probe[sizeof(T)] = {};
+    return uint32_t((const char *)&(reinterpret_cast<const T *>(probe)->*member) - probe);
+  }
+};
+} // namespace dblk
+
+#include <supp/dag_undef_COREIMP.h>
@@ -208,6 +208,49 @@ static int __forceinline traceray4TrianglesMask(vec3f from, vec3f dir, vec4f &mi
   return v_signmask(valid);
 }
 
+// packet version: 4 rays (from, dir transposed, lane per ray) vs one triangle, same math as traceray4TrianglesVecMask
+// return vector mask of rays which hit triangle, min_t will be updated for each ray independently
+static vec4f __forceinline traceray4RaysTriangleVecMask(const mat43f &from, const mat43f &dir, vec4f &min_t, vec3f vert0, vec3f vert1,
+  vec3f vert2, bool no_cull)
+{
+  vec3f edge1 = v_sub(vert0, vert1);
+  vec3f edge2 = v_sub(vert2, vert0);
+  mat43f p0, e1, e2, Ng;
+  p0.row0 = v_splat_x(vert0);
+  p0.row1 = v_splat_y(vert0);
+  p0.row2 = v_splat_z(vert0);
+  e1.row0 = v_splat_x(edge1);
+  e1.row1 = v_splat_y(edge1);
+  e1.row2 = v_splat_z(edge1);
+  e2.row0 = v_splat_x(edge2);
+  e2.row1 = v_splat_y(edge2);
+  e2.row2 = v_splat_z(edge2);
+  v_mat43_cross(Ng, e1, e2);
+
+  mat43f C, R;
+  v_mat43_sub(C, p0, from);
+  v_mat43_cross(R, dir, C);
+  vec4f det = v_dot(Ng, dir);
+
+  vec4i allBits = v_cmp_eqi(v_zeroi(), v_zeroi());
+  vec4f absMask = v_cast_vec4f(v_srli_n(allBits, no_cull ? 1 : 0));
+
+  vec4f sgnDet = v_andnot(absMask, det);
+  det = v_and(det, absMask);
+
+  vec4f U = v_xor(v_dot(R, e2), sgnDet);
+  vec4f V = v_xor(v_dot(R, e1), sgnDet);
+
+  vec4f valid = v_and(v_cmp_ge(U, v_splats(-TRACE_EPSILON)), v_cmp_ge(V, v_splats(-TRACE_EPSILON)));
+  vec4f W1 = v_div(v_add(U, V), det);
+  valid = v_and(valid, v_cmp_ge(v_splats(TRACE_ONE_PLUS_EPSILON), W1));
+  vec4f T = v_xor(v_dot(Ng, C), sgnDet);
+  T = v_div(T, det);
+  valid = v_and(valid, v_and(v_and(v_cmp_gt(det, v_zero()), v_cmp_ge(T, v_zero())), v_cmp_gt(min_t, T)));
+  min_t = v_sel(min_t, T, valid);
+  return valid;
+}
+
 static int __forceinline rayhit4Triangles(vec3f from, vec3f dir, float len, mat43f p0, mat43f p1, mat43f p2, bool no_cull,
   vec4f mask = V_CI_MASK1111)
 {
@@ -0,0 +1,39 @@
+//
+// Dagor Engine 6.5
+// Copyright (C) 2023  Gaijin Games KFT.  All rights reserved
+// (for conditions of use see prog/license.txt)
+//
+#pragma once
+
+#include <util/dag_stdint.h>
+#include <math.h>
+
+#include <supp/dag_define_COREIMP.h>
+
+namespace dagor_memory_sampling
+{
+//! called for sampled allocation; allocations made from within hooks are never sampled;
+//! returns false when sample is not recorded as new one (dropped, or replaced live sample of the same address)
+typedef bool (*alloc_cb_t)(void *ptr, size_t size);
+//! called before freeing block that could have been sampled (false positives are possible, callee should check);
+//! returns true when ptr was recorded sample, so its address is released from filter of sampled addresses
+typedef bool (*free_cb_t)(void *ptr);
+
+//! installs sampling hooks for heaps of dagor memory manager; one allocation is sampled per ~mean_interval allocated bytes
+//! (Poisson process: intervals between sampled bytes are exponentially distributed, so each byte has same chance to be sampled
+//! regardless of allocation pattern, and probability of sampling block of size S is 1-exp(-S/mean_interval))
+//! pass nullptr callbacks or mean_interval=0 to remove hooks
+KRNLIMP void set_hooks(alloc_cb_t on_alloc, free_cb_t on_free, size_t mean_interval);
+
+//! returns current mean interval (0 when sampling is off)
+KRNLIMP size_t get_mean_interval();
+
+//! estimated bytes represented by sampled block: size/P(sampled), so sum over samples is unbiased estimation of sampled heap
+inline uint64_t estimate_sampled_bytes(size_t size, double mean_interval)
+{
+  const double prob = -expm1(-double(size) / mean_interval);
+  return uint64_t(double(size) / (prob > 1e-12 ? prob : 1e-12) + 0.5);
+}
+} // namespace dagor_memory_sampling
+
+#include <supp/dag_undef_COREIMP.h>
@@ -41,6 +41,22 @@ extern "C"
   // checks for async read completion
   KRNLIMP bool dfa_check_complete(int asyncdata_handle, int *read_len);
 
+#if _TARGET_PC_LINUX
+  // reads placed between begin/end are submitted to kernel at once (io_uring backend); batches may nest
+  KRNLIMP void dfa_begin_read_batch();
+  KRNLIMP void dfa_end_read_batch();
+
+  // registers buffer that is reused for many async reads, so io_uring backend reads into it without pinning pages per request;
+  // returns false when not supported (or registration failed before and backend was not re-enabled since);
+  // buffer must be unregistered (with no reads pending) before it is freed
+  KRNLIMP bool dfa_register_read_buffer(void *buf, int len);
+  KRNLIMP void dfa_unregister_read_buffer(void *buf);
+
+  // io_uring backend is used when kernel supports it, unless DAGOR_DISABLE_IO_URING env var is set; otherwise POSIX AIO is used;
+  // switches backend at runtime (must be called with no reads pending), returns whether io_uring is used
+  KRNLIMP bool dfa_use_io_uring(bool enable);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -13,6 +13,9 @@ KRNLIMP void *global_mutex_create(const char *mutex_name);
 //! locks named inter-process mutex
 KRNLIMP int global_mutex_enter(void *mutex);
 
+//! locks named inter-process mutex, waiting no longer than timeout_ms; returns 0 when locked
+KRNLIMP int global_mutex_enter_timeout(void *mutex, int timeout_ms);
+
 //! unlocks named inter-process mutex
 KRNLIMP int global_mutex_leave(void *mutex);
 
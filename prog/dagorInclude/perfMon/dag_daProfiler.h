@@ -125,6 +125,8 @@ DA_STUB void get_spike_save_parameters(uint32_t &, uint32_t &) {}
 DA_STUB void set_sampling_parameters(uint32_t, uint32_t, uint32_t) {}
 DA_STUB void get_sampling_parameters(uint32_t &, uint32_t &, uint32_t &) {}
 DA_STUB void set_continuous_limits(uint32_t, uint32_t) {}
+DA_STUB void set_heap_sampling(uint32_t) {}
+DA_STUB uint32_t get_heap_sampling() { return 0; }
 DA_STUB void pause_sampling() {}
 DA_STUB void resume_sampling() {}
 DA_STUB void sync_stop_sampling() {}
@@ -241,6 +243,12 @@ DA_API void get_sampling_parameters(uint32_t &sampling_freq, uint32_t &sampling_
 // zero - means no limit
 DA_API void set_continuous_limits(uint32_t frames, uint32_t size_mb);
 
+// sampling heap profiler: one allocation per ~sampling_interval_bytes allocated bytes is sampled (Poisson) with its callstack
+// live heap and allocated bytes (since previous dump) by callsite are saved within each ring/continuous dump
+// 0 - stops heap sampling and releases collected samples. Reasonable intervals are 64K..1M, overhead of 512K is negligible
+DA_API void set_heap_sampling(uint32_t sampling_interval_bytes);
+DA_API uint32_t get_heap_sampling();
+
 // will pause sampling till next frame or resume_sampling called. Doesn't guarantee that samples won't be gathered
 DA_API void pause_sampling();
 
@@ -13,6 +13,10 @@
 #include <osApiWrappers/dag_rwLock.h>
 #include <osApiWrappers/dag_atomic.h>
 #include <memory/dag_framemem.h>
+#include <generic/dag_span.h>
+#include <util/dag_parallelForInline.h>
+#include <math/dag_bits.h>
+#include <supp/dag_prefetch.h>
 #include <atomic>
 #include <mutex>
 
@@ -20,6 +24,15 @@ namespace scene
 {
 class TiledScene;
 struct TiledSceneCullContext;
+
+// one of views culled at once by TiledScene::frustumCullMultiView()
+struct TiledSceneCullView
+{
+  mat44f globtm;
+  vec4f pos_distscale = v_zero(); // w <= 0 disables distance culling
+  uint32_t test_flags = 0, equal_flags = 0;
+  Occlusion *occlusion = nullptr; // optional
+};
 } // namespace scene
 
 #define KD_LEAVES_ONLY 1
@@ -125,6 +138,16 @@ public:
     frustumCullOneTile(const scene::TiledSceneCullContext &ctx, mat44f_cref globtm, vec4f pos_distscale, Occlusion *occlusion,
       int tile_idx, VisibleNodesF visible_nodes) const;
 
+  static constexpr int MAX_MULTI_VIEWS = 32;
+  // culls up to MAX_MULTI_VIEWS views (i.e. main camera, csm cascades and local shadows) in one walk over tiles and kd-tree leaves,
+  // testing each box against 4 views at once. VisibleNodesF is [](scene::node_index, mat44f_cref, uint32_t views_mask,
+  // uint32_t worker_id), it is called once per node visible in any of views, with bit i of views_mask set if node is visible in
+  // views[i].
+  // If tiles_per_job is not 0, tiles are distributed between threadpool workers and visible_nodes is called concurrently,
+  // worker_id is in [0, threadpool::get_num_workers()]. Otherwise worker_id is always 0.
+  template <bool use_flags, bool use_pools, typename VisibleNodesF>
+  void frustumCullMultiView(dag::ConstSpan<TiledSceneCullView> views, VisibleNodesF visible_nodes, uint32_t tiles_per_job = 0) const;
+
   template <bool use_flags, bool use_pools, typename VisibleNodesFunctor> // VisibleNodesFunctor(scene::node_index, mat44f_cref)
   void boxCull(bbox3f_cref box, uint32_t test_flags, uint32_t equal_flags, VisibleNodesFunctor visible_nodes) const;
   // default is min_nodes_count = 16, kdtree_rebuild_threshold = 1.
@@ -340,6 +363,50 @@ protected:
     mat44f_cref globtm, const vec4f &pos_distscale, uint32_t test_flags, uint32_t equal_flags, Occlusion *occlusion,
     VisibleNodesF visible_nodes) const;
 
+  struct MultiViewCullData
+  {
+    struct Group // planes and positions of 4 views, lane per view
+    {
+      vec4f planeX[6], planeY[6], planeZ[6], planeW[6];
+      vec4f absPlaneX[6], absPlaneY[6], absPlaneZ[6];
+      vec4f posX, posY, posZ, distScale;
+      vec4f boxMinX, boxMinY, boxMinZ, boxMaxX, boxMaxY, boxMaxZ; // frustum boxes, like tiles region in single view cull
+    };
+    struct View // planes and position of one view, each component splatted, to test 4 nodes at once
+    {
+      vec4f planeX[6], planeY[6], planeZ[6], planeW[6];
+      vec4f posX, posY, posZ, distScale;
+    };
+    // tiles and kd-tree leaves are tested with 4 views at once, as they are mostly visible in many views. Nodes are mostly visible in
+    // few of views and in most of them their leaf is fully inside, so 4 nodes are tested at once with only views which need it
+    Group groups[MAX_MULTI_VIEWS / 4];
+    View viewSplat[MAX_MULTI_VIEWS];
+    const TiledSceneCullView *views = nullptr;
+    uint32_t groupsCount = 0, allViews = 0, occlusionViews = 0, distViews = 0;
+    // views with the same flags are tested at once, there are usually few of different flags (e.g. main camera and shadows)
+    uint32_t flagsCount = 0;
+    uint32_t testFlags[MAX_MULTI_VIEWS], equalFlags[MAX_MULTI_VIEWS], flagsViews[MAX_MULTI_VIEWS]; // shifted to pool flags bits
+
+    // tile and kd-tree leaf flags are union of node flags, so only required flags can be tested
+    __forceinline uint32_t unionFlagsVisibility(uint32_t flags, uint32_t in_views) const;
+    __forceinline vec4i nodesFlagsVisibility(vec4i flags, uint32_t in_views) const; // lane per node
+    // in_out_inside is views where box is known to be inside frustum on input, and where it is found inside on output
+    __forceinline uint32_t boxVisibility(bbox3f_cref box, uint32_t in_views, uint32_t &in_out_inside) const;
+    // tests bounding spheres of 4 nodes, transposed to x, y, z and radius, with views which are not in in_inside or use distance
+    __forceinline void spheresVisibility(const vec4f *spheres, vec4f max_dist_sq, uint32_t in_views, uint32_t in_inside,
+      uint32_t *in_out_views, uint32_t *out_inside) const;
+    __forceinline uint32_t boxOcclusion(bbox3f_cref box, uint32_t in_views) const;
+  };
+  // returns union of frustum boxes of all views
+  bbox3f initMultiViewCullData(MultiViewCullData &mv, dag::ConstSpan<TiledSceneCullView> views) const;
+  // culls 4 nodes at once (pointers can repeat), out_views (16 bytes aligned) is views where each of them is visible
+  template <bool use_flags, bool use_pools>
+  __forceinline void multiViewNodesVisibility(const MultiViewCullData &mv, const mat44f *const *m, uint32_t views,
+    uint32_t inside_views, uint32_t *out_views) const;
+  template <bool use_flags, bool use_pools, typename VisibleNodesF>
+  __forceinline void internalFrustumCullMultiView(const MultiViewCullData &mv, uint32_t tile_idx, uint32_t worker_id,
+    VisibleNodesF &visible_nodes) const;
+
   template <bool use_flags, bool use_pools, typename VisibleNodesFunctor> // VisibleNodesFunctor(scene::node_index, mat44f_cref)
   __forceinline void internalBoxCull(bbox3f_cref bbox, const TileCullData &tile, bbox3f_cref cull_box, uint32_t test_flags,
     uint32_t equal_flags, VisibleNodesFunctor visible_nodes) const;
@@ -941,6 +1008,314 @@ void scene::TiledScene::frustumCullOneTile(const scene::TiledSceneCullContext &c
       ctx.test_flags, ctx.equal_flags, occlusion, visible_nodes);
 }
 
+__forceinline uint32_t scene::TiledScene::MultiViewCullData::unionFlagsVisibility(uint32_t flags, uint32_t in_views) const
+{
+  for (uint32_t i = 0; i < flagsCount; ++i)
+    if ((flags & equalFlags[i]) != equalFlags[i])
+      in_views &= ~flagsViews[i];
+  return in_views;
+}
+
+__forceinline vec4i scene::TiledScene::MultiViewCullData::nodesFlagsVisibility(vec4i flags, uint32_t in_views) const
+{
+  vec4i views = v_splatsi(in_views);
+  for (uint32_t i = 0; i < flagsCount; ++i)
+  {
+    const vec4i passed = v_cmp_eqi(v_andi(flags, v_splatsi(testFlags[i])), v_splatsi(equalFlags[i]));
+    views = v_andi(views, v_ori(passed, v_splatsi(~flagsViews[i])));
+  }
+  return views;
+}
+
+__forceinline uint32_t scene::TiledScene::MultiViewCullData::boxVisibility(bbox3f_cref box, uint32_t in_views,
+  uint32_t &in_out_inside) const
+{
+  const vec3f center = v_bbox3_center(box), extent = v_sub(box.bmax, center);
+  const vec4f cx = v_splat_x(center), cy = v_splat_y(center), cz = v_splat_z(center);
+  const vec4f ex = v_splat_x(extent), ey = v_splat_y(extent), ez = v_splat_z(extent);
+  const vec4f minX = v_splat_x(box.bmin), minY = v_splat_y(box.bmin), minZ = v_splat_z(box.bmin);
+  const vec4f maxX = v_splat_x(box.bmax), maxY = v_splat_y(box.bmax), maxZ = v_splat_z(box.bmax);
+  const vec4f maxDistSq = v_splat_w(box.bmax);
+  uint32_t visible = 0, inside = 0;
+  for (uint32_t g = 0; g < groupsCount; ++g)
+  {
+    const uint32_t groupViews = (in_views >> (g * 4)) & 0xF;
+    if (!groupViews)
+      continue;
+    const Group &grp = groups[g];
+    const uint32_t groupInside = (in_out_inside >> (g * 4)) & 0xF;
+    vec4f outside = v_zero(), intersect = v_zero();
+    if ((groupViews & ~groupInside) != 0)
+      for (int p = 0; p < 6; ++p)
+      {
+        vec4f dist = v_madd(cx, grp.planeX[p], v_madd(cy, grp.planeY[p], v_madd(cz, grp.planeZ[p], grp.planeW[p])));
+        vec4f rad = v_madd(ex, grp.absPlaneX[p], v_madd(ey, grp.absPlaneY[p], v_mul(ez, grp.absPlaneZ[p])));
+        outside = v_or(outside, v_add(dist, rad));
+        intersect = v_or(intersect, v_sub(dist, rad));
+      }
+    // same as v_distance_sq_to_bbox_x, but for 4 view positions
+    vec4f dx = v_max(v_max(v_sub(minX, grp.posX), v_sub(grp.posX, maxX)), v_zero());
+    vec4f dy = v_max(v_max(v_sub(minY, grp.posY), v_sub(grp.posY, maxY)), v_zero());
+    vec4f dz = v_max(v_max(v_sub(minZ, grp.posZ), v_sub(grp.posZ, maxZ)), v_zero());
+    vec4f distSqScaled = v_mul(v_madd(dx, dx, v_madd(dy, dy, v_mul(dz, dz))), grp.distScale);
+    // planes test of box is conservative, so box outside of frustum box can still pass it
+    vec4f outsideBox = v_or(v_cmp_gt(minX, grp.boxMaxX), v_cmp_gt(grp.boxMinX, maxX));
+    outsideBox = v_or(outsideBox, v_or(v_cmp_gt(minY, grp.boxMaxY), v_cmp_gt(grp.boxMinY, maxY)));
+    outsideBox = v_or(outsideBox, v_or(v_cmp_gt(minZ, grp.boxMaxZ), v_cmp_gt(grp.boxMinZ, maxZ)));
+    const uint32_t culled =
+      (v_signmask(outside) & ~groupInside) | v_signmask(v_cmp_gt(distSqScaled, maxDistSq)) | v_signmask(outsideBox);
+    const uint32_t groupVisible = groupViews & ~culled;
+    visible |= groupVisible << (g * 4);
+    inside |= (groupVisible & (groupInside | ~v_signmask(intersect))) << (g * 4);
+  }
+  in_out_inside = inside;
+  return visible;
+}
+
+__forceinline void scene::TiledScene::MultiViewCullData::spheresVisibility(const vec4f *spheres, vec4f max_dist_sq, uint32_t in_views,
+  uint32_t in_inside, uint32_t *in_out_views, uint32_t *out_inside) const
+{
+  const vec4f cx = spheres[0], cy = spheres[1], cz = spheres[2], rad = spheres[3];
+  vec4i culled = v_zeroi(), intersected = v_zeroi(); // lane per node, bit per view
+  for (uint32_t bits = in_views & (~in_inside | distViews); bits; bits &= bits - 1)
+  {
+    const uint32_t v = __bsf_unsafe(bits);
+    const View &view = viewSplat[v];
+    const vec4i viewBit = v_splatsi(1 << v);
+    // distance scale is zero when distance culling is disabled
+    const vec4f dx = v_sub(view.posX, cx), dy = v_sub(view.posY, cy), dz = v_sub(view.posZ, cz);
+    const vec4f distSqScaled = v_mul(v_madd(dx, dx, v_madd(dy, dy, v_mul(dz, dz))), view.distScale);
+    vec4i culledLanes = v_cast_vec4i(v_cmp_gt(distSqScaled, max_dist_sq));
+    if (!(in_inside & (1u << v)))
+    {
+      vec4f outside = v_zero(), intersect = v_zero();
+      for (int p = 0; p < 6; ++p)
+      {
+        vec4f dist = v_madd(cx, view.planeX[p], v_madd(cy, view.planeY[p], v_madd(cz, view.planeZ[p], view.planeW[p])));
+        outside = v_or(outside, v_add(dist, rad));
+        intersect = v_or(intersect, v_sub(dist, rad));
+      }
+      culledLanes = v_ori(culledLanes, v_srai(v_cast_vec4i(outside), 31));
+      intersected = v_ori(intersected, v_andi(v_srai(v_cast_vec4i(intersect), 31), viewBit));
+    }
+    culled = v_ori(culled, v_andi(culledLanes, viewBit));
+  }
+  alignas(16) uint32_t culledViews[4], intersectedViews[4];
+  v_sti(culledViews, culled);
+  v_sti(intersectedViews, intersected);
+  for (uint32_t k = 0; k < 4; ++k)
+  {
+    in_out_views[k] &= ~culledViews[k];
+    out_inside[k] = in_inside & ~intersectedViews[k];
+  }
+}
+
+__forceinline uint32_t scene::TiledScene::MultiViewCullData::boxOcclusion(bbox3f_cref box, uint32_t in_views) const
+{
+  uint32_t ret = in_views;
+  for (uint32_t bits = in_views & occlusionViews; bits; bits &= bits - 1)
+  {
+    const uint32_t v = __bsf_unsafe(bits);
+    if (!views[v].occlusion->isVisibleBox(box.bmin, box.bmax))
+      ret &= ~(1u << v);
+  }
+  return ret;
+}
+
+template <bool use_flags, bool use_pools>
+__forceinline void scene::TiledScene::multiViewNodesVisibility(const MultiViewCullData &mv, const mat44f *const *m, uint32_t views,
+  uint32_t inside_views, uint32_t *out_views) const
+{
+  vec4f spheres[4]; // broad phase
+  for (uint32_t k = 0; k < 4; ++k)
+    spheres[k] = get_node_bsphere(*m[k]);
+  if (use_flags)
+    v_sti(out_views, mv.nodesFlagsVisibility(v_make_vec4i(get_node_pool_flags(*m[0]), get_node_pool_flags(*m[1]),
+                                                get_node_pool_flags(*m[2]), get_node_pool_flags(*m[3])),
+                                                views));
+  else
+    v_sti(out_views, v_splatsi(views));
+  v_mat44_transpose(spheres[0], spheres[1], spheres[2], spheres[3]);
+  const vec4f maxDistSq = v_perm_zwcd(v_merge_lw(m[0]->col0, m[1]->col0), v_merge_lw(m[2]->col0, m[3]->col0)); // w of col0
+  uint32_t inside[4];
+  mv.spheresVisibility(spheres, maxDistSq, out_views[0] | out_views[1] | out_views[2] | out_views[3], inside_views, out_views,
+    inside);
+
+  // narrow check by pool box, for views where sphere intersects frustum, and occlusion
+  for (uint32_t k = 0; k < 4; ++k)
+  {
+    for (uint32_t bits = out_views[k] & ((use_pools ? ~inside[k] : 0) | mv.occlusionViews); bits; bits &= bits - 1)
+    {
+      const uint32_t v = __bsf_unsafe(bits);
+      const TiledSceneCullView &view = mv.views[v];
+      if (use_pools)
+      {
+        const uint32_t pool = get_node_pool_flags(*m[k]) & 0xFFFF;
+        G_FAST_ASSERT(pool < poolBox.size());
+        mat44f clipTm;
+        v_mat44_mul43(clipTm, view.globtm, *m[k]);
+        bbox3f poolBbox = poolBox.data()[pool];
+        if (view.occlusion ? !view.occlusion->isVisibleBox(poolBbox.bmin, poolBbox.bmax, clipTm)
+                           : !v_is_visible_b_fast_8planes(poolBbox.bmin, poolBbox.bmax, clipTm))
+          out_views[k] &= ~(1u << v);
+      }
+      else
+      {
+        const vec4f sphere = get_node_bsphere(*m[k]);
+        if (!view.occlusion->isVisibleSphere(sphere, v_splat_w(sphere)))
+          out_views[k] &= ~(1u << v);
+      }
+    }
+  }
+}
+
+template <bool use_flags, bool use_pools, typename VisibleNodesF>
+__forceinline void scene::TiledScene::internalFrustumCullMultiView(const MultiViewCullData &mv, uint32_t tile_idx, uint32_t worker_id,
+  VisibleNodesF &visible_nodes) const
+{
+  const bbox3f &bbox = tileBox.data()[tile_idx];
+  const TileCullData &tile = tileCull.data()[tile_idx];
+  G_FAST_ASSERT(!tile.isDead());
+  const uint32_t flags_and_kdtreenodes_count = getKdTreeCountFlags(bbox);
+  uint32_t views = mv.allViews;
+  if (use_flags && !(views = mv.unionFlagsVisibility(flags_and_kdtreenodes_count, views)))
+    return;
+  uint32_t insideViews = 0;
+  views = mv.boxOcclusion(bbox, mv.boxVisibility(bbox, views, insideViews));
+  if (!views)
+    return;
+
+  // nodes are prefetched and tested in chunks, and only then reported, so that loads of node matrices overlap
+  static constexpr uint32_t CHUNK = 32;
+  auto cullNodes = [&](uint32_t start, uint32_t end, uint32_t leaf_views, uint32_t leaf_inside) {
+    for (uint32_t chunk = start; chunk < end; chunk += CHUNK)
+    {
+      const uint32_t count = min(end - chunk, CHUNK);
+      const mat44f *m[CHUNK];
+      alignas(16) uint32_t nodeViews[CHUNK];
+      for (uint32_t i = 0; i < count; ++i)
+      {
+#if DAGOR_DBGLEVEL > 1
+        m[i] = &getNode(tile.nodes[chunk + i]);
+#else
+        m[i] = &nodes.data()[getNodeIndexInternal(tile.nodes[chunk + i])];
+#endif
+        PREFETCH_DATA(0, m[i]);
+      }
+      for (uint32_t i = count; i & 3; ++i) // last node is repeated in incomplete batch
+        m[i] = m[count - 1];
+      for (uint32_t i = 0; i < count; i += 4)
+        multiViewNodesVisibility<use_flags, use_pools>(mv, m + i, leaf_views, leaf_inside, nodeViews + i);
+      for (uint32_t i = 0; i < count; ++i)
+        if (nodeViews[i])
+          visible_nodes(tile.nodes[chunk + i], *m[i], nodeViews[i], worker_id);
+    }
+  };
+
+#if !KD_LEAVES_ONLY
+#error unsupport full kd trees
+#endif
+  const uint16_t kdTreeNodeCount = flags_and_kdtreenodes_count & 0xFFFF;
+  if (!kdTreeNodeCount)
+  {
+    cullNodes(0, tile.nodesCount, views, insideViews);
+    return;
+  }
+  const int32_t kdTreeLeftNode = tile.kdTreeLeftNode;
+  G_FAST_ASSERT(kdTreeLeftNode >= 0);
+  G_FAST_ASSERT(kdTreeLeftNode + kdTreeNodeCount <= kdNodes.size());
+  uint32_t start = 0, count = 0;
+  for (int i = kdTreeLeftNode, ei = kdTreeLeftNode + kdTreeNodeCount; i < ei; ++i, start += count)
+  {
+    const auto kdNode = kdNodes.data()[i];
+    const uint32_t flags_nodes_count = v_extract_wi(v_cast_vec4i(kdNode.bmin_start));
+    count = flags_nodes_count & 0xFFFF;
+    uint32_t leafViews = views;
+    if (use_flags && !(leafViews = mv.unionFlagsVisibility(flags_nodes_count, leafViews)))
+      continue;
+    uint32_t leafInside = insideViews;
+    leafViews = mv.boxOcclusion(kdNode.getBox(), mv.boxVisibility(kdNode.getBox(), leafViews, leafInside));
+    if (leafViews)
+      cullNodes(start, start + count, leafViews, leafInside);
+  }
+}
+
+template <bool use_flags, bool use_pools, typename VisibleNodesF>
+void scene::TiledScene::frustumCullMultiView(dag::ConstSpan<TiledSceneCullView> views, VisibleNodesF visible_nodes,
+  uint32_t tiles_per_job) const
+{
+  G_ASSERT_RETURN(views.size() <= MAX_MULTI_VIEWS, );
+  if (!views.size() || !getNodesAliveCount())
+    return;
+
+  ReadLockRAII lock(*this);
+  MultiViewCullData mv;
+  const bbox3f frustumsBox = initMultiViewCullData(mv, views);
+  if (tileCull.size() <= 1) // if evrything is in outer tile, or no tiles at all, there is nothing to distribute between workers
+  {
+    const bool hasFree = freeIndices.size() != 0;
+    int batch[4], batchCount = 0;
+    auto cullBatch = [&]() {
+      const mat44f *m[4];
+      for (int k = 0; k < 4; ++k)
+        m[k] = &nodes.data()[batch[min(k, batchCount - 1)]];
+      alignas(16) uint32_t nodeViews[4];
+      multiViewNodesVisibility<use_flags, use_pools>(mv, m, mv.allViews, 0, nodeViews);
+      for (int k = 0; k < batchCount; ++k)
+        if (nodeViews[k])
+          visible_nodes(getNodeFromIndex(batch[k]), *m[k], nodeViews[k], 0);
+      batchCount = 0;
+    };
+    for (int i = firstAlive, ei = (node_index)nodes.size(); i < ei; ++i)
+    {
+      if (hasFree && isInvalidIndex(i))
+        continue;
+      batch[batchCount++] = i;
+      if (batchCount == 4)
+        cullBatch();
+    }
+    if (batchCount)
+      cullBatch();
+    return;
+  }
+
+  eastl::fixed_vector<uint32_t, 256, true, framemem_allocator> tiles;
+  alignas(16) int regions[4];
+  getBoxRegion(regions, frustumsBox.bmin, frustumsBox.bmax);
+  const int tilesInGrid = (regions[2] - regions[0] + 1) * (regions[3] - regions[1] + 1);
+  checkSoA();
+  if ((int)tileCull.size() <= tilesInGrid)
+  {
+    for (int i = OUTER_TILE_INDEX; i < tileCull.size(); ++i)
+      if (!isEmptyTileMemory(tileBox.data()[i]))
+        tiles.push_back(i);
+  }
+  else
+  {
+    for (int tz = regions[1]; tz <= regions[3]; ++tz)
+      for (int tx = regions[0]; tx <= regions[2]; ++tx)
+      {
+        const uint32_t tileIndex = getTileIndexOffseted(tx, tz);
+        if (tileIndex == INVALID_INDEX)
+          continue;
+        G_FAST_ASSERT(tileIndex < tileCull.size());
+        G_FAST_ASSERT(!isEmptyTileMemory(tileBox.data()[tileIndex]));
+        tiles.push_back(tileIndex);
+      }
+    if (!isEmptyTileMemory(tileBox.data()[OUTER_TILE_INDEX]))
+      tiles.push_back(OUTER_TILE_INDEX);
+  }
+
+  auto cullTiles = [&](uint32_t begin, uint32_t end, uint32_t worker_id) {
+    for (uint32_t i = begin; i < end; ++i)
+      internalFrustumCullMultiView<use_flags, use_pools>(mv, tiles[i], worker_id, visible_nodes);
+  };
+  if (tiles_per_job && threadpool::get_num_workers() > 0)
+    threadpool::parallel_for_inline(0, tiles.size(), tiles_per_job, cullTiles);
+  else
+    cullTiles(0, tiles.size(), 0);
+}
+
 
 template <bool use_flags, bool use_pools, typename VisibleNodesFunctor>
 __forceinline void scene::TiledScene::internalBoxCull(bbox3f_cref bbox, const TileCullData &tile, bbox3f_cref cull_box,
@@ -114,11 +114,11 @@ protected:
   void clear_leaf_bounds() { dump.leafLimits.setEmpty(); }
 
   void buildLNode(LNode *node, FaceIndex *fc, int numf, SceneRayBuildContext &ctx);
-  void buildLeaf(Leaf **leaf, SceneRayBuildContext &ctx);
+  void buildLeaf(Leaf **leaf, uintptr_t &at, SceneRayBuildContext &ctx);
   void replacePointers(Node *);
   void replaceAllPointers();
   __forceinline bool __add_face(const RTface &rf, int ri);
-  uintptr_t build_node(FaceIndex *fc, int numf, SceneRayBuildContext &ctx); // index in nodesMemory
+  uintptr_t build_node(FaceIndex *fc, int numf, uintptr_t at, SceneRayBuildContext &ctx); // at is index in nodesMemory
 };
 
 BuildableStaticSceneRayTracer *create_buildable_staticmeshscene_raytracer(const Point3 &lsz, int lev);
@@ -12,7 +12,7 @@ using namespace AnimV20;
 struct AnimData::AnimDataHeader
 {
   unsigned label;    // MAKE4C('A','N','I','M')
-  unsigned ver;      // 0x220
+  unsigned ver;      // 0x220 (+1 when additive, +2 when some tracks use KEYFMT_PACKED16)
   unsigned hdrSize;  // =sizeof(AnimDataHeader)
   unsigned dumpSize; // total dump size
 };
@@ -256,7 +256,7 @@ bool AnimData::load(IGenLoad &crd, class IMemAlloc *ma)
     logerr_ctx("unrecognized label %c%c%c%c", _DUMP4C(hdr.label));
     return false;
   }
-  else if (hdr.ver != 0x220 && hdr.ver != 0x221)
+  else if ((hdr.ver & ~3u) != 0x220)
   {
     logerr_ctx("unsupported version 0x%08x", hdr.ver);
     return false;
@@ -274,7 +274,7 @@ bool AnimData::load(IGenLoad &crd, class IMemAlloc *ma)
 
   crd.read(&dumpData, sizeof(dumpData));
   dumpData.patchData(dump);
-  animAdditive = (hdr.ver == 0x221);
+  animAdditive = (hdr.ver & 1) != 0;
 
   anim.setup(dumpData);
   return true;
@@ -301,14 +301,14 @@ void AnimData::Anim::setup(DumpData &d)
   p3 = d.getChanPoint3(CHTYPE_ORIGIN_LINVEL);
   if (p3)
   {
-    G_ASSERT(p3->nodeNum == 1);
+    G_ASSERT(p3->nodeNum == 1 && !p3->nodeAnim[0].isPacked());
     memcpy(&originLinVel, &p3->nodeAnim[0], sizeof(originLinVel));
   }
 
   p3 = d.getChanPoint3(CHTYPE_ORIGIN_ANGVEL);
   if (p3)
   {
-    G_ASSERT(p3->nodeNum == 1);
+    G_ASSERT(p3->nodeNum == 1 && !p3->nodeAnim[0].isPacked());
     memcpy(&originAngVel, &p3->nodeAnim[0], sizeof(originAngVel));
   }
 }
@@ -792,6 +792,7 @@ bool AnimBlender::blend(TlsContext &tls, IPureAnimStateHolder &st, IAnimBlendNod
   WeightedNode<AnimKeyPoint3> *chPos = tls.chPos, *chScl = tls.chScl;
   WeightedNode<AnimKeyQuat> *chRot = tls.chRot;
   PrsResult *chPrs = tls.chPrs;
+  Tab<vec4f> &packedVal = tls.packedVal;
 
   if (PROFILE_BLENDING)
   {
@@ -829,6 +830,7 @@ bool AnimBlender::blend(TlsContext &tls, IPureAnimStateHolder &st, IAnimBlendNod
   // clear blending lists
   memset(wtPos, 0, nodenum * sizeof(NodeWeight) * 3); // zero wtPos, wtScl, wtRot
   mem_set_0(readyMark);
+  packedVal.clear();
 
   if (PROFILE_BLENDING)
     __pm_prepare.go();
@@ -837,7 +839,8 @@ bool AnimBlender::blend(TlsContext &tls, IPureAnimStateHolder &st, IAnimBlendNod
   enum
   {
     BMOD_ADDITIVE = 1 << 0,
-    BMOD_CHARDEP = 1 << 1
+    BMOD_CHARDEP = 1 << 1,
+    BMOD_PACKED = 1 << 2, // value is already sampled to packedVal[bsrc.packedIdx]
   };
   for (i = 0; i < bnlNum; i++)
   {
@@ -880,7 +883,7 @@ bool AnimBlender::blend(TlsContext &tls, IPureAnimStateHolder &st, IAnimBlendNod
 
       WeightedNode<AnimKeyPoint3> &ch = chPos[targetChN];
       WeightedNode<AnimKeyPoint3>::BlendSrc &bsrc = ch.blendSrc[ch_w.totalNum];
-      ch.blendMod[ch_w.totalNum] = bmod;
+      ch.blendMod[ch_w.totalNum] = bmod | (chan.isPacked() ? BMOD_PACKED : 0);
       if (charDep && charDepNodeId != targetChN)
         ch.blendMod[ch_w.totalNum] &= ~BMOD_CHARDEP;
       ch.readyFlg = (ch_w.totalNum ? ch.readyFlg : 0) | (additive ? RM_POS_A : RM_POS_B);
@@ -890,7 +893,16 @@ bool AnimBlender::blend(TlsContext &tls, IPureAnimStateHolder &st, IAnimBlendNod
       else if (ch_w.totalNum == 1)
         ch_w.wTotal = 1.0; //< only additive anims for node, mark wTotal as 'used'
       bsrc.w = w;
-      bsrc.k = chan.findKey(wa_pos, &bsrc.t);
+      if (chan.isPacked())
+      {
+        float t;
+        int k = chan.findKeyIdx(wa_pos, &t);
+        bsrc.packedIdx = packedVal.size();
+        bsrc.t = 0;
+        packedVal.push_back(AnimV20Math::interp_chan_key(chan, k, t));
+      }
+      else
+        bsrc.k = chan.findKey(wa_pos, &bsrc.t);
     }
 
     for (j = 0; j < scl.nodeNum; j++)
@@ -919,7 +931,7 @@ bool AnimBlender::blend(TlsContext &tls, IPureAnimStateHolder &st, IAnimBlendNod
 
       WeightedNode<AnimKeyPoint3> &ch = chScl[targetChN];
       WeightedNode<AnimKeyPoint3>::BlendSrc &bsrc = ch.blendSrc[ch_w.totalNum];
-      ch.blendMod[ch_w.totalNum] = bmod;
+      ch.blendMod[ch_w.totalNum] = bmod | (chan.isPacked() ? BMOD_PACKED : 0);
       ch.readyFlg = (ch_w.totalNum ? ch.readyFlg : 0) | (additive ? RM_SCL_A : RM_SCL_B);
       ch_w.totalNum++;
       if (!additive)
@@ -927,7 +939,16 @@ bool AnimBlender::blend(TlsContext &tls, IPureAnimStateHolder &st, IAnimBlendNod
       else if (ch_w.totalNum == 1)
         ch_w.wTotal = 1.0; //< only additive anims for node, mark wTotal as 'used'
       bsrc.w = w;
-      bsrc.k = chan.findKey(wa_pos, &bsrc.t);
+      if (chan.isPacked())
+      {
+        float t;
+        int k = chan.findKeyIdx(wa_pos, &t);
+        bsrc.packedIdx = packedVal.size();
+        bsrc.t = 0;
+        packedVal.push_back(AnimV20Math::interp_chan_key(chan, k, t));
+      }
+      else
+        bsrc.k = chan.findKey(wa_pos, &bsrc.t);
     }
 
     for (j = 0; j < rot.nodeNum; j++)
@@ -954,7 +975,7 @@ bool AnimBlender::blend(TlsContext &tls, IPureAnimStateHolder &st, IAnimBlendNod
 
       WeightedNode<AnimKeyQuat> &ch = chRot[targetChN];
       WeightedNode<AnimKeyQuat>::BlendSrc &bsrc = ch.blendSrc[ch_w.totalNum];
-      ch.blendMod[ch_w.totalNum] = bmod & ~BMOD_CHARDEP;
+      ch.blendMod[ch_w.totalNum] = (bmod & ~BMOD_CHARDEP) | (chan.isPacked() ? BMOD_PACKED : 0);
       ch.readyFlg = (ch_w.totalNum ? ch.readyFlg : 0) | (additive ? RM_ROT_A : RM_ROT_B);
       ch_w.totalNum++;
       if (!additive)
@@ -962,7 +983,16 @@ bool AnimBlender::blend(TlsContext &tls, IPureAnimStateHolder &st, IAnimBlendNod
       else if (ch_w.totalNum == 1)
         ch_w.wTotal = 1.0; //< only additive anims for node, mark wTotal as 'used'
       bsrc.w = w;
-      bsrc.k = chan.findKey(wa_pos, &bsrc.t);
+      if (chan.isPacked())
+      {
+        float t;
+        int k = chan.findKeyIdx(wa_pos, &t);
+        bsrc.packedIdx = packedVal.size();
+        bsrc.t = 0;
+        packedVal.push_back(AnimV20Math::interp_chan_key(chan, k, t));
+      }
+      else
+        bsrc.k = chan.findKey(wa_pos, &bsrc.t);
     }
   }
   if (PROFILE_BLENDING)
@@ -992,7 +1022,10 @@ bool AnimBlender::blend(TlsContext &tls, IPureAnimStateHolder &st, IAnimBlendNod
     t4 = v_splat4(&bsrc->t);
     w4 = v_splat4(&bsrc->w);
 
-    v = bsrc->interp() ? AnimV20Math::interp_key(*bsrc->k, t4) : bsrc->k->p;
+    if (*bmod & BMOD_PACKED)
+      v = packedVal[bsrc->packedIdx];
+    else
+      v = bsrc->interp() ? AnimV20Math::interp_key(*bsrc->k, t4) : bsrc->k->p;
     if (*bmod & BMOD_CHARDEP)
       v = v_madd(v, cmm_scl, cmm_ofs);
 
@@ -1008,7 +1041,10 @@ bool AnimBlender::blend(TlsContext &tls, IPureAnimStateHolder &st, IAnimBlendNod
       {
         t4 = v_splat4(&bsrc->t);
         w4 = v_splat4(&bsrc->w);
-        v = bsrc->interp() ? AnimV20Math::interp_key(*bsrc->k, t4) : bsrc->k->p;
+        if (*bmod & BMOD_PACKED)
+          v = packedVal[bsrc->packedIdx];
+        else
+          v = bsrc->interp() ? AnimV20Math::interp_key(*bsrc->k, t4) : bsrc->k->p;
         if (*bmod & BMOD_CHARDEP)
           v = v_madd(v, cmm_scl, cmm_ofs);
 
@@ -1037,7 +1073,10 @@ bool AnimBlender::blend(TlsContext &tls, IPureAnimStateHolder &st, IAnimBlendNod
     t4 = v_splat4(&bsrc->t);
     w4 = v_splat4(&bsrc->w);
 
-    v = bsrc->interp() ? AnimV20Math::interp_key(*bsrc->k, t4) : bsrc->k->p;
+    if (*bmod & BMOD_PACKED)
+      v = packedVal[bsrc->packedIdx];
+    else
+      v = bsrc->interp() ? AnimV20Math::interp_key(*bsrc->k, t4) : bsrc->k->p;
     if (*bmod & BMOD_CHARDEP)
       v = v_mul(v, cmm_scl);
 
@@ -1057,7 +1096,10 @@ bool AnimBlender::blend(TlsContext &tls, IPureAnimStateHolder &st, IAnimBlendNod
       {
         t4 = v_splat4(&bsrc->t);
         w4 = v_splat4(&bsrc->w);
-        v = bsrc->interp() ? AnimV20Math::interp_key(*bsrc->k, t4) : bsrc->k->p;
+        if (*bmod & BMOD_PACKED)
+          v = packedVal[bsrc->packedIdx];
+        else
+          v = bsrc->interp() ? AnimV20Math::interp_key(*bsrc->k, t4) : bsrc->k->p;
         if (*bmod & BMOD_CHARDEP)
           v = v_mul(v, cmm_scl);
 
@@ -1092,7 +1134,10 @@ bool AnimBlender::blend(TlsContext &tls, IPureAnimStateHolder &st, IAnimBlendNod
     readyMark[i] |= ch.readyFlg;
 
 
-    v = bsrc->interp() ? AnimV20Math::interp_key(bsrc->k[0], bsrc->k[1], bsrc->t) : bsrc->k->p;
+    if (*bmod & BMOD_PACKED)
+      v = packedVal[bsrc->packedIdx];
+    else
+      v = bsrc->interp() ? AnimV20Math::interp_key(bsrc->k[0], bsrc->k[1], bsrc->t) : bsrc->k->p;
 
     if (!bnum && !(*bmod & BMOD_ADDITIVE) && fabsf(bsrc->w) > 0)
       chPrs[i].rot = v;
@@ -1107,7 +1152,10 @@ bool AnimBlender::blend(TlsContext &tls, IPureAnimStateHolder &st, IAnimBlendNod
       bmod++;
       for (; bnum; bsrc++, bmod++, bnum--)
       {
-        v = bsrc->interp() ? AnimV20Math::interp_key(bsrc->k[0], bsrc->k[1], bsrc->t) : bsrc->k->p;
+        if (*bmod & BMOD_PACKED)
+          v = packedVal[bsrc->packedIdx];
+        else
+          v = bsrc->interp() ? AnimV20Math::interp_key(bsrc->k[0], bsrc->k[1], bsrc->t) : bsrc->k->p;
         if (!(*bmod & BMOD_ADDITIVE))
         {
           wsum += bsrc->w;
@@ -1292,7 +1292,6 @@ void ApbAnimateCtrl::init(IPureAnimStateHolder &st, const GeomNodeTree &tree)
 void ApbAnimateCtrl::process(IPureAnimStateHolder &st, real /*w*/, GeomNodeTree &tree, AnimPostBlendCtrl::Context &)
 {
   NodeId *nodeId = (NodeId *)st.getInlinePtr(varId);
-  float tpos = 0, tscl = 0, trot = 0;
   vec3f p, s;
   quat4f r;
 
@@ -1312,20 +1311,9 @@ void ApbAnimateCtrl::process(IPureAnimStateHolder &st, real /*w*/, GeomNodeTree
       if (!n_idx)
         continue;
 
-      if (AnimV20::AnimKeyPoint3 *kpos = anim[j].pos ? anim[j].pos->findKey(t, &tpos) : NULL)
-        p = (tpos != 0.f) ? AnimV20Math::interp_key(kpos[0], v_splat4(&tpos)) : kpos->p;
-      else
-        p = v_zero();
-
-      if (AnimV20::AnimKeyQuat *krot = anim[j].rot ? anim[j].rot->findKey(t, &trot) : NULL)
-        r = (trot != 0.f) ? AnimV20Math::interp_key(krot[0], krot[1], trot) : krot->p;
-      else
-        r = v_zero();
-
-      if (AnimV20::AnimKeyPoint3 *kscl = anim[j].scl ? anim[j].scl->findKey(t, &tscl) : NULL)
-        s = (tscl != 0.f) ? AnimV20Math::interp_key(kscl[0], v_splat4(&tscl)) : kscl->p;
-      else
-        s = V_C_ONE;
+      p = anim[j].pos ? AnimV20Math::sample_chan(*anim[j].pos, t) : v_zero();
+      r = anim[j].rot ? AnimV20Math::sample_chan(*anim[j].rot, t) : v_zero();
+      s = anim[j].scl ? AnimV20Math::sample_chan(*anim[j].scl, t) : V_C_ONE;
 
       v_mat44_compose(tree.getNodeTm(n_idx), p, r, s);
       tree.invalidateWtm(n_idx.preceeding());
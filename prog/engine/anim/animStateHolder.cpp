@@ -9,6 +9,7 @@
 #include <anim/dag_animBlend.h>
 #include "animFifo.h"
 #include <anim/dag_animIrq.h>
+#include <util/dag_hash.h>
 
 using namespace AnimV20;
 
@@ -202,6 +203,36 @@ void AnimCommonStateHolder::advance(real dt)
   }
 }
 
+uint64_t AnimCommonStateHolder::calcBlendStateHash(float time_quant) const
+{
+  const AnimationGraph *g = &graph;
+  uint64_t h = mem_hash_fnv1<64>((const char *)&g, sizeof(g));
+  float inv_quant = time_quant > 0 ? 1.f / time_quant : 0.f;
+  for (int i = 0, ie = val.size(); i < ie; i++)
+  {
+    ParamState s = val[i];
+    if (paramTypes[i] == PT_InlinePtrCTZ) // per-instance data, doesn't define pose
+    {
+      i += getInlinePtrWords(paramTypes, i) - 1;
+      continue;
+    }
+    if (paramTypes[i] == PT_TimeParam && inv_quant > 0)
+      s.scalarInt = int(floorf(s.scalar * inv_quant));
+    h = mem_hash_fnv1<64>((const char *)&s, sizeof(s), h);
+  }
+  return h;
+}
+
+void AnimCommonStateHolder::copyValuesFrom(const void *src)
+{
+  const ParamState *src_val = (const ParamState *)src;
+  for (int i = 0, ie = val.size(); i < ie; i++)
+    if (paramTypes[i] == PT_InlinePtrCTZ)
+      i += getInlinePtrWords(paramTypes, i) - 1;
+    else
+      val[i] = src_val[i];
+}
+
 
 //
 // Store/restore state of anim state holder via snapshot
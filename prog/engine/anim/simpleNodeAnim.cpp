@@ -50,9 +50,9 @@ void SimpleNodeAnim::calcAnimTm(TMatrix &tm, int t, int d_keys_no_blend /* = -1*
   vec3f p, s;
   quat4f r;
   int dkeys = 0;
-  AnimV20::AnimKeyPoint3 *kpos = pos ? pos->findKeyEx(t, &tpos, dkeys) : NULL;
-  AnimV20::AnimKeyQuat *krot = rot ? rot->findKey(t, &trot) : NULL;
-  AnimV20::AnimKeyPoint3 *kscl = scl ? scl->findKey(t, &tscl) : NULL;
+  int kpos = pos ? pos->findKeyIdxEx(t, &tpos, dkeys) : -1;
+  int krot = rot ? rot->findKeyIdx(t, &trot) : -1;
+  int kscl = scl ? scl->findKeyIdx(t, &tscl) : -1;
 
   if (dkeys <= d_keys_no_blend)
   {
@@ -61,20 +61,9 @@ void SimpleNodeAnim::calcAnimTm(TMatrix &tm, int t, int d_keys_no_blend /* = -1*
     trot = 0;
   }
 
-  if (kpos)
-    p = (tpos != 0.f) ? AnimV20Math::interp_key(kpos[0], v_splat4(&tpos)) : kpos->p;
-  else
-    p = v_zero();
-
-  if (krot)
-    r = (trot != 0.f) ? AnimV20Math::interp_key(krot[0], krot[1], trot) : krot->p;
-  else
-    r = v_zero();
-
-  if (kscl)
-    s = (tscl != 0.f) ? AnimV20Math::interp_key(kscl[0], v_splat4(&tscl)) : kscl->p;
-  else
-    s = V_C_ONE;
+  p = (kpos >= 0) ? AnimV20Math::interp_chan_key(*pos, kpos, tpos) : v_zero();
+  r = (krot >= 0) ? AnimV20Math::interp_chan_key(*rot, krot, trot) : v_zero();
+  s = (kscl >= 0) ? AnimV20Math::interp_chan_key(*scl, kscl, tscl) : V_C_ONE;
 
   tm = AnimV20Math::makeTM((Point3 &)p, (Quat &)r, (Point3 &)s);
 }
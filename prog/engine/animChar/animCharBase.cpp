@@ -22,6 +22,8 @@
 #include <debug/dag_log.h>
 #include <debug/dag_debug.h>
 #include <startup/dag_globalSettings.h>
+#include <osApiWrappers/dag_spinlock.h>
+#include <util/dag_hash.h>
 // #include <debug/dag_debug3d.h>
 
 using namespace AnimV20;
@@ -441,6 +443,7 @@ void AnimcharBaseComponent::resetAnim()
       stateDirector->reset(true);
     // debug_ctx("animState.size=%d", animState->getSize());
   }
+  clear_and_shrink(poseHist);
   if (originalNodeTree && nodeTree.nodeCount() > 1)
   {
     memcpy(&nodeTree.getRootTm() + 1, &originalNodeTree->getRootTm() + 1, sizeof(mat44f) * (nodeTree.nodeCount() - 1));
@@ -749,6 +752,121 @@ const DataBlock *AnimcharBaseComponent::getDebugNodemasks()
   return animGraph ? animGraph->getDebugNodemasks(animDbgCtx) : NULL;
 }
 
+// poses blended during current sharing pass (see ULF_SHARE_POSE), reused by animchars with equal key
+namespace
+{
+struct SharedPose
+{
+  uint64_t key;
+  Tab<mat44f> tm;     // local tm of animMap nodes
+  Tab<char> stateVal; // anim state values after blend
+};
+} // namespace
+static constexpr int MAX_SHARED_POSES = 64;
+static SharedPose shared_pose[MAX_SHARED_POSES];
+static int shared_pose_cnt = 0;
+static float shared_pose_time_quant = 1.f / 30.f;
+static OSSpinlock shared_pose_lock;
+
+void AnimcharBaseComponent::resetSharedPoses(float time_quant)
+{
+  OSSpinlockScopedLock lock(shared_pose_lock);
+  shared_pose_cnt = 0;
+  shared_pose_time_quant = time_quant;
+}
+
+static bool get_shared_pose(uint64_t key, AnimCommonStateHolder &st, const Tab<AnimMap> &anim_map, GeomNodeTree &tree)
+{
+  OSSpinlockScopedLock lock(shared_pose_lock);
+  for (int i = 0; i < shared_pose_cnt; i++)
+  {
+    const SharedPose &sp = shared_pose[i];
+    if (sp.key != key || sp.tm.size() != anim_map.size() || sp.stateVal.size() != st.getSize())
+      continue;
+    for (int j = 0, je = anim_map.size(); j < je; j++)
+      tree.getNodeTm(anim_map[j].geomId) = sp.tm[j];
+    st.copyValuesFrom(sp.stateVal.data());
+    return true;
+  }
+  return false;
+}
+
+static bool can_put_shared_pose(uint64_t key)
+{
+  for (int i = 0; i < shared_pose_cnt; i++)
+    if (shared_pose[i].key == key) // already published by other animchar
+      return false;
+  return shared_pose_cnt < MAX_SHARED_POSES;
+}
+
+static void put_shared_pose(uint64_t key, const AnimCommonStateHolder &st, const Tab<AnimMap> &anim_map, const GeomNodeTree &tree)
+{
+  {
+    OSSpinlockScopedLock lock(shared_pose_lock);
+    if (!can_put_shared_pose(key))
+      return;
+  }
+
+  // pose is copied (and memory allocated) outside of spinlock, slot data is only swapped under it
+  SharedPose pose;
+  pose.key = key;
+  pose.tm.resize(anim_map.size());
+  for (int j = 0, je = anim_map.size(); j < je; j++)
+    pose.tm[j] = tree.getNodeTm(anim_map[j].geomId);
+  pose.stateVal.resize(st.getSize());
+  st.copyValuesTo(pose.stateVal.data());
+
+  OSSpinlockScopedLock lock(shared_pose_lock);
+  if (!can_put_shared_pose(key))
+    return;
+  SharedPose &sp = shared_pose[shared_pose_cnt++];
+  sp.key = key;
+  sp.tm.swap(pose.tm); // stale data of slot is freed with pose, after lock is released
+  sp.stateVal.swap(pose.stateVal);
+}
+
+void AnimcharBaseComponent::setUpdateLodFlags(unsigned flags)
+{
+  if (!(flags & ULF_INTERP_POSE))
+    clear_and_shrink(poseHist);
+  updateLodFlags = flags;
+}
+
+void AnimcharBaseComponent::capturePoseHistory()
+{
+  const int n = animMap.size();
+  const bool first = poseHist.size() != n * 6;
+  if (first)
+    clear_and_resize(poseHist, n * 6);
+  else
+    memcpy(poseHist.data(), poseHist.data() + n * 3, n * 3 * sizeof(vec4f));
+
+  vec4f *last = poseHist.data() + n * 3;
+  for (int i = 0; i < n; i++)
+    v_mat4_decompose(nodeTree.getNodeTm(animMap[i].geomId), last[i * 3 + 0], last[i * 3 + 1], last[i * 3 + 2]);
+  if (first)
+    memcpy(poseHist.data(), last, n * 3 * sizeof(vec4f));
+}
+
+void AnimcharBaseComponent::applyPoseHistory(float t)
+{
+  const int n = animMap.size();
+  const vec4f *prev = poseHist.data(), *last = prev + n * 3;
+  vec4f vt = v_splats(t);
+  for (int i = 0; i < n; i++, prev += 3, last += 3)
+    if (animMap[i].geomId) // root tm is owned by setTm()
+      v_mat44_compose(nodeTree.getNodeTm(animMap[i].geomId), v_lerp_vec4f(vt, prev[0], last[0]), v_quat_qslerp(t, prev[1], last[1]),
+        v_lerp_vec4f(vt, prev[2], last[2]));
+  nodeTree.invalidateWtm();
+}
+
+void AnimcharBaseComponent::interpolatePose(float t)
+{
+  if ((updateLodFlags & ULF_INTERP_POSE) && poseHist.size() == animMap.size() * 6)
+    applyPoseHistory(t);
+  recalcWtm();
+}
+
 void AnimcharBaseComponent::calcAnimWtm(bool may_calc_anim)
 {
   if (animGraph && !animValid && may_calc_anim)
@@ -757,11 +875,28 @@ void AnimcharBaseComponent::calcAnimWtm(bool may_calc_anim)
     nodeTree.invalidateWtm();
     vec3f world_translate = nodeTree.translateToZero();
     bool haveBlend = false;
+    uint64_t sharedPoseKey = 0;
     if (!postCtrl || !postCtrl->overridesBlender())
     {
-      haveBlend |= animGraph->blend(*(tls = &animGraph->selectBlenderCtx(&irq, this)), *animState, getCharDepModif());
-      haveBlend |= motionMatchingController && motionMatchingController->blend(*tls, animMap, animMapPRS);
-      // we need both blend, because we have blending from animGraph to motionMatchingController.
+      if ((updateLodFlags & ULF_SHARE_POSE) && !motionMatchingController)
+      {
+        sharedPoseKey = animState->calcBlendStateHash(shared_pose_time_quant);
+        sharedPoseKey = mem_hash_fnv1<64>((const char *)&originalNodeTree, sizeof(originalNodeTree), sharedPoseKey);
+        sharedPoseKey = mem_hash_fnv1<64>((const char *)&node0, sizeof(node0), sharedPoseKey);
+        if (get_shared_pose(sharedPoseKey, *animState, animMap, nodeTree))
+          sharedPoseKey = 0;
+        else
+          tls = &animGraph->selectBlenderCtx(&irq, this);
+      }
+      else
+        tls = &animGraph->selectBlenderCtx(&irq, this);
+
+      if (tls)
+      {
+        haveBlend |= animGraph->blend(*tls, *animState, getCharDepModif());
+        haveBlend |= motionMatchingController && motionMatchingController->blend(*tls, animMap, animMapPRS);
+        // we need both blend, because we have blending from animGraph to motionMatchingController.
+      }
     }
     if (haveBlend && tls)
     {
@@ -806,6 +941,8 @@ void AnimcharBaseComponent::calcAnimWtm(bool may_calc_anim)
       perf_tm2.pause();
       perfanimgblend::perf_tm.pause();
 #endif
+      if (sharedPoseKey)
+        put_shared_pose(sharedPoseKey, *animState, animMap, nodeTree);
     }
 
     nodeTree.calcWtm();
@@ -815,7 +952,7 @@ void AnimcharBaseComponent::calcAnimWtm(bool may_calc_anim)
     perf_tm3.go();
 #endif
     // post-blend processing
-    if (tls)
+    if (tls && !(updateLodFlags & ULF_SKIP_POST_BLEND))
     {
       AnimPostBlendCtrl::Context ctx(*originalNodeTree, this, (float *)alloca(animGraph->getPbcWtParamCount() * sizeof(float)),
         animGraph->getPbcWtParamCount(), node0.chanNodeId() < -1 ? NULL : &node0.sScale, &irq, this, world_translate);
@@ -829,6 +966,12 @@ void AnimcharBaseComponent::calcAnimWtm(bool may_calc_anim)
     perfanimgblend::perf_tm.pause();
 #endif
 
+    if (updateLodFlags & ULF_INTERP_POSE)
+    {
+      // previous pose is shown now and interpolated to just evaluated one till next evaluation
+      capturePoseHistory();
+      applyPoseHistory(0.f);
+    }
     recalcWtm(world_translate);
 
     animValid = true;
@@ -3,6 +3,7 @@
 #include <math/dag_triangleBoxIntersection.h>
 #include <math/dag_geomTree.h>
 #include <math/dag_traceRayTriangle.h>
+#include <math/dag_bits.h>
 #include <math/dag_plane3.h>
 #include <debug/dag_debug.h>
 #include <generic/dag_sort.h>
@@ -107,6 +108,21 @@ struct ProfileStats
   unsigned meshTrianglesHits = 0;
 };
 
+// 4 rays (transposed, lane per ray) vs box, same as v_test_ray_box_intersection_unsafe() for each ray
+// inv_dir should be v_rcp_safe(dir, V_C_MAX_VAL), returns vector mask of intersected rays
+static __forceinline vec4f v_test_ray4_box_intersection_unsafe(const mat43f &from, const mat43f &inv_dir, vec4f len, bbox3f box)
+{
+  vec4f t1x = v_mul(v_sub(v_splat_x(box.bmin), from.row0), inv_dir.row0);
+  vec4f t2x = v_mul(v_sub(v_splat_x(box.bmax), from.row0), inv_dir.row0);
+  vec4f t1y = v_mul(v_sub(v_splat_y(box.bmin), from.row1), inv_dir.row1);
+  vec4f t2y = v_mul(v_sub(v_splat_y(box.bmax), from.row1), inv_dir.row1);
+  vec4f t1z = v_mul(v_sub(v_splat_z(box.bmin), from.row2), inv_dir.row2);
+  vec4f t2z = v_mul(v_sub(v_splat_z(box.bmax), from.row2), inv_dir.row2);
+  vec4f tFar = v_min(v_min(v_max(t1x, t2x), v_max(t1y, t2y)), v_max(t1z, t2z));
+  vec4f tNear = v_max(v_max(v_min(t1x, t2x), v_min(t1y, t2y)), v_min(t1z, t2z));
+  return v_and(v_cmp_ge(tFar, v_max(tNear, v_zero())), v_cmp_ge(len, tNear));
+}
+
 template <typename T>
 static inline void sort_collres_intersections(T &intersected_nodes_list)
 {
@@ -814,6 +830,128 @@ __forceinline bool CollisionResource::forEachIntersectedNode(const mat44f tm, fl
       else
         v_mat44_inverse43(nodeItm, nodeTm);
 
+      auto onHit = [&](int traceId, float localT, float inOutLocalT, vec3f vNodeLocalNorm, vec3f vNodeLocalCapsuleHitPos) {
+        CollisionTrace &trace = traces[traceId];
+        hasCollision = true;
+        float intersectionT = trace.t * (inOutLocalT / localT);
+        vec3f vIntersectionPos = v_madd(trace.vDir, v_splats(intersectionT), trace.vFrom);
+        vec3f vIntersectionNorm = v_zero();
+        if (trace_mode == FIND_BEST_INTERSECTION)
+        {
+          trace.t = intersectionT;
+          trace.vTo = vIntersectionPos;
+        }
+        if (calc_normal)
+        {
+          if (EASTL_LIKELY(isOrthouniformTm))
+            vIntersectionNorm = v_mat44_mul_vec3v(nodeTm, vNodeLocalNorm);
+          else
+          {
+            mat33f itm33, titm33;
+            v_mat33_from_mat44(itm33, nodeItm);
+            v_mat33_transpose(titm33, itm33);
+            vIntersectionNorm = v_mat33_mul_vec3(titm33, vNodeLocalNorm);
+          }
+          vIntersectionNorm = v_norm3(vIntersectionNorm);
+        }
+        if (trace_type == CollisionTraceType::TRACE_CAPSULE)
+        {
+          // For capsule trace we have custom intersection pos output, which often lie not on a ray
+          vIntersectionPos = v_mat44_mul_vec3p(nodeTm, vNodeLocalCapsuleHitPos);
+        }
+        if (out_stats)
+        {
+          out_stats->nodeCount++;
+          out_stats->triangleCount += (meshNode->indices.size() / 3);
+        }
+        profileStats.meshTrianglesHits++;
+        callback(traceId, meshNode, intersectionT, vIntersectionNorm, vIntersectionPos);
+        if (trace_mode == FIND_BEST_INTERSECTION && intersectionT < VERY_SMALL_NUMBER)
+          trace.isectBounding = false;
+      };
+
+      auto onAllHits = [&](int traceId, float localT, const all_nodes_ret_t &ret) {
+        const CollisionTrace &trace = traces[traceId];
+        hasCollision = true;
+        mat33f titm33;
+        if (!isOrthouniformTm && calc_normal)
+        {
+          mat33f itm33;
+          v_mat33_from_mat44(itm33, nodeItm);
+          v_mat33_transpose(titm33, itm33);
+        }
+        for (auto n_t : ret)
+        {
+          float intersectionT = trace.t * (v_extract_w(n_t) / localT);
+          vec3f vIntersectionNorm = v_zero();
+          vec3f vIntersectionPos = v_madd(trace.vDir, v_splats(intersectionT), trace.vFrom);
+          if (calc_normal)
+          {
+            mat33f normTm;
+            v_mat33_from_mat44(normTm, nodeTm);
+            if (EASTL_UNLIKELY(!isOrthouniformTm))
+              normTm = titm33;
+            vIntersectionNorm = v_norm3(v_mat33_mul_vec3(normTm, n_t));
+          }
+          callback(traceId, meshNode, intersectionT, vIntersectionNorm, vIntersectionPos);
+        }
+        if (out_stats)
+        {
+          out_stats->nodeCount++;
+          out_stats->triangleCount += (meshNode->indices.size() / 3);
+        }
+        profileStats.meshTrianglesHits += ret.size();
+      };
+
+      // Rays of multi trace which passed node bounding are traced by packets of 4, so triangles are loaded and tested once per
+      // packet instead of once per ray. Hits of packet are reported in order of rays, as in ray by ray tracing.
+      constexpr bool use_ray_packets = !is_single_ray && trace_type == CollisionTraceType::TRACE_RAY &&
+                                       (trace_mode == FIND_BEST_INTERSECTION || trace_mode == ALL_INTERSECTIONS);
+      constexpr int PACKET_SIZE = 4;
+      alignas(16) vec4f packetFrom[PACKET_SIZE], packetDir[PACKET_SIZE];
+      alignas(16) float packetT[PACKET_SIZE];
+      int packetTraceId[PACKET_SIZE];
+      int packetSize = 0;
+      auto flushPacket = [&]() {
+        if (!packetSize)
+          return;
+        for (int i = packetSize; i < PACKET_SIZE; i++)
+        {
+          packetFrom[i] = packetDir[i] = v_zero();
+          packetT[i] = 0.f; // can't hit anything
+        }
+        mat43f from4, dir4;
+        v_mat44_transpose_to_mat43(packetFrom[0], packetFrom[1], packetFrom[2], packetFrom[3], from4.row0, from4.row1, from4.row2);
+        v_mat44_transpose_to_mat43(packetDir[0], packetDir[1], packetDir[2], packetDir[3], dir4.row0, dir4.row1, dir4.row2);
+        bool isLightNode = meshNode->indices.size() < traceMeshNodeLocalApi.threshold;
+        IF_CONSTEXPR (trace_mode == FIND_BEST_INTERSECTION)
+        {
+          vec4f inOutT = v_ld(packetT);
+          alignas(16) vec4f norm[PACKET_SIZE];
+          int hitMask = (isLightNode ? traceRay4MeshNodeLocalCullCCW<false> : traceRay4MeshNodeLocalCullCCW<true>)(*meshNode, from4, dir4,
+            inOutT, calc_normal ? norm : nullptr);
+          alignas(16) float outT[PACKET_SIZE];
+          v_st(outT, inOutT);
+          for (; hitMask; hitMask &= hitMask - 1)
+          {
+            const int lane = __bsf_unsafe(hitMask);
+            onHit(packetTraceId[lane], packetT[lane], outT[lane], calc_normal ? norm[lane] : v_zero(), v_zero());
+          }
+        }
+        else
+        {
+          all_nodes_ret_t ret[PACKET_SIZE];
+          int hitMask = (isLightNode ? traceRay4MeshNodeLocalAllHits<false> : traceRay4MeshNodeLocalAllHits<true>)(*meshNode, from4, dir4,
+            v_ld(packetT), calc_normal, force_no_cull, ret);
+          for (; hitMask; hitMask &= hitMask - 1)
+          {
+            const int lane = __bsf_unsafe(hitMask);
+            onAllHits(packetTraceId[lane], packetT[lane], ret[lane]);
+          }
+        }
+        packetSize = 0;
+      };
+
       for (int traceId = 0, traceEnd = traces.size(); traceId < traceEnd; traceId++)
       {
         CollisionTrace &trace = traces[traceId];
@@ -856,11 +994,20 @@ __forceinline bool CollisionResource::forEachIntersectedNode(const mat44f tm, fl
         profileStats.meshNodesBoxCheckPassed++;
         profileStats.meshTrianglesTraced += meshNode->indices.size() / 3;
 
-        IF_CONSTEXPR (trace_mode != ALL_INTERSECTIONS || trace_type == CollisionTraceType::RAY_HIT ||
-                      trace_type == CollisionTraceType::CAPSULE_HIT)
+        IF_CONSTEXPR (use_ray_packets)
+        {
+          packetFrom[packetSize] = vNodeLocalFrom;
+          packetDir[packetSize] = vNodeLocalDir;
+          packetT[packetSize] = localT;
+          packetTraceId[packetSize] = traceId;
+          if (++packetSize == PACKET_SIZE)
+            flushPacket();
+        }
+        else IF_CONSTEXPR (trace_mode != ALL_INTERSECTIONS || trace_type == CollisionTraceType::RAY_HIT ||
+                           trace_type == CollisionTraceType::CAPSULE_HIT)
         {
           float inOutLocalT = localT;
-          vec3f vNodeLocalNorm, vNodeLocalCapsuleHitPos;
+          vec3f vNodeLocalNorm = v_zero(), vNodeLocalCapsuleHitPos = v_zero();
           vec3f *normPtr = calc_normal ? &vNodeLocalNorm : nullptr;
 
           bool isHit = false;
@@ -888,48 +1035,11 @@ __forceinline bool CollisionResource::forEachIntersectedNode(const mat44f tm, fl
           }
           if (isHit)
           {
-            hasCollision = true;
-            float intersectionT = trace.t * (inOutLocalT / localT);
-            vec3f vIntersectionPos = v_madd(trace.vDir, v_splats(intersectionT), trace.vFrom);
-            vec3f vIntersectionNorm = v_zero();
-            if (trace_mode == FIND_BEST_INTERSECTION)
-            {
-              trace.t = intersectionT;
-              trace.vTo = vIntersectionPos;
-            }
-            if (calc_normal)
-            {
-              if (EASTL_LIKELY(isOrthouniformTm))
-                vIntersectionNorm = v_mat44_mul_vec3v(nodeTm, vNodeLocalNorm);
-              else
-              {
-                mat33f itm33, titm33;
-                v_mat33_from_mat44(itm33, nodeItm);
-                v_mat33_transpose(titm33, itm33);
-                vIntersectionNorm = v_mat33_mul_vec3(titm33, vNodeLocalNorm);
-              }
-              vIntersectionNorm = v_norm3(vIntersectionNorm);
-            }
-            if (trace_type == CollisionTraceType::TRACE_CAPSULE)
-            {
-              // For capsule trace we have custom intersection pos output, which often lie not on a ray
-              vIntersectionPos = v_mat44_mul_vec3p(nodeTm, vNodeLocalCapsuleHitPos);
-            }
-            if (out_stats)
-            {
-              out_stats->nodeCount++;
-              out_stats->triangleCount += (meshNode->indices.size() / 3);
-            }
-            profileStats.meshTrianglesHits++;
-            callback(traceId, meshNode, intersectionT, vIntersectionNorm, vIntersectionPos);
+            onHit(traceId, localT, inOutLocalT, vNodeLocalNorm, vNodeLocalCapsuleHitPos);
             if (trace_mode == ANY_ONE_INTERSECTION)
               return hasCollision;
-            if (trace_mode == FIND_BEST_INTERSECTION && intersectionT < VERY_SMALL_NUMBER)
-            {
-              trace.isectBounding = false;
-              if (is_single_ray)
-                return hasCollision;
-            }
+            if (is_single_ray && !trace.isectBounding)
+              return hasCollision;
           }
         }
         else IF_CONSTEXPR (trace_mode == ALL_INTERSECTIONS)
@@ -947,39 +1057,11 @@ __forceinline bool CollisionResource::forEachIntersectedNode(const mat44f tm, fl
                                     : traceMeshNodeLocalApi.heavy.pfnTraceRayMeshNodeLocalAllHits)(*meshNode, vNodeLocalFrom,
             vNodeLocalDir, localT, calc_normal, force_no_cull, ret);
           if (isHit)
-          {
-            hasCollision = true;
-            mat33f titm33;
-            if (!isOrthouniformTm && calc_normal)
-            {
-              mat33f itm33;
-              v_mat33_from_mat44(itm33, nodeItm);
-              v_mat33_transpose(titm33, itm33);
-            }
-            for (auto n_t : ret)
-            {
-              float intersectionT = trace.t * (v_extract_w(n_t) / localT);
-              vec3f vIntersectionNorm = v_zero();
-              vec3f vIntersectionPos = v_madd(trace.vDir, v_splats(intersectionT), trace.vFrom);
-              if (calc_normal)
-              {
-                mat33f normTm;
-                v_mat33_from_mat44(normTm, nodeTm);
-                if (EASTL_UNLIKELY(!isOrthouniformTm))
-                  normTm = titm33;
-                vIntersectionNorm = v_norm3(v_mat33_mul_vec3(normTm, n_t));
-              }
-              callback(traceId, meshNode, intersectionT, vIntersectionNorm, vIntersectionPos);
-            }
-            if (out_stats)
-            {
-              out_stats->nodeCount++;
-              out_stats->triangleCount += (meshNode->indices.size() / 3);
-            }
-            profileStats.meshTrianglesHits += ret.size();
-          }
+            onAllHits(traceId, localT, ret);
         } // allow multiple intersection of one node or not
       }   // traces loop
+      IF_CONSTEXPR (use_ray_packets)
+        flushPacket();
     }     // mesh nodes loop
 
     if (EASTL_LIKELY(!boxNodesHead && !sphereNodesHead && !capsuleNodesHead))
@@ -1944,6 +2026,119 @@ VECTORCALL DAGOR_NOINLINE bool CollisionResource::traceRayMeshNodeLocalAllHits(c
   return !ret_array.empty();
 }
 
+template <bool check_bounding>
+VECTORCALL DAGOR_NOINLINE int CollisionResource::traceRay4MeshNodeLocalCullCCW(const CollisionNode &node, const mat43f &v_local_from,
+  const mat43f &v_local_dir, vec4f &in_out_t, vec4f *v_out_norm)
+{
+  const uint16_t *__restrict indices = node.indices.data();
+  const Point3_vec4 *__restrict vertices = node.vertices.data();
+  const uint32_t indicesSize = node.indices.size();
+
+  mat43f invDir;
+  if (check_bounding)
+  {
+    invDir.row0 = v_rcp_safe(v_local_dir.row0, V_C_MAX_VAL);
+    invDir.row1 = v_rcp_safe(v_local_dir.row1, V_C_MAX_VAL);
+    invDir.row2 = v_rcp_safe(v_local_dir.row2, V_C_MAX_VAL);
+  }
+
+  // same batches as in single ray version, batch bounding is skipped only when all rays of packet miss it
+  const uint32_t batchSize = 4;
+  vec4i resultIdx = v_splatsi(-1);
+  for (uint32_t i = 0; EASTL_LIKELY(i < indicesSize); i += batchSize * 3)
+  {
+    const uint32_t batchEnd = min(i + batchSize * 3, indicesSize);
+    if (check_bounding)
+    {
+      bbox3f box;
+      v_bbox3_init(box, v_ld(&vertices[indices[i]].x));
+      for (uint32_t j = i + 1; j < batchEnd; j++)
+        v_bbox3_add_pt(box, v_ld(&vertices[indices[j]].x));
+      if (EASTL_LIKELY(!v_signmask(v_test_ray4_box_intersection_unsafe(v_local_from, invDir, in_out_t, box))))
+        continue;
+    }
+
+    // same culling as traceray4TrianglesCullCCW() in single ray version, so results of both are identical
+    for (uint32_t j = i; j < batchEnd; j += 3)
+    {
+      vec4f valid = traceray4RaysTriangleVecMask(v_local_from, v_local_dir, in_out_t, v_ld(&vertices[indices[j + 0]].x),
+        v_ld(&vertices[indices[j + 1]].x), v_ld(&vertices[indices[j + 2]].x), true);
+      resultIdx = v_cast_vec4i(v_sel(v_cast_vec4f(resultIdx), v_cast_vec4f(v_splatsi(j)), valid));
+    }
+  }
+
+  int hitMask = ~v_signmask(v_cast_vec4f(resultIdx)) & 0xF;
+  if (hitMask && v_out_norm)
+  {
+    alignas(16) int idx[4];
+    v_sti(idx, resultIdx);
+    for (int lanes = hitMask; lanes; lanes &= lanes - 1)
+    {
+      const int lane = __bsf_unsafe(lanes);
+      vec4f v0 = v_ld(&vertices[indices[idx[lane] + 0]].x);
+      vec4f v1 = v_ld(&vertices[indices[idx[lane] + 1]].x);
+      vec4f v2 = v_ld(&vertices[indices[idx[lane] + 2]].x);
+      v_out_norm[lane] = v_cross3(v_sub(v1, v0), v_sub(v2, v0));
+    }
+  }
+  return hitMask;
+}
+
+template <bool check_bounding>
+VECTORCALL DAGOR_NOINLINE int CollisionResource::traceRay4MeshNodeLocalAllHits(const CollisionNode &node, const mat43f &v_local_from,
+  const mat43f &v_local_dir, vec4f in_t, bool calc_normal, bool no_cull, all_nodes_ret_t *ret_arrays)
+{
+  const uint16_t *__restrict indices = node.indices.data();
+  const Point3_vec4 *__restrict vertices = node.vertices.data();
+  const uint32_t indicesSize = node.indices.size();
+  no_cull |= node.checkBehaviorFlags(CollisionNode::SOLID);
+
+  mat43f invDir;
+  if (check_bounding)
+  {
+    invDir.row0 = v_rcp_safe(v_local_dir.row0, V_C_MAX_VAL);
+    invDir.row1 = v_rcp_safe(v_local_dir.row1, V_C_MAX_VAL);
+    invDir.row2 = v_rcp_safe(v_local_dir.row2, V_C_MAX_VAL);
+  }
+
+  const uint32_t batchSize = 4;
+  int hitMask = 0;
+  for (uint32_t i = 0; EASTL_LIKELY(i < indicesSize); i += batchSize * 3)
+  {
+    const uint32_t batchEnd = min(i + batchSize * 3, indicesSize);
+    if (check_bounding)
+    {
+      bbox3f box;
+      v_bbox3_init(box, v_ld(&vertices[indices[i]].x));
+      for (uint32_t j = i + 1; j < batchEnd; j++)
+        v_bbox3_add_pt(box, v_ld(&vertices[indices[j]].x));
+      if (EASTL_LIKELY(!v_signmask(v_test_ray4_box_intersection_unsafe(v_local_from, invDir, in_t, box))))
+        continue;
+    }
+
+    for (uint32_t j = i; j < batchEnd; j += 3)
+    {
+      vec4f v0 = v_ld(&vertices[indices[j + 0]].x);
+      vec4f v1 = v_ld(&vertices[indices[j + 1]].x);
+      vec4f v2 = v_ld(&vertices[indices[j + 2]].x);
+      vec4f vOutT = in_t;
+      int ret = v_signmask(traceray4RaysTriangleVecMask(v_local_from, v_local_dir, vOutT, v0, v1, v2, no_cull));
+      if (EASTL_LIKELY(ret == 0))
+        continue;
+      hitMask |= ret;
+      vec3f vNorm = calc_normal ? v_cross3(v_sub(v1, v0), v_sub(v2, v0)) : v_zero();
+      alignas(16) float outT[4];
+      v_st(outT, vOutT);
+      for (; ret; ret &= ret - 1)
+      {
+        const int lane = __bsf_unsafe(ret);
+        ret_arrays[lane].push_back(v_perm_xyzd(vNorm, v_splats(outT[lane])));
+      }
+    }
+  }
+  return hitMask;
+}
+
 template <bool check_bounding>
 VECTORCALL DAGOR_NOINLINE bool CollisionResource::rayHitMeshNodeLocalCullCCW(const CollisionNode &node, const vec3f &v_local_from,
   const vec3f &v_local_dir, float in_t)
@@ -29,6 +29,8 @@
 #include <util/dag_globDef.h>
 #include <util/dag_texMetaData.h>
 #include <perfMon/dag_perfTimer.h>
+#include <util/dag_threadPool.h>
+#include <osApiWrappers/dag_atomic.h>
 #include "grpData.h"
 #include <stdio.h>
 #include <osApiWrappers/dag_miscApi.h>
@@ -217,18 +219,23 @@ void get_game_resource_name(int id, String &name) { return ::getGameResName(id,
 // ZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZ//
 
 
+struct GameResPackPrefetch;
+
 struct GameResPackInfo
 {
   SimpleString fileName;
   gamerespackbin::GrpData *grData;
+  GameResPackPrefetch *prefetch;
   int refCount;
   bool surelyLoaded;
 
-  GameResPackInfo() : grData(NULL), refCount(0), surelyLoaded(false) {}
+  GameResPackInfo() : grData(NULL), prefetch(NULL), refCount(0), surelyLoaded(false) {}
 
   bool processGrData();
 
   void loadPack();
+  bool loadPrefetchedPack();
+  void loadResData(IGenLoad &cb);
 
   void endLoading()
   {
@@ -761,11 +768,463 @@ void GameResPackInfo::addRefResIds(int res_id, Tab<int> &res_ids)
   }
 }
 
+static constexpr int GRP_RANGES_BUF_SZ = 64;
+
+struct GrpRangesStats
+{
+  int dataSize = 0, wasteSize = 0, wasteLastSize = 0, resCnt = 0;
+};
+
+static inline bool is_pack_res_needed(int gdni, int pack_id)
+{
+  if (resRestrictionList.size() && ((uint32_t)gdni >= (uint32_t)resRestrictionList.size() || !resRestrictionList.get(gdni)))
+    return false;
+  return resId_to_packId[gdni] == pack_id;
+}
+
+// reads GRP header and descriptor (from cache dump when available); throws IGenLoad::LoadException on error
+static gamerespackbin::GrpData *read_grp_desc(IGenLoad &cb, const char *fname, int file_sz)
+{
+  using namespace gamerespackbin;
+  GrpData *gd = NULL;
+  String cache_fname(0, "%scache.bin", fname);
+  VromReadHandle dump_data = ::vromfs_get_file_data(cache_fname);
+
+  if (!dump_data.data())
+  {
+    GrpHeader ghdr;
+
+    // check id
+    cb.read(&ghdr, sizeof(ghdr));
+    if (ghdr.label != _MAKE4C('GRP2') && ghdr.label != _MAKE4C('GRP3'))
+    {
+      debug("no GRP2 label (hdr: 0x%x 0x%x 0x%x 0x%x)", ghdr.label, ghdr.descOnlySize, ghdr.fullDataSize, ghdr.restFileSize);
+#if (DAGOR_DBGLEVEL < 1) && DAGOR_FORCE_LOGS
+      fatal("no GRP2 label in %s", fname);
+#endif
+      DAGOR_THROW(IGenLoad::LoadException("no GRP2 label", cb.tell()));
+    }
+    if (ghdr.restFileSize + sizeof(ghdr) != file_sz)
+    {
+      debug("Corrupt file: hdr+restFileSize=%u != filesz=%d", unsigned(ghdr.restFileSize + sizeof(ghdr)), file_sz);
+#if (DAGOR_DBGLEVEL < 1) && DAGOR_FORCE_LOGS
+      fatal("Corrupt file %s", fname);
+#endif
+      DAGOR_THROW(IGenLoad::LoadException("Corrupt file: restFileSize", cb.tell()));
+    }
+
+    gd = (GrpData *)memalloc(ghdr.descOnlySize, inimem);
+    cb.read(gd, ghdr.descOnlySize);
+    gd->patchDescOnly(ghdr.label);
+  }
+  else
+  {
+    GrpHeader *__restrict ghdr = (GrpHeader *)dump_data.data();
+
+    gd = (GrpData *)memalloc(ghdr->descOnlySize, inimem);
+    memcpy(gd, dump_data.data() + sizeof(GrpHeader), ghdr->descOnlySize);
+    gd->patchDescOnly(ghdr->label);
+  }
+
+  // register all names and renew nameMap
+  for (int i = 0; i < gd->nameMap.size(); i++)
+    gd->nameMap[i] = ::addGameResId(gd->getName(i));
+  return gd;
+}
+
+// builds (coalesced) ranges of resource data to be read from GRP; returns number of ranges written to rb
+static int gather_grp_ranges(const gamerespackbin::GrpData &gd, int pack_id, int file_sz, FastSeqReader::Range *rangesBuf,
+  GrpRangesStats &st)
+{
+  using namespace gamerespackbin;
+  FastSeqReader::Range *__restrict rb = rangesBuf, *__restrict rb_end = rb + GRP_RANGES_BUF_SZ;
+  dag::ConstSpan<int> gdNameId = gd.nameMap;
+  const ResEntry *__restrict rre = gd.resTable.data(), *__restrict rre_end = rre + gd.resTable.size();
+
+  for (; rre != rre_end; rre++)
+  {
+    if (rre->offset == 0)
+      continue;
+    if (!is_pack_res_needed(gdNameId[rre->resId], pack_id))
+      continue;
+    int st_p = rre->offset;
+    int end_p = (rre + 1 == rre_end) ? file_sz : rre[1].offset;
+    st.dataSize += end_p - st_p;
+    st.resCnt++;
+
+    if (rb == rangesBuf)
+    {
+      rb->start = st_p;
+      rb->end = end_p;
+      rb++;
+      continue;
+    }
+
+    if (st_p > rb[-1].end + (32 << 10) && rb < rb_end)
+    {
+      rb->start = st_p;
+      rb->end = end_p;
+      rb++;
+    }
+    else
+    {
+      st.wasteSize += st_p - rb[-1].end;
+      if (rb == rb_end)
+        st.wasteLastSize += st_p - rb[-1].end;
+      rb[-1].end = end_p;
+    }
+  }
+  return rb - rangesBuf;
+}
+
+
+// Reader over GRP data ranges fetched to memory in advance; offsets are the same as in GRP file
+class PrefetchedRangesLoadCB final : public IBaseLoad
+{
+public:
+  PrefetchedRangesLoadCB(dag::ConstSpan<FastSeqReader::Range> r, const char *d, const char *name) :
+    ranges(r), data(d), targetName(name)
+  {}
+
+  virtual void read(void *ptr, int size) override
+  {
+    if (tryRead(ptr, size) != size)
+      DAGOR_THROW(LoadException("read outside of prefetched ranges", pos));
+  }
+  virtual int tryRead(void *ptr, int size) override
+  {
+    if (!findRange())
+      return 0;
+    const FastSeqReader::Range &r = ranges[curRange];
+    if (size > r.end - pos)
+      size = r.end - pos;
+    memcpy(ptr, data + curRangeDataOfs + (pos - r.start), size);
+    pos += size;
+    return size;
+  }
+  virtual int tell() override { return pos; }
+  virtual void seekto(int p) override { pos = p; }
+  virtual void seekrel(int ofs) override { pos += ofs; }
+  virtual const char *getTargetName() override { return targetName; }
+
+protected:
+  dag::ConstSpan<FastSeqReader::Range> ranges;
+  const char *data;
+  const char *targetName;
+  int pos = 0, curRange = 0, curRangeDataOfs = 0;
+
+  bool findRange()
+  {
+    if (curRange < ranges.size() && pos >= ranges[curRange].start && pos < ranges[curRange].end)
+      return true;
+    curRangeDataOfs = 0;
+    for (curRange = 0; curRange < ranges.size(); curRangeDataOfs += ranges[curRange].end - ranges[curRange].start, curRange++)
+      if (pos >= ranges[curRange].start && pos < ranges[curRange].end)
+        return true;
+    return false;
+  }
+};
+
+
+// Job that reads GRP on threadpool worker, so that I/O of next packs overlaps with resource creation (which is done by
+// factories on the loading thread). It runs in two stages: descriptor first, then data ranges that are gathered from it on the
+// loading thread; worker touches only job members and thread-safe resNameMap
+struct GameResPackPrefetch final : public cpujobs::IJob
+{
+  SimpleString fileName;
+  gamerespackbin::GrpData *grData = NULL;
+  FastSeqReader::Range ranges[GRP_RANGES_BUF_SZ];
+  int rangesCnt = 0, fileSize = 0;
+  SmallTab<char, MidmemAlloc> data;
+  GrpRangesStats stats;
+  int readTimeUsec = 0;
+  bool dataRequested = false, failed = false;
+
+  explicit GameResPackPrefetch(const char *fname) : fileName(fname) {}
+  ~GameResPackPrefetch()
+  {
+    if (grData)
+      memfree(grData, inimem);
+  }
+
+  bool isDescReady() const { return interlocked_acquire_load(done) && !dataRequested && !failed; }
+
+  virtual void doJob() override
+  {
+    int64_t reft = profile_ref_ticks();
+    FastSeqReadCB cb;
+    if (!cb.open(fileName, 32 << 10))
+    {
+      failed = true;
+      return;
+    }
+
+    DAGOR_TRY
+    {
+      if (!dataRequested)
+      {
+        fileSize = cb.getSize();
+        grData = read_grp_desc(cb, fileName, fileSize);
+      }
+      else
+      {
+        cb.setRangesOfInterest(make_span(ranges, rangesCnt));
+        char *p = data.data();
+        for (int i = 0; i < rangesCnt; p += ranges[i].end - ranges[i].start, i++)
+        {
+          cb.seekto(ranges[i].start);
+          cb.read(p, ranges[i].end - ranges[i].start);
+        }
+      }
+    }
+    DAGOR_CATCH(IGenLoad::LoadException)
+    {
+      debug("Error prefetching GameResPack file %s", fileName.str());
+      failed = true;
+    }
+    cb.close();
+    readTimeUsec += profile_time_usec(reft);
+  }
+  virtual void releaseJob() override {}
+};
+
+static bool is_pack_loaded_or_loading(int pack_id)
+{
+  if (packInfo[pack_id].surelyLoaded || packInfo[pack_id].grData)
+    return true;
+  for (int i = 0; i < loadedPacks.size(); ++i)
+    if (loadedPacks[i] == pack_id)
+      return true;
+  return false;
+}
+
+// Window of packs that are prefetched ahead of loading during preload_all_required_res(); read but not yet consumed data
+// is limited by maxDataSize (except for the nearest pack), descriptors are limited by depth only.
+// Prefetch that won't be consumed (nothing needed in pack, pack is loaded already or loading went past it) is discarded to
+// return its slot and data budget
+static struct GameResPackPrefetchQueue
+{
+  Tab<int> order;
+  int firstIdx = 0, nextIdx = 0, consumedIdx = -1, inFlight = 0, depth = 0;
+  int dataInFlight = 0, maxDataSize = 64 << 20;
+  int usedCnt = 0, descOnlyCnt = 0, wastedCnt = 0, waitUsec = 0, readUsec = 0;
+
+  bool active() const { return depth > 0 && order.size() > 0; }
+  void start(dag::ConstSpan<int> pack_order)
+  {
+    finish();
+    if (depth <= 0 || !threadpool::get_num_workers() || pack_order.empty())
+      return;
+    order = pack_order;
+    usedCnt = descOnlyCnt = wastedCnt = waitUsec = readUsec = 0;
+    kick();
+  }
+  // called on loading thread only; prefetch of loading_pack_id is about to be consumed
+  void kick(int loading_pack_id = -1)
+  {
+    // drop prefetches that are not going to be consumed
+    for (int i = firstIdx; i < nextIdx; i++)
+      if (packInfo[order[i]].prefetch && order[i] != loading_pack_id && (i < consumedIdx || packInfo[order[i]].surelyLoaded))
+        discard(order[i]);
+
+    // request data of packs with ready descriptors in load order, while it fits into budget
+    while (firstIdx < nextIdx && !packInfo[order[firstIdx]].prefetch)
+      firstIdx++;
+    for (int i = firstIdx; i < nextIdx; i++)
+      if (GameResPackPrefetch *pf = packInfo[order[i]].prefetch)
+        if (pf->isDescReady() && !requestData(order[i], *pf))
+          break;
+
+    for (; inFlight < depth && nextIdx < order.size(); nextIdx++)
+    {
+      GameResPackInfo &pack = packInfo[order[nextIdx]];
+      if (pack.prefetch || is_pack_loaded_or_loading(order[nextIdx]) || ::vromfs_get_file_data(pack.fileName.str()).data())
+        continue;
+      pack.prefetch = new GameResPackPrefetch(pack.fileName);
+      threadpool::add(pack.prefetch, threadpool::PRIO_LOW);
+      inFlight++;
+    }
+  }
+  bool requestData(int pack_id, GameResPackPrefetch &pf)
+  {
+    GrpRangesStats st;
+    int cnt, total = 0;
+    {
+      WinAutoLock lock(gameres_cs);
+      cnt = gather_grp_ranges(*pf.grData, pack_id, pf.fileSize, pf.ranges, st);
+    }
+    for (int i = 0; i < cnt; i++)
+      total += pf.ranges[i].end - pf.ranges[i].start;
+    if (!cnt)
+    {
+      // all resources of pack are excluded by restriction list or loaded from other packs, so it won't be loaded
+      discard(pack_id);
+      return true;
+    }
+    if (dataInFlight && dataInFlight + total > maxDataSize)
+      return false;
+
+    pf.rangesCnt = cnt;
+    pf.stats = st;
+    pf.dataRequested = true;
+    clear_and_resize(pf.data, total);
+    dataInFlight += total;
+    threadpool::add(&pf, threadpool::PRIO_LOW);
+    return true;
+  }
+  void release(const GameResPackPrefetch &pf)
+  {
+    inFlight--;
+    dataInFlight -= pf.data.size();
+  }
+  void discard(int pack_id)
+  {
+    GameResPackPrefetch *pf = eastl::exchange(packInfo[pack_id].prefetch, nullptr);
+    threadpool::wait(pf, 0, threadpool::PRIO_LOW);
+    release(*pf);
+    del_it(pf);
+    wastedCnt++;
+  }
+  void onConsumed(int pack_id, const GameResPackPrefetch &pf, int wait_usec)
+  {
+    for (int i = firstIdx; i < nextIdx; i++)
+      if (order[i] == pack_id)
+      {
+        consumedIdx = max(consumedIdx, i);
+        break;
+      }
+    release(pf);
+    if (pf.dataRequested)
+      usedCnt++;
+    else
+      descOnlyCnt++;
+    waitUsec += wait_usec;
+    readUsec += pf.readTimeUsec;
+    if (active())
+      kick();
+  }
+  void finish()
+  {
+    if (!order.size())
+      return;
+    for (int pack_id : order)
+      if (packInfo[pack_id].prefetch)
+        discard(pack_id);
+    G_ASSERTF(!inFlight && !dataInFlight, "inFlight=%d dataInFlight=%d", inFlight, dataInFlight);
+    debug("GRP prefetch: %d packs used (read %d usec on workers, waited %d usec), %d with descriptor only, "
+          "%d prefetched but unused",
+      usedCnt, readUsec, waitUsec, descOnlyCnt, wastedCnt);
+    clear_and_shrink(order);
+    firstIdx = nextIdx = inFlight = dataInFlight = 0;
+    consumedIdx = -1;
+  }
+} pack_prefetch_queue;
+
+void set_gameres_pack_prefetch_depth(int depth, int max_data_kb)
+{
+  pack_prefetch_queue.depth = depth;
+  pack_prefetch_queue.maxDataSize = max_data_kb << 10;
+}
+
+void GameResPackInfo::loadResData(IGenLoad &cb)
+{
+  using namespace gamerespackbin;
+  int this_packId = this - packInfo.data();
+  dag::ConstSpan<int> gdNameId = grData->nameMap;
+  const ResEntry *rre = grData->resTable.data(), *rre_end = rre + grData->resTable.size();
+  for (; rre != rre_end; rre++)
+  {
+    if (rre->offset == 0)
+      continue;
+
+    // debug("read %s at %d", ::resNameMap.getName(gdNameId[rre->resId]), rre->offset);
+    if (!is_pack_res_needed(gdNameId[rre->resId], this_packId))
+      continue;
+    cb.seekto(rre->offset);
+
+    GameResourceFactory *fac = ::getFactoryByClassId(rre->classId);
+
+    if (!fac)
+    {
+      String className, resName;
+
+      ::getResClassName(rre->classId, className);
+      ::getGameResName(gdNameId[rre->resId], resName);
+
+      if (noFactoryFatal)
+        fatal("No factory for game resource %s:%s", className.str(), resName.str());
+      else
+        logwarn("No factory for game resource %s:%s", className.str(), resName.str());
+
+      continue;
+    }
+
+    fac->loadGameResourceData(gdNameId[rre->resId], cb);
+    if (gameres_finer_load_enabled)
+    {
+      int cnt = gameres_cs.fullUnlock();
+      sleep_msec(0);
+      gameres_cs.reLock(cnt);
+    }
+  }
+}
+
+bool GameResPackInfo::loadPrefetchedPack()
+{
+  GameResPackPrefetch *pf = prefetch;
+  prefetch = NULL;
+
+  // don't block other threads on gameres_cs while job is in flight
+  int64_t reft = profile_ref_ticks();
+  gameres_cs.lock();
+  int gameres_cs_cnt = gameres_cs.fullUnlock() - 1;
+  threadpool::wait(pf, 0, threadpool::PRIO_LOW);
+  if (gameres_cs_cnt)
+    gameres_cs.reLock(gameres_cs_cnt);
+  int wait_usec = profile_time_usec(reft);
+  pack_prefetch_queue.onConsumed(this - packInfo.data(), *pf, wait_usec);
+  if (pf->failed || !pf->dataRequested)
+  {
+    // when data didn't fit into prefetch budget, it is read as usual using prefetched descriptor
+    if (!pf->failed)
+      grData = eastl::exchange(pf->grData, nullptr);
+    del_it(pf);
+    return false;
+  }
+
+  debug_ctx("loading GRP %s (prefetched)", (char *)fileName);
+  grData = eastl::exchange(pf->grData, nullptr);
+  int64_t create_reft = profile_ref_ticks();
+  DAGOR_TRY
+  {
+    PrefetchedRangesLoadCB cb(make_span_const(pf->ranges, pf->rangesCnt), pf->data.data(), fileName.str());
+    loadResData(cb);
+  }
+  DAGOR_CATCH(IGenLoad::LoadException) { debug("Error reading GameResPack file %s", fileName.str()); }
+  int create_usec = profile_time_usec(create_reft);
+
+  debug("loaded GRP %s (prefetched), %dK in %d res (%d areas), read %d usec on worker, waited %d usec (%d%% overlapped), "
+        "loaded data in %d usec",
+    fileName.str(), pf->stats.dataSize >> 10, pf->stats.resCnt, pf->rangesCnt, pf->readTimeUsec, wait_usec,
+    pf->readTimeUsec ? 100 - min(wait_usec, pf->readTimeUsec) * 100 / pf->readTimeUsec : 100, create_usec);
+  del_it(pf);
+
+  // process loaded res-data
+  processGrData();
+  surelyLoaded = true;
+  return true;
+}
+
 void GameResPackInfo::loadPack()
 {
   if (!refCount)
     TRACE("===+ load extraneous GRP: %s\n", fileName.str());
 
+  if (pack_prefetch_queue.active())
+    pack_prefetch_queue.kick(this - packInfo.data());
+  if (prefetch && loadPrefetchedPack())
+    return;
+
   int64_t reft = profile_ref_ticks();
   using namespace gamerespackbin;
   FastSeqReadCB seq_cb;
@@ -798,145 +1257,24 @@ void GameResPackInfo::loadPack()
   size_t sys_mem = dagor_memory_stat::get_memory_allocated();
   size_t gpu_mem = d3d::driver_command(DRV3D_COMMAND_GETTEXTUREMEM, 0, 0, 0);
 #endif
-  static constexpr int RANGES_BUF_SZ = 64;
-  FastSeqReader::Range rangesBuf[RANGES_BUF_SZ];
-  FastSeqReader::Range *__restrict rb = rangesBuf, *__restrict rb_end = rb + RANGES_BUF_SZ;
-  int data_size = 0;
-  int waste_size = 0, waste_last_size = 0;
-  int res_cnt = 0;
+  FastSeqReader::Range rangesBuf[GRP_RANGES_BUF_SZ];
+  FastSeqReader::Range *rb = rangesBuf;
+  GrpRangesStats st;
 
   DAGOR_TRY
   {
-    String cache_fname(0, "%scache.bin", fileName.str());
-    VromReadHandle dump_data = ::vromfs_get_file_data(cache_fname);
-
-    if (!dump_data.data())
-    {
-      GrpHeader ghdr;
-
-      // check id
-      cb.read(&ghdr, sizeof(ghdr));
-      if (ghdr.label != _MAKE4C('GRP2') && ghdr.label != _MAKE4C('GRP3'))
-      {
-        debug("no GRP2 label (hdr: 0x%x 0x%x 0x%x 0x%x)", ghdr.label, ghdr.descOnlySize, ghdr.fullDataSize, ghdr.restFileSize);
-#if (DAGOR_DBGLEVEL < 1) && DAGOR_FORCE_LOGS
-        fatal("no GRP2 label in %s", fileName.str());
-#endif
-        DAGOR_THROW(IGenLoad::LoadException("no GRP2 label", cb.tell()));
-      }
-      if (ghdr.restFileSize + sizeof(ghdr) != file_sz)
-      {
-        debug("Corrupt file: hdr+restFileSize=%u != filesz=%d", unsigned(ghdr.restFileSize + sizeof(ghdr)), file_sz);
-#if (DAGOR_DBGLEVEL < 1) && DAGOR_FORCE_LOGS
-        fatal("Corrupt file %s", fileName.str());
-#endif
-        DAGOR_THROW(IGenLoad::LoadException("Corrupt file: restFileSize", cb.tell()));
-      }
-
-      grData = (GrpData *)memalloc(ghdr.descOnlySize, inimem);
-      cb.read(grData, ghdr.descOnlySize);
-      grData->patchDescOnly(ghdr.label);
-    }
-    else
-    {
-      GrpHeader *__restrict ghdr = (GrpHeader *)dump_data.data();
-
-      grData = (GrpData *)memalloc(ghdr->descOnlySize, inimem);
-      memcpy(grData, dump_data.data() + sizeof(GrpHeader), ghdr->descOnlySize);
-      grData->patchDescOnly(ghdr->label);
-    }
-
-    // register all names and renew nameMap
-    for (int i = 0; i < grData->nameMap.size(); i++)
-      grData->nameMap[i] = ::addGameResId(grData->getName(i));
+    if (!grData)
+      grData = read_grp_desc(cb, fileName, file_sz);
 
     // create real-res
-    dag::ConstSpan<int> gdNameId = grData->nameMap;
-    const ResEntry *__restrict rre = grData->resTable.data(), *__restrict rre_end = rre + grData->resTable.size();
-
-    for (; rre != rre_end; rre++)
-    {
-      if (rre->offset == 0)
-        continue;
-      int gdni = gdNameId[rre->resId];
-      if (resRestrictionList.size() && ((uint32_t)gdni >= (uint32_t)resRestrictionList.size() || !resRestrictionList.get(gdni)))
-        continue;
-      if (resId_to_packId[gdni] != this_packId)
-        continue;
-      int st_p = rre->offset;
-      int end_p = (rre + 1 == rre_end) ? file_sz : rre[1].offset;
-      data_size += end_p - st_p;
-      res_cnt++;
-
-      if (rb == rangesBuf)
-      {
-        rb->start = st_p;
-        rb->end = end_p;
-        rb++;
-        continue;
-      }
-
-      if (st_p > rb[-1].end + (32 << 10) && rb < rb_end)
-      {
-        rb->start = st_p;
-        rb->end = end_p;
-        rb++;
-      }
-      else
-      {
-        waste_size += st_p - rb[-1].end;
-        if (rb == rb_end)
-          waste_last_size += st_p - rb[-1].end;
-        rb[-1].end = end_p;
-      }
-    }
+    rb = rangesBuf + gather_grp_ranges(*grData, this_packId, file_sz, rangesBuf, st);
     if (rb == rangesBuf)
       goto end_load;
     if (!vrom_data.data())
       seq_cb.setRangesOfInterest(make_span(rangesBuf, rb - rangesBuf));
     cb.seekto(rangesBuf[0].start);
 
-    rre = grData->resTable.data();
-    rre_end = rre + grData->resTable.size();
-    for (; rre != rre_end; rre++)
-    {
-      if (rre->offset == 0)
-        continue;
-
-      int gdni = gdNameId[rre->resId];
-      if (resRestrictionList.size() && ((uint32_t)gdni >= (uint32_t)resRestrictionList.size() || !resRestrictionList.get(gdni)))
-        continue;
-
-      // debug("read %s at %d", ::resNameMap.getName(gdNameId[rre->resId]), rre->offset);
-      if (resId_to_packId[gdni] != this_packId)
-        continue;
-      cb.seekto(rre->offset);
-
-      GameResourceFactory *fac = ::getFactoryByClassId(rre->classId);
-
-      if (!fac)
-      {
-        String className, resName;
-
-        ::getResClassName(rre->classId, className);
-        ::getGameResName(gdNameId[rre->resId], resName);
-
-        if (noFactoryFatal)
-          fatal("No factory for game resource %s:%s", className.str(), resName.str());
-        else
-          logwarn("No factory for game resource %s:%s", className.str(), resName.str());
-
-        continue;
-      }
-
-      fac->loadGameResourceData(gdNameId[rre->resId], cb);
-      if (gameres_finer_load_enabled)
-      {
-        int cnt = gameres_cs.fullUnlock();
-        sleep_msec(0);
-        gameres_cs.reLock(cnt);
-      }
-    }
+    loadResData(cb);
 
     // debug_ctx("loaded real-res from GRP %s", (char*)fileName);
   end_load:;
@@ -954,12 +1292,12 @@ void GameResPackInfo::loadPack()
     (gpu_mem - d3d::driver_command(DRV3D_COMMAND_GETTEXTUREMEM, 0, 0, 0)) >> 10);
 #else
   if (vrom_data.data())
-    debug("loaded GRP %s (from VROMFS), %d usec (%dK in %d res), %6.2f Mb/s", fileName.str(), t0, data_size >> 10, res_cnt,
-      double(data_size) / (t0 ? t0 : 1));
+    debug("loaded GRP %s (from VROMFS), %d usec (%dK in %d res), %6.2f Mb/s", fileName.str(), t0, st.dataSize >> 10, st.resCnt,
+      double(st.dataSize) / (t0 ? t0 : 1));
   else
     debug("loaded GRP %s, %d usec (%dK of %dK range in %d areas, %d res, %dK waste load, %dK waste due to ranges), %6.2f Mb/s",
-      fileName.str(), t0, data_size >> 10, (rb[-1].end - rangesBuf[0].start) >> 10, rb - rangesBuf, res_cnt, waste_size >> 10,
-      waste_last_size >> 10, double(data_size) / (t0 ? t0 : 1));
+      fileName.str(), t0, st.dataSize >> 10, rb > rangesBuf ? (rb[-1].end - rangesBuf[0].start) >> 10 : 0, rb - rangesBuf, st.resCnt,
+      st.wasteSize >> 10, st.wasteLastSize >> 10, double(st.dataSize) / (t0 ? t0 : 1));
 #endif
   G_UNUSED(t0);
 
@@ -1143,6 +1481,7 @@ void load_game_resource_pack(int res_id)
   if (resRestrictionList.size() && !resRestrictionList.get(res_id))
   {
     logerr("res_id=%d <%s> is not present in res restriction list", res_id, resNameMap.getName(res_id));
+    pack_prefetch_queue.finish(); // prefetched ranges were gathered for previous restriction list
     resRestrictionList.set(res_id); // for the case when we ignore next fatal in fatal handler
     resRestrictionList.set(grMap[info->grMapIdx].id.resId);
     clearLoadedPacksList();
@@ -2052,6 +2391,33 @@ bool preload_all_required_res()
 
   bool ok = true;
 
+  if (pack_prefetch_queue.depth > 0)
+  {
+    // packs are prefetched in order of first use by required resources, then by their references
+    Tab<int> pack_order;
+    Bitarray pack_used;
+    pack_used.resize(packInfo.size());
+    pack_used.reset();
+    // packs which are loaded already or needed only for loaded resources won't be loaded, so they are not prefetched
+    auto add_pack = [&](int res_id) {
+      GameResInfo *info = getGameResInfo(res_id);
+      if (!info || info->packId < 0 || pack_used.get(info->packId) || packInfo[info->packId].surelyLoaded)
+        return;
+      GameResourceFactory *fac = ::getFactoryByClassId(grMap[info->grMapIdx].id.classId);
+      if (!fac || fac->isResLoaded(res_id))
+        return;
+      pack_used.set(info->packId);
+      pack_order.push_back(info->packId);
+    };
+    WinAutoLock lock(gameres_cs);
+    for (int res_id : l)
+      add_pack(res_id);
+    for (int res_id = 0; res_id < resRestrictionList.size(); res_id++)
+      if (resRestrictionList.get(res_id))
+        add_pack(res_id);
+    pack_prefetch_queue.start(pack_order);
+  }
+
   for (int i = 0; i < l.size(); i++)
   {
     GameResource *r = get_game_resource(l[i]);
@@ -2063,6 +2429,7 @@ bool preload_all_required_res()
       logwarn_ctx("cannot preload res: <%s>", resNameMap.getName(l[i]));
     }
   }
+  pack_prefetch_queue.finish();
 
   return ok;
 }
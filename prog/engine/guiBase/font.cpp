@@ -1111,7 +1111,11 @@ void DagorFontBinDump::DynamicFontAtlas::prepareTex(int idx)
   tex = (Texture *)d3d::create_tex(NULL, hist.size(), hist.size(), TEXFMT_L8 | TEXCF_MAYBELOST | TEXCF_UPDATE_DESTINATION, 1,
     "dynFontAtlas");
   texId = register_managed_tex(String(0, "dynFontAtlas%d", idx), tex);
-  if (d3d::is_stub_driver()) // we don't want doing useless concurrent lock along with gen_sys_tex
+  clearTex();
+}
+void DagorFontBinDump::DynamicFontAtlas::clearTex()
+{
+  if (!tex || d3d::is_stub_driver()) // we don't want doing useless concurrent lock along with gen_sys_tex
     return;
 
   unsigned texLockFlags = TEXLOCK_WRITE | TEXLOCK_DELSYSMEMCOPY;
@@ -1160,15 +1164,15 @@ void DagorFontBinDump::termDynFonts()
   debug("strboxcache: resetCnt=%d priCache.bb=%d secCache.bb=%d h2i_str=%d h2i_char=%d  (strVisBoxCnt=%d)", strboxcache::resetCnt,
     strboxcache::priCache.bb.size(), strboxcache::secCache.bb.size(), strboxcache::priCache.hash2idx[strboxcache::H2I_STR].size(),
     strboxcache::priCache.hash2idx[strboxcache::H2I_CHAR].size(), strboxcache::strVisBoxCnt);
-#if STRBOXCACHE_DEBUG
-  debug("  test=%d hit=%d secHit=%d  hitRate=%.2f%%", strboxcache::testCnt, strboxcache::hitCnt, strboxcache::secHitCnt,
-    strboxcache::testCnt ? 100.0 * (strboxcache::hitCnt + strboxcache::secHitCnt) / strboxcache::testCnt : 0);
-  debug("  cacheTime=%d usec (avg %.3f usec/test), calcTime=%d usec (avg %.1f usec/calc for calcCount=%d)",
-    profile_usec_from_ticks_delta(strboxcache::cacheTimeTicks),
-    strboxcache::testCnt ? profile_usec_from_ticks_delta(strboxcache::cacheTimeTicks) / double(strboxcache::testCnt) : 0,
+  debug("  test=%d hit=%d secHit=%d  hitRate=%.2f%%, calcTime=%d usec (avg %.1f usec/calc for calcCount=%d)", strboxcache::testCnt,
+    strboxcache::hitCnt, strboxcache::secHitCnt,
+    strboxcache::testCnt ? 100.0 * (strboxcache::hitCnt + strboxcache::secHitCnt) / strboxcache::testCnt : 0,
     profile_usec_from_ticks_delta(strboxcache::calcTimeTicks),
     strboxcache::calcCount ? profile_usec_from_ticks_delta(strboxcache::calcTimeTicks) / double(strboxcache::calcCount) : 0,
     strboxcache::calcCount);
+#if STRBOXCACHE_DEBUG
+  debug("  cacheTime=%d usec (avg %.3f usec/test)", profile_usec_from_ticks_delta(strboxcache::cacheTimeTicks),
+    strboxcache::testCnt ? profile_usec_from_ticks_delta(strboxcache::cacheTimeTicks) / double(strboxcache::testCnt) : 0);
 #endif
 }
 
@@ -1270,6 +1274,45 @@ int DagorFontBinDump::tryPlaceGlyph(int wd, int ht, int &x0, int &y0)
   return -1;
 }
 
+int DagorFontBinDump::findLruDynFontTex()
+{
+  // pages used in current frame are not evicted to avoid dropping glyphs of strings being rendered right now
+  int lru_idx = -1;
+  unsigned frame_no = dagor_frame_no();
+  for (int i = 0; i < dynFontTex.size(); i++)
+    if (dynFontTex[i].lastUsedFrame < frame_no && (lru_idx < 0 || dynFontTex[i].lastUsedFrame < dynFontTex[lru_idx].lastUsedFrame))
+      lru_idx = i;
+  return lru_idx;
+}
+
+void DagorFontBinDump::evictDynFontTex(int tex_idx)
+{
+  // texture is kept and just cleared, so glyphs placed later are packed from scratch without leftover gaps
+  DynamicFontAtlas &dtex = dynFontTex[tex_idx];
+  debug("evicting dynFontAtlas[%d] %dx%d, %d%% used, last used at frame %d", tex_idx, dtex.texSz(), dtex.texSz(),
+    dtex.calcUsagePercent(), dtex.lastUsedFrame);
+  mem_set_0(dtex.hist);
+  dtex.clearTex();
+}
+
+void DagorFontBinDump::evictGen(int tex_idx)
+{
+  TEXTUREID tex_id = dynFontTex[tex_idx].texId;
+  if (tex_id != BAD_TEXTUREID)
+    for (int i = 0; i < glyph.size(); i++)
+      if (glyph[i].isDynGrpValid() && glyph[i].texIdx >= texOrig.size() && glyph[i].texIdx < tex.size() &&
+          tex[glyph[i].texIdx].texId == tex_id)
+        const_cast<GlyphData &>(glyph[i]).texIdx = 0xFF;
+  // placed glyph keeps its size in u1-u0/v1-v0, so NOTPLACED state is enough to get it rasterized again
+  if (isFullyDynamicFont())
+    for (auto &u256p : dfont.fontGlyphs)
+      for (Unicode256Place *p : u256p)
+        if (p)
+          for (GlyphPlace &g : p->gp)
+            if (g.texIdx == tex_idx)
+              g.texIdx = GlyphPlace::TEXIDX_NOTPLACED;
+}
+
 void DagorFontBinDump::dumpDynFontUsage()
 {
   for (int i = 0; i < dynFontTex.size(); i++)
@@ -1853,9 +1896,10 @@ void DagorFontBinDump::doFetch()
 strboxcache::StrBboxCache strboxcache::priCache, strboxcache::secCache;
 OSSpinlock strboxcache::cc;
 uint32_t strboxcache::resetCnt = 0, strboxcache::strVisBoxCnt = 0, strboxcache::resetFrameNo = 0;
-#if STRBOXCACHE_DEBUG
 uint64_t strboxcache::testCnt = 0, strboxcache::hitCnt = 0, strboxcache::secHitCnt = 0;
-uint64_t strboxcache::cacheTimeTicks = 0, strboxcache::calcTimeTicks = 0, strboxcache::calcCount = 0;
+uint64_t strboxcache::calcTimeTicks = 0, strboxcache::calcCount = 0;
+#if STRBOXCACHE_DEBUG
+uint64_t strboxcache::cacheTimeTicks = 0;
 #endif
 #if CHECK_HASH_COLLISIONS
 Tab<uint32_t> strboxcache::hcc_hash2;
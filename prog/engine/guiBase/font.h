@@ -284,6 +284,7 @@ public:
     Texture *tex;
     TEXTUREID texId;
     SmallTab<uint16_t, MidmemAlloc> hist;
+    uint32_t lastUsedFrame = 0;
 
     DynamicFontAtlas() : tex(NULL), texId(BAD_TEXTUREID) {}
     DynamicFontAtlas(const DynamicFontAtlas &) = delete;
@@ -344,6 +345,7 @@ public:
       g.v1 = y0 + dy;
     }
     void prepareTex(int idx);
+    void clearTex();
     int texSz() const { return hist.size(); }
 
     int calcUsage() const
@@ -365,6 +367,21 @@ public:
   static int tryPlaceGlyph(int wd, int ht, int &x0, int &y0);
   static void dumpDynFontUsage();
 
+  // atlas page is marked as used each time glyphs from it are rendered; when out of area, least recently used page is evicted
+  // (its glyphs are dropped and re-rasterized on demand into the same texture) instead of recreating all atlas textures
+  static void touchDynFontTex(TEXTUREID tex_id)
+  {
+    for (DynamicFontAtlas &dtex : dynFontTex)
+      if (dtex.texId == tex_id)
+      {
+        dtex.lastUsedFrame = dagor_frame_no();
+        break;
+      }
+  }
+  static int findLruDynFontTex();
+  static void evictDynFontTex(int tex_idx);
+  void evictGen(int tex_idx);
+
   class InscriptionsAtlas : public DynamicAtlasTex
   {
   public:
@@ -555,9 +572,10 @@ static constexpr int DEF_CACHE_SIZE = 2048;
 
 extern uint32_t resetCnt, strVisBoxCnt, resetFrameNo;
 extern OSSpinlock cc;
+extern uint64_t testCnt, hitCnt, secHitCnt; // reported via StdGuiRender::get_font_cache_stats()
+extern uint64_t calcTimeTicks, calcCount;
 #if STRBOXCACHE_DEBUG
-extern uint64_t testCnt, hitCnt, secHitCnt;
-extern uint64_t cacheTimeTicks, calcTimeTicks, calcCount;
+extern uint64_t cacheTimeTicks;
 #endif
 
 static inline hash_t build_hash(const wchar_t *p, int len, uint32_t font_id, uint32_t font_ht, uint32_t font_sp)
@@ -587,9 +605,11 @@ static inline uint32_t build_hash2_fnv1a(const wchar_t *p, int len, uint32_t fon
 static inline uint32_t build_hash2_fnv1a(const wchar_t *, int, uint32_t, uint32_t, uint32_t) { return 0; }
 #endif
 
-static inline void add_bbox(hash_t hash, Hash2IdxStratum h2i, const BBox2 &bb, unsigned check_hash2)
+static inline void add_bbox(hash_t hash, Hash2IdxStratum h2i, const BBox2 &bb, unsigned check_hash2, int64_t calc_ticks)
 {
   OSSpinlockScopedLock lock(cc);
+  calcCount++;
+  calcTimeTicks += calc_ticks;
   int idx = priCache.bb.size();
   priCache.bb.push_back(bb);
   priCache.hash2idx[h2i][hash] = idx;
@@ -603,14 +623,10 @@ static inline const BBox2 *find_bbox(hash_t hash, Hash2IdxStratum h2i, unsigned
 {
   OSSpinlockScopedLock lock(cc);
   HashToIdx::iterator it = priCache.hash2idx[h2i].find(hash);
-#if STRBOXCACHE_DEBUG
   testCnt++;
-#endif
   if (it != priCache.hash2idx[h2i].end())
   {
-#if STRBOXCACHE_DEBUG
     hitCnt++;
-#endif
 #if CHECK_HASH_COLLISIONS
     G_ASSERTF(hcc_hash2[it->second] == check_hash2, "hash=0x%x check_hash2=0x%x != 0x%x\nchange HASH_BITS to 64", hash, check_hash2,
       hcc_hash2[it->second]);
@@ -623,9 +639,7 @@ static inline const BBox2 *find_bbox(hash_t hash, Hash2IdxStratum h2i, unsigned
     it = secCache.hash2idx[h2i].find(hash);
     if (it != secCache.hash2idx[h2i].end())
     {
-#if STRBOXCACHE_DEBUG
       secHitCnt++;
-#endif
       int idx = priCache.bb.size();
       priCache.bb.push_back(secCache.bb[it->second]);
 #if CHECK_HASH_COLLISIONS
@@ -14,6 +14,7 @@
 #include <osApiWrappers/dag_localConv.h>
 #include <osApiWrappers/dag_unicode.h>
 #include <osApiWrappers/dag_direct.h>
+#include <osApiWrappers/dag_miscApi.h>
 #include <math/integer/dag_IBBox2.h>
 #include <math/dag_adjpow2.h>
 #include <util/dag_fastStrMap.h>
@@ -171,6 +172,128 @@ const Point2 AXIS_Y = Point2(0, 1);
 static Tab<DagorFontBinDump> rfont(inimem_ptr());
 static FastStrMap font_names;
 static WinCritSec font_critsec;
+static int atlas_evict_cnt = 0, atlas_reset_cnt = 0;
+
+// LRU cache of shaped strings of fully dynamic fonts: draw_str_scaled_u() replays cached glyph placement instead of
+// shaping string with HarfBuzz and looking up glyphs every frame; it is used for immediate rendering on main thread only
+namespace strruncache
+{
+struct ShapedGlyph
+{
+  DagorFontBinDump::GlyphPlace gp;
+  int x, y; // glyph offset from string origin (unscaled)
+};
+// string with font params it is shaped for; hash is only used for lookup, key is compared on hit to reject collisions
+struct RunKey
+{
+  const wchar_t *str;
+  int len;
+  uint32_t fontId, fontHt, fontSp;
+  uint64_t hash;
+};
+struct ShapedRun
+{
+  uint64_t hash = 0;
+  uint32_t fontId = 0, fontHt = 0, fontSp = 0;
+  int advX = 0, advY = 0;
+  int prev = -1, next = -1;
+  short gen = 0;
+  Tab<wchar_t> str;
+  Tab<ShapedGlyph> glyphs;
+
+  bool matches(const RunKey &k) const
+  {
+    return fontId == k.fontId && fontHt == k.fontHt && fontSp == k.fontSp && str.size() == k.len &&
+           memcmp(str.data(), k.str, k.len * sizeof(wchar_t)) == 0;
+  }
+};
+static Tab<ShapedRun> runs;
+static ska::flat_hash_map<uint64_t, int, ska::power_of_two_std_hash<uint64_t>> hash2idx;
+static int mruIdx = -1, lruIdx = -1, maxCount = 1024;
+static uint64_t testCnt = 0, hitCnt = 0, layoutCnt = 0, layoutTicks = 0;
+
+static inline RunKey build_key(const wchar_t *p, int len, uint32_t font_id, uint32_t font_ht, uint32_t font_sp)
+{
+  RunKey k{p, len, font_id, font_ht, font_sp, fnv1a_step<64>(font_id)};
+  k.hash = fnv1a_step<64>(font_ht, k.hash);
+  k.hash = fnv1a_step<64>(font_sp, k.hash);
+  for (const wchar_t *pe = p + len; p != pe; p++)
+    k.hash = fnv1a_step<64>(*p, k.hash);
+  return k;
+}
+
+static void unlink(int idx)
+{
+  ShapedRun &r = runs[idx];
+  (r.prev >= 0 ? runs[r.prev].next : mruIdx) = r.next;
+  (r.next >= 0 ? runs[r.next].prev : lruIdx) = r.prev;
+  r.prev = r.next = -1;
+}
+static void link_as_mru(int idx)
+{
+  ShapedRun &r = runs[idx];
+  r.prev = -1;
+  r.next = mruIdx;
+  (mruIdx >= 0 ? runs[mruIdx].prev : lruIdx) = idx;
+  mruIdx = idx;
+}
+
+static const ShapedRun *find(const RunKey &k)
+{
+  testCnt++;
+  auto it = hash2idx.find(k.hash);
+  if (it == hash2idx.end())
+    return nullptr;
+  ShapedRun &r = runs[it->second];
+  if (r.gen != dyn_font_atlas_reset_generation || !r.matches(k))
+    return nullptr;
+  if (mruIdx != it->second)
+  {
+    unlink(it->second);
+    link_as_mru(it->second);
+  }
+  hitCnt++;
+  return &r;
+}
+
+static void add(const RunKey &k, int adv_x, int adv_y, dag::ConstSpan<ShapedGlyph> glyphs)
+{
+  int idx;
+  auto it = hash2idx.find(k.hash);
+  if (it != hash2idx.end()) // same string re-shaped after atlas reset, or colliding one which replaces it
+    unlink(idx = it->second);
+  else if (runs.size() < maxCount)
+  {
+    hash2idx[k.hash] = idx = runs.size();
+    runs.push_back();
+  }
+  else
+  {
+    unlink(idx = lruIdx);
+    hash2idx.erase(runs[idx].hash);
+    hash2idx[k.hash] = idx;
+  }
+  link_as_mru(idx);
+
+  ShapedRun &r = runs[idx];
+  r.hash = k.hash;
+  r.fontId = k.fontId;
+  r.fontHt = k.fontHt;
+  r.fontSp = k.fontSp;
+  r.str.assign(k.str, k.str + k.len);
+  r.advX = adv_x;
+  r.advY = adv_y;
+  r.gen = dyn_font_atlas_reset_generation;
+  r.glyphs.assign(glyphs.begin(), glyphs.end());
+}
+
+static void clear()
+{
+  clear_and_shrink(runs);
+  hash2idx.clear();
+  mruIdx = lruIdx = -1;
+}
+} // namespace strruncache
 
 
 void acquire() { font_critsec.lock(); }
@@ -189,7 +312,10 @@ void init_fonts(DataBlock &blk)
   ScopedAcquire l;
 
   if (const DataBlock *b = blk.getBlockByName("dynamicGen"))
+  {
     DagorFontBinDump::initDynFonts(b->getInt("texCount", 1), b->getInt("texSz", 256), b->getStr("prefix", "."));
+    strruncache::maxCount = b->getInt("shapedStrCacheSize", 1024);
+  }
   DagorFontBinDump::initInscriptions(blk);
 
   if (blk.paramExists("fontSizeByWidthCap"))
@@ -285,6 +411,10 @@ void close_fonts()
     f.clear();
   clear_and_shrink(rfont);
   font_names.reset();
+  debug("shaped str cache: %d runs, test=%d hit=%d hitRate=%.2f%%, layout %d usec for %d strings", strruncache::runs.size(),
+    strruncache::testCnt, strruncache::hitCnt, strruncache::testCnt ? 100.0 * strruncache::hitCnt / strruncache::testCnt : 0,
+    profile_usec_from_ticks_delta(strruncache::layoutTicks), strruncache::layoutCnt);
+  strruncache::clear();
   DagorFontBinDump::termDynFonts();
   DagorFontBinDump::termInscriptions();
 }
@@ -319,14 +449,30 @@ static inline void update_dyn_fonts()
 
   if (DagorFontBinDump::reqCharGenReset)
   {
-    logwarn("out of area, trying to reset font cache");
     dyn_font_atlas_reset_generation++;
     DagorFontBinDump::reqCharGenReset = false;
-    for (DagorFontBinDump &f : rfont)
-      f.resetGen();
-    for (DagorFontBinDump &f : DagorFontBinDump::add_font)
-      f.resetGen();
-    DagorFontBinDump::resetDynFontsCache();
+    int tex_idx = DagorFontBinDump::findLruDynFontTex();
+    if (tex_idx >= 0)
+    {
+      logwarn("out of area, evicting least recently used font atlas page %d", tex_idx);
+      for (DagorFontBinDump &f : rfont)
+        f.evictGen(tex_idx);
+      for (DagorFontBinDump &f : DagorFontBinDump::add_font)
+        f.evictGen(tex_idx);
+      DagorFontBinDump::evictDynFontTex(tex_idx);
+      atlas_evict_cnt++;
+    }
+    else
+    {
+      logwarn("out of area, all font atlas pages are in use, trying to reset font cache");
+      for (DagorFontBinDump &f : rfont)
+        f.resetGen();
+      for (DagorFontBinDump &f : DagorFontBinDump::add_font)
+        f.resetGen();
+      for (int i = 0; i < DagorFontBinDump::dynFontTex.size(); i++)
+        DagorFontBinDump::evictDynFontTex(i);
+      atlas_reset_cnt++;
+    }
   }
 
   if (added_glyph)
@@ -367,6 +513,35 @@ void update_internals_per_act()
     update_dyn_fonts();
 }
 
+void get_font_cache_stats(FontCacheStats &out_stats)
+{
+  {
+    OSSpinlockScopedLock lock(strboxcache::cc);
+    out_stats.strBoxTests = strboxcache::testCnt;
+    out_stats.strBoxHits = strboxcache::hitCnt + strboxcache::secHitCnt;
+    out_stats.strBoxLayoutCount = strboxcache::calcCount;
+    out_stats.strBoxLayoutUsec = profile_usec_from_ticks_delta(strboxcache::calcTimeTicks);
+  }
+  out_stats.shapedStrTests = strruncache::testCnt;
+  out_stats.shapedStrHits = strruncache::hitCnt;
+  out_stats.shapedStrLayoutCount = strruncache::layoutCnt;
+  out_stats.shapedStrLayoutUsec = profile_usec_from_ticks_delta(strruncache::layoutTicks);
+  out_stats.shapedStrCount = strruncache::runs.size();
+  out_stats.atlasEvictions = atlas_evict_cnt;
+  out_stats.atlasResets = atlas_reset_cnt;
+}
+
+void reset_font_cache_stats()
+{
+  {
+    OSSpinlockScopedLock lock(strboxcache::cc);
+    strboxcache::testCnt = strboxcache::hitCnt = strboxcache::secHitCnt = 0;
+    strboxcache::calcCount = strboxcache::calcTimeTicks = 0;
+  }
+  strruncache::testCnt = strruncache::hitCnt = strruncache::layoutCnt = strruncache::layoutTicks = 0;
+  atlas_evict_cnt = atlas_reset_cnt = 0;
+}
+
 static float dynfont_compute_str_width_u_cached(const StdGuiFontContext &fctx, const wchar_t *str, int len, BBox2 &out_bb)
 {
 #if STRBOXCACHE_DEBUG
@@ -385,16 +560,10 @@ static float dynfont_compute_str_width_u_cached(const StdGuiFontContext &fctx, c
     return out_bb[1].x;
   }
 
-#if STRBOXCACHE_DEBUG
-  strboxcache::calcCount++;
   int64_t reft2 = profile_ref_ticks();
-#endif
   float dx = fctx.font->dynfont_compute_str_width_u(fctx.fontHt, str, len, 1.0f, fctx.spacing, out_bb);
-#if STRBOXCACHE_DEBUG
-  int calc_time = profile_ref_ticks() - reft2;
-  strboxcache::calcTimeTicks += calc_time;
-#endif
-  strboxcache::add_bbox(hash, len == 1 ? strboxcache::H2I_CHAR : strboxcache::H2I_STR, out_bb, hash2);
+  int64_t calc_time = profile_ref_ticks() - reft2;
+  strboxcache::add_bbox(hash, len == 1 ? strboxcache::H2I_CHAR : strboxcache::H2I_STR, out_bb, hash2, calc_time);
 #if STRBOXCACHE_DEBUG
   strboxcache::cacheTimeTicks += profile_ref_ticks() - reft - calc_time;
 #endif
@@ -516,6 +685,17 @@ BBox2 get_str_bbox_u_ex(const wchar_t *str, int len, const StdGuiFontContext &fc
   {
     if (fctx.monoW)
       len = dag_wcsnlen(str, len);
+    else if (dynfont_compute_str_width_u_cached(fctx, str, len, box) + 1.0f <= max_w)
+    {
+      // whole string surely fits (with margin for rounding of width), so answer from cache without shaping string again;
+      // string fully rendered with other font gets ascent of that font, so it is left for full computation
+      int seg_ht = fctx.fontHt ? fctx.fontHt : fctx.font->getFontHt(), seglen = 0;
+      if (fctx.font->dynfont_get_next_segment(str, len, seg_ht, seglen) == fctx.font || seglen < len)
+      {
+        out_count = len;
+        return box;
+      }
+    }
     return fctx.font->dynfont_compute_str_width_u_ex(fctx.fontHt, str, len, 1.0f, fctx.spacing, fctx.monoW, max_w, left_align,
       break_sym, ellipsis_resv_w, out_start_idx, out_count);
   }
@@ -1068,6 +1248,7 @@ GuiContext::GuiContext() : viewportList(midmem)
 {
   renderer = new BufferedRenderer();
   recCb = NULL;
+  cmdRec = NULL;
   setExtStateLocation(0, &extStateStorage);
 
   screenWidth = 0;
@@ -1181,6 +1362,7 @@ void GuiContext::setRenderCallback(RenderCallBack cb, uintptr_t data)
 
 void GuiContext::execCommand(int command, const Point2 &pos, const Point2 &size)
 {
+  invalidateRecording();
   flushData();
   renderer->execCommand(command, pos, size);
   flushData();
@@ -1188,6 +1370,7 @@ void GuiContext::execCommand(int command, const Point2 &pos, const Point2 &size)
 
 void GuiContext::execCommand(int command, const Point2 &pos, const Point2 &size, RenderCallBack cb, uintptr_t data)
 {
+  invalidateRecording();
   flushData();
   renderer->execCommand(command, pos, size, cb, data);
   flushData();
@@ -1201,6 +1384,7 @@ void GuiContext::execCommand(int command)
 
 uintptr_t GuiContext::execCommandImmediate(int command, const Point2 &pos, const Point2 &size)
 {
+  invalidateRecording();
   return renderer->execCommandImmediate(command, pos, size);
 }
 
@@ -1211,6 +1395,8 @@ void GuiContext::setBuffer(int buffer_id, bool force)
 
   // TODO: ignore last states
   flushData();
+  if (buffer_id != 0)
+    invalidateRecording();
 
   reset_draw_str_attr();
   reset_draw_str_texture();
@@ -1253,6 +1439,7 @@ void GuiContext::setShaderToBuffer(int buffer_id, GuiShader *shader)
 
   if (renderer->currentShaders[buffer_id] != shader)
   {
+    invalidateRecording();
     renderer->validateShader(buffer_id, shader);
     renderer->currentShaders[buffer_id] = shader;
     // update buffer if active
@@ -1276,6 +1463,9 @@ void *GuiContext::qCacheAlloc(int num)
 // flush, qcache, layers, and update states
 void GuiContext::qCacheFlush(bool force)
 {
+  if (cmdRec && qCacheUsed > 0)
+    recordQuads(qCacheBuffer, qCacheUsed);
+
   if (!currentViewPort.isZero() && qCacheUsed > 0)
   {
     // delayed sorted draw
@@ -1333,6 +1523,8 @@ void GuiContext::applyViewport(GuiViewPort &vp)
   viewH = vp.getHeight();
   viewN = 0.0f;
   viewF = 1.0f;
+  if (cmdRec)
+    recordStateBlock();
 
   renderer->pushViewportRect(vp.leftTop.x, vp.leftTop.y, vp.getWidth(), vp.getHeight());
   vp.applied = true;
@@ -1803,6 +1995,8 @@ void GuiContext::rollStateBlock()
   guiState.fontAttr.dump();
 #endif
   renderer->quadCache.guiState = guiState;
+  if (cmdRec)
+    recordStateBlock();
 
   // flushed by rendercache if cache enabled (bufferId > 0)
   if (rollState & ROLL_GUI_STATE)
@@ -1814,6 +2008,119 @@ void GuiContext::rollStateBlock()
   rollState = 0;
 }
 
+//************************************************************************
+//* commands recording
+//************************************************************************
+
+void GuiContext::beginRecording(GuiCommandBuffer &buf)
+{
+  G_ASSERT_RETURN(!cmdRec && !recCb, );
+  qCacheFlush(false); // submit quads of previous draws, so that only ours get recorded
+
+  buf.clear();
+  buf.replayable = currentBufferId == 0 && !drawRawLayer;
+  buf.fontAtlasGeneration = dyn_font_atlas_reset_generation;
+  cmdRec = &buf;
+  recordStateBlock();
+}
+
+void GuiContext::endRecording()
+{
+  G_ASSERT_RETURN(cmdRec, );
+  qCacheFlush(false);
+  if (!cmdRec->batches.empty() && !cmdRec->batches.back().numQuads)
+    cmdRec->batches.pop_back();
+  cmdRec = NULL;
+}
+
+void GuiContext::invalidateRecording()
+{
+  if (cmdRec)
+    cmdRec->replayable = false;
+}
+
+void GuiContext::recordStateBlock()
+{
+  if (currentBufferId != 0)
+  {
+    cmdRec->replayable = false;
+    return;
+  }
+  if (cmdRec->batches.empty() || cmdRec->batches.back().numQuads)
+    cmdRec->batches.push_back();
+  GuiCommandBuffer::Batch &b = cmdRec->batches.back();
+  b.state = guiState;
+  b.extState = extStateStorage;
+  b.viewport[0] = viewX;
+  b.viewport[1] = viewY;
+  b.viewport[2] = viewW;
+  b.viewport[3] = viewH;
+  b.firstQuad = cmdRec->verts.size() / 4;
+  b.numQuads = 0;
+}
+
+void GuiContext::recordQuads(const void *verts, int num_quads)
+{
+  if (drawRawLayer || currentBufferId != 0 || qCacheStride != sizeof(GuiVertex) || cmdRec->batches.empty())
+  {
+    cmdRec->replayable = false;
+    return;
+  }
+  append_items(cmdRec->verts, num_quads * 4, (const GuiVertex *)verts);
+  cmdRec->batches.back().numQuads += num_quads;
+}
+
+void GuiContext::replay(const GuiCommandBuffer &buf, const Point2 &offset)
+{
+  G_ASSERT_RETURN(buf.canReplay(), );
+  G_ASSERT_RETURN(currentBufferId == 0 && !drawRawLayer, );
+
+  const GuiState prevGuiState = guiState;
+  const ExtState prevExtState = extStateStorage;
+  const int dx = GuiVertex::fast_floori(offset.x * GUI_POS_SCALE + 0.5f);
+  const int dy = GuiVertex::fast_floori(offset.y * GUI_POS_SCALE + 0.5f);
+  const float vpDx = float(dx) / GUI_POS_SCALE, vpDy = float(dy) / GUI_POS_SCALE;
+  const float *curViewport = nullptr;
+
+  for (const GuiCommandBuffer::Batch &b : buf.batches)
+  {
+    if (!curViewport || memcmp(curViewport, b.viewport, sizeof(b.viewport)) != 0)
+    {
+      // quads are bound to viewport on flush
+      flushData();
+      float l = floorf((b.viewport[0] + vpDx) * screenScale.x) * screenScaleRcp.x;
+      float t = floorf((b.viewport[1] + vpDy) * screenScale.y) * screenScaleRcp.y;
+      renderer->pushViewportRect(l, t, b.viewport[2], b.viewport[3]);
+      curViewport = b.viewport;
+    }
+    guiState = b.state;
+    extStateStorage = b.extState;
+    rollState |= ROLL_ALL_STATES;
+
+    const GuiVertex *src = buf.verts.data() + b.firstQuad * 4;
+    for (int left = b.numQuads; left > 0;)
+    {
+      const int num = min(left, qCacheCapacity());
+      GuiVertex *dst = qCacheAllocT<GuiVertex>(num);
+      memcpy(dst, src, num * 4 * sizeof(GuiVertex));
+      if (dx | dy)
+        for (GuiVertex *v = dst, *v_e = dst + num * 4; v < v_e; v++)
+        {
+          v->px = (int16_t)clamp(v->px + dx, -32768, 32767);
+          v->py = (int16_t)clamp(v->py + dy, -32768, 32767);
+        }
+      src += num * 4;
+      left -= num;
+    }
+  }
+
+  flushData();
+  renderer->pushViewportRect(viewX, viewY, viewW, viewH);
+  guiState = prevGuiState;
+  extStateStorage = prevExtState;
+  rollState |= ROLL_ALL_STATES;
+}
+
 // draw vertices
 void GuiContext::draw_quads(const void *verts, int num_quads)
 {
@@ -1821,6 +2128,8 @@ void GuiContext::draw_quads(const void *verts, int num_quads)
 #if LOG_DRAWS
   debug("STDG:draw_quads %x, %d", verts, num_quads);
 #endif
+  if (cmdRec && num_quads > 0)
+    recordQuads(verts, num_quads);
 
   if (!currentViewPort.isZero() && num_quads > 0)
   {
@@ -1841,6 +2150,7 @@ void GuiContext::draw_faces(const void *verts, int num_verts, const IndexType *i
     logerr("draw_faces requires raw_layer clause");
     return;
   }
+  invalidateRecording();
 #if LOG_DRAWS
   debug("STDG:draw_faces v:%x, %d i:%x %d", verts, num_verts, indices, num_faces);
 #endif
@@ -1860,6 +2170,7 @@ void GuiContext::draw_prims(int d3d_prim, int num_prims, const void *verts, cons
     logerr("draw_prim requires raw_layer clause");
     return;
   }
+  invalidateRecording();
 
   if (currentViewPort.isZero() || num_prims <= 0)
     return;
@@ -3519,6 +3830,7 @@ static void draw_char_internal(GuiContext &ctx, const DagorFontBinDump::GlyphDat
       curRenderFont.font->reqCharGen(ch);
       if (ctx.getRenderCallback())
         ctx.getRenderCallback()->missingGlyphs++;
+      ctx.invalidateRecording();
     }
     return;
   }
@@ -3527,6 +3839,8 @@ static void draw_char_internal(GuiContext &ctx, const DagorFontBinDump::GlyphDat
   ctx.currentPos.x += curRenderFont.font->getDx2(dx2, curRenderFont.monoW, g, next_ch) * scale;
 
   TEXTUREID fontTexId = curRenderFont.font->tex[g.texIdx].texId;
+  if (g.isDynGrpValid())
+    DagorFontBinDump::touchDynFontTex(fontTexId);
 
   if (ctx.prevTextTextureId != fontTexId)
     update_font_halftexel(ctx, fontTexId);
@@ -3550,44 +3864,58 @@ static void draw_char_internal(GuiContext &ctx, const DagorFontBinDump::GlyphDat
   enqueue_glyph(ctx, fontTexId, halftexelExpansion, g.u0, g.v0, g.u1, g.v1, g.x1 - g.x0, g.y1 - g.y0, lt, rb);
 }
 
-static void draw_char_internal_hb(GuiContext &ctx, const hb_glyph_position_t &glyph_pos, hb_codepoint_t cp, real scale, float uv_scale,
-  int &sum_x_advance, int &sum_y_advance, int adv_sp, DagorFontBinDump *f, int fgidx)
+static void draw_dyn_glyph(GuiContext &ctx, const DagorFontBinDump::GlyphPlace &gp, int gx_offset, int gy_offset, real scale,
+  float uv_scale)
+{
+  DagorFontBinDump::DynamicFontAtlas &dtex = DagorFontBinDump::dynFontTex[gp.texIdx];
+  TEXTUREID fontTexId = dtex.texId;
+  dtex.lastUsedFrame = dagor_frame_no();
+
+  if (ctx.prevTextTextureId != fontTexId)
+    update_font_halftexel(ctx, fontTexId);
+
+  G_ASSERT(ctx.isCurrentFontTexturePow2);
+  // using half texel expansion
+  int gw = gp.u1 - gp.u0, gh = gp.v1 - gp.v0;
+  Point2 lt(ROUND_COORD((gx_offset - 0.5f) * scale + ctx.currentPos.x), (gy_offset - 0.5f) * scale + ctx.currentPos.y);
+  Point2 rb(lt.x + (gw + 1) * scale, lt.y + (gh + 1) * scale);
+
+  if ((!ctx.getRenderCallback() || ctx.getRenderCallback()->checkVis) && !ctx.vpBoxIsVisible(lt, rb))
+    return;
+
+  update_font_fx_tex(ctx, fontTexId);
+  enqueue_glyph(ctx, fontTexId, true, gp.u0 * uv_scale, gp.v0 * uv_scale, gp.u1 * uv_scale, gp.v1 * uv_scale, gw, gh, lt, rb);
+}
+
+// returns false when glyph is not rasterized yet; placed glyphs are appended to out_run (when specified) for shaped str cache
+static bool draw_char_internal_hb(GuiContext &ctx, const hb_glyph_position_t &glyph_pos, hb_codepoint_t cp, real scale, float uv_scale,
+  int &sum_x_advance, int &sum_y_advance, int adv_sp, DagorFontBinDump *f, int fgidx, Tab<strruncache::ShapedGlyph> *out_run)
 {
   const DagorFontBinDump::GlyphPlace *gp = f->getDynGlyph(fgidx, cp);
   int mono_w = ctx.curRenderFont.monoW ? int(floorf(ctx.curRenderFont.monoW * scale * 64)) : 0;
+  bool ready = true;
 
   if (gp && gp->texIdx < DagorFontBinDump::dynFontTex.size())
   {
-    TEXTUREID fontTexId = DagorFontBinDump::dynFontTex[gp->texIdx].texId;
-
-    if (ctx.prevTextTextureId != fontTexId)
-      update_font_halftexel(ctx, fontTexId);
-
-    G_ASSERT(ctx.isCurrentFontTexturePow2);
-    // using half texel expansion
-    int gw = gp->u1 - gp->u0, gh = gp->v1 - gp->v0;
+    int gw = gp->u1 - gp->u0;
     int gx_offset = (sum_x_advance + glyph_pos.x_offset + (mono_w ? (mono_w - gw * 64) / 2 : 0) + 32) / 64 + gp->ox;
     int gy_offset = (sum_y_advance + glyph_pos.y_offset + 32) / 64 + gp->oy;
-
-    Point2 lt(ROUND_COORD((gx_offset - 0.5f) * scale + ctx.currentPos.x), (gy_offset - 0.5f) * scale + ctx.currentPos.y);
-    Point2 rb(lt.x + (gw + 1) * scale, lt.y + (gh + 1) * scale);
-
-    if ((!ctx.getRenderCallback() || ctx.getRenderCallback()->checkVis) && !ctx.vpBoxIsVisible(lt, rb))
-      goto ret;
-
-    update_font_fx_tex(ctx, fontTexId);
-    enqueue_glyph(ctx, fontTexId, true, gp->u0 * uv_scale, gp->v0 * uv_scale, gp->u1 * uv_scale, gp->v1 * uv_scale, gw, gh, lt, rb);
+    draw_dyn_glyph(ctx, *gp, gx_offset, gy_offset, scale, uv_scale);
+    if (out_run)
+      out_run->push_back({*gp, gx_offset, gy_offset});
   }
   else if (!gp || gp->texIdx == gp->TEXIDX_NOTPLACED)
   {
     f->reqCharGen(cp, f->getHtForFontGlyphIdx(fgidx));
     if (ctx.getRenderCallback())
       ctx.getRenderCallback()->missingGlyphs++;
+    ctx.invalidateRecording();
+    ready = false;
   }
 
-ret:
   sum_x_advance += mono_w ? mono_w : glyph_pos.x_advance + adv_sp;
   sum_y_advance += glyph_pos.y_advance;
+  return ready;
 }
 
 // render single character using current font
@@ -3624,21 +3952,55 @@ void GuiContext::draw_str_scaled_u(real scale, const wchar_t *str, int len)
     if (len < 0)
       len = wcslen(str);
 
+    // glyph placement doesn't depend on scale (unless monoW is used), so cached runs are reused for any scale
+    bool use_run_cache = strruncache::maxCount > 0 && !recCb && !curRenderFont.monoW && is_main_thread();
+    strruncache::RunKey run_key{};
+    int64_t reft = 0;
+    if (use_run_cache)
+    {
+      run_key = strruncache::build_key(str, len, curRenderFont.font - rfont.data(), font_ht, curRenderFont.spacing);
+      if (const strruncache::ShapedRun *run = strruncache::find(run_key))
+      {
+        for (const strruncache::ShapedGlyph &g : run->glyphs)
+          draw_dyn_glyph(*this, g.gp, g.x, g.y, scale, uv_scale);
+        currentPos.x += float((run->advX + 32) / 64) * scale;
+        currentPos.y += float((run->advY + 32) / 64) * scale;
+        return;
+      }
+      reft = profile_ref_ticks();
+    }
+
+    Tab<strruncache::ShapedGlyph> run_glyphs(framemem_ptr());
+    bool all_glyphs_ready = true;
     DagorFontBinDump::ScopeHBuf buf;
     for (int eff_font_ht = 0, seglen = len; len > 0; str += seglen, len -= seglen)
     {
       DagorFontBinDump *f = curRenderFont.font->dynfont_get_next_segment(str, len, eff_font_ht = font_ht, seglen);
       f->dynfont_prepare_str(buf, eff_font_ht, str, seglen, &fgidx);
       if (fgidx < 0)
+      {
+        all_glyphs_ready = false;
         break;
+      }
       unsigned glyph_count = 0;
       hb_glyph_position_t *glyph_pos = hb_buffer_get_glyph_positions(buf, &glyph_count);
       hb_glyph_info_t *glyph_info = hb_buffer_get_glyph_infos(buf, &glyph_count);
       for (int i = 0; i < glyph_count; ++i, glyph_pos++, glyph_info++)
-        draw_char_internal_hb(*this, *glyph_pos, glyph_info->codepoint, scale, uv_scale, adv_x, adv_y, adv_sp, f, fgidx);
+        if (!draw_char_internal_hb(*this, *glyph_pos, glyph_info->codepoint, scale, uv_scale, adv_x, adv_y, adv_sp, f, fgidx,
+              use_run_cache ? &run_glyphs : nullptr))
+          all_glyphs_ready = false;
     }
     currentPos.x += float((adv_x + 32) / 64) * scale;
     currentPos.y += float((adv_y + 32) / 64) * scale;
+
+    if (use_run_cache)
+    {
+      // strings with glyphs pending rasterization are not cached, as they will look different next frames
+      if (all_glyphs_ready)
+        strruncache::add(run_key, adv_x, adv_y, run_glyphs); // run_key.str still points to start of string
+      strruncache::layoutCnt++;
+      strruncache::layoutTicks += profile_ref_ticks() - reft;
+    }
     return;
   }
 
@@ -3736,6 +4098,7 @@ void GuiContext::render_str_buf(dag::ConstSpan<GuiVertex> buf_qv, dag::ConstSpan
     if (!full_qnum)
       continue;
     TEXTUREID font_tid = D3DRESID::fromIndex(tq[0]);
+    DagorFontBinDump::touchDynFontTex(font_tid);
     update_font_fx_tex(*this, font_tid);
     set_textures(font_tid, BAD_TEXTUREID, true);
     while (full_qnum > 0)
@@ -954,7 +954,10 @@ void DataBlock::reset()
   G_ASSERTF_RETURN(topMost() || hasNoNameId(), , "trying to reset child datablock: nameId=%d topMost=%d", getNameId(), topMost());
   nameIdAndFlags &= ~NAME_ID_MASK;
   if (topMost())
+  {
     shared->rw.reset();
+    shared->namesUid = DataBlockShared::alloc_names_uid();
+  }
   clearData();
 }
 
@@ -965,6 +968,7 @@ void DataBlock::resetAndReleaseRoNameMap()
   {
     shared->ro->delRef();
     shared->ro = nullptr;
+    shared->namesUid = DataBlockShared::alloc_names_uid();
   }
 }
 
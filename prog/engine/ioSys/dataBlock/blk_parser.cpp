@@ -15,6 +15,11 @@
 #include <math/dag_Point4.h>
 #include <math/dag_TMatrix.h>
 #include <math/dag_e3dColor.h>
+#include <util/dag_oaHashNameMap.h>
+#include <util/dag_parallelForInline.h>
+#include <osApiWrappers/dag_spinlock.h>
+#include <osApiWrappers/dag_miscApi.h>
+#include <dag/dag_vector.h>
 #pragma warning(disable : 4577)
 #include <fast_float/fast_float.h>
 #include "blk_comments_def.h"
@@ -39,6 +44,73 @@ public:
 static GenericRootIncludeFileResolver gen_root_inc_resv;
 
 
+// Include files shared by parser threads of dblk::load_many(): each include is read once per bulk load,
+// and every BLK including it gets the same text, no matter which thread requested it first
+class BlkIncludeCache
+{
+public:
+  // returns file text, or nullptr when file is missing or binary (such files are processed by usual include path)
+  const Tab<char> *getText(const char *fname)
+  {
+    Entry *e = nullptr;
+    bool owner = false;
+    {
+      OSSpinlockScopedLock lock(mutex);
+      int id = names.getNameId(fname);
+      if (id < 0)
+      {
+        id = names.addNameId(fname);
+        entries.push_back(eastl::make_unique<Entry>());
+        owner = true;
+      }
+      e = entries[id].get();
+    }
+    if (owner)
+      interlocked_release_store(e->state, readFile(fname, e->text) ? Entry::TEXT : Entry::UNCACHED);
+    else
+      spin_wait([e] { return interlocked_acquire_load(e->state) == Entry::LOADING; });
+    return e->state == Entry::TEXT ? &e->text : nullptr;
+  }
+
+private:
+  struct Entry
+  {
+    enum
+    {
+      LOADING,
+      TEXT,
+      UNCACHED
+    };
+    Tab<char> text;
+    volatile int state = LOADING;
+  };
+
+  static bool readFile(const char *fname, Tab<char> &text)
+  {
+    file_ptr_t h = df_open(fname, DF_READ | DF_IGNORE_MISSING);
+    if (!h)
+      return false;
+    int len = df_length(h);
+    bool ok = len >= 0;
+    if (ok)
+    {
+      text.resize(len);
+      ok = df_read(h, text.data(), len) == len;
+    }
+    df_close(h);
+    if (ok && ((len > 1 && text[0] >= dblk::BBF_full_binary_in_stream && text[0] <= dblk::BBF_binary_with_shared_nm_zd) ||
+                (len >= 4 && *(int *)text.data() == _MAKE4C('BBF'))))
+      ok = false;
+    return ok;
+  }
+
+  OSSpinlock mutex;
+  OAHashNameMap<false> names;
+  dag::Vector<eastl::unique_ptr<Entry>> entries;
+};
+static thread_local BlkIncludeCache *tls_include_cache = nullptr;
+
+
 #define EOF_CHAR '\0'
 #define INC_CURLINE  \
   {                  \
@@ -69,6 +141,7 @@ public:
   };
   Tab<PendingComment> pendCmnt;
   DataBlock::IFileNotify *fnotify;
+  BlkIncludeCache *includeCache = tls_include_cache;
 
   DataBlockParser(Tab<char> &buf, const char *fn, bool robust_parsing, DataBlock::IFileNotify *fnot) :
     buffer(buf),
@@ -1436,15 +1509,17 @@ bool DataBlockParser::parse(DataBlock &blk, bool isTop)
       includeStack.push_back(valueStr);
       fileName = includeStack.back();
 
-      file_ptr_t h = df_open(valueStr, DF_READ | (robustParsing ? DF_IGNORE_MISSING : 0));
-      if (!h)
+      // text of include shared by parallel loads; missing and binary files are not cached and take usual path below
+      const Tab<char> *cachedText = includeCache ? includeCache->getText(valueStr) : nullptr;
+      file_ptr_t h = cachedText ? nullptr : df_open(valueStr, DF_READ | (robustParsing ? DF_IGNORE_MISSING : 0));
+      if (!h && !cachedText)
       {
         logerr("can't open include file '%s' for '%s'", valueStr.str(), baseFileName);
         SYNTAX_ERROR("can't open include file");
       }
       (void)baseFileName;
 
-      int len = df_length(h);
+      int len = cachedText ? (int)cachedText->size() : df_length(h);
       if (len < 0)
       {
         df_close(h);
@@ -1459,17 +1534,19 @@ bool DataBlockParser::parse(DataBlock &blk, bool isTop)
 
       insert_items(buffer, pos, len + 2);
 
-      if (df_read(h, &buffer[pos], len) != len)
+      if (cachedText)
+        memcpy(&buffer[pos], cachedText->data(), len);
+      else if (df_read(h, &buffer[pos], len) != len)
       {
         df_close(h);
         SYNTAX_ERROR("error loading include file");
       }
 
-      if (
-        (len > 1 && buffer[pos] >= dblk::BBF_full_binary_in_stream && buffer[pos] <= dblk::BBF_binary_with_shared_nm_zd) || // new
-                                                                                                                            // binary
-                                                                                                                            // formats
-        (len >= 4 && *(int *)&buffer[pos] == _MAKE4C('BBF'))) // old BBF3 format
+      const bool binaryInclude =
+        !cachedText && ((len > 1 && buffer[pos] >= dblk::BBF_full_binary_in_stream &&
+                          buffer[pos] <= dblk::BBF_binary_with_shared_nm_zd) ||   // new binary formats
+                         (len >= 4 && *(int *)&buffer[pos] == _MAKE4C('BBF'))); // old BBF3 format
+      if (binaryInclude)
       {
         logwarn("including binary file '%s', not fastest codepath", valueStr.str());
 
@@ -1504,7 +1581,8 @@ bool DataBlockParser::parse(DataBlock &blk, bool isTop)
           (unsigned char)buffer[pos + 2] == 0xBF)
         erase_items(buffer, pos, 3);
 
-      df_close(h);
+      if (h)
+        df_close(h);
 
       updatePointers();
       lastStatement = -1;
@@ -1822,5 +1900,49 @@ void DataBlock::setRootIncludeResolver(const char *root)
   setIncludeResolver(&gen_root_inc_resv);
 }
 
+int dblk::load_many(dag::ConstSpan<DataBlock *> blks, dag::ConstSpan<const char *> fnames, dblk::ReadFlags flg,
+  DataBlock::IFileNotify *fnotify, bool *out_ok)
+{
+  G_ASSERT_RETURN(blks.size() == fnames.size(), 0);
+  struct RecordFileNotify final : public DataBlock::IFileNotify
+  {
+    Tab<String> files;
+    void onFileLoaded(const char *fname) override { files.push_back() = fname; }
+  };
+
+  // allowSimpleString is global, so it is set once here rather than by each loading thread
+  const bool prevAllowSS = DataBlock::allowSimpleString;
+  if (flg & ReadFlag::ALLOW_SS)
+  {
+    DataBlock::allowSimpleString = true;
+    flg = flg ^ ReadFlag::ALLOW_SS;
+  }
+
+  BlkIncludeCache includeCache;
+  dag::Vector<RecordFileNotify> notify(fnotify ? blks.size() : 0);
+  dag::Vector<uint8_t> loaded(blks.size(), 0);
+  threadpool::parallel_for_inline(0, blks.size(), 1, [&](uint32_t begin, uint32_t end, uint32_t) {
+    tls_include_cache = &includeCache;
+    for (uint32_t i = begin; i < end; i++)
+      loaded[i] = dblk::load(*blks[i], fnames[i], flg, fnotify ? &notify[i] : nullptr);
+    tls_include_cache = nullptr;
+  });
+
+  DataBlock::allowSimpleString = prevAllowSS;
+
+  // notifications are issued on calling thread in order of fnames, exactly as serial loads would do
+  int loadedCnt = 0;
+  for (uint32_t i = 0; i < blks.size(); i++)
+  {
+    if (fnotify)
+      for (const String &fn : notify[i].files)
+        fnotify->onFileLoaded(fn);
+    if (out_ok)
+      out_ok[i] = loaded[i];
+    loadedCnt += loaded[i];
+  }
+  return loadedCnt;
+}
+
 #define EXPORT_PULL dll_pull_iosys_datablock_parser
 #include <supp/exportPull.h>
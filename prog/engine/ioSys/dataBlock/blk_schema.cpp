@@ -0,0 +1,157 @@
+#include <ioSys/dag_dataBlockSchema.h>
+#include "blk_shared.h"
+#include <debug/dag_debug.h>
+#include <EASTL/sort.h>
+#include <EASTL/algorithm.h>
+
+using namespace dblk;
+
+void SchemaBase::addField(const char *name, uint32_t ofs, int type, bool required)
+{
+  G_ASSERTF_RETURN(fields.size() < MAX_FIELDS, , "too many fields in BLK schema, '%s' is ignored", name);
+  for (const Field &f : fields)
+    G_ASSERTF_RETURN(strcmp(f.name, name) != 0, , "duplicate field '%s' in BLK schema", name);
+  if (required)
+    requiredMask |= uint64_t(1) << fields.size();
+  fields.push_back(Field{name, ofs, uint8_t(type), required});
+
+  OSSpinlockScopedLock lock(cacheLock);
+  cacheKeys.resize(CACHE_SIZE * fields.size());
+  for (BoundNames &b : cache)
+    b.keyCount = -1;
+}
+
+// copies (nameId << 32 | field) keys for name map of shared to out_keys, resolving them on cache miss; returns key count
+int SchemaBase::bindNames(const DataBlockShared &shared, uint64_t *out_keys) const
+{
+  const uint32_t nameCount = shared.nameCount(), fieldsCnt = fields.size();
+  {
+    OSSpinlockScopedLock lock(cacheLock);
+    for (int i = 0; i < CACHE_SIZE; i++)
+      if (cache[i].keyCount >= 0 && cache[i].namesUid == shared.namesUid && cache[i].nameCount == nameCount)
+      {
+        memcpy(out_keys, cacheKeys.data() + i * fieldsCnt, cache[i].keyCount * sizeof(uint64_t));
+        return cache[i].keyCount;
+      }
+  }
+
+  int keyCount = 0;
+  for (uint32_t i = 0; i < fieldsCnt; i++)
+  {
+    int nid = shared.getNameId(fields[i].name);
+    if (nid >= 0) // name that is absent in name map can't be in block
+      out_keys[keyCount++] = (uint64_t(nid) << 32) | i;
+  }
+  eastl::sort(out_keys, out_keys + keyCount);
+
+  OSSpinlockScopedLock lock(cacheLock);
+  const uint32_t slot = cacheNext++ % CACHE_SIZE;
+  cache[slot].namesUid = shared.namesUid;
+  cache[slot].nameCount = nameCount;
+  cache[slot].keyCount = keyCount;
+  memcpy(cacheKeys.data() + slot * fieldsCnt, out_keys, keyCount * sizeof(uint64_t));
+  return keyCount;
+}
+
+static inline int find_field(const uint64_t *keys, int key_count, uint32_t name_id)
+{
+  const uint64_t *it = eastl::lower_bound(keys, keys + key_count, uint64_t(name_id) << 32);
+  return (it != keys + key_count && uint32_t(*it >> 32) == name_id) ? int(uint32_t(*it)) : -1;
+}
+
+bool SchemaBase::read(const DataBlock &blk, void *dst, SchemaReadReport *report) const
+{
+  uint64_t keys[MAX_FIELDS];
+  const int keyCount = bindNames(*blk.shared, keys);
+
+  uint64_t seenMask = 0, badTypeMask = 0;
+  int unknownCount = 0;
+  const DataBlock::Param *params = blk.getParamsImpl();
+  for (uint32_t i = 0, e = blk.paramCount(); i < e; i++)
+  {
+    const DataBlock::Param &p = params[i];
+    const int fieldIdx = find_field(keys, keyCount, p.nameId);
+    if (fieldIdx < 0)
+    {
+      unknownCount++;
+      continue;
+    }
+    const uint64_t bit = uint64_t(1) << fieldIdx;
+    if (seenMask & bit) // only first param with given name is used
+      continue;
+    seenMask |= bit;
+
+    const Field &f = fields[fieldIdx];
+    char *fieldData = (char *)dst + f.ofs;
+    if (DAGOR_LIKELY(p.type == f.type))
+    {
+      if (f.type == DataBlock::TYPE_STRING)
+      {
+        const char *str = blk.getParamData(p);
+        memcpy(fieldData, &str, sizeof(str));
+      }
+      else
+        memcpy(fieldData, blk.getParamData(p), dblk::get_type_size(f.type));
+    }
+    // same int/int64 interchange as in DataBlock::get()
+    else if (f.type == DataBlock::TYPE_INT && p.type == DataBlock::TYPE_INT64)
+    {
+      int64_t v;
+      memcpy(&v, blk.getParamData(p), sizeof(v));
+      if (v == int32_t(v))
+      {
+        int32_t v32 = int32_t(v);
+        memcpy(fieldData, &v32, sizeof(v32));
+      }
+      else
+        badTypeMask |= bit;
+    }
+    else if (f.type == DataBlock::TYPE_INT64 && p.type == DataBlock::TYPE_INT)
+    {
+      uint32_t v32; // not sign-extended, the same way DataBlock::getInt64() converts it
+      memcpy(&v32, blk.getParamData(p), sizeof(v32));
+      int64_t v = v32;
+      memcpy(fieldData, &v, sizeof(v));
+    }
+    else
+      badTypeMask |= bit;
+  }
+
+  const uint64_t missingMask = requiredMask & ~seenMask;
+  if (report)
+  {
+    report->readMask = seenMask & ~badTypeMask;
+    report->missingMask = missingMask;
+    report->badTypeMask = badTypeMask;
+    report->unknownCount = unknownCount;
+  }
+  return !missingMask && !badTypeMask;
+}
+
+void SchemaBase::logReport(const DataBlock &blk, const SchemaReadReport &report, bool as_error) const
+{
+  const int lev = as_error ? LOGLEVEL_ERR : LOGLEVEL_WARN;
+  const char *blkName = blk.hasNoNameId() ? "<root>" : blk.getBlockName();
+  const char *src = blk.resolveFilename();
+  for (int i = 0, e = fields.size(); i < e; i++)
+  {
+    const uint64_t bit = uint64_t(1) << i;
+    if (report.missingMask & bit)
+      logmessage(lev, "%s: block '%s' misses required %s param '%s'", src, blkName, dblk::resolve_type(fields[i].type),
+        fields[i].name);
+    if (report.badTypeMask & bit)
+    {
+      int pidx = blk.findParam(fields[i].name);
+      logmessage(lev, "%s: block '%s' param '%s' has type %s, expected %s", src, blkName, fields[i].name,
+        dblk::resolve_type(pidx >= 0 ? blk.getParamType(pidx) : DataBlock::TYPE_NONE), dblk::resolve_type(fields[i].type));
+    }
+  }
+  if (!report.unknownCount)
+    return;
+  for (uint32_t i = 0, e = blk.paramCount(); i < e; i++)
+  {
+    const char *name = blk.getParamName(i);
+    if (eastl::find_if(fields.begin(), fields.end(), [&](const Field &f) { return strcmp(f.name, name) == 0; }) == fields.end())
+      logmessage(lev, "%s: block '%s' has unknown %s param '%s'", src, blkName, dblk::resolve_type(blk.getParamType(i)), name);
+  }
+}
@@ -150,6 +150,14 @@ struct DataBlockShared
   uint32_t roDataBlocks = 0;
   uint32_t blocksStartsAt = 0;
 
+  // unique across all instances, renewed when names are reset; lets external caches of name ids detect remapping
+  uint32_t namesUid = alloc_names_uid();
+  static uint32_t alloc_names_uid()
+  {
+    static volatile int lastUid = 0;
+    return (uint32_t)interlocked_increment(lastUid);
+  }
+
   SimpleString srcFilename; // src filename
   void setSrc(const char *src) { srcFilename = src; }
   const char *getSrc() const { return !srcFilename.empty() ? srcFilename.str() : nullptr; }
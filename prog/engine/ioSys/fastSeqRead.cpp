@@ -4,6 +4,7 @@
 #include <osApiWrappers/dag_files.h>
 #include <osApiWrappers/dag_cpuJobs.h>
 #include <osApiWrappers/dag_vromfs.h>
+#include <osApiWrappers/dag_critSec.h>
 #include <util/dag_globDef.h>
 // #include <osApiWrappers/dag_dbgStr.h>
 
@@ -14,6 +15,62 @@ void sleep_msec_ex(int ms) { SleepEx(ms, /*TRUE*/ 1); } // Alertable sleep in or
 void sleep_msec_ex(int ms) { sleep_msec(ms); }
 #endif
 
+#if _TARGET_PC_LINUX
+// Read buffers registered for io_uring fixed reads are kept and reused by all readers: registration is a syscall and
+// table of registered buffers is small. Readers beyond the pool (or when registration fails) use plain buffers;
+// pool is unregistered and freed at exit (FastSeqReader instances are not expected to outlive static destruction)
+static constexpr int MAX_REGISTERED_BUFS = FastSeqReader::BUF_CNT * 4;
+static struct RegisteredReadBufs
+{
+  char *data[MAX_REGISTERED_BUFS];
+  bool used[MAX_REGISTERED_BUFS];
+  int cnt = 0;
+  WinCritSec cs;
+
+  ~RegisteredReadBufs()
+  {
+    WinAutoLock lock(cs);
+    for (int i = 0; i < cnt; i++)
+    {
+      G_ASSERTF(!used[i], "FastSeqReader buffer %p is still in use at exit", data[i]);
+      dfa_unregister_read_buffer(data[i]);
+      if (!used[i])
+        tmpmem->freeAligned(data[i]);
+    }
+    cnt = 0;
+  }
+} reg_read_bufs;
+
+static char *alloc_read_buf(int sz)
+{
+  WinAutoLock lock(reg_read_bufs.cs);
+  for (int i = 0; i < reg_read_bufs.cnt; i++)
+    if (!reg_read_bufs.used[i])
+    {
+      reg_read_bufs.used[i] = true;
+      return reg_read_bufs.data[i];
+    }
+  char *p = (char *)tmpmem->allocAligned(sz, 32);
+  if (reg_read_bufs.cnt >= MAX_REGISTERED_BUFS || !dfa_register_read_buffer(p, sz)) // fails fast when backend is unavailable
+    return p;
+  reg_read_bufs.data[reg_read_bufs.cnt] = p;
+  reg_read_bufs.used[reg_read_bufs.cnt++] = true;
+  return p;
+}
+
+static void free_read_buf(char *p)
+{
+  WinAutoLock lock(reg_read_bufs.cs);
+  for (int i = 0; i < reg_read_bufs.cnt; i++)
+    if (reg_read_bufs.data[i] == p)
+    {
+      reg_read_bufs.used[i] = false;
+      return;
+    }
+  tmpmem->freeAligned(p);
+}
+#endif
+
 FastSeqReader::FastSeqReader()
 {
   memset(&file, 0, sizeof(file));
@@ -26,6 +83,8 @@ FastSeqReader::FastSeqReader()
   _TARGET_XBOX // MS require special aligment for non_cached reads (see
                // https://msdn.microsoft.com/en-us/library/windows/desktop/cc644950(v=vs.85).aspx#ALIGNMENT_AND_FILE_ACCESS_REQUIREMENTS)
     buf[i].data = (char *)tmpmem->allocAligned(BUF_SZ, 4096);
+#elif _TARGET_PC_LINUX
+    buf[i].data = alloc_read_buf(BUF_SZ);
 #else
     buf[i].data = (char *)tmpmem->allocAligned(BUF_SZ, 32);
 #endif
@@ -76,7 +135,11 @@ void FastSeqReader::closeData()
     if (buf[i].data)
     {
       dfa_free_asyncdata(buf[i].handle);
+#if _TARGET_PC_LINUX
+      free_read_buf(buf[i].data);
+#else
       tmpmem->freeAligned(buf[i].data);
+#endif
     }
   memset(&file, 0, sizeof(file));
   memset(buf, 0, sizeof(buf));
@@ -250,6 +313,9 @@ void FastSeqReader::placeRequests()
   }
 
   unsigned unusedMask = (~(doneMask | pendMask)) & BUF_ALL_MASK;
+#if _TARGET_PC_LINUX
+  dfa_begin_read_batch(); // refill all free buffers with single submission
+#endif
   if (unusedMask && readAheadPos < file.size)
     for (int i = 0, bit = 1; i < BUF_CNT; i++, bit <<= 1)
       if (unusedMask & bit)
@@ -308,6 +374,9 @@ void FastSeqReader::placeRequests()
         if (readAheadPos >= file.size)
           break;
       }
+#if _TARGET_PC_LINUX
+  dfa_end_read_batch();
+#endif
 }
 
 void FastSeqReader::seekto(int pos)
@@ -17,6 +17,8 @@
 #include <osApiWrappers/dag_files.h>
 #include <startup/dag_globalSettings.h>
 #include <osApiWrappers/dag_miscApi.h>
+#include <osApiWrappers/dag_threads.h>
+#include <osApiWrappers/dag_events.h>
 #include <perfMon/dag_cpuFreq.h>
 #include <osApiWrappers/basePath.h>
 #include <atomic>
@@ -266,9 +268,283 @@ static bool prepare_file_impl(const char *path, write_stream_t &fpout, int lev_b
   return true;
 }
 
+static void write_record_locked(write_stream_t fp, int ik, char *buf, int sz)
+{
+#if DAGOR_DBGLEVEL > 0
+  out_debug_str(buf);
+#endif
+#if DAGOR_FORCE_LOGS
+  crypt_out_str((unsigned char *)buf, sz, ik);
+#else
+  G_UNUSED(ik);
+#endif
+#if MEASURE_WRITE_TIME
+  int64_t ref = ref_time_ticks();
+#endif
+  write_stream_write(buf, sz, fp);
+  logFileSizes[ik].fetch_add(sz, std::memory_order_relaxed); // dropped and not yet written records are not counted
+#if MEASURE_WRITE_TIME
+  totalWriteCalls++;
+  if (int spent = get_time_usec(ref))
+  {
+    maxWriteTimeUs = max(maxWriteTimeUs, spent);
+    totalWriteTimeUs += spent;
+  }
+#endif
+}
+
+// Asynchronous mode: formatted records are put to per-thread single producer/single consumer rings and written (and crypted)
+// by background thread in order of global sequence number, so logging threads never wait for writeCS or file io.
+// Records are published strictly in order of their sequence numbers (async_published_seq), so writer never sees record
+// before all records with lower numbers are visible to it.
+// Rings are never freed, rings of finished threads are reused by new ones.
+struct AsyncLogRecordHdr
+{
+  uint32_t seq;
+  uint32_t ik : 8, len : 24;
+};
+
+struct AsyncLogRing
+{
+  AsyncLogRing *next;
+  volatile int owned;
+  volatile uint32_t writePos, readPos; // monotonic, wrapped with (size - 1) mask
+  uint32_t size;
+  char data[1];
+
+  void copyIn(uint32_t pos, const void *src, uint32_t len)
+  {
+    const uint32_t ofs = pos & (size - 1), first = min(len, size - ofs);
+    memcpy(data + ofs, src, first);
+    memcpy(data, (const char *)src + first, len - first);
+  }
+  void copyOut(uint32_t pos, void *dst, uint32_t len) const
+  {
+    const uint32_t ofs = pos & (size - 1), first = min(len, size - ofs);
+    memcpy(dst, data + ofs, first);
+    memcpy((char *)dst + first, data, len - first);
+  }
+};
+
+static AsyncLogRing *volatile async_rings = NULL;
+static volatile int async_log_enabled = 0, async_drop_on_overflow = 0;
+static int async_ring_size = 0;
+static volatile int async_seq = 0, async_published_seq = 0, async_dropped = 0;
+static volatile int async_producers = 0; // threads inside async_log_push(), stop waits for them before freeing writer/event
+static os_event_t async_wake_event;
+static class AsyncLogWriterThread *async_writer = NULL;
+static thread_local bool is_async_writer_thread = false;
+static char *async_drain_buf = NULL;
+
+struct AsyncLogRingOwner
+{
+  AsyncLogRing *ring = NULL;
+  ~AsyncLogRingOwner()
+  {
+    if (ring)
+      interlocked_release_store(ring->owned, 0);
+  }
+};
+static thread_local AsyncLogRingOwner async_ring_owner;
+
+static AsyncLogRing *acquire_async_ring()
+{
+  if (AsyncLogRing *ring = async_ring_owner.ring)
+    return ring;
+  for (AsyncLogRing *r = interlocked_acquire_load_ptr(async_rings); r; r = r->next)
+    if (r->size == async_ring_size && !interlocked_acquire_load(r->owned) && interlocked_compare_exchange(r->owned, 1, 0) == 0)
+      return async_ring_owner.ring = r;
+
+  AsyncLogRing *r = (AsyncLogRing *)malloc(sizeof(AsyncLogRing) + async_ring_size);
+  if (!r)
+    return NULL;
+  r->owned = 1;
+  r->writePos = r->readPos = 0;
+  r->size = async_ring_size;
+  do
+    r->next = interlocked_acquire_load_ptr(async_rings);
+  while (interlocked_compare_exchange_ptr(async_rings, r, r->next) != r->next);
+  return async_ring_owner.ring = r;
+}
+
+static write_stream_t async_stream_for(int ik)
+{
+  return ik == LOGLEVEL_ERR ? logerrFile : (ik == LOGLEVEL_WARN ? logwarnFile : dbgFile);
+}
+
+// writes all published records, called from writer thread and from flush (i.e. on crash)
+static void async_log_drain()
+{
+  WinAutoLock lock(writeCS);
+  for (;;)
+  {
+    // records with later numbers may be already visible in some rings while ones before them are not yet published
+    const uint32_t published = interlocked_acquire_load(async_published_seq);
+    AsyncLogRing *best = NULL;
+    AsyncLogRecordHdr bestHdr = {};
+    for (AsyncLogRing *r = interlocked_acquire_load_ptr(async_rings); r; r = r->next)
+    {
+      if (r->readPos == interlocked_acquire_load(r->writePos))
+        continue;
+      AsyncLogRecordHdr hdr;
+      r->copyOut(r->readPos, &hdr, sizeof(hdr));
+      if (int(hdr.seq - published) <= 0 && (!best || int(hdr.seq - bestHdr.seq) < 0))
+        best = r, bestHdr = hdr;
+    }
+    if (!best)
+      break;
+    best->copyOut(best->readPos + sizeof(bestHdr), async_drain_buf, bestHdr.len);
+    interlocked_release_store(best->readPos, best->readPos + ((sizeof(bestHdr) + bestHdr.len + 3) & ~3u));
+    async_drain_buf[bestHdr.len] = '\0';
+    if (write_stream_t fp = async_stream_for(bestHdr.ik))
+      write_record_locked(fp, bestHdr.ik, async_drain_buf, bestHdr.len);
+  }
+  if (int dropped = interlocked_exchange(async_dropped, 0))
+  {
+    char sbuf[64];
+    int sz = _snprintf(sbuf, sizeof(sbuf), "[%d log records dropped]\n", dropped);
+    if (dbgFile)
+      write_record_locked(dbgFile, LOGLEVEL_DEBUG, sbuf, sz);
+  }
+  if (flush_debug)
+  {
+    write_stream_t files[] = {dbgFile, logerrFile, logwarnFile};
+    for (write_stream_t fp : files)
+      if (fp)
+        write_stream_flush(fp);
+  }
+}
+
+class AsyncLogWriterThread final : public DaThread
+{
+public:
+  AsyncLogWriterThread() : DaThread("AsyncLogWriter", 128 << 10) {}
+  void execute() override
+  {
+    is_async_writer_thread = true;
+    while (!interlocked_acquire_load(terminating))
+    {
+      os_event_wait(&async_wake_event, 10);
+      async_log_drain();
+    }
+    async_log_drain();
+  }
+};
+
+enum class AsyncRecord
+{
+  DROPPABLE,
+  KEEP,
+  SYNC
+};
+
+// called with async_producers held, so async_writer and async_wake_event stay alive
+static bool async_log_push_record(int ik, const char *buf, int sz, AsyncRecord kind)
+{
+  if (!async_writer->isThreadRunnning())
+  {
+    async_log_drain(); // writer is gone (i.e. terminated on shutdown), keep order and write it ourselves
+    return false;
+  }
+  AsyncLogRing *r = acquire_async_ring();
+  const uint32_t need = (sizeof(AsyncLogRecordHdr) + sz + 3) & ~3u;
+  if (!r || need > r->size / 2)
+    return false;
+
+  const uint32_t wr = r->writePos;
+  while (r->size - (wr - interlocked_acquire_load(r->readPos)) < need)
+  {
+    if (kind == AsyncRecord::DROPPABLE && interlocked_relaxed_load(async_drop_on_overflow))
+    {
+      interlocked_increment(async_dropped);
+      return true;
+    }
+    if (!async_writer->isThreadRunnning())
+    {
+      async_log_drain();
+      return false;
+    }
+    os_event_set(&async_wake_event);
+    sleep_msec(0);
+  }
+
+  // number is taken and record is published as one step: producers publish in order of taken numbers
+  r->copyIn(wr + sizeof(AsyncLogRecordHdr), buf, sz);
+  AsyncLogRecordHdr hdr;
+  hdr.seq = interlocked_increment(async_seq);
+  hdr.ik = ik;
+  hdr.len = sz;
+  r->copyIn(wr, &hdr, sizeof(hdr));
+  while (interlocked_acquire_load(async_published_seq) != int(hdr.seq - 1))
+    sleep_msec(0);
+  interlocked_release_store(r->writePos, wr + need);
+  interlocked_release_store(async_published_seq, int(hdr.seq));
+  if (wr + need - interlocked_relaxed_load(r->readPos) > r->size / 2 || ik == LOGLEVEL_ERR)
+    os_event_set(&async_wake_event);
+  return true;
+}
+
+// returns false when record should be written synchronously
+static bool async_log_push(int ik, const char *buf, int sz, AsyncRecord kind)
+{
+  if (!interlocked_relaxed_load(async_log_enabled) || is_async_writer_thread || kind == AsyncRecord::SYNC)
+    return false;
+  interlocked_increment(async_producers);
+  // re-check after announcing ourselves: async_log_stop() clears the flag first and then waits for producers to leave
+  bool pushed = interlocked_acquire_load(async_log_enabled) && async_log_push_record(ik, buf, sz, kind);
+  interlocked_decrement(async_producers);
+  return pushed;
+}
+
+void debug_enable_async_log(bool enable, int ring_size_kb, bool drop_on_overflow)
+{
+  if (enable && !async_writer)
+  {
+    async_ring_size = 4 << 10;
+    while (async_ring_size < (min(ring_size_kb, 16 << 10) << 10))
+      async_ring_size <<= 1;
+    async_drain_buf = (char *)realloc(async_drain_buf, async_ring_size / 2 + 1);
+    os_event_create(&async_wake_event, "asyncLog");
+    async_writer = new AsyncLogWriterThread;
+    if (!async_writer->start())
+    {
+      async_writer->destroy();
+      async_writer = NULL;
+      os_event_destroy(&async_wake_event);
+      return;
+    }
+  }
+  else if (!enable && async_writer)
+    debug_internal::async_log_stop();
+  interlocked_release_store(async_drop_on_overflow, drop_on_overflow ? 1 : 0);
+  interlocked_release_store(async_log_enabled, enable ? 1 : 0);
+}
+
+void debug_internal::async_log_flush()
+{
+  if (async_drain_buf)
+    async_log_drain();
+}
+
+void debug_internal::async_log_stop()
+{
+  interlocked_exchange(async_log_enabled, 0); // full barrier, pairs with increment+load in async_log_push()
+  if (!async_writer)
+    return;
+  // producers still inside push may wait for ring space, so keep the writer running until all of them left
+  while (interlocked_acquire_load(async_producers))
+    sleep_msec(0);
+  async_writer->terminate(true, -1, &async_wake_event); // writer drains everything published before exiting
+  async_writer->destroy();
+  async_writer = NULL;
+  os_event_destroy(&async_wake_event);
+  async_log_drain();
+}
+
 #define MAX_CRYPTO_LINE (4 << 10)
 
-static void out_file(write_stream_t fp, int lc, int t, bool term, int ik, const char *format, const void *arg, int anum)
+static void out_file(write_stream_t fp, int lc, int t, bool term, int ik, AsyncRecord kind, const char *format, const void *arg,
+  int anum)
 {
   if (logsMaxSize && ik != LOGLEVEL_FATAL && logFileSizes[ik] >= logsMaxSize)
     return;
@@ -327,28 +603,11 @@ static void out_file(write_stream_t fp, int lc, int t, bool term, int ik, const
     final_sbuf[sz++] = '\n';
   final_sbuf[sz] = '\0';
   G_ASSERT(strlen(final_sbuf) == sz);
+  if (!async_log_push(ik, final_sbuf, sz, kind))
   {
     WinAutoLock lock(writeCS); // both operations of crypto & file write should be not only atomic, but strictly ordered as well
-#if DAGOR_DBGLEVEL > 0
-    out_debug_str(final_sbuf);
-#endif
-#if DAGOR_FORCE_LOGS
-    crypt_out_str((unsigned char *)final_sbuf, sz, ik);
-#endif
-#if MEASURE_WRITE_TIME
-    int64_t ref = ref_time_ticks();
-#endif
-    write_stream_write(final_sbuf, sz, fp);
-#if MEASURE_WRITE_TIME
-    totalWriteCalls++;
-    if (int spent = get_time_usec(ref))
-    {
-      maxWriteTimeUs = max(maxWriteTimeUs, spent);
-      totalWriteTimeUs += spent;
-    }
-#endif
+    write_record_locked(fp, ik, final_sbuf, sz);
   }
-  logFileSizes[ik].fetch_add(sz, std::memory_order_relaxed);
   if (final_sbuf != sbuf)
     free(final_sbuf);
 }
@@ -366,11 +625,17 @@ void debug_internal::vlog(int lev, const char *fmt, const void *arg, int anum)
   bool term = !(&dbg_ctx)->holdLine;
 
   int t = (!(&dbg_ctx)->lastHoldLine && timestampEnabled) ? get_time_msec() : -1;
+  // only errors and warnings are kept when async log is overflown, fatal ones are written after all queued records
+  const AsyncRecord kind =
+    lev == LOGLEVEL_FATAL ? AsyncRecord::SYNC : ((uint32_t)lev > LOGLEVEL_WARN ? AsyncRecord::DROPPABLE : AsyncRecord::KEEP);
+  if (kind == AsyncRecord::SYNC)
+    async_log_flush();
+  const bool flushNow = flush_debug && !interlocked_relaxed_load(async_log_enabled); // otherwise flushed by writer
   if (prepare_file(dbgFilepath, dbgFile, 1 << LOGLEVEL_DEBUG))
   {
-    out_file(dbgFile, lc, t, term, LOGLEVEL_DEBUG, fmt, arg, anum);
+    out_file(dbgFile, lc, t, term, LOGLEVEL_DEBUG, kind, fmt, arg, anum);
 
-    if (flush_debug)
+    if (flushNow)
       write_stream_flush_locked(dbgFile);
   }
 #if DAGOR_DBGLEVEL > 0
@@ -401,14 +666,14 @@ void debug_internal::vlog(int lev, const char *fmt, const void *arg, int anum)
   {
     if (lev == LOGLEVEL_ERR && prepare_file(logerrFilepath, logerrFile, 1 << LOGLEVEL_ERR))
     {
-      out_file(logerrFile, lc, t, term, LOGLEVEL_ERR, fmt, arg, anum);
-      if (flush_debug)
+      out_file(logerrFile, lc, t, term, LOGLEVEL_ERR, kind, fmt, arg, anum);
+      if (flushNow)
         write_stream_flush_locked(logerrFile);
     }
     else if (lev == LOGLEVEL_WARN && prepare_file(logwarnFilepath, logwarnFile, 1 << LOGLEVEL_WARN))
     {
-      out_file(logwarnFile, lc, t, term, LOGLEVEL_WARN, fmt, arg, anum);
-      if (flush_debug)
+      out_file(logwarnFile, lc, t, term, LOGLEVEL_WARN, kind, fmt, arg, anum);
+      if (flushNow)
         write_stream_flush_locked(logwarnFile);
     }
     else if (lev == LOGLEVEL_FATAL && fatalerrFilepath[0])
@@ -416,7 +681,7 @@ void debug_internal::vlog(int lev, const char *fmt, const void *arg, int anum)
       write_stream_t fp = file2stream(fopen(fatalerrFilepath, "at"));
       if (fp)
       {
-        out_file(fp, lc, t, term, LOGLEVEL_FATAL, fmt, arg, anum);
+        out_file(fp, lc, t, term, LOGLEVEL_FATAL, AsyncRecord::SYNC, fmt, arg, anum);
         write_stream_close(fp);
       }
     }
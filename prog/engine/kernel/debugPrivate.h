@@ -63,6 +63,11 @@ inline const char *get_logging_directory() { return ""; }
 #endif
 
 bool on_log_handler(int tag, const char *fmt, const void *arg, int anum);
+
+#if _TARGET_PC && (DAGOR_DBGLEVEL > 0 || DAGOR_FORCE_LOGS)
+void async_log_flush(); // writes queued records on calling thread
+void async_log_stop();
+#endif
 } // namespace debug_internal
 
 extern "C" const char *dagor_get_build_stamp_str(char *buf, size_t bufsz, const char *suffix);
@@ -355,6 +355,7 @@ void debug_internal::vlog(int tag, const char *format, const void *arg, int anum
 #undef PFUN
 
 void debug_override_log_timestamp_format(debug_override_timestamp_cb_t) {}
+void debug_enable_async_log(bool, int, bool) {}
 
 #if DAGOR_DBGLEVEL > 0 || DAGOR_FORCE_LOGS
 int tail_debug_file(char *out_buf, int buf_size) { return GET_FROM_TAIL_BUF(out_buf, buf_size); }
@@ -509,6 +510,7 @@ void debug_enable_timestamps(bool e, bool hhmmss_fmt, int hhmmss_subsec)
 #define DIF(x) debug_internal::x##File
 void flush_debug_file()
 {
+  debug_internal::async_log_flush();
   debug_internal::write_stream_t files[] = {DIF(dbg), DIF(logerr), DIF(logwarn)};
   for (int i = 0; i < countof(files); ++i)
     if (files[i])
@@ -517,6 +519,7 @@ void flush_debug_file()
 
 void close_debug_files()
 {
+  debug_internal::async_log_stop();
   if (debug_internal::totalWriteCalls > 0)
   {
     debug("max log write time %d us, average %d us in %d calls", debug_internal::maxWriteTimeUs,
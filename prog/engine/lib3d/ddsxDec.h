@@ -13,23 +13,26 @@
 #include <osApiWrappers/dag_spinlock.h>
 #include <osApiWrappers/dag_events.h>
 #include <osApiWrappers/dag_atomic.h>
+#include <util/dag_threadPool.h>
 #include <math/dag_bits.h>
 #include <stdio.h>
+#include <limits.h>
 #include "texMgrData.h"
+#include "ddsxDecQueue.h"
+#include "loadDDSx/uniTexCrd.h"
 
 static constexpr int DXP_PRIO_COUNT = 3;
 
 
 struct DDSxDecodeCtxBase //-V730
 {
-  cpujobs::JobQueue<cpujobs::IJob *, false> q;
-  OSSpinlock queueSL;
   volatile int maybeIdle = 0;
 };
 
 struct DDSxDecodeCtx : DDSxDecodeCtxBase
 {
   static constexpr int MAX_WORKERS = 8;
+  static constexpr int JOBS_PER_WORKER = 8; // read-ahead depth; actual depth is also limited by readAheadBudget
 
   class NamedInPlaceMemLoadCB : public InPlaceMemLoadCB
   {
@@ -41,6 +44,26 @@ struct DDSxDecodeCtx : DDSxDecodeCtxBase
 
   struct TexCreateJob : public cpujobs::IJob
   {
+    // unpacks compressed data on threadpool and then queues job to decoders, so they only upload mips to texture
+    struct UnpackJob final : public cpujobs::IJob
+    {
+      TexCreateJob *owner = NULL;
+      void doJob() override
+      {
+        if (owner->calcDecodePriority() != DDSxDecodeQueue<TexCreateJob>::DROP_PRIO)
+          owner->unpackData();
+        dCtx->queueForUpload(owner);
+        interlocked_decrement(dCtx->unpackingCount);
+      }
+    };
+
+    struct PrioKey
+    {
+      TEXTUREID tid;
+      const ddsx::Header *hdr;
+      int prio;
+    };
+
     const ddsx::Header *hdr;
     char *data;
     const char *texName, *packName;
@@ -49,8 +72,19 @@ struct DDSxDecodeCtx : DDSxDecodeCtxBase
     TEXTUREID tid;
     int prio = -1;
     volatile int *stillLoading;
+    volatile int queued = 0; // read and waiting to be picked by decoder
+    int reservedSize = 0;    // part of read-ahead budget, see DDSxDecodeQueue
+    int decodePrio = 0;      // cached priority, see DDSxDecodeQueue::refreshPriorities()
+    unsigned queueGen = 0;
+    bool unpacked = false; // data is unpacked already and unpackedHdr describes it
+    ddsx::Header unpackedHdr;
+    UnpackJob unpackJob;
 
-    TexCreateJob() : hdr(NULL), texQ(-1), texName(NULL), packName(NULL) { tid = BAD_TEXTUREID; }
+    TexCreateJob() : hdr(NULL), texQ(-1), texName(NULL), packName(NULL)
+    {
+      tid = BAD_TEXTUREID;
+      unpackJob.owner = this;
+    }
     bool initJob(const ddsx::Header &_hdr, int tq, const char *tex_name, const char *pack_name, TEXTUREID _tid, FastSeqReader &crd,
       int data_sz, int _prio, volatile int &still_loading)
     {
@@ -58,16 +92,11 @@ struct DDSxDecodeCtx : DDSxDecodeCtxBase
       stillLoading = &still_loading;
       prio = _prio;
       data = (char *)tmpmem->tryAlloc(data_sz);
-      if (data)
-      {
-        crd.read(data, data_sz);
-        dataSize = data_sz;
-      }
-      else
-      {
-        interlocked_release_store(done, 1);
+      if (!data)
         return false;
-      }
+      crd.read(data, data_sz);
+      dataSize = data_sz;
+      unpacked = false;
       hdr = &_hdr;
       texName = tex_name;
       packName = pack_name;
@@ -76,6 +105,63 @@ struct DDSxDecodeCtx : DDSxDecodeCtxBase
       return true;
     }
 
+    // jobs with higher value are decoded first; it is evaluated when job is queued and re-evaluated by decoders before picking
+    // next job, so changes of requested levels (screen size/distance feedback, memory quota decrease) made after data was read
+    // reorder pending decoding; must be called with texmgr lock held
+    static int calcDecodePriority(const PrioKey &k)
+    {
+      unsigned idx = k.tid.index();
+      if (RMGR.shouldSkipReading(idx, *k.hdr))
+        return DDSxDecodeQueue<TexCreateJob>::DROP_PRIO; // not needed anymore, read data is freed without decoding
+      if ((k.hdr->flags & k.hdr->FLG_NEED_PAIRED_BASETEX) && !RMGR.hasTexBaseData(RMGR.pairedBaseTexId[idx]))
+        return INT_MIN; // would only wait for basetex and block decoder thread, so let other jobs go first
+      // more urgent load queue goes first, then textures with fewer mips loaded (stubs and thumbnails), then more important ones
+      return ((DXP_PRIO_COUNT - k.prio) << 24) + ((16 - RMGR.resQS[idx].getLdLev()) << 16) + RMGR.getTexImportance(idx);
+    }
+    static void calcDecodePriorities(const PrioKey *keys, int *out_prio, int cnt)
+    {
+      texmgr_internal::TexMgrAutoLock lock;
+      for (int i = 0; i < cnt; i++)
+        out_prio[i] = calcDecodePriority(keys[i]);
+    }
+    PrioKey getPrioKey() const { return PrioKey{tid, hdr, prio}; }
+    int calcDecodePriority() const
+    {
+      const PrioKey k = getPrioKey();
+      int p = 0;
+      calcDecodePriorities(&k, &p, 1);
+      return p;
+    }
+
+    // unpacks whole mip chain at once; readDdsxTex() may stop before last mips when they are loaded already, so some of them may be
+    // unpacked in vain, but decoder thread is not busy with decompression while holding loading lock;
+    // on failure packed data is kept as is and is decoded by readDdsxTex() later
+    void unpackData()
+    {
+      char *unp = (char *)tmpmem->tryAlloc(hdr->memSz);
+      if (!unp)
+        return;
+      bool ok;
+      {
+        InPlaceMemLoadCB mcrd(data, dataSize);
+        UnifiedTexGenLoad ucrd(mcrd, *hdr);
+        ok = ucrd->tryRead(unp, hdr->memSz) == (int)hdr->memSz;
+      }
+      if (!ok)
+      {
+        logwarn("failed to unpack tex '%s' from pack '%s', %d bytes", texName, packName, dataSize);
+        tmpmem->free(unp);
+        return;
+      }
+      tmpmem->free(data);
+      data = unp;
+      dataSize = hdr->memSz;
+      unpackedHdr = *hdr;
+      unpackedHdr.flags &= ~ddsx::Header::FLG_COMPR_MASK;
+      unpacked = true;
+      dCtx->queue.resizeReserved(this, dataSize); // unpacked data holds read-ahead budget till it is uploaded
+    }
+
     virtual void doJob()
     {
       if (hdr->flags & hdr->FLG_NEED_PAIRED_BASETEX)
@@ -112,11 +198,24 @@ struct DDSxDecodeCtx : DDSxDecodeCtxBase
         RMGR.hasTexBaseData(RMGR.pairedBaseTexId[tid.index()]));
       {
         d3d::LoadingAutoLock loadingLock;
-        if (!RMGR.readDdsxTex(tid, *hdr, crd, texQ))
+        if (!RMGR.readDdsxTex(tid, unpacked ? unpackedHdr : *hdr, crd, texQ))
           if (!d3d::is_in_device_reset_now())
             logwarn("failed loading tex '%s' from pack '%s'", texName, packName);
       }
+      finishJob();
+    }
+
+    // frees read data without decoding, texture state is left as skipped readDdsxTex() leaves it
+    void dropJob()
+    {
+      RMGR_TRACE("drop read data of tex %s (req=%d ld=%d)", RMGR.getName(tid.index()), RMGR.resQS[tid.index()].getMaxReqLev(),
+        RMGR.resQS[tid.index()].getLdLev());
+      RMGR.resQS[tid.index()].setRdLev(RMGR.resQS[tid.index()].getLdLev());
+      finishJob();
+    }
 
+    void finishJob()
+    {
       tmpmem->free(data);
       data = NULL;
       texName = packName = NULL;
@@ -149,12 +248,14 @@ struct DDSxDecodeCtx : DDSxDecodeCtxBase
         if (interlocked_acquire_load(terminating))
           break;
 
-        cpujobs::IJob *job = ctx->q.pop();
+        DDSxDecodeCtx &dctx = *static_cast<DDSxDecodeCtx *>(ctx);
+        bool drop = false;
+        TexCreateJob *job = dctx.pickJob(drop);
         if (!job)
         {
           if (DAGOR_UNLIKELY(wres == OS_WAIT_TIMEOUTED || ddsx::get_streaming_mode() == ddsx::BackgroundSerial))
           {
-            OSSpinlockScopedLock lock(ctx->queueSL);
+            OSSpinlockScopedLock lock(dctx.queue.queueSL);
             if (os_event_wait(&event, OS_WAIT_IGNORE) != OS_WAIT_OK)
               break;
           }
@@ -164,27 +265,36 @@ struct DDSxDecodeCtx : DDSxDecodeCtxBase
         while (job)
         {
           G_ASSERT(interlocked_acquire_load(job->done) == 0);
-          job->doJob();
-          DDSxDecodeCtx::updateWorkerUsedMask(static_cast<TexCreateJob *>(job)->prio, wIdx);
+          if (drop)
+            job->dropJob();
+          else
+            job->doJob();
+          DDSxDecodeCtx::updateWorkerUsedMask(job->prio, wIdx);
           G_ASSERT(interlocked_acquire_load(job->done) == 0);
-          interlocked_release_store(job->done, 1);
+          dctx.queue.releaseJob(job);
           if (interlocked_acquire_load(terminating)) // check quit request
             return;
-          job = ctx->q.pop();
+          job = dctx.pickJob(drop);
         }
       }
     }
   };
 
   DecThread workers[MAX_WORKERS];
-  TexCreateJob *jobs;
+  DDSxDecodeQueue<TexCreateJob> queue;
+  static_assert(MAX_WORKERS * JOBS_PER_WORKER <= DDSxDecodeQueue<TexCreateJob>::MAX_JOBS, "refreshPriorities() limit");
   int numWorkers;
+  int readAheadBudget; // max size of data read and not decoded yet
+  bool unpackOnThreadpool;
+  volatile int unpackingCount = 0;
 
-  DDSxDecodeCtx(int nworkers)
+  DDSxDecodeCtx(int nworkers, int read_ahead_budget, bool unpack_on_threadpool)
   {
     numWorkers = min(nworkers, MAX_WORKERS);
-    q.allocQueue(get_bigger_pow2(numWorkers * 2));
-    jobs = new TexCreateJob[numWorkers * 2];
+    readAheadBudget = read_ahead_budget;
+    unpackOnThreadpool = unpack_on_threadpool;
+    queue.numJobs = numWorkers * JOBS_PER_WORKER;
+    queue.jobs = new TexCreateJob[queue.numJobs];
     for (int i = 0; i < numWorkers; i++)
     {
       workers[i].ctx = this;
@@ -193,10 +303,11 @@ struct DDSxDecodeCtx : DDSxDecodeCtxBase
   }
   ~DDSxDecodeCtx()
   {
+    for (int i = 0; i < queue.numJobs; i++)
+      threadpool::wait(&queue.jobs[i].unpackJob);
     for (int i = 0; i < numWorkers; i++)
       workers[i].terminate(true, -1, &workers[i].event);
-    q.freeQueue();
-    delete[] jobs;
+    delete[] queue.jobs;
   }
 
   void wakeUpAll()
@@ -234,39 +345,79 @@ struct DDSxDecodeCtx : DDSxDecodeCtxBase
     return false;
   }
 
-  TexCreateJob *allocJob()
+  // read-ahead is limited by free streaming memory quota too, so it shrinks with quota instead of reading data to be skipped
+  int calcReadAheadBudget() const
   {
-    OSSpinlockScopedLock lock(queueSL);
-    for (int i = 0; i < numWorkers * 2; i++)
-      if (interlocked_acquire_load(jobs[i].done))
-      {
-        interlocked_release_store(jobs[i].done, 0);
-        return &jobs[i];
-      }
-    return NULL;
+    if (!texmgr_internal::texq_load_on_demand)
+      return readAheadBudget;
+    int free_quota_kb = tql::mem_quota_kb - tql::mem_used_persistent_kb - tql::mem_quota_reserve_kb - RMGR.getTotalUsedTexSzKB() -
+                        RMGR.getTotalAddMemNeededSzKB();
+    return clamp(free_quota_kb, 0, readAheadBudget >> 10) << 10;
+  }
+
+  // returns NULL when all jobs are busy or read-ahead budget is exhausted (at least one job is allowed to exceed it);
+  // job keeps data_sz reserved in budget until it is decoded or dropped
+  TexCreateJob *allocJob(int data_sz)
+  {
+    int budget = calcReadAheadBudget();
+    if (TexCreateJob *j = queue.allocJob(data_sz, budget))
+      return j;
+
+    // drop read jobs that are not needed anymore (e.g. after quota decrease) before spending budget to read more
+    queue.refreshPriorities();
+    TexCreateJob *dropped[MAX_WORKERS * JOBS_PER_WORKER];
+    int cnt = queue.unqueueDropped(dropped, countof(dropped));
+    for (int i = 0; i < cnt; i++)
+    {
+      dropped[i]->dropJob();
+      queue.releaseJob(dropped[i]);
+    }
+    return cnt ? queue.allocJob(data_sz, budget) : NULL;
   }
+  void releaseJob(TexCreateJob *j) { queue.releaseJob(j); }
 
+  // compressed data is unpacked on threadpool first (when it has workers) and then is queued to decoders for upload;
+  // otherwise job is queued directly and readDdsxTex() unpacks data while uploading
   void submitJob(TexCreateJob *j)
   {
-    q.push(j, NULL, NULL);
-    OSSpinlockScopedLock lock(queueSL);
+    if (unpackOnThreadpool && j->hdr->compressionType() && threadpool::get_num_workers() > 0)
+    {
+      interlocked_increment(unpackingCount);
+      threadpool::add(&j->unpackJob, threadpool::PRIO_LOW);
+      return;
+    }
+    queueForUpload(j);
+  }
+  void queueForUpload(TexCreateJob *j)
+  {
+    const int decode_prio = j->calcDecodePriority(); // evaluated before queueSL is locked, since it takes texmgr lock
+    OSSpinlockScopedLock lock(queue.queueSL);
+    queue.queueJob(j, decode_prio);
     if (!wakeUpIdle())
       if (!startOne())
         // All workers are started and busy - wake up first one just in case
         G_VERIFY(os_event_set(&workers[0].event) == 0);
   }
 
+  // single queued job is picked anyway (and readDdsxTex() skips it when not needed), so priorities are refreshed for more jobs only
+  TexCreateJob *pickJob(bool &drop)
+  {
+    if (interlocked_relaxed_load(queue.queuedCount) > 1)
+      queue.refreshPriorities();
+    return queue.pickJob(drop);
+  }
+
   void waitAllDone(int prio)
   {
     if (prio < 0)
-      while (q.size() > 0)
+      while (interlocked_acquire_load(unpackingCount) > 0 || interlocked_acquire_load(queue.queuedCount) > 0)
         sleep_msec(1);
 
   check_done:
-    for (int i = 0; i < numWorkers * 2; i++)
-      if (!interlocked_acquire_load(jobs[i].done))
+    for (int i = 0; i < queue.numJobs; i++)
+      if (!interlocked_acquire_load(queue.jobs[i].done))
       {
-        if (jobs[i].prio != prio)
+        if (queue.jobs[i].prio != prio)
           continue;
         sleep_msec(1);
         goto check_done;
@@ -276,8 +427,8 @@ struct DDSxDecodeCtx : DDSxDecodeCtxBase
   {
     if (!RMGR.resQS[tid.index()].isReading() || !dCtx)
       return false;
-    TexCreateJob *jobs = dCtx->jobs;
-    for (int i = 0, ie = dCtx->numWorkers * 2; i < ie; i++)
+    TexCreateJob *jobs = dCtx->queue.jobs;
+    for (int i = 0, ie = dCtx->queue.numJobs; i < ie; i++)
       if (!interlocked_acquire_load(jobs[i].done) && jobs[i].prio == prio)
         if (jobs[i].tid == tid)
           return true;
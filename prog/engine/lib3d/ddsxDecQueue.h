@@ -0,0 +1,141 @@
+#pragma once
+
+#include <osApiWrappers/dag_spinlock.h>
+#include <osApiWrappers/dag_atomic.h>
+#include <debug/dag_assert.h>
+#include <limits.h>
+
+// pool of DDSx decoding jobs with read-ahead budget and queue of jobs that are read and wait for decoder;
+// JOB must provide `volatile int done, queued`, `int reservedSize, decodePrio`, `unsigned queueGen`, type PrioKey,
+// `PrioKey getPrioKey() const` and `static void calcDecodePriorities(const PrioKey *keys, int *out_prio, int cnt)`
+template <class JOB>
+struct DDSxDecodeQueue
+{
+  static constexpr int DROP_PRIO = INT_MAX; // decode priority of job which is not needed anymore
+  static constexpr int MAX_JOBS = 64;
+
+  OSSpinlock queueSL;
+  volatile int queuedCount = 0;
+  volatile int refreshing = 0;
+  int reservedDataSize = 0; // data size of jobs from allocJob() till releaseJob(), guarded by queueSL
+  JOB *jobs = NULL;
+  int numJobs = 0;
+
+  // returns NULL when all jobs are busy or budget is exhausted (single job is allowed to exceed it);
+  // data_sz is reserved under the same lock as budget is checked, so concurrent readers cannot overshoot it
+  JOB *allocJob(int data_sz, int budget)
+  {
+    OSSpinlockScopedLock lock(queueSL);
+    if (reservedDataSize && reservedDataSize + data_sz > budget)
+      return NULL;
+    for (int i = 0; i < numJobs; i++)
+      if (interlocked_acquire_load(jobs[i].done))
+      {
+        jobs[i].reservedSize = data_sz;
+        reservedDataSize += data_sz;
+        interlocked_release_store(jobs[i].done, 0);
+        return &jobs[i];
+      }
+    return NULL;
+  }
+
+  // changes data size reserved by job (e.g. when packed data is replaced with unpacked one)
+  void resizeReserved(JOB *j, int new_sz)
+  {
+    OSSpinlockScopedLock lock(queueSL);
+    reservedDataSize += new_sz - j->reservedSize;
+    j->reservedSize = new_sz;
+  }
+
+  // returns job to pool and its data size to budget
+  void releaseJob(JOB *j)
+  {
+    G_ASSERT(!interlocked_relaxed_load(j->queued));
+    {
+      OSSpinlockScopedLock lock(queueSL);
+      reservedDataSize -= j->reservedSize;
+      j->reservedSize = 0;
+    }
+    interlocked_release_store(j->done, 1);
+  }
+
+  // must be called with queueSL locked (to wake up decoders under the same lock);
+  // decode_prio is computed by caller before lock and is kept till refreshPriorities()
+  void queueJob(JOB *j, int decode_prio)
+  {
+    j->decodePrio = decode_prio;
+    j->queueGen++;
+    interlocked_release_store(j->queued, 1);
+    queuedCount++;
+  }
+
+  // re-evaluates priorities of queued jobs (to follow changes of requested levels and memory quota) without holding queueSL,
+  // so readers and decoders are not stalled by it; results for jobs picked or queued again meanwhile are discarded;
+  // returns false when other thread is refreshing already
+  bool refreshPriorities()
+  {
+    if (!interlocked_acquire_load(queuedCount) || interlocked_compare_exchange(refreshing, 1, 0) != 0)
+      return false;
+
+    G_ASSERT(numJobs <= MAX_JOBS);
+    typename JOB::PrioKey keys[MAX_JOBS];
+    int idx[MAX_JOBS], prio[MAX_JOBS];
+    unsigned gen[MAX_JOBS];
+    int cnt = 0;
+    {
+      OSSpinlockScopedLock lock(queueSL);
+      for (int i = 0; i < numJobs && cnt < queuedCount; i++)
+        if (interlocked_relaxed_load(jobs[i].queued))
+        {
+          keys[cnt] = jobs[i].getPrioKey();
+          gen[cnt] = jobs[i].queueGen;
+          idx[cnt++] = i;
+        }
+    }
+
+    if (cnt)
+    {
+      JOB::calcDecodePriorities(keys, prio, cnt);
+      OSSpinlockScopedLock lock(queueSL);
+      for (int k = 0; k < cnt; k++)
+        if (interlocked_relaxed_load(jobs[idx[k]].queued) && jobs[idx[k]].queueGen == gen[k])
+          jobs[idx[k]].decodePrio = prio[k];
+    }
+    interlocked_release_store(refreshing, 0);
+    return true;
+  }
+
+  // picks queued job with highest decode priority, so decoding order is not bound to read order;
+  // drop is set when job is not needed anymore and should be released without decoding
+  JOB *pickJob(bool &drop)
+  {
+    OSSpinlockScopedLock lock(queueSL);
+    if (!queuedCount)
+      return NULL;
+    JOB *best = NULL;
+    int best_pri = INT_MIN;
+    for (int i = 0; i < numJobs && best_pri != DROP_PRIO; i++)
+      if (interlocked_relaxed_load(jobs[i].queued) && (!best || jobs[i].decodePrio > best_pri))
+        best = &jobs[i], best_pri = jobs[i].decodePrio;
+    G_ASSERT_RETURN(best, NULL);
+    interlocked_release_store(best->queued, 0);
+    queuedCount--;
+    drop = best_pri == DROP_PRIO;
+    return best;
+  }
+
+  // removes queued jobs which are not needed anymore (to drop them before budget is spent to read more); returns count
+  int unqueueDropped(JOB **out, int max_cnt)
+  {
+    OSSpinlockScopedLock lock(queueSL);
+    int cnt = 0;
+    for (int i = 0; i < numJobs && cnt < max_cnt && queuedCount; i++)
+      if (interlocked_relaxed_load(jobs[i].queued) && jobs[i].decodePrio == DROP_PRIO)
+      {
+        interlocked_release_store(jobs[i].queued, 0);
+        queuedCount--;
+        out[cnt++] = &jobs[i];
+      }
+    return cnt;
+  }
+};
@@ -540,6 +540,23 @@ unsigned texmgr_internal::D3dResMgrDataFinal::calcTexMemSize(int idx, int target
 
   return total * a + (target_lev > 1 ? 4096 : 0);
 }
+// same checks as in readDdsxTex() below, to drop loads before reading data
+bool texmgr_internal::D3dResMgrDataFinal::shouldSkipReading(int idx, const ddsx::Header &hdr)
+{
+  unsigned max_lev = resQS[idx].getMaxLev();
+  if (getRefCount(idx) == 0 && getBaseTexUsedCount(idx) == 0)
+    return true;
+  if (resQS[idx].getLdLev() >= min<unsigned>(resQS[idx].getMaxReqLev(), max_lev) && !getBaseTexUsedCount(idx))
+    return true;
+  if (getRefCount(idx) > 0 && RMGR.baseTexture(idx) && getTexAddMemSizeNeeded4K(idx) &&
+      min<unsigned>(resQS[idx].getRdLev(), max_lev) > getLevDesc(idx, TQL_base) &&
+      !texmgr_internal::is_gpu_mem_enough_to_load_hq_tex() && getTexImportance(idx) < 1)
+    return !((hdr.flags & hdr.FLG_HOLD_SYSMEM_COPY) && getBaseTexUsedCount(idx) > 0 && !hasTexBaseData(idx));
+  if ((hdr.flags & hdr.FLG_HOLD_SYSMEM_COPY) && !texmgr_internal::is_sys_mem_enough_to_load_basedata())
+    return getBaseTexUsedCount(idx) < 1;
+  return false;
+}
+
 bool texmgr_internal::D3dResMgrDataFinal::readDdsxTex(TEXTUREID tid, const ddsx::Header &hdr, IGenLoad &crd, int quality_id)
 {
   unsigned idx = tid.index();
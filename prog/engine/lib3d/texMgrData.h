@@ -368,6 +368,8 @@ public:
   // texture loads management
   static bool scheduleReading(int idx, TextureFactory *f);
   static bool readDdsxTex(TEXTUREID tid, const ddsx::Header &hdr, IGenLoad &crd, int quality_id);
+  //! returns true when readDdsxTex() would skip reading (texture released, mips not requested anymore or don't fit memory quota)
+  static bool shouldSkipReading(int idx, const ddsx::Header &hdr);
   static void finishReading(int idx);
   static void cancelReading(int idx);
   static bool startReading(int idx, unsigned rd_lev)
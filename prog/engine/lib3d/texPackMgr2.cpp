@@ -1456,7 +1456,7 @@ bool DDSxTexturePack2::Factory::performDelayedLoad(int prio)
   }
   fastSeqCrd->setRangesOfInterest(make_span(rangesBuf).first(num_ranges));
 
-  int data_sz = 0, mem_data_sz = 0;
+  int data_sz = 0, mem_data_sz = 0, read_stall_usec = 0;
   int last_recid = -1;
   for (int i = 0; i < localLoad.size(); i++)
   {
@@ -1490,6 +1490,20 @@ bool DDSxTexturePack2::Factory::performDelayedLoad(int prio)
         RMGR.updateResReqLev(p.texId, idx, RMGR.getLevDesc(idx, TQL_high));
       }
     }
+    if (RMGR.shouldSkipReading(p.texId.index(), pack.texHdr[rec_id]))
+    {
+      // mips are not needed anymore (e.g. quota decreased while waiting in queue), so don't spend read time and budget on them
+      RMGR_TRACE("skip loading tex %s (req=%d ld=%d) at 0x%x", pack.texNames.map[rec_id], get_managed_res_maxreq_lev(p.texId),
+        RMGR.resQS[p.texId.index()].getLdLev(), p.ofs);
+      RMGR.resQS[p.texId.index()].setRdLev(RMGR.resQS[p.texId.index()].getLdLev());
+      {
+        texmgr_internal::TexMgrAutoLock tlock;
+        RMGR.markUpdatedAfterLoad(p.texId.index());
+      }
+      if (!is_managed_textures_streaming_load_on_demand())
+        RMGR.scheduleReading(p.texId.index(), RMGR.getFactory(p.texId.index()));
+      continue;
+    }
     G_ASSERT(rec_id != last_recid);
 
     int tex_q = texProps[rec_id].curQID;
@@ -1499,11 +1513,16 @@ bool DDSxTexturePack2::Factory::performDelayedLoad(int prio)
     interlocked_increment(ddsx_loaded_tex_cnt[prio]);
     if (DDSxDecodeCtx::dCtx && may_use_dctx)
     {
-      DDSxDecodeCtx::TexCreateJob *j = DDSxDecodeCtx::dCtx->allocJob();
-      while (!j)
+      DDSxDecodeCtx::TexCreateJob *j = DDSxDecodeCtx::dCtx->allocJob(p.packedDataSize);
+      if (!j)
       {
-        sleep_msec(1);
-        j = DDSxDecodeCtx::dCtx->allocJob();
+        int64_t wait_reft = profile_ref_ticks();
+        while (!j)
+        {
+          sleep_msec(1);
+          j = DDSxDecodeCtx::dCtx->allocJob(p.packedDataSize);
+        }
+        read_stall_usec += profile_time_usec(wait_reft);
       }
 
       if (j->initJob(pack.texHdr[rec_id], tex_q, pack.texNames.map[rec_id], pack.file->name, p.texId, *fastSeqCrd, p.packedDataSize,
@@ -1514,7 +1533,7 @@ bool DDSxTexturePack2::Factory::performDelayedLoad(int prio)
       else
       {
         G_ASSERT_LOG(0, "%s allocation of %dK failed, fallback to serial load", __FUNCTION__, p.packedDataSize >> 10);
-        j->done = 1; // "free" it
+        DDSxDecodeCtx::dCtx->releaseJob(j);
         goto serial;
       }
     }
@@ -1550,6 +1569,7 @@ bool DDSxTexturePack2::Factory::performDelayedLoad(int prio)
   // other thread won't be able receive left aio callbacks)
   fastSeqCrd->reset();
 
+  int read_usec = profile_time_usec(reft);
   if (may_use_dctx)
     DDSxDecodeCtx::dCtx->waitAllDone(prio);
 
@@ -1557,7 +1577,10 @@ bool DDSxTexturePack2::Factory::performDelayedLoad(int prio)
   debug("(%s).performDelayedLoad(%d): %d usec (%dK of %dK range in %d areas), %.2f Mb/s (unp. %dM)", pack.file->name, prio, t0,
     data_sz >> 10, (rangesBuf[num_ranges - 1].end - rangesBuf[0].start) >> 10, num_ranges, double(data_sz) / (t0 ? t0 : 1),
     mem_data_sz >> 20);
+  if (may_use_dctx)
+    debug("  read %d usec (stalled %d usec by decoders), decode tail %d usec", read_usec, read_stall_usec, t0 - read_usec);
   G_UNUSED(t0);
+  G_UNUSED(read_usec);
 
   if (ALWAYS_REOPEN_FILES)
     pack.file->closeHandle();
@@ -1847,8 +1870,12 @@ int ddsx::set_decoder_workers_count(int wcnt)
   {
     G_ASSERTF(!ddsx_factory_uses_dctx, "ddsx_factory_uses_dctx=%d", ddsx_factory_uses_dctx);
     del_it(DDSxDecodeCtx::dCtx);
-    DDSxDecodeCtx::dCtx = wcnt >= 2 ? new DDSxDecodeCtx(wcnt) : NULL;
-    debug("ddsx::set_decoder_workers_count(%d), reinit", wcnt);
+    const DataBlock *b = dgs_get_settings() ? dgs_get_settings()->getBlockByNameEx("texStreaming") : &DataBlock::emptyBlock;
+    int read_ahead_kb = clamp(b->getInt("decoderReadAheadKB", 32 << 10), 0, INT_MAX >> 10); // budget is int in bytes
+    bool unpack_on_threadpool = b->getBool("decoderUnpackOnThreadpool", true);
+    DDSxDecodeCtx::dCtx = wcnt >= 2 ? new DDSxDecodeCtx(wcnt, read_ahead_kb << 10, unpack_on_threadpool) : NULL;
+    debug("ddsx::set_decoder_workers_count(%d), reinit (read-ahead %dK, unpack on threadpool %d)", wcnt, read_ahead_kb,
+      unpack_on_threadpool);
   }
   return prev;
 }
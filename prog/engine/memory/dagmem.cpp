@@ -819,6 +819,8 @@ CRT_PREFIX void *mt_dlrealloc_crt(void *mem, size_t bytes)
 #undef CRT_PREFIX
 #endif
 
+#include "memSampling.inc.cpp"
+
 class StdDlmallocAllocator final : public IMemAlloc
 {
 public:
@@ -837,12 +839,14 @@ public:
       dumpUsedMem(), fatal("Not enough memory to alloc %llu bytes", sz);
     }
     memory_tracker.addBlock(this, p, sz);
+    dagor_memory_sampling::on_alloc(p, sz);
     return p;
   }
   void *tryAlloc(size_t sz) override
   {
     void *p = mt_dlmalloc(sz);
     memory_tracker.addBlock(this, p, sz);
+    dagor_memory_sampling::on_alloc(p, sz);
     return p;
   }
   void *allocAligned(size_t sz, size_t alignment) override
@@ -854,16 +858,19 @@ public:
       dumpUsedMem(), fatal("Not enough memory to alloc %llu bytes (alignment: %u)", sz, alignment);
     }
     memory_tracker.addBlock(this, p, sz);
+    dagor_memory_sampling::on_alloc(p, sz);
     return p;
   }
   void free(void *p) override
   {
     memory_tracker.removeBlock(this, p);
+    dagor_memory_sampling::on_free(p);
     mt_dlfree(p);
   }
   void freeAligned(void *p) override
   {
     memory_tracker.removeBlock(this, p);
+    dagor_memory_sampling::on_free(p);
     mt_dlfree_aligned(p);
   }
   size_t getSize(void *p) override { return p ? sys_malloc_usable_size(p) : 0; }
@@ -872,11 +879,17 @@ public:
     memory_tracker.removeBlock(this, p);
     bool res = mt_expand(p, sz);
     memory_tracker.addBlock(this, p, sz);
+    if (res) // block keeps its size (and sample) when it cannot be resized
+    {
+      dagor_memory_sampling::on_free(p);
+      dagor_memory_sampling::on_alloc(p, sz);
+    }
     return res;
   }
   void *realloc(void *p, size_t sz) override
   {
     memory_tracker.removeBlock(this, p);
+    dagor_memory_sampling::on_free(p);
 #if MEASURE_EXPAND_EFF
     size_t asz = sys_malloc_usable_size(p);
     if (asz > 2048 && sz > asz)
@@ -888,6 +901,7 @@ public:
         interlocked_decrement(asz <= (16 << 10) ? cnt_expand_ok_16K : cnt_expand_ok);
         interlocked_increment(asz <= (16 << 10) ? cnt_expand_r_ok_16K : cnt_expand_r_ok);
         memory_tracker.addBlock(this, p, sz);
+        dagor_memory_sampling::on_alloc(p, sz);
         return p;
       }
     }
@@ -899,6 +913,7 @@ public:
       dumpUsedMem(), fatal("Not enough memory in realloc(%p,%llu) call", p, sz);
     }
     memory_tracker.addBlock(this, np, sz);
+    dagor_memory_sampling::on_alloc(np, sz);
     return np;
   }
 
@@ -1092,6 +1107,7 @@ static void real_init_memory()
 void memfree_anywhere(void *p)
 {
   memory_tracker.removeBlock(nullptr, p, 0, true);
+  dagor_memory_sampling::on_free(p);
   // measureFree(p) is not called
   mt_dlfree(p);
 }
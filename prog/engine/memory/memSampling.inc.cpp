@@ -0,0 +1,129 @@
+//-- to be included from dagmem.cpp --
+// allocation sampling hooks (used by sampling heap profilers); costs single load+branch per call when sampling is off
+#include <memory/dag_memSampling.h>
+#include <math.h>
+
+namespace dagor_memory_sampling
+{
+struct Hooks
+{
+  alloc_cb_t onAlloc;
+  free_cb_t onFree;
+  size_t meanInterval;
+};
+static Hooks hooks_storage = {nullptr, nullptr, 0};
+static Hooks *volatile active_hooks = nullptr;
+static volatile int hooks_generation = 0;
+
+// counting filter of sampled addresses, so free() of not sampled block doesn't reach hook; 8-bit counters (4 per word) are
+// incremented when block is sampled and decremented when hook reports that sampled block is freed (or was not recorded),
+// so filter holds only live samples; saturated counter is never decremented
+static constexpr int FREE_FILTER_SLOTS = 1 << 16;
+static volatile uint32_t free_filter[FREE_FILTER_SLOTS / 4];
+static inline uint32_t free_filter_slot(const void *p)
+{
+  return uint32_t((uint64_t(uintptr_t(p)) >> 4) * 0x9E3779B97F4A7C15ull >> 40) & (FREE_FILTER_SLOTS - 1);
+}
+static inline bool free_filter_test(uint32_t slot)
+{
+  return (interlocked_relaxed_load(free_filter[slot / 4]) >> (slot % 4 * 8)) & 0xFF;
+}
+static void free_filter_add(uint32_t slot, int delta)
+{
+  volatile uint32_t &w = free_filter[slot / 4];
+  const uint32_t shift = slot % 4 * 8;
+  for (uint32_t old = interlocked_relaxed_load(w);;)
+  {
+    const uint32_t cnt = (old >> shift) & 0xFF;
+    if (cnt == 0xFF || (delta < 0 && !cnt))
+      return;
+    const uint32_t prev = interlocked_compare_exchange(w, old + (uint32_t(delta) << shift), old);
+    if (prev == old)
+      return;
+    old = prev;
+  }
+}
+
+struct ThreadState
+{
+  intptr_t bytesLeft;
+  uint32_t rnd;
+  int generation;
+  bool inHook;
+};
+static thread_local ThreadState tls_state = {0, 0, 0, false};
+
+static intptr_t next_interval(ThreadState &ts, size_t mean_interval)
+{
+  ts.rnd ^= ts.rnd << 13, ts.rnd ^= ts.rnd >> 17, ts.rnd ^= ts.rnd << 5; // xorshift32
+  const float u = float((ts.rnd >> 8) + 1) * (1.f / 16777216.f);   // (0, 1]
+  const intptr_t interval = intptr_t(-logf(u) * float(mean_interval));
+  return interval > 0 ? interval : 1;
+}
+
+static DAGOR_NOINLINE void sample_alloc(Hooks &h, ThreadState &ts, void *p, size_t sz)
+{
+  const int gen = interlocked_relaxed_load(hooks_generation);
+  if (DAGOR_UNLIKELY(ts.generation != gen)) // first allocation on this thread since hooks were set, start countdown
+  {
+    ts.generation = gen;
+    ts.rnd = (uint32_t(uintptr_t(&ts) >> 4) ^ uint32_t(gen * 0x9E3779B9u)) | 1u;
+    ts.bytesLeft = next_interval(ts, h.meanInterval);
+    return;
+  }
+  ts.bytesLeft = next_interval(ts, h.meanInterval);
+  const uint32_t slot = free_filter_slot(p);
+  free_filter_add(slot, 1);
+  ts.inHook = true;
+  if (!h.onAlloc(p, sz))
+    free_filter_add(slot, -1);
+  ts.inHook = false;
+}
+
+static __forceinline void on_alloc(void *p, size_t sz)
+{
+  Hooks *h = interlocked_relaxed_load_ptr(active_hooks);
+  if (DAGOR_LIKELY(!h) || !p)
+    return;
+  ThreadState &ts = tls_state;
+  if ((ts.bytesLeft -= intptr_t(sz)) >= 0 || ts.inHook)
+    return;
+  sample_alloc(*h, ts, p, sz);
+}
+
+static __forceinline void on_free(void *p)
+{
+  Hooks *h = interlocked_relaxed_load_ptr(active_hooks);
+  if (DAGOR_LIKELY(!h) || !p)
+    return;
+  const uint32_t slot = free_filter_slot(p);
+  if (!free_filter_test(slot))
+    return;
+  ThreadState &ts = tls_state;
+  if (ts.inHook)
+    return;
+  ts.inHook = true;
+  if (h->onFree(p))
+    free_filter_add(slot, -1);
+  ts.inHook = false;
+}
+
+void set_hooks(alloc_cb_t on_alloc_cb, free_cb_t on_free_cb, size_t mean_interval)
+{
+  interlocked_release_store_ptr(active_hooks, (Hooks *)nullptr);
+  if (!on_alloc_cb || !on_free_cb || !mean_interval)
+  {
+    hooks_storage.meanInterval = 0;
+    return;
+  }
+  hooks_storage.onAlloc = on_alloc_cb;
+  hooks_storage.onFree = on_free_cb;
+  hooks_storage.meanInterval = mean_interval;
+  for (volatile uint32_t &w : free_filter)
+    interlocked_relaxed_store(w, 0u);
+  interlocked_increment(hooks_generation);
+  interlocked_release_store_ptr(active_hooks, &hooks_storage);
+}
+
+size_t get_mean_interval() { return hooks_storage.meanInterval; }
+} // namespace dagor_memory_sampling
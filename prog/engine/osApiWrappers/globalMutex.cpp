@@ -5,6 +5,10 @@
 #elif _TARGET_APPLE | _TARGET_PC_LINUX
 #include <semaphore.h>
 #include <fcntl.h>
+#include <errno.h>
+#include <time.h>
+#include <osApiWrappers/dag_miscApi.h>
+#include <perfMon/dag_cpuFreq.h>
 #endif
 #include <util/dag_globDef.h>
 #include <stdio.h>
@@ -46,6 +50,45 @@ int global_mutex_enter(void *mutex)
   return ret;
 }
 
+int global_mutex_enter_timeout(void *mutex, int timeout_ms)
+{
+  ScopeLockProfiler<da_profiler::DescGlobalMutex> lp;
+  G_UNUSED(lp);
+#if _TARGET_PC_WIN
+  int ret = WaitForSingleObject(mutex, timeout_ms) == WAIT_OBJECT_0 ? 0 : -1;
+#elif _TARGET_PC_LINUX
+  sem_t *sem = (sem_t *)mutex;
+  if (!sem)
+    return -1;
+  timespec ts;
+  clock_gettime(CLOCK_REALTIME, &ts);
+  ts.tv_sec += timeout_ms / 1000;
+  ts.tv_nsec += (timeout_ms % 1000) * 1000000L;
+  if (ts.tv_nsec >= 1000000000L)
+  {
+    ts.tv_sec++;
+    ts.tv_nsec -= 1000000000L;
+  }
+  int ret;
+  while ((ret = sem_timedwait(sem, &ts)) != 0 && errno == EINTR)
+    ;
+#elif _TARGET_APPLE
+  // no sem_timedwait() on Apple platforms, so poll
+  sem_t *sem = (sem_t *)mutex;
+  if (!sem)
+    return -1;
+  const int64_t start = ref_time_ticks();
+  int ret;
+  while ((ret = sem_trywait(sem)) != 0 && (errno == EAGAIN || errno == EINTR) && get_time_usec(start) < timeout_ms * 1000ll)
+    sleep_msec(10);
+#else
+  (void)(mutex);
+  (void)(timeout_ms);
+  int ret = -1;
+#endif
+  return ret;
+}
+
 int global_mutex_leave(void *mutex)
 {
 #if _TARGET_PC_WIN
@@ -0,0 +1,349 @@
+#include "linuxIoUringRead.h"
+
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#endif
+
+#ifdef IORING_RSRC_REGISTER_SPARSE // 5.19+ kernel headers, everything used below is available
+
+#include <osApiWrappers/dag_atomic.h>
+#include <debug/dag_debug.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+namespace io_uring_read
+{
+// one SQ entry per slot: queued + in-flight reads never exceed number of slots, so neither SQ nor CQ (2x) can overflow
+static constexpr unsigned RING_ENTRIES = MAX_SLOTS;
+static constexpr unsigned MAX_FIXED_BUFFERS = 64;
+
+struct FixedBuffer
+{
+  char *base;
+  int len;
+};
+
+struct Ring
+{
+  int fd = -1;
+  unsigned *sqHead = nullptr, *sqTail = nullptr, *sqArray = nullptr, sqMask = 0;
+  io_uring_sqe *sqes = nullptr;
+  unsigned *cqHead = nullptr, *cqTail = nullptr, cqMask = 0;
+  io_uring_cqe *cqes = nullptr;
+  unsigned unsubmitted = 0;
+
+  int results[MAX_SLOTS];
+  uint64_t doneMask = 0;
+
+  bool fixedBuffersSupported = false;
+  FixedBuffer fixed[MAX_FIXED_BUFFERS] = {};
+  int fixedUsed = 0; // upper bound of used entries in fixed[]
+};
+
+static Ring ring;
+static pthread_mutex_t ring_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t ring_once = PTHREAD_ONCE_INIT;
+static bool ring_available = false;
+static volatile int ring_enabled = 0;
+static bool register_failed = false; // out of resources for fixed buffers, not retried until backend is enabled again
+static thread_local int batch_depth = 0;
+
+static int sys_io_uring_setup(unsigned entries, io_uring_params *p) { return (int)syscall(__NR_io_uring_setup, entries, p); }
+static int sys_io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags)
+{
+  return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0);
+}
+static int sys_io_uring_register(int fd, unsigned opcode, const void *arg, unsigned nr_args)
+{
+  return (int)syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+}
+
+static bool is_read_op_supported(int fd)
+{
+  static constexpr int PROBE_OPS = 256;
+  size_t sz = sizeof(io_uring_probe) + PROBE_OPS * sizeof(io_uring_probe_op);
+  io_uring_probe *probe = (io_uring_probe *)calloc(1, sz);
+  bool supported = false;
+  if (sys_io_uring_register(fd, IORING_REGISTER_PROBE, probe, PROBE_OPS) == 0)
+    supported = probe->last_op >= IORING_OP_READ && (probe->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED) &&
+                (probe->ops[IORING_OP_READ_FIXED].flags & IO_URING_OP_SUPPORTED);
+  free(probe);
+  return supported;
+}
+
+static bool setup_ring()
+{
+  io_uring_params p;
+  memset(&p, 0, sizeof(p));
+  int fd = sys_io_uring_setup(RING_ENTRIES, &p);
+  if (fd < 0)
+  {
+    debug("io_uring: not available (errno=%d), using POSIX AIO", errno);
+    return false;
+  }
+  if (!(p.features & IORING_FEAT_SINGLE_MMAP) || !is_read_op_supported(fd))
+  {
+    debug("io_uring: kernel is too old (features=0x%x), using POSIX AIO", p.features);
+    close(fd);
+    return false;
+  }
+
+  size_t sqSz = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+  size_t cqSz = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+  size_t ringSz = sqSz > cqSz ? sqSz : cqSz;
+  char *rings = (char *)mmap(nullptr, ringSz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+  void *sqes = mmap(nullptr, p.sq_entries * sizeof(io_uring_sqe), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+    IORING_OFF_SQES);
+  if (rings == MAP_FAILED || sqes == MAP_FAILED)
+  {
+    logwarn("io_uring: failed to map rings (errno=%d), using POSIX AIO", errno);
+    if (rings != MAP_FAILED)
+      munmap(rings, ringSz);
+    if (sqes != MAP_FAILED)
+      munmap(sqes, p.sq_entries * sizeof(io_uring_sqe));
+    close(fd);
+    return false;
+  }
+
+  ring.fd = fd;
+  ring.sqHead = (unsigned *)(rings + p.sq_off.head);
+  ring.sqTail = (unsigned *)(rings + p.sq_off.tail);
+  ring.sqMask = *(unsigned *)(rings + p.sq_off.ring_mask);
+  ring.sqArray = (unsigned *)(rings + p.sq_off.array);
+  ring.sqes = (io_uring_sqe *)sqes;
+  ring.cqHead = (unsigned *)(rings + p.cq_off.head);
+  ring.cqTail = (unsigned *)(rings + p.cq_off.tail);
+  ring.cqMask = *(unsigned *)(rings + p.cq_off.ring_mask);
+  ring.cqes = (io_uring_cqe *)(rings + p.cq_off.cqes);
+
+  // sparse table, buffers are put into it later with IORING_REGISTER_BUFFERS_UPDATE
+  io_uring_rsrc_register rr;
+  memset(&rr, 0, sizeof(rr));
+  rr.nr = MAX_FIXED_BUFFERS;
+  rr.flags = IORING_RSRC_REGISTER_SPARSE;
+  ring.fixedBuffersSupported = sys_io_uring_register(fd, IORING_REGISTER_BUFFERS2, &rr, sizeof(rr)) == 0;
+
+  debug("io_uring: using io_uring for async reads (sq=%d cq=%d, fixed buffers %s)", p.sq_entries, p.cq_entries,
+    ring.fixedBuffersSupported ? "on" : "off");
+  return true;
+}
+
+static void init_once()
+{
+  const char *disable = getenv("DAGOR_DISABLE_IO_URING");
+  if (disable && *disable && strcmp(disable, "0") != 0)
+  {
+    debug("io_uring: disabled with DAGOR_DISABLE_IO_URING, using POSIX AIO");
+    return;
+  }
+  ring_available = setup_ring();
+  interlocked_release_store(ring_enabled, ring_available ? 1 : 0);
+}
+
+bool is_enabled()
+{
+  pthread_once(&ring_once, init_once);
+  return interlocked_acquire_load(ring_enabled) != 0;
+}
+
+bool set_enabled(bool enable)
+{
+  pthread_once(&ring_once, init_once);
+  if (enable && ring_available && !interlocked_acquire_load(ring_enabled))
+  {
+    pthread_mutex_lock(&ring_mutex);
+    register_failed = false;
+    pthread_mutex_unlock(&ring_mutex);
+  }
+  interlocked_release_store(ring_enabled, (enable && ring_available) ? 1 : 0);
+  return is_enabled();
+}
+
+static void submit_locked()
+{
+  while (ring.unsubmitted)
+  {
+    int ret = sys_io_uring_enter(ring.fd, ring.unsubmitted, 0, 0);
+    if (ret > 0)
+      ring.unsubmitted -= ret;
+    else if (ret < 0 && errno == EINTR)
+      continue;
+    else // EAGAIN/EBUSY: kernel is short on resources, entries stay queued and are resubmitted on next check
+      break;
+  }
+}
+
+static void reap_locked()
+{
+  unsigned head = *ring.cqHead;
+  unsigned tail = __atomic_load_n(ring.cqTail, __ATOMIC_ACQUIRE);
+  for (; head != tail; head++)
+  {
+    const io_uring_cqe &cqe = ring.cqes[head & ring.cqMask];
+    G_ASSERT(cqe.user_data < MAX_SLOTS);
+    ring.results[cqe.user_data] = cqe.res;
+    ring.doneMask |= uint64_t(1) << cqe.user_data;
+  }
+  __atomic_store_n(ring.cqHead, head, __ATOMIC_RELEASE);
+}
+
+static int find_fixed_buffer_locked(const void *buf, int len)
+{
+  for (int i = 0; i < ring.fixedUsed; i++)
+    if (ring.fixed[i].base <= (const char *)buf && (const char *)buf + len <= ring.fixed[i].base + ring.fixed[i].len)
+      return i;
+  return -1;
+}
+
+bool queue_read(int slot, int fd, int64_t offset, void *buf, int len)
+{
+  G_ASSERT(slot >= 0 && slot < MAX_SLOTS);
+  pthread_mutex_lock(&ring_mutex);
+  ring.doneMask &= ~(uint64_t(1) << slot);
+
+  unsigned tail = *ring.sqTail;
+  unsigned idx = tail & ring.sqMask;
+  G_ASSERTF(tail - __atomic_load_n(ring.sqHead, __ATOMIC_ACQUIRE) < RING_ENTRIES, "io_uring: SQ overflow");
+  io_uring_sqe &sqe = ring.sqes[idx];
+  memset(&sqe, 0, sizeof(sqe));
+  int fixedIdx = find_fixed_buffer_locked(buf, len);
+  sqe.opcode = fixedIdx >= 0 ? IORING_OP_READ_FIXED : IORING_OP_READ;
+  sqe.buf_index = fixedIdx >= 0 ? fixedIdx : 0;
+  sqe.fd = fd;
+  sqe.off = offset;
+  sqe.addr = (uintptr_t)buf;
+  sqe.len = len;
+  sqe.user_data = slot;
+  ring.sqArray[idx] = idx;
+  __atomic_store_n(ring.sqTail, tail + 1, __ATOMIC_RELEASE);
+  ring.unsubmitted++;
+
+  if (!batch_depth)
+    submit_locked();
+  pthread_mutex_unlock(&ring_mutex);
+  return true;
+}
+
+bool check_complete(int slot, int &out_res)
+{
+  uint64_t bit = uint64_t(1) << slot;
+  pthread_mutex_lock(&ring_mutex);
+  submit_locked();
+  if (!(ring.doneMask & bit))
+    reap_locked();
+  bool done = (ring.doneMask & bit) != 0;
+  if (done) // result stays reported until slot is reused by queue_read() or released
+    out_res = ring.results[slot];
+  pthread_mutex_unlock(&ring_mutex);
+  return done;
+}
+
+void release_slot(int slot)
+{
+  if (!ring_available)
+    return;
+  pthread_mutex_lock(&ring_mutex);
+  ring.doneMask &= ~(uint64_t(1) << slot);
+  pthread_mutex_unlock(&ring_mutex);
+}
+
+void begin_batch() { batch_depth++; }
+
+void end_batch()
+{
+  G_ASSERT(batch_depth > 0);
+  if (--batch_depth || !ring_available) // entries queued before backend was disabled must still be submitted
+    return;
+  pthread_mutex_lock(&ring_mutex);
+  submit_locked();
+  pthread_mutex_unlock(&ring_mutex);
+}
+
+bool register_buffer(void *buf, int len)
+{
+  if (!is_enabled() || !ring.fixedBuffersSupported)
+    return false;
+  pthread_mutex_lock(&ring_mutex);
+  if (register_failed)
+  {
+    pthread_mutex_unlock(&ring_mutex);
+    return false;
+  }
+  int i = 0;
+  for (; i < MAX_FIXED_BUFFERS; i++)
+    if (!ring.fixed[i].base)
+      break;
+  bool ok = false;
+  if (i < MAX_FIXED_BUFFERS)
+  {
+    iovec iov = {buf, (size_t)len};
+    io_uring_rsrc_update2 up;
+    memset(&up, 0, sizeof(up));
+    up.offset = i;
+    up.data = (uintptr_t)&iov;
+    up.nr = 1;
+    ok = sys_io_uring_register(ring.fd, IORING_REGISTER_BUFFERS_UPDATE, &up, sizeof(up)) == 1;
+    if (ok)
+    {
+      ring.fixed[i].base = (char *)buf;
+      ring.fixed[i].len = len;
+      if (i >= ring.fixedUsed)
+        ring.fixedUsed = i + 1;
+    }
+    else // e.g. RLIMIT_MEMLOCK exceeded, plain reads are used for this buffer
+    {
+      debug("io_uring: failed to register %d bytes buffer (errno=%d)", len, errno);
+      register_failed = true;
+    }
+  }
+  pthread_mutex_unlock(&ring_mutex);
+  return ok;
+}
+
+void unregister_buffer(void *buf)
+{
+  if (!ring_available || !ring.fixedBuffersSupported)
+    return;
+  pthread_mutex_lock(&ring_mutex);
+  for (int i = 0; i < ring.fixedUsed; i++)
+    if (ring.fixed[i].base == buf)
+    {
+      iovec iov = {nullptr, 0};
+      io_uring_rsrc_update2 up;
+      memset(&up, 0, sizeof(up));
+      up.offset = i;
+      up.data = (uintptr_t)&iov;
+      up.nr = 1;
+      sys_io_uring_register(ring.fd, IORING_REGISTER_BUFFERS_UPDATE, &up, sizeof(up));
+      ring.fixed[i].base = nullptr;
+      ring.fixed[i].len = 0;
+      while (ring.fixedUsed > 0 && !ring.fixed[ring.fixedUsed - 1].base)
+        ring.fixedUsed--;
+      break;
+    }
+  pthread_mutex_unlock(&ring_mutex);
+}
+} // namespace io_uring_read
+
+#else // no io_uring in kernel headers, always fall back to POSIX AIO
+
+namespace io_uring_read
+{
+bool is_enabled() { return false; }
+bool set_enabled(bool) { return false; }
+bool queue_read(int, int, int64_t, void *, int) { return false; }
+bool check_complete(int, int &) { return false; }
+void release_slot(int) {}
+void begin_batch() {}
+void end_batch() {}
+bool register_buffer(void *, int) { return false; }
+void unregister_buffer(void *) {}
+} // namespace io_uring_read
+
+#endif
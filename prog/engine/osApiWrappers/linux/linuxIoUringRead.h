@@ -0,0 +1,33 @@
+#pragma once
+
+#include <stdint.h>
+
+// io_uring backend for dfa_read_async() on Linux.
+// Ring is created lazily on first use; when kernel (or seccomp policy) does not support it, caller falls back to POSIX AIO.
+// Slots are async data handles (0..63) returned by dfa_alloc_asyncdata().
+namespace io_uring_read
+{
+static constexpr int MAX_SLOTS = 64;
+
+// returns true when io_uring backend is available and enabled
+bool is_enabled();
+// enables/disables backend at runtime (if available); must not be called while reads are pending
+bool set_enabled(bool enable);
+
+// queues read; submission is deferred while batch is open on calling thread, done immediately otherwise
+bool queue_read(int slot, int fd, int64_t offset, void *buf, int len);
+// reaps completions; returns true when slot read is complete, out_res is number of bytes read or -errno
+// (completion is reported by every call until slot is reused by queue_read() or released)
+bool check_complete(int slot, int &out_res);
+// forgets completion of slot when async data handle is freed
+void release_slot(int slot);
+
+void begin_batch();
+void end_batch();
+
+// registers buffer used for many reads, so reads into it use IORING_OP_READ_FIXED (no page pinning per request);
+// table of registered buffers is small, so only long-lived buffers should be registered;
+// after registration fails it is not retried until backend is disabled and enabled again
+bool register_buffer(void *buf, int len);
+void unregister_buffer(void *buf);
+} // namespace io_uring_read
@@ -10,6 +10,7 @@
 #include <sys/stat.h>
 #include <string.h>
 #include <debug/dag_debug.h>
+#include "../linux/linuxIoUringRead.h"
 
 #define DAGOR_ASYNC_IO 1
 
@@ -19,10 +20,12 @@
 #include <math/random/dag_random.h>
 #endif
 
+// aiocb fields also describe request when it is served by io_uring (to resubmit it on error)
 struct AsyncReadContext : public aiocb
 {
   int code;
   int bytesRead;
+  bool viaIoUring;
 } __attribute__((aligned(16)));
 
 #else
@@ -134,6 +137,10 @@ void dfa_free_asyncdata(int data_handle)
   pthread_mutex_unlock(&ov_mutex);
   if (!unused)
     debug_ctx("already freed handle: %d", data_handle);
+#if DAGOR_ASYNC_IO
+  else
+    io_uring_read::release_slot(data_handle);
+#endif
 }
 
 bool dfa_read_async(void *handle, int asyncdata_handle, int offset, void *buf, int len)
@@ -154,6 +161,10 @@ bool dfa_read_async(void *handle, int asyncdata_handle, int offset, void *buf, i
   p.bytesRead = 0;
 
 #if DAGOR_ASYNC_IO
+  p.viaIoUring = io_uring_read::is_enabled();
+  if (p.viaIoUring)
+    return io_uring_read::queue_read(asyncdata_handle, p.aio_fildes, offset, buf, len);
+
   while (aio_read(&p) != 0)
   {
     if (errno == EAGAIN)
@@ -173,6 +184,43 @@ bool dfa_read_async(void *handle, int asyncdata_handle, int offset, void *buf, i
   return true;
 }
 
+#if DAGOR_ASYNC_IO
+static bool check_complete_io_uring(int asyncdata_handle, AsyncReadContext &p, int *read_len)
+{
+  int res = 0;
+  if (!io_uring_read::check_complete(asyncdata_handle, res))
+  {
+    *read_len = 0;
+    return false;
+  }
+  if (res >= 0)
+  {
+    p.code = 0;
+    p.bytesRead = res;
+    *read_len = res;
+    return true;
+  }
+
+  p.code = -res;
+  if (p.code == ECANCELED)
+  {
+    *read_len = 0;
+    return true;
+  }
+  errno = p.code;
+  if (dag_on_read_error_cb && dag_on_read_error_cb(FD2HANDLE(p.aio_fildes), (int)p.aio_offset, (int)p.aio_nbytes))
+  {
+    *read_len = 0;
+    p.code = -1;
+    if (io_uring_read::queue_read(asyncdata_handle, p.aio_fildes, p.aio_offset, (void *)p.aio_buf, (int)p.aio_nbytes))
+      return false;
+    p.code = EIO;
+  }
+  *read_len = -p.code;
+  return true;
+}
+#endif
+
 bool dfa_check_complete(int asyncdata_handle, int *read_len)
 {
   G_ASSERT(asyncdata_handle >= 0 && asyncdata_handle < 64);
@@ -183,6 +231,9 @@ bool dfa_check_complete(int asyncdata_handle, int *read_len)
     return true;
   }
 #if DAGOR_ASYNC_IO
+  if (p.viaIoUring)
+    return check_complete_io_uring(asyncdata_handle, p, read_len);
+
   if (aio_error(&p) == EINPROGRESS)
   {
     *read_len = 0;
@@ -228,5 +279,13 @@ bool dfa_check_complete(int asyncdata_handle, int *read_len)
 #endif
 }
 
+void dfa_begin_read_batch() { io_uring_read::begin_batch(); }
+void dfa_end_read_batch() { io_uring_read::end_batch(); }
+
+bool dfa_register_read_buffer(void *buf, int len) { return io_uring_read::register_buffer(buf, len); }
+void dfa_unregister_read_buffer(void *buf) { io_uring_read::unregister_buffer(buf); }
+
+bool dfa_use_io_uring(bool enable) { return io_uring_read::set_enabled(enable); }
+
 #define EXPORT_PULL dll_pull_osapiwrappers_asyncRead
 #include <supp/exportPull.h>
@@ -45,6 +45,7 @@ bool gpu_cpu_ticks_ref(int64_t &cpu, int64_t &gpu);
 bool stackhlp_enum_modules(const function<bool(const char *, size_t base, size_t size)> &cb);
 bool stackhlp_get_symbol(void *addr, uint32_t &line, char *filename, size_t max_file_name, char *symbolname, size_t max_symbol_name);
 bool can_resolve_symbols();
+uint32_t fill_current_thread_stack(uint64_t *addresses, uint32_t max_size, int skip_frames); // innermost frame first
 
 template <typename F>
 __forceinline void spin_wait_no_profile(F keep_waiting_cb)
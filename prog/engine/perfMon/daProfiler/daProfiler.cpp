@@ -230,6 +230,7 @@ void ProfilerData::shutdown(bool pre_destructor)
   u64_interlocked_release_store(firstNeededTick, 0); // avoid freeing memory
   syncStopSampling();                                // first let's stop current unwinding
   stopStackSampling();
+  set_heap_sampling(0);
   uint64_t memAllocated = 0, memGpuAllocated = 0;
   interlocked_release_store(active_mode, 0);
   settings.setMode(0);
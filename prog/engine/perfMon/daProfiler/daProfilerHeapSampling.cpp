@@ -0,0 +1,174 @@
+#include "daProfilerInternal.h"
+#include "daProfilePlatform.h"
+#include <memory/dag_memSampling.h>
+#include <osApiWrappers/dag_ttas_spinlock.h>
+#include <util/dag_hash.h>
+
+// sampling heap profiler
+// memory manager calls us for one allocation per ~samplingInterval allocated bytes (Poisson sampling), we capture callstack of that
+// allocation and keep it until block is freed. Each sample represents size/(1-exp(-size/samplingInterval)) bytes (size divided by
+// probability of block to be sampled), so estimations of live heap and allocation rate by callsite are unbiased regardless of sizes
+
+namespace da_profiler
+{
+
+struct HeapSampler
+{
+  static constexpr uint32_t MAX_HEAP_STACK_SIZE = 48, SKIP_FRAMES = 3; // hook, memory sampler, allocator
+  struct Callsite
+  {
+    uint32_t stackOfs = 0, stackSize = 0;
+    uint64_t liveBytes = 0, liveCount = 0, allocBytes = 0, allocCount = 0;
+  };
+  struct LiveSample
+  {
+    uint32_t callsite = 0;
+    uint32_t size = 0;
+    uint64_t bytes = 0; // estimated bytes represented by sample
+  };
+  typedef HashedKeyMap<uint64_t, uint32_t, 0ULL, oa_hashmap_util::MumStepHash<uint64_t>> CallsitesMap;
+  typedef HashedKeyMap<uint64_t, LiveSample, 0ULL, oa_hashmap_util::MumStepHash<uint64_t>> LiveSamplesMap;
+
+  volatile int spinlock = 0;
+  uint32_t samplingInterval = 0;
+  uint64_t windowStart = 0;
+  CallsitesMap callsitesMap; // stack hash -> callsite index
+  vector<Callsite> callsites;
+  vector<uint64_t> stacks;
+  LiveSamplesMap live; // sampled address -> sample
+
+  uint32_t addCallsite(const uint64_t *stack, uint32_t cnt)
+  {
+    uint64_t hash = mem_hash_fnv1<64>((const char *)stack, cnt * sizeof(uint64_t));
+    hash = hash ? hash : 1;
+    auto it = callsitesMap.emplace_if_missing(hash);
+    if (it.second)
+    {
+      *it.first = callsites.size();
+      callsites.push_back(Callsite{uint32_t(stacks.size()), cnt});
+      stacks.insert(stacks.end(), stack, stack + cnt);
+    }
+    return *it.first;
+  }
+  bool onAlloc(void *p, size_t sz)
+  {
+    uint64_t stack[MAX_HEAP_STACK_SIZE];
+    const uint32_t cnt = fill_current_thread_stack(stack, MAX_HEAP_STACK_SIZE, SKIP_FRAMES);
+    const double interval = interlocked_relaxed_load(samplingInterval);
+    if (!interval)
+      return false;
+    const uint64_t bytes = dagor_memory_sampling::estimate_sampled_bytes(sz, interval);
+    const uint64_t count = (bytes + sz / 2) / (sz ? sz : 1);
+
+    ttas_spinlock_lock(spinlock);
+    const uint32_t callsite = addCallsite(stack, cnt);
+    Callsite &c = callsites[callsite];
+    c.allocBytes += bytes, c.allocCount += count;
+    c.liveBytes += bytes, c.liveCount += count;
+    LiveSample *prev = live.findVal(uint64_t(uintptr_t(p)));
+    if (prev) // missed free (i.e. block freed by heap which isn't hooked), forget old sample
+    {
+      Callsite &pc = callsites[prev->callsite];
+      pc.liveBytes -= prev->bytes, pc.liveCount -= (prev->bytes + prev->size / 2) / (prev->size ? prev->size : 1);
+      *prev = LiveSample{callsite, uint32_t(sz), bytes};
+    }
+    else
+      live.emplace(uint64_t(uintptr_t(p)), LiveSample{callsite, uint32_t(sz), bytes});
+    ttas_spinlock_unlock(spinlock);
+    return !prev;
+  }
+  bool onFree(void *p)
+  {
+    ttas_spinlock_lock(spinlock);
+    LiveSample *s = live.findVal(uint64_t(uintptr_t(p)));
+    if (s)
+    {
+      Callsite &c = callsites[s->callsite];
+      c.liveBytes -= s->bytes, c.liveCount -= (s->bytes + s->size / 2) / (s->size ? s->size : 1);
+      live.erase(uint64_t(uintptr_t(p)));
+    }
+    ttas_spinlock_unlock(spinlock);
+    return s != nullptr;
+  }
+};
+static HeapSampler heap_sampler;
+
+// allocations made under lock outside of hooks (dump copy, reset) must not reenter hooks
+static thread_local bool heap_sampler_locked = false;
+struct HeapSamplerScopedLock
+{
+  HeapSamplerScopedLock()
+  {
+    heap_sampler_locked = true;
+    ttas_spinlock_lock(heap_sampler.spinlock);
+  }
+  ~HeapSamplerScopedLock()
+  {
+    ttas_spinlock_unlock(heap_sampler.spinlock);
+    heap_sampler_locked = false;
+  }
+};
+
+static bool heap_sampler_on_alloc(void *p, size_t sz) { return !heap_sampler_locked && heap_sampler.onAlloc(p, sz); }
+static bool heap_sampler_on_free(void *p) { return !heap_sampler_locked && heap_sampler.onFree(p); }
+
+void set_heap_sampling(uint32_t sampling_interval_bytes)
+{
+  if (interlocked_acquire_load(heap_sampler.samplingInterval) == sampling_interval_bytes)
+    return;
+  dagor_memory_sampling::set_hooks(nullptr, nullptr, 0);
+  {
+    // old samples are freed after unlock
+    HeapSampler::CallsitesMap callsitesMap;
+    vector<HeapSampler::Callsite> callsites;
+    vector<uint64_t> stacks;
+    HeapSampler::LiveSamplesMap live;
+    HeapSamplerScopedLock lock;
+    callsitesMap.swap(heap_sampler.callsitesMap);
+    move_swap(callsites, heap_sampler.callsites);
+    move_swap(stacks, heap_sampler.stacks);
+    live.swap(heap_sampler.live);
+    interlocked_release_store(heap_sampler.samplingInterval, sampling_interval_bytes);
+    heap_sampler.windowStart = cpu_current_ticks();
+  }
+  if (sampling_interval_bytes)
+    dagor_memory_sampling::set_hooks(&heap_sampler_on_alloc, &heap_sampler_on_free, sampling_interval_bytes);
+  report_debug("heap sampling interval set to %d bytes", sampling_interval_bytes);
+}
+
+uint32_t get_heap_sampling() { return interlocked_acquire_load(heap_sampler.samplingInterval); }
+
+// copies live heap and allocations since previous copy (window) by callsite
+void copy_heap_samples(HeapSamplesDump &dump)
+{
+  if (!interlocked_acquire_load(heap_sampler.samplingInterval))
+    return;
+  uint32_t callsitesCount, stacksCount;
+  {
+    HeapSamplerScopedLock lock;
+    callsitesCount = heap_sampler.callsites.size();
+    stacksCount = heap_sampler.stacks.size();
+  }
+  // reserve outside of lock, callsites/stacks are only appended
+  dump.callsites.reserve(callsitesCount + callsitesCount / 4 + 16);
+  dump.stacks.reserve(stacksCount + stacksCount / 4 + 256);
+  HeapSamplerScopedLock lock;
+  const uint64_t now = cpu_current_ticks();
+  dump.samplingInterval = heap_sampler.samplingInterval;
+  dump.windowStart = heap_sampler.windowStart;
+  dump.windowEnd = heap_sampler.windowStart = now;
+  for (HeapSampler::Callsite &c : heap_sampler.callsites)
+  {
+    if ((c.liveBytes || c.allocBytes) && dump.callsites.size() < dump.callsites.capacity() &&
+        dump.stacks.size() + c.stackSize <= dump.stacks.capacity())
+    {
+      const uint64_t *stack = heap_sampler.stacks.data() + c.stackOfs;
+      dump.callsites.push_back(HeapSamplesDump::Callsite{c.liveBytes, c.liveCount, c.allocBytes, c.allocCount,
+        uint32_t(dump.stacks.size()), c.stackSize});
+      dump.stacks.insert(dump.stacks.end(), stack, stack + c.stackSize);
+    }
+    c.allocBytes = c.allocCount = 0;
+  }
+}
+
+} // namespace da_profiler
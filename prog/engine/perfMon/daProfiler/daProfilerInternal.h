@@ -222,6 +222,8 @@ struct ProfilerData
 
 extern ProfilerData the_profiler;
 
+void copy_heap_samples(HeapSamplesDump &dump); // thread safe
+
 #include <osApiWrappers/dag_atomic.h>
 #if _TARGET_64BIT
 // on 64 bit platform firstTick is atomic.
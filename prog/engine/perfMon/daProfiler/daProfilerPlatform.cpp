@@ -3,6 +3,7 @@
 #include <osApiWrappers/dag_miscApi.h>
 #include <osApiWrappers/dag_threads.h>
 #include <osApiWrappers/dag_cpuJobs.h>
+#include <osApiWrappers/dag_stackHlp.h>
 #include <osApiWrappers/dag_stackHlpEx.h>
 #include <startup/dag_globalSettings.h>
 #include <time.h>
@@ -77,6 +78,14 @@ bool stackhlp_get_symbol(void *addr, uint32_t &line, char *filename, size_t max_
   return ::stackhlp_get_symbol(addr, line, filename, max_file_name, symbolname, max_symbol_name);
 }
 bool stackhlp_enum_modules(const function<bool(const char *, size_t base, size_t size)> &cb) { return ::stackhlp_enum_modules(cb); }
+uint32_t fill_current_thread_stack(uint64_t *addresses, uint32_t max_size, int skip_frames)
+{
+  void *stack[128];
+  const uint32_t cnt = ::stackhlp_fill_stack(stack, max_size < 128 ? max_size : 128, skip_frames + 1);
+  for (uint32_t i = 0; i < cnt; ++i)
+    addresses[i] = uintptr_t(stack[i]);
+  return cnt;
+}
 #if (_TARGET_PC_WIN | _TARGET_ANDROID | _TARGET_XBOX | _TARGET_APPLE)
 bool support_sample_other_threads() { return true; }
 #else
@@ -166,6 +166,8 @@ size_t ProfilerData::prepareDump(unique_ptr<Dump> &&dump_)
   if (dump.type != Dump::Type::Spike)
     dump.stacks.reserve(stackSamples.approximateSize());
   copyCallStacks(timeStart, timeEnd, dump.stacks);
+  if (dump.type != Dump::Type::Spike)
+    copy_heap_samples(dump.heap);
   dump.uniqueProfileRunName = uniqueProfileRunName;
   dump.frameThreadId = frameThreadId;
 
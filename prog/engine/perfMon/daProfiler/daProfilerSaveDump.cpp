@@ -621,12 +621,38 @@ void save_dump(IGenSave &cb, const Dump &dump, const ProfilerDescriptions &descr
     }
     callstacksStream.writeInt64(~0ULL); // end marker
     send_data(cb, DataResponse::CallstackPack, callstacksStream);
-
+  }
+  if (!dump.heap.callsites.empty())
+  {
+    // sampled heap, stacks are reversed same way as in CallstackPack
+    DynamicMemGeneralSaveCB &heapStream = newStream(stream);
+    heapStream.writeInt(dump.board);
+    heapStream.writeInt(dump.heap.samplingInterval);
+    heapStream.writeInt64(cpu_frequency());
+    write_duration(heapStream, dump.heap.windowStart, dump.heap.windowEnd);
+    for (const HeapSamplesDump::Callsite &c : dump.heap.callsites)
+    {
+      heapStream.writeInt64(c.liveBytes);
+      heapStream.writeInt64(c.liveCount);
+      heapStream.writeInt64(c.allocBytes);
+      heapStream.writeInt64(c.allocCount);
+      write_vlq_uint(heapStream, c.stackSize);
+      for (uint32_t stackI = c.stackSize; stackI > 0; --stackI)
+        heapStream.writeInt64(dump.heap.stacks[c.stackOfs + stackI - 1]);
+    }
+    heapStream.writeInt64(~0ULL); // end marker
+    send_data(cb, DataResponse::HeapSamplesPack, heapStream);
+  }
+  if (!dump.stacks.empty() || !dump.heap.callsites.empty())
+  {
     // write symbols
     SymbolsSet symbolsSet;
     // modules and symbols
     if (can_resolve_symbols())
     {
+      for (uint64_t addr : dump.heap.stacks)
+        if (addr)
+          symbolsSet.insert(addr);
       for (const uint16_t *i = dump.stacks.begin(), *end = dump.stacks.end(); i != end;)
       {
         // whole loop is not needed if we use symbol deferred resolver from profiler via network or / minidump
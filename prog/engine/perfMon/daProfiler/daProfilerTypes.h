@@ -91,6 +91,20 @@ using DescriptionStorage = ChunkedStorage<EventDescription, 1, VirtualPageAlloca
 
 using CallStackDumpStorage = vector<uint16_t>; // todo: another allocator for dump storage as well!
 // using CallStackDumpStorage = CallStackStorage;
+struct HeapSamplesDump // sampling heap profiler: live heap and allocations by callsite
+{
+  struct Callsite
+  {
+    uint64_t liveBytes, liveCount, allocBytes, allocCount;
+    uint32_t stackOfs, stackSize;
+  };
+  vector<Callsite> callsites;
+  vector<uint64_t> stacks;                 // innermost frame first
+  uint64_t windowStart = 0, windowEnd = 0; // allocations are counted within that window
+  uint32_t samplingInterval = 0;
+  size_t memAllocated() const { return callsites.capacity() * sizeof(Callsite) + stacks.capacity() * sizeof(uint64_t); }
+};
+
 struct Dump // full memory copy, saving spikes, etc
 {
   FramesStorage frames;
@@ -106,6 +120,7 @@ struct Dump // full memory copy, saving spikes, etc
   const char *uniqueProfileRunName = nullptr;
   GpuEventDataStorage gpuEvents;
   CallStackDumpStorage stacks;
+  HeapSamplesDump heap;
   uint32_t board = 0;
   uint32_t dumpAtMs = 0;
   uint64_t dateTime = 0;
@@ -122,7 +137,7 @@ struct Dump // full memory copy, saving spikes, etc
   Dump(Type tp, bool append_to_current_if_exist);
   size_t memoryAllocated() const
   {
-    size_t mem = stacks.capacity() * sizeof(uint64_t) + gpuEvents.memAllocated();
+    size_t mem = stacks.capacity() * sizeof(uint64_t) + gpuEvents.memAllocated() + heap.memAllocated();
     for (auto &t : threads)
       mem += t.events.memAllocated() + t.stringTags.memAllocated();
     return mem;
@@ -69,6 +69,7 @@ struct DataResponse
     SyscallPack,
     SummaryPack,
     FramesPack,
+    HeapSamplesPack, // sampled live heap and allocations by callsite
   };
 
   uint32_t version;
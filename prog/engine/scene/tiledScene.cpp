@@ -1476,3 +1476,90 @@ void scene::TiledScene::dumpSceneState(bool dump_node_too) const
       debug("  outer tile=%p objs=%d", &tileData[0], tileData[0].nodes.size());
   }
 }
+
+bbox3f scene::TiledScene::initMultiViewCullData(MultiViewCullData &mv, dag::ConstSpan<TiledSceneCullView> views) const
+{
+  G_ASSERT(views.size() <= MAX_MULTI_VIEWS);
+  mv.views = views.data();
+  mv.groupsCount = (views.size() + 3) / 4;
+  mv.allViews = views.size() == MAX_MULTI_VIEWS ? ~0u : (1u << views.size()) - 1;
+  mv.occlusionViews = mv.distViews = 0;
+  mv.flagsCount = 0;
+  bbox3f frustumsBox;
+  v_bbox3_init_empty(frustumsBox);
+  for (int g = 0; g < mv.groupsCount; ++g)
+  {
+    MultiViewCullData::Group &grp = mv.groups[g];
+    vec4f planes[6][4], pos[4], boxMin[4], boxMax[4];
+    for (int l = 0; l < 4; ++l)
+    {
+      const int v = g * 4 + l;
+      if (v >= views.size())
+      {
+        // plane which rejects everything
+        for (int p = 0; p < 6; ++p)
+          planes[p][l] = v_make_vec4f(0.f, 0.f, 0.f, -1.f);
+        pos[l] = v_zero();
+        boxMin[l] = boxMax[l] = v_zero();
+        continue;
+      }
+      const TiledSceneCullView &view = views[v];
+      const uint32_t testFlags = view.test_flags << 16, equalFlags = view.equal_flags << 16;
+      uint32_t flagsIdx = 0;
+      while (flagsIdx < mv.flagsCount && (mv.testFlags[flagsIdx] != testFlags || mv.equalFlags[flagsIdx] != equalFlags))
+        flagsIdx++;
+      if (flagsIdx == mv.flagsCount)
+      {
+        mv.testFlags[flagsIdx] = testFlags;
+        mv.equalFlags[flagsIdx] = equalFlags;
+        mv.flagsViews[flagsIdx] = 0;
+        mv.flagsCount++;
+      }
+      mv.flagsViews[flagsIdx] |= 1u << v;
+      if (view.occlusion)
+        mv.occlusionViews |= 1u << v;
+
+      vec4f p0, p1, p2, p3, p4, p5;
+      v_construct_camplanes(view.globtm, p0, p1, p2, p3, p4, p5);
+      bbox3f frustumBox;
+      v_frustum_box_unsafe(frustumBox, p0, p1, p2, p3, p4, p5);
+      v_bbox3_add_box(frustumsBox, frustumBox);
+      boxMin[l] = frustumBox.bmin;
+      boxMax[l] = frustumBox.bmax;
+      planes[0][l] = v_norm3(p0);
+      planes[1][l] = v_norm3(p1);
+      planes[2][l] = v_norm3(p2);
+      planes[3][l] = v_norm3(p3);
+      planes[4][l] = v_norm3(p4);
+      planes[5][l] = v_norm3(p5);
+      const bool useDist = v_extract_w(view.pos_distscale) > 0.f;
+      pos[l] = useDist ? view.pos_distscale : v_zero();
+      mv.distViews |= uint32_t(useDist) << v;
+
+      MultiViewCullData::View &splat = mv.viewSplat[v];
+      for (int p = 0; p < 6; ++p)
+      {
+        splat.planeX[p] = v_splat_x(planes[p][l]);
+        splat.planeY[p] = v_splat_y(planes[p][l]);
+        splat.planeZ[p] = v_splat_z(planes[p][l]);
+        splat.planeW[p] = v_splat_w(planes[p][l]);
+      }
+      splat.posX = v_splat_x(pos[l]), splat.posY = v_splat_y(pos[l]), splat.posZ = v_splat_z(pos[l]);
+      splat.distScale = v_splat_w(pos[l]);
+    }
+    for (int p = 0; p < 6; ++p)
+    {
+      vec4f x = planes[p][0], y = planes[p][1], z = planes[p][2], w = planes[p][3];
+      v_mat44_transpose(x, y, z, w);
+      grp.planeX[p] = x, grp.planeY[p] = y, grp.planeZ[p] = z, grp.planeW[p] = w;
+      grp.absPlaneX[p] = v_abs(x), grp.absPlaneY[p] = v_abs(y), grp.absPlaneZ[p] = v_abs(z);
+    }
+    grp.posX = pos[0], grp.posY = pos[1], grp.posZ = pos[2], grp.distScale = pos[3];
+    v_mat44_transpose(grp.posX, grp.posY, grp.posZ, grp.distScale);
+    grp.boxMinX = boxMin[0], grp.boxMinY = boxMin[1], grp.boxMinZ = boxMin[2];
+    v_mat44_transpose(grp.boxMinX, grp.boxMinY, grp.boxMinZ, boxMin[3]);
+    grp.boxMaxX = boxMax[0], grp.boxMaxY = boxMax[1], grp.boxMaxZ = boxMax[2];
+    v_mat44_transpose(grp.boxMaxX, grp.boxMaxY, grp.boxMaxZ, boxMax[3]);
+  }
+  return frustumsBox;
+}
@@ -9,8 +9,12 @@
 #include <math/dag_mathUtils.h>
 #include <math/dag_traceRayTriangle.h>
 #include <debug/dag_log.h>
+#include <util/dag_parallelForInline.h>
+#include <dag/dag_vector.h>
 
 #define MAX_SCENE_LEAF_FACES 48
+// subtrees with less faces are built as single task, when building in parallel; larger ones are split level by level
+#define MIN_SCENE_TASK_FACES 2048
 
 static inline void init_index_and_flags(SceneRayI24F8 &out, unsigned i, unsigned f) { out.index = i, out.flags = f; }
 static inline void init_index_and_flags(uint16_t &out, unsigned i, unsigned) { out = i; }
@@ -178,14 +182,40 @@ void BuildableStaticSceneRayTracerT<FI>::oneMeshInplace(const Point3_vec4 *vert,
   rebuild();
 }
 
+struct SceneRaySubtreeTask
+{
+  int face, count;
+  uintptr_t at;
+};
+
 class SceneRayBuildContext
 {
 public:
-  Bitarray vertsUsed;
+  Bitarray vertsUsed; // all bits are cleared between build_node() calls
   Tab<Point3> usedVerts;
   bool fastBuild = false;
+  // when set, subtrees of grid leaves and children of built node are only reserved in nodesMemory and added here to be built
+  // later, instead of recursion
+  Tab<SceneRaySubtreeTask> *tasks = nullptr;
 };
 
+// Median split (not SAH): it keeps nodes count of subtree dependent on faces count only, which allows to place subtrees
+// before they are built and gives the same nodes layout for any number of workers.
+static inline int split_faces(int numf)
+{
+  int df = numf >> 1;
+  return (df + 3) & ~3; // try to keep number faces in nodes as multiple of 4
+}
+
+// nodes count of subtree depends only on faces count, so subtrees can be placed before they are built
+static uintptr_t subtree_nodes(int numf)
+{
+  if (numf <= MAX_SCENE_LEAF_FACES)
+    return 1;
+  const int df = split_faces(numf);
+  return 1 + subtree_nodes(df) + subtree_nodes(numf - df);
+}
+
 template <typename FI>
 void BuildableStaticSceneRayTracerT<FI>::buildLNode(LNode *node, FaceIndex *f, int numf, SceneRayBuildContext &)
 {
@@ -211,7 +241,7 @@ extern vec4f mesh_fast_bounding_sphere(const Point3 *point, unsigned point_count
 static constexpr int BNBIAS = 1;
 
 template <typename FI>
-uintptr_t BuildableStaticSceneRayTracerT<FI>::build_node(FaceIndex *fc, int numf, SceneRayBuildContext &ctx)
+uintptr_t BuildableStaticSceneRayTracerT<FI>::build_node(FaceIndex *fc, int numf, uintptr_t at, SceneRayBuildContext &ctx)
 {
   G_STATIC_ASSERT(BNBIAS < sizeof(Node));
   int i;
@@ -223,7 +253,6 @@ uintptr_t BuildableStaticSceneRayTracerT<FI>::build_node(FaceIndex *fc, int numf
   BBox3_vec4 box;
 
   ctx.vertsUsed.resize(getVertsCount());
-  ctx.vertsUsed.reset();
 
   // we need to reserve enough memory so when we read our last vertex it'll still fit in the memory if
   // we read 16 bytes (vec4), instead of 12 bytes (Point3), as this is what happens in mesh_bounding_sphere
@@ -255,6 +284,14 @@ uintptr_t BuildableStaticSceneRayTracerT<FI>::build_node(FaceIndex *fc, int numf
     v_bbox3_add_box(vBox, fboxes[fid]);
   }
   fb_median = v_div(fb_median, v_splats(numf));
+  // clearing only used bits is much cheaper than whole array reset for small nodes of large meshes
+  for (i = 0; i < numf; ++i)
+  {
+    const RTface &f = faces((int)fc[i]);
+    ctx.vertsUsed.reset(f.v[0]);
+    ctx.vertsUsed.reset(f.v[1]);
+    ctx.vertsUsed.reset(f.v[2]);
+  }
   // fb_median = v_div(fb_median, v_splats(2.0f*numf));
   G_ASSERT((((intptr_t)&box[0].x) & 15) == 0);
   v_st(&box[0].x, vBox.bmin);
@@ -271,12 +308,11 @@ uintptr_t BuildableStaticSceneRayTracerT<FI>::build_node(FaceIndex *fc, int numf
   }
 
   Point3 wd = box.width();
-  uintptr_t allocatedAt = nodesMemory.size();
-  append_items(nodesMemory, sizeof(Node));
+  G_ASSERT(at + subtree_nodes(numf) * sizeof(Node) <= nodesMemory.size());
   if (numf <= MAX_SCENE_LEAF_FACES)
   {
     // build leaf node
-    LNode *n = new (nodesMemory.data() + allocatedAt, _NEW_INPLACE) LNode;
+    LNode *n = new (nodesMemory.data() + at, _NEW_INPLACE) LNode;
     n->bsc = Point3::xyz(nodeSphR2);
     n->bsr2 = nodeSphR2.w;
     G_ASSERT(!n->sub0); // FIXME: this assertion is actually a check for VC2010 compiler bug with /arch:SSE2 (fixed in VC2010sp1)
@@ -284,9 +320,8 @@ uintptr_t BuildableStaticSceneRayTracerT<FI>::build_node(FaceIndex *fc, int numf
   }
   else
   {
-    // build branch
-    int df = numf >> 1;
-    df = (df + 3) & ~3; // try to keep number faces in nodes as multiple of 4
+    // build branch, subtrees are placed right after it
+    int df = split_faces(numf);
     int md = 0;
     float ms = wd[0];
     for (i = 1; i < 3; ++i)
@@ -296,15 +331,25 @@ uintptr_t BuildableStaticSceneRayTracerT<FI>::build_node(FaceIndex *fc, int numf
     AxisSeparator<FI> axis((Point3 *)&faceboundsTab[0].sc[md]);
     stlsort::nth_element(fc, fc + df, fc + numf, axis);
 
-    const uintptr_t left = build_node(fc, df, ctx);
-    const uintptr_t right = build_node(fc + df, numf - df, ctx);
-    Node *n = new (nodesMemory.data() + allocatedAt, _NEW_INPLACE) Node;
+    const uintptr_t leftAt = at + sizeof(Node), rightAt = at + (1 + subtree_nodes(df)) * sizeof(Node);
+    uintptr_t left = leftAt + BNBIAS, right = rightAt + BNBIAS;
+    if (ctx.tasks)
+    {
+      ctx.tasks->push_back(SceneRaySubtreeTask{int(fc - &faceIndices(0)), df, leftAt});
+      ctx.tasks->push_back(SceneRaySubtreeTask{int(fc + df - &faceIndices(0)), numf - df, rightAt});
+    }
+    else
+    {
+      left = build_node(fc, df, leftAt, ctx);
+      right = build_node(fc + df, numf - df, rightAt, ctx);
+    }
+    Node *n = new (nodesMemory.data() + at, _NEW_INPLACE) Node;
     n->bsc = Point3::xyz(nodeSphR2);
     n->bsr2 = nodeSphR2.w;
     n->sub1 = (Node *)left;
     n->sub0 = (Node *)right;
   }
-  return allocatedAt + BNBIAS;
+  return at + BNBIAS;
 }
 
 template <typename FI>
@@ -316,10 +361,17 @@ struct FaceIndexContainer
 };
 
 template <typename FI>
-void BuildableStaticSceneRayTracerT<FI>::buildLeaf(Leaf **leaf, SceneRayBuildContext &ctx)
+void BuildableStaticSceneRayTracerT<FI>::buildLeaf(Leaf **leaf, uintptr_t &at, SceneRayBuildContext &ctx)
 {
   FaceIndexContainer<FI> *fc1 = (FaceIndexContainer<FI> *)*leaf;
-  *leaf = (Node *)build_node(&faceIndices(0) + fc1->face, fc1->count, ctx);
+  if (ctx.tasks)
+  {
+    ctx.tasks->push_back(SceneRaySubtreeTask{fc1->face, fc1->count, at});
+    *leaf = (Node *)(at + BNBIAS);
+  }
+  else
+    *leaf = (Node *)build_node(&faceIndices(0) + fc1->face, fc1->count, at, ctx);
+  at += subtree_nodes(fc1->count) * sizeof(Node);
   delete fc1;
 }
 
@@ -431,15 +483,59 @@ bool BuildableStaticSceneRayTracerT<FI>::rebuild(bool fast)
   dump.faceIndicesPtr = faceIndicesTab.data();
   dump.faceIndicesCount = faceIndicesTab.size();
   // nomem(fgrp2.resize(faces.size()));
+  // subtrees of grid leaves are placed in enumeration order, so whole nodesMemory is allocated at once
+  uintptr_t nodesCount = 0;
+  for (int ci = 0; ci < containers.size(); ++ci)
+    nodesCount += subtree_nodes(containers[ci]->count);
+  nodesMemory.resize(nodesCount * sizeof(Node));
+
+  // with workers, subtrees are built in parallel at reserved offsets, which gives the same nodes layout as serial build;
+  // large ones are split level by level (each pass builds one node of each large subtree and defers its children to the next
+  // pass), so that partitioning of top levels is parallel too
+  Tab<SceneRaySubtreeTask> tasks(tmpmem);
+  const int numWorkers = threadpool::get_num_workers();
   struct MyCB : public RTHierGrid3LeafCB<Leaf>
   {
     BuildableStaticSceneRayTracerT<FI> *rt;
     SceneRayBuildContext ctx;
-    MyCB(BuildableStaticSceneRayTracerT<FI> *r, bool fast) : rt(r) { ctx.fastBuild = fast; }
-    void leaf_callback(Leaf **l, int, int, int) { rt->buildLeaf(l, ctx); }
-  } cb(this, fast);
+    uintptr_t at = 0;
+    MyCB(BuildableStaticSceneRayTracerT<FI> *r, bool fast, Tab<SceneRaySubtreeTask> *tasks) : rt(r)
+    {
+      ctx.fastBuild = fast;
+      ctx.tasks = tasks;
+    }
+    void leaf_callback(Leaf **l, int, int, int) { rt->buildLeaf(l, at, ctx); }
+  } cb(this, fast, numWorkers > 0 ? &tasks : nullptr);
   createdGrid.enum_all_leaves(cb);
 
+  if (!tasks.empty())
+  {
+    dag::Vector<SceneRayBuildContext> contexts(numWorkers + 1);
+    dag::Vector<Tab<SceneRaySubtreeTask>> deferred(numWorkers + 1);
+    for (SceneRayBuildContext &ctx : contexts)
+      ctx.fastBuild = fast;
+    while (!tasks.empty())
+    {
+      // larger subtrees go first for better balance
+      stlsort::sort(tasks.begin(), tasks.end(),
+        [](const SceneRaySubtreeTask &a, const SceneRaySubtreeTask &b) { return a.count > b.count; });
+      threadpool::parallel_for_inline(0, tasks.size(), 1, [&](uint32_t begin, uint32_t end, uint32_t thread_id) {
+        SceneRayBuildContext &ctx = contexts[thread_id];
+        for (uint32_t i = begin; i < end; ++i)
+        {
+          ctx.tasks = tasks[i].count > MIN_SCENE_TASK_FACES ? &deferred[thread_id] : nullptr;
+          build_node(&faceIndices(0) + tasks[i].face, tasks[i].count, tasks[i].at, ctx);
+        }
+      });
+      tasks.clear();
+      for (Tab<SceneRaySubtreeTask> &d : deferred)
+      {
+        append_items(tasks, d.size(), d.data());
+        d.clear();
+      }
+    }
+  }
+
   nodesMemory.shrink_to_fit();
   replaceAllPointers();
   // printf("missing %d total=%d\n", ::missing, ::total);
@@ -3,6 +3,7 @@
 #endif
 
 #include "scriptSElem.h"
+#include "stcodeExec.h"
 #include "scriptSMat.h"
 #include "shAssert.h"
 #include "mapBinarySearch.h"
@@ -41,17 +42,6 @@
 #include <stdlib.h>
 #endif
 
-#define VEC_ALIGN(v, a)
-// #define VEC_ALIGN(v, a)  G_ASSERT((v & (a-1)) == 0)
-
-// #define DEBUG_RENDER
-#if defined(DEBUG_RENDER)
-#define S_DEBUG debug
-#else
-__forceinline bool DEBUG_F(...) { return false; };
-#define S_DEBUG 0 && DEBUG_F
-#endif
-
 #if MEASURE_STCODE_PERF
 extern bool enable_measure_stcode_perf;
 #include <perfMon/dag_cpuFreq.h>
@@ -800,429 +790,32 @@ void ScriptedShaderElement::update_stvar(ScriptedShaderMaterial &m, int stvarid)
 static void scripted_shader_element_default_before_resource_used_callback(const D3dResource *, const char *){};
 void (*scripted_shader_element_on_before_resource_used)(const D3dResource *,
   const char *) = &scripted_shader_element_default_before_resource_used_callback;
-#else
-static void scripted_shader_element_on_before_resource_used(const D3dResource *, const char *){};
 #endif
 
-void ScriptedShaderElement::exec_stcode(dag::ConstSpan<int> cod, const shaderbindump::ShaderCode::Pass *__restrict code_cp) const
+void ScriptedShaderElement::exec_stcode(int stcode_id, const shaderbindump::ShaderCode::Pass *__restrict code_cp) const
 {
   alignas(16) real vpr_const[32 * 4];
   alignas(16) real fsh_const[32 * 4];
   alignas(16) real vregs[MAX_TEMP_REGS];
-  char *regs = (char *)vregs;
-  uint32_t vpr_c_mask = 0;
-  uint32_t fsh_c_mask = 0;
-
-#define SHL1(y) 1 << (y)
-#define SHLF(y) 0xF << (y)
 
   MEASURE_STCODE_PERF_START;
-  const vec4f *tm_world_c = NULL, *tm_lview_c = NULL;
-
-  // ShUtils::shcod_dump(cod);
 
   shader_assert::ScopedShaderAssert scoped_shader_assert(shClass);
 
-  const uint8_t *vars = getVars();
-  const int *__restrict codp = cod.data(), *__restrict codp_end = codp + cod.size();
-  for (; codp < codp_end; codp++)
-  {
-    const uint32_t opc = *codp;
-
-    switch (shaderopcode::getOp(opc))
-    {
-      case SHCOD_GET_GVEC:
-      {
-        const uint32_t ro = shaderopcode::getOp2p1(opc);
-        const uint32_t index = shaderopcode::getOp2p2(opc);
-        color4_reg(regs, ro) = shBinDump().globVars.get<Color4>(index);
-      }
-      break;
-      case SHCOD_GET_GMAT44:
-      {
-        const uint32_t ro = shaderopcode::getOp2p1(opc);
-        const uint32_t index = shaderopcode::getOp2p2(opc);
-        float4x4_reg(regs, ro) = shBinDump().globVars.get<TMatrix4>(index);
-      }
-      break;
-      case SHCOD_VPR_CONST:
-      {
-        const uint32_t ind = shaderopcode::getOp2p1(opc);
-        const uint32_t ofs = shaderopcode::getOp2p2(opc);
-        VEC_ALIGN(ofs, 4);
-        if (ind < 32)
-        {
-          //        memcpy(&vpr_const[ind<<2], get_reg_ptr<float>(regs, ofs), 4*sizeof(real));
-          v_st(&vpr_const[ind << 2], v_ld(get_reg_ptr<float>(regs, ofs)));
-          vpr_c_mask |= SHL1(ind);
-        }
-        else
-        {
-          d3d::set_vs_const(ind, get_reg_ptr<float>(regs, ofs), 1);
-        }
-      }
-      break;
-      case SHCOD_FSH_CONST:
-      {
-        const uint32_t ind = shaderopcode::getOp2p1(opc);
-        const uint32_t ofs = shaderopcode::getOp2p2(opc);
-        VEC_ALIGN(ofs, 4);
-        if (ind < 32)
-        {
-          //          memcpy(&fsh_const[ind<<2], get_reg_ptr<float>(regs, ofs), 4*sizeof(real));
-          v_st(&fsh_const[ind << 2], v_ld(get_reg_ptr<float>(regs, ofs)));
-          fsh_c_mask |= SHL1(ind);
-        }
-        else
-        {
-          d3d::set_ps_const(ind, get_reg_ptr<float>(regs, ofs), 1);
-        }
-      }
-      break;
-      case SHCOD_CS_CONST:
-      {
-        const uint32_t ind = shaderopcode::getOp2p1(opc);
-        const uint32_t ofs = shaderopcode::getOp2p2(opc);
-        VEC_ALIGN(ofs, 4);
-        d3d::set_cs_const(ind, get_reg_ptr<float>(regs, ofs), 1);
-      }
-      break;
-      case SHCOD_IMM_REAL1: int_reg(regs, shaderopcode::getOp2p1_8(opc)) = int(shaderopcode::getOp2p2_16(opc)) << 16; break;
-      case SHCOD_IMM_SVEC1:
-      {
-        int *reg = get_reg_ptr<int>(regs, shaderopcode::getOp2p1_8(opc));
-        int v = int(shaderopcode::getOp2p2_16(opc)) << 16;
-        reg[0] = reg[1] = reg[2] = reg[3] = v;
-      }
-      break;
-      case SHCOD_GET_GREAL:
-      {
-        const uint32_t ro = shaderopcode::getOp2p1(opc);
-        const uint32_t index = shaderopcode::getOp2p2(opc);
-        real_reg(regs, ro) = shBinDump().globVars.get<real>(index);
-      }
-      break;
-      case SHCOD_MUL_REAL:
-      {
-        const uint32_t regDst = shaderopcode::getOp3p1(opc);
-        const uint32_t regL = shaderopcode::getOp3p2(opc);
-        const uint32_t regR = shaderopcode::getOp3p3(opc);
-        real_reg(regs, regDst) = real_reg(regs, regL) * real_reg(regs, regR);
-      }
-      break;
-      case SHCOD_MAKE_VEC:
-      {
-        const uint32_t ro = shaderopcode::getOp3p1(opc);
-        const uint32_t r1 = shaderopcode::getOp3p2(opc);
-        const uint32_t r2 = shaderopcode::getOp3p3(opc);
-        const uint32_t r3 = shaderopcode::getData2p1(codp[1]);
-        const uint32_t r4 = shaderopcode::getData2p2(codp[1]);
-        real *reg = get_reg_ptr<real>(regs, ro);
-        reg[0] = real_reg(regs, r1);
-        reg[1] = real_reg(regs, r2);
-        reg[2] = real_reg(regs, r3);
-        reg[3] = real_reg(regs, r4);
-        codp++;
-      }
-      break;
-      case SHCOD_GET_VEC:
-      {
-        const uint32_t ro = shaderopcode::getOp2p1(opc);
-        const uint32_t ofs = shaderopcode::getOp2p2(opc);
-        set_vec_reg(v_ldu((const float *)&vars[ofs]), regs, ro);
-      }
-      break;
-      case SHCOD_IMM_REAL:
-      {
-        const uint32_t reg = shaderopcode::getOp1p1(opc);
-        real_reg(regs, reg) = *(const real *)&codp[1];
-        codp++;
-      }
-      break;
-      case SHCOD_GET_REAL:
-      {
-        const uint32_t ro = shaderopcode::getOp2p1(opc);
-        const uint32_t ofs = shaderopcode::getOp2p2(opc);
-        real_reg(regs, ro) = *(real *)&vars[ofs];
-      }
-      break;
-      case SHCOD_TEXTURE:
-      {
-        const uint32_t ind = shaderopcode::getOp2p1(opc);
-        const uint32_t ofs = shaderopcode::getOp2p2(opc);
-        TEXTUREID tid = tex_reg(regs, ofs);
-        mark_managed_tex_lfu(tid, tex_level);
-        S_DEBUG("ind=%d ofs=%d tid=0x%X", ind, ofs, unsigned(tid));
-        BaseTexture *tex = D3dResManagerData::getBaseTex(tid);
-        scripted_shader_element_on_before_resource_used(tex, shClass.name.data());
-        d3d::set_tex(stageDest, ind, tex);
-      }
-      break;
-      case SHCOD_TEXTURE_VS:
-      {
-        TEXTUREID tid = tex_reg(regs, shaderopcode::getOp2p2(opc));
-        mark_managed_tex_lfu(tid, tex_level);
-        BaseTexture *tex = D3dResManagerData::getBaseTex(tid);
-        scripted_shader_element_on_before_resource_used(tex, shClass.name.data());
-        d3d::set_tex(STAGE_VS, shaderopcode::getOp2p1(opc), tex);
-      }
-      break;
-      case SHCOD_BUFFER:
-      {
-        const uint32_t stage = shaderopcode::getOpStageSlot_Stage(opc);
-        const uint32_t slot = shaderopcode::getOpStageSlot_Slot(opc);
-        const uint32_t ofs = shaderopcode::getOpStageSlot_Reg(opc);
-        Sbuffer *buf = buf_reg(regs, ofs);
-        S_DEBUG("buf: stage = %d slot=%d ofs=%d buf=%X", stage, slot, ofs, buf);
-        scripted_shader_element_on_before_resource_used(buf, shClass.name.data());
-        d3d::set_buffer(stage, slot, buf);
-      }
-      break;
-      case SHCOD_CONST_BUFFER:
-      {
-        const uint32_t stage = shaderopcode::getOpStageSlot_Stage(opc);
-        const uint32_t slot = shaderopcode::getOpStageSlot_Slot(opc);
-        const uint32_t ofs = shaderopcode::getOpStageSlot_Reg(opc);
-        Sbuffer *buf = buf_reg(regs, ofs);
-        S_DEBUG("cb: stage = %d slot=%d ofs=%d buf=%X", stage, slot, ofs, buf);
-        scripted_shader_element_on_before_resource_used(buf, shClass.name.data());
-        d3d::set_const_buffer(stage, slot, buf);
-      }
-      break;
-      case SHCOD_RWTEX:
-      {
-        const uint32_t ind = shaderopcode::getOp2p1(opc);
-        const uint32_t ofs = shaderopcode::getOp2p2(opc);
-        TEXTUREID tid = tex_reg(regs, ofs);
-        BaseTexture *tex = D3dResManagerData::getBaseTex(tid);
-        scripted_shader_element_on_before_resource_used(tex, shClass.name.data());
-        S_DEBUG("rwtex: ind=%d ofs=%d tex=%X", ind, ofs, tex);
-        d3d::set_rwtex(stageDest, ind, tex, 0, 0);
-      }
-      break;
-      case SHCOD_RWBUF:
-      {
-        const uint32_t ind = shaderopcode::getOp2p1(opc);
-        const uint32_t ofs = shaderopcode::getOp2p2(opc);
-        Sbuffer *buf = buf_reg(regs, ofs);
-        scripted_shader_element_on_before_resource_used(buf, shClass.name.data());
-        S_DEBUG("rwbuf: ind=%d ofs=%d buf=%X", ind, ofs, buf);
-        d3d::set_rwbuffer(stageDest, ind, buf);
-      }
-      break;
-      case SHCOD_LVIEW:
-      {
-        real *reg = get_reg_ptr<real>(regs, shaderopcode::getOp2p1(opc));
-        if (!tm_lview_c)
-          tm_lview_c = &d3d::gettm_cref(TM_VIEW2LOCAL).col0;
-        v_stu(reg, tm_lview_c[shaderopcode::getOp2p2(opc)]);
-      }
-      break;
-      case SHCOD_GET_GTEX:
-      {
-        const uint32_t reg = shaderopcode::getOp2p1(opc);
-        const uint32_t index = shaderopcode::getOp2p2(opc);
-        tex_reg(regs, reg) = shBinDump().globVars.getTex(index).texId;
-      }
-      break;
-      case SHCOD_GET_GBUF:
-      {
-        const uint32_t reg = shaderopcode::getOp2p1(opc);
-        const uint32_t index = shaderopcode::getOp2p2(opc);
-        Sbuffer *&tex = buf_reg(regs, reg);
-        tex = shBinDump().globVars.getBuf(index).buf;
-      }
-      break;
-      case SHCOD_G_TM:
-      {
-        int ind = shaderopcode::getOp2p2_16(opc);
-        TMatrix4_vec4 gtm;
-        switch (shaderopcode::getOp2p1_8(opc))
-        {
-          case P1_SHCOD_G_TM_GLOBTM: d3d::getglobtm(gtm); break;
-          case P1_SHCOD_G_TM_PROJTM: d3d::gettm(TM_PROJ, &gtm); break;
-          case P1_SHCOD_G_TM_VIEWPROJTM:
-          {
-            TMatrix4_vec4 v, p;
-            d3d::gettm(TM_VIEW, &v);
-            d3d::gettm(TM_PROJ, &p);
-            gtm = v * p;
-          }
-          break;
-          default: G_ASSERTF(0, "SHCOD_G_TM(%d, %d)", shaderopcode::getOp2p1_8(opc), ind);
-        }
-
-        process_tm_for_drv_consts(gtm);
-
-        if (ind < 29)
-        {
-          memcpy(&vpr_const[ind << 2], gtm[0], sizeof(real) * 4 * 4);
-          vpr_c_mask |= SHLF(ind);
-        }
-        else
-        {
-          d3d::set_vs_const(ind, gtm[0], 4);
-        }
-      }
-      break;
-      case SHCOD_DIV_REAL:
-      {
-        const uint32_t regDst = shaderopcode::getOp3p1(opc);
-        const uint32_t regL = shaderopcode::getOp3p2(opc);
-        const uint32_t regR = shaderopcode::getOp3p3(opc);
-        if (int_reg(regs, regR) == 0)
-        {
-#if DAGOR_DBGLEVEL > 0
-          debug("shclass: %s", (const char *)shClass.name);
-          ShUtils::shcod_dump(cod, &shBinDump().globVars, &shClass.localVars, code.stVarMap);
-          fatal("divide by zero [real] while exec shader code. stopped at operand #%d", codp - cod.data());
-#endif
-          real_reg(regs, regDst) = real_reg(regs, regL);
-        }
-        else
-          real_reg(regs, regDst) = real_reg(regs, regL) / real_reg(regs, regR);
-      }
-      break;
-      case SHCOD_CALL_FUNCTION:
-      {
-        int functionName = shaderopcode::getOp3p1(opc);
-        int rOut = shaderopcode::getOp3p2(opc);
-        int paramCount = shaderopcode::getOp3p3(opc);
-        functional::callFunction((functional::FunctionId)functionName, rOut, codp + 1, regs);
-        codp += paramCount;
-      }
-      break;
-      case SHCOD_GET_TEX:
-      {
-        const uint32_t reg = shaderopcode::getOp2p1(opc);
-        const uint32_t ofs = shaderopcode::getOp2p2(opc);
-        Tex &t = *(Tex *)&vars[ofs];
-        tex_reg(regs, reg) = t.texId;
-        t.get();
-      }
-      break;
-      case SHCOD_TMWORLD:
-      {
-        real *reg = get_reg_ptr<real>(regs, shaderopcode::getOp2p1(opc));
-        if (!tm_world_c)
-          tm_world_c = &d3d::gettm_cref(TM_WORLD).col0;
-        v_stu(reg, tm_world_c[shaderopcode::getOp2p2(opc)]);
-      }
-      break;
-      case SHCOD_COPY_REAL: int_reg(regs, shaderopcode::getOp2p1(opc)) = int_reg(regs, shaderopcode::getOp2p2(opc)); break;
-      case SHCOD_COPY_VEC: color4_reg(regs, shaderopcode::getOp2p1(opc)) = color4_reg(regs, shaderopcode::getOp2p2(opc)); break;
-      case SHCOD_SUB_REAL:
-      {
-        const uint32_t regDst = shaderopcode::getOp3p1(opc);
-        const uint32_t regL = shaderopcode::getOp3p2(opc);
-        const uint32_t regR = shaderopcode::getOp3p3(opc);
-        real_reg(regs, regDst) = real_reg(regs, regL) - real_reg(regs, regR);
-      }
-      break;
-      case SHCOD_ADD_REAL:
-      {
-        const uint32_t regDst = shaderopcode::getOp3p1(opc);
-        const uint32_t regL = shaderopcode::getOp3p2(opc);
-        const uint32_t regR = shaderopcode::getOp3p3(opc);
-        real_reg(regs, regDst) = real_reg(regs, regL) + real_reg(regs, regR);
-      }
-      break;
-      case SHCOD_SUB_VEC:
-      {
-        const uint32_t regDst = shaderopcode::getOp3p1(opc);
-        const uint32_t regL = shaderopcode::getOp3p2(opc);
-        const uint32_t regR = shaderopcode::getOp3p3(opc);
-        set_vec_reg(v_sub(get_vec_reg(regs, regL), get_vec_reg(regs, regR)), regs, regDst);
-      }
-      break;
-      case SHCOD_MUL_VEC:
-      {
-        const uint32_t regDst = shaderopcode::getOp3p1(opc);
-        const uint32_t regL = shaderopcode::getOp3p2(opc);
-        const uint32_t regR = shaderopcode::getOp3p3(opc);
-        set_vec_reg(v_mul(get_vec_reg(regs, regL), get_vec_reg(regs, regR)), regs, regDst);
-      }
-      break;
-      case SHCOD_IMM_VEC:
-      {
-        const uint32_t ro = shaderopcode::getOp1p1(opc);
-        set_vec_reg(v_ldu((const float *)&codp[1]), regs, ro);
-        codp += 4;
-      }
-      break;
-      case SHCOD_GET_INT_TOREAL:
-      {
-        const uint32_t ro = shaderopcode::getOp2p1(opc);
-        const uint32_t ofs = shaderopcode::getOp2p2(opc);
-        real_reg(regs, ro) = *(int *)&vars[ofs];
-      }
-      break;
-      case SHCOD_GET_INT:
-      {
-        const uint32_t ro = shaderopcode::getOp2p1(opc);
-        const uint32_t ofs = shaderopcode::getOp2p2(opc);
-        int_reg(regs, ro) = *(int *)&vars[ofs];
-      }
-      break;
-      case SHCOD_INVERSE:
-      {
-        real *r = get_reg_ptr<real>(regs, shaderopcode::getOp2p1(opc));
-        r[0] = -r[0];
-        if (shaderopcode::getOp2p2(opc) == 4)
-          r[1] = -r[1], r[2] = -r[2], r[3] = -r[3];
-      }
-      break;
-      case SHCOD_ADD_VEC:
-      {
-        const uint32_t regDst = shaderopcode::getOp3p1(opc);
-        const uint32_t regL = shaderopcode::getOp3p2(opc);
-        const uint32_t regR = shaderopcode::getOp3p3(opc);
-        set_vec_reg(v_add(get_vec_reg(regs, regL), get_vec_reg(regs, regR)), regs, regDst);
-      }
-      break;
-      case SHCOD_DIV_VEC:
-      {
-        const uint32_t regDst = shaderopcode::getOp3p1(opc);
-        const uint32_t regL = shaderopcode::getOp3p2(opc);
-        const uint32_t regR = shaderopcode::getOp3p3(opc);
-        vec4f lval = get_vec_reg(regs, regL);
-        vec4f rval = get_vec_reg(regs, regR);
-        rval = v_sel(rval, V_C_ONE, v_cmp_eq(rval, v_zero()));
-        set_vec_reg(v_div(lval, rval), regs, regDst);
-
-#if DAGOR_DBGLEVEL > 0
-        Color4 rvalS = color4_reg(regs, regR);
-
-        for (int j = 0; j < 4; j++)
-          if (rvalS[j] == 0)
-          {
-            debug("shclass: %s", (const char *)shClass.name);
-            ShUtils::shcod_dump(cod, &shBinDump().globVars, &shClass.localVars, code.stVarMap);
-            fatal("divide by zero [color4[%d]] while exec shader code. stopped at operand #%d", j, codp - cod.data());
-          }
-#endif
-      }
-      break;
+  StcodeExecState st;
+  st.elem = this;
+  st.cod = shBinDump().stcode[stcode_id];
+  st.regs = (char *)vregs;
+  st.vars = getVars();
+  st.vprConst = vpr_const;
+  st.fshConst = fsh_const;
+  if (stcode_id < shaderbindump::nativeStcode.size() && shaderbindump::nativeStcode[stcode_id])
+    shaderbindump::nativeStcode[stcode_id](st);
+  else
+    exec_stcode_ops(st, st.cod);
 
-      case SHCOD_GET_GINT:
-      {
-        const uint32_t ro = shaderopcode::getOp2p1(opc);
-        const uint32_t index = shaderopcode::getOp2p2(opc);
-        int_reg(regs, ro) = shBinDump().globVars.get<int>(index);
-      }
-      break;
-      case SHCOD_GET_GINT_TOREAL:
-      {
-        const uint32_t ro = shaderopcode::getOp2p1(opc);
-        const uint32_t index = shaderopcode::getOp2p2(opc);
-        real_reg(regs, ro) = shBinDump().globVars.get<int>(index);
-      }
-      break;
-      default:
-        fatal("exec_stcode: illegal instruction %u %s (index=%d)", shaderopcode::getOp(opc),
-          ShUtils::shcod_tokname(shaderopcode::getOp(opc)), codp - cod.data());
-    }
-  }
+  uint32_t vpr_c_mask = st.vprMask;
+  uint32_t fsh_c_mask = st.fshMask;
 
   int start = 0, end, mask = 1;
   while (fsh_c_mask)
@@ -1454,7 +1047,7 @@ void ScriptedShaderElement::setStatesForVariant(int curVariant, uint32_t program
   {
     const int stcodeId = codeCp->rpass->stcodeId;
     G_ASSERT(stcodeId < shBinDump().stcode.size());
-    exec_stcode(shBinDump().stcode[stcodeId], codeCp);
+    exec_stcode(stcodeId, codeCp);
   }
 }
 
@@ -1494,7 +1087,7 @@ bool ScriptedShaderElement::setStatesDispatch() const
   if (p->stcodeId != shaderbindump::ShaderCode::INVALID_FSH_VPR_ID)
   {
     G_ASSERT(p->stcodeId < shBinDump().stcode.size());
-    exec_stcode(shBinDump().stcode[p->stcodeId], codeCp);
+    exec_stcode(p->stcodeId, codeCp);
   }
   return true;
 }
@@ -99,7 +99,7 @@ public:
 
   void update_stvar(ScriptedShaderMaterial &m, int stvarid);
 
-  GCC_HOT void exec_stcode(dag::ConstSpan<int> cod, const shaderbindump::ShaderCode::Pass *__restrict code_cp) const;
+  GCC_HOT void exec_stcode(int stcode_id, const shaderbindump::ShaderCode::Pass *__restrict code_cp) const;
 
   SNC_LIKELY_TARGET bool setStates() const override;
   SNC_LIKELY_TARGET void render(int minv, int numv, int sind, int numf, int base_vertex, int prim = PRIM_TRILIST) const override;
@@ -156,6 +156,8 @@ struct ShaderStatistics
 };
 
 uint32_t get_dynvariant_collection_id(const shaderbindump::ShaderCode &code);
+// selects native stcode routines registered for this dump, if any (null dump just resets them)
+void init_native_stcode(const ScriptedShadersBinDump *dump);
 void build_dynvariant_collection_cache(dag::Vector<int, framemem_allocator> &cache);
 void build_dynvariant_collection_cache(dag::Vector<int> &cache);
 } // namespace shaderbindump
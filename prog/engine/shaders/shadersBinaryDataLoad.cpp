@@ -273,6 +273,9 @@ void ScriptedShadersBinDumpOwner::initAfterLoad()
 
   shaderbindump::intervalBinds.clear();
   shaderbindump::intervalBindRanges.clear();
+
+  if (this == &shBinDumpOwner())
+    shaderbindump::init_native_stcode(mShaderDump);
 }
 
 void ScriptedShadersBinDumpOwner::clear()
@@ -282,6 +285,8 @@ void ScriptedShadersBinDumpOwner::clear()
     // tell the driver that we are going to unload this bindump
     d3d::driver_command(DRV3D_COMMAND_REGISTER_SHADER_DUMP, nullptr, nullptr, nullptr);
   }
+  if (this == &shBinDumpOwner())
+    shaderbindump::init_native_stcode(nullptr);
   mDecompressedGropusLru.reset();
   mDictionary.reset();
   mSelfData = {};
@@ -0,0 +1,474 @@
+#pragma once
+
+#include "scriptSElem.h"
+#include "shRegs.h"
+#include <shaders/shFunc.h>
+#include <shaders/shUtils.h>
+#include <shaders/shOpcodeFormat.h>
+#include <shaders/shOpcode.h>
+#include <3d/dag_render.h>
+#include <3d/dag_drv3d_platform.h>
+#include <3d/dag_texMgr.h>
+#include <debug/dag_debug.h>
+#include <debug/dag_log.h>
+#include <math/dag_TMatrix4more.h>
+#include <generic/dag_span.h>
+
+#if DAGOR_DBGLEVEL > 0
+extern void (*scripted_shader_element_on_before_resource_used)(const D3dResource *, const char *);
+#else
+inline void scripted_shader_element_on_before_resource_used(const D3dResource *, const char *) {}
+#endif
+
+// #define DEBUG_RENDER
+#if defined(DEBUG_RENDER)
+#define S_DEBUG debug
+#else
+__forceinline bool DEBUG_F(...) { return false; };
+#define S_DEBUG 0 && DEBUG_F
+#endif
+
+#define VEC_ALIGN(v, a)
+// #define VEC_ALIGN(v, a)  G_ASSERT((v & (a-1)) == 0)
+
+// State of one stcode execution, shared by interpreter and native stcode routines generated by shader compiler.
+// vprConst/fshConst keep first 32 consts which are sent to driver at once after execution.
+struct StcodeExecState
+{
+  const ScriptedShaderElement *elem; // can be null only when stcode doesn't set resources
+  dag::ConstSpan<int> cod;           // stcode of dump, for error reports
+  char *regs;
+  const uint8_t *vars;
+  real *vprConst, *fshConst;
+  uint32_t vprMask = 0, fshMask = 0;
+  const vec4f *tmWorld = nullptr, *tmLview = nullptr;
+};
+
+// Executes instruction cod[idx] and returns count of data words which follow it. Native routines call it with constant
+// cod and idx, so switch is folded to body of single opcode.
+__forceinline int exec_stcode_op(StcodeExecState &st, const int *__restrict cod, int idx)
+{
+  char *regs = st.regs;
+  const uint8_t *vars = st.vars;
+  const uint32_t opc = cod[idx];
+
+  switch (shaderopcode::getOp(opc))
+  {
+    case SHCOD_GET_GVEC:
+    {
+      const uint32_t ro = shaderopcode::getOp2p1(opc);
+      const uint32_t index = shaderopcode::getOp2p2(opc);
+      color4_reg(regs, ro) = shBinDump().globVars.get<Color4>(index);
+    }
+    break;
+    case SHCOD_GET_GMAT44:
+    {
+      const uint32_t ro = shaderopcode::getOp2p1(opc);
+      const uint32_t index = shaderopcode::getOp2p2(opc);
+      float4x4_reg(regs, ro) = shBinDump().globVars.get<TMatrix4>(index);
+    }
+    break;
+    case SHCOD_VPR_CONST:
+    {
+      const uint32_t ind = shaderopcode::getOp2p1(opc);
+      const uint32_t ofs = shaderopcode::getOp2p2(opc);
+      VEC_ALIGN(ofs, 4);
+      if (ind < 32)
+      {
+        //        memcpy(&st.vprConst[ind<<2], get_reg_ptr<float>(regs, ofs), 4*sizeof(real));
+        v_st(&st.vprConst[ind << 2], v_ld(get_reg_ptr<float>(regs, ofs)));
+        st.vprMask |= 1 << ind;
+      }
+      else
+      {
+        d3d::set_vs_const(ind, get_reg_ptr<float>(regs, ofs), 1);
+      }
+    }
+    break;
+    case SHCOD_FSH_CONST:
+    {
+      const uint32_t ind = shaderopcode::getOp2p1(opc);
+      const uint32_t ofs = shaderopcode::getOp2p2(opc);
+      VEC_ALIGN(ofs, 4);
+      if (ind < 32)
+      {
+        //          memcpy(&st.fshConst[ind<<2], get_reg_ptr<float>(regs, ofs), 4*sizeof(real));
+        v_st(&st.fshConst[ind << 2], v_ld(get_reg_ptr<float>(regs, ofs)));
+        st.fshMask |= 1 << ind;
+      }
+      else
+      {
+        d3d::set_ps_const(ind, get_reg_ptr<float>(regs, ofs), 1);
+      }
+    }
+    break;
+    case SHCOD_CS_CONST:
+    {
+      const uint32_t ind = shaderopcode::getOp2p1(opc);
+      const uint32_t ofs = shaderopcode::getOp2p2(opc);
+      VEC_ALIGN(ofs, 4);
+      d3d::set_cs_const(ind, get_reg_ptr<float>(regs, ofs), 1);
+    }
+    break;
+    case SHCOD_IMM_REAL1: int_reg(regs, shaderopcode::getOp2p1_8(opc)) = int(shaderopcode::getOp2p2_16(opc)) << 16; break;
+    case SHCOD_IMM_SVEC1:
+    {
+      int *reg = get_reg_ptr<int>(regs, shaderopcode::getOp2p1_8(opc));
+      int v = int(shaderopcode::getOp2p2_16(opc)) << 16;
+      reg[0] = reg[1] = reg[2] = reg[3] = v;
+    }
+    break;
+    case SHCOD_GET_GREAL:
+    {
+      const uint32_t ro = shaderopcode::getOp2p1(opc);
+      const uint32_t index = shaderopcode::getOp2p2(opc);
+      real_reg(regs, ro) = shBinDump().globVars.get<real>(index);
+    }
+    break;
+    case SHCOD_MUL_REAL:
+    {
+      const uint32_t regDst = shaderopcode::getOp3p1(opc);
+      const uint32_t regL = shaderopcode::getOp3p2(opc);
+      const uint32_t regR = shaderopcode::getOp3p3(opc);
+      real_reg(regs, regDst) = real_reg(regs, regL) * real_reg(regs, regR);
+    }
+    break;
+    case SHCOD_MAKE_VEC:
+    {
+      const uint32_t ro = shaderopcode::getOp3p1(opc);
+      const uint32_t r1 = shaderopcode::getOp3p2(opc);
+      const uint32_t r2 = shaderopcode::getOp3p3(opc);
+      const uint32_t r3 = shaderopcode::getData2p1(cod[idx + 1]);
+      const uint32_t r4 = shaderopcode::getData2p2(cod[idx + 1]);
+      real *reg = get_reg_ptr<real>(regs, ro);
+      reg[0] = real_reg(regs, r1);
+      reg[1] = real_reg(regs, r2);
+      reg[2] = real_reg(regs, r3);
+      reg[3] = real_reg(regs, r4);
+      return 1;
+    }
+    case SHCOD_GET_VEC:
+    {
+      const uint32_t ro = shaderopcode::getOp2p1(opc);
+      const uint32_t ofs = shaderopcode::getOp2p2(opc);
+      set_vec_reg(v_ldu((const float *)&vars[ofs]), regs, ro);
+    }
+    break;
+    case SHCOD_IMM_REAL:
+    {
+      const uint32_t reg = shaderopcode::getOp1p1(opc);
+      real_reg(regs, reg) = *(const real *)&cod[idx + 1];
+      return 1;
+    }
+    case SHCOD_GET_REAL:
+    {
+      const uint32_t ro = shaderopcode::getOp2p1(opc);
+      const uint32_t ofs = shaderopcode::getOp2p2(opc);
+      real_reg(regs, ro) = *(real *)&vars[ofs];
+    }
+    break;
+    case SHCOD_TEXTURE:
+    {
+      const uint32_t ind = shaderopcode::getOp2p1(opc);
+      const uint32_t ofs = shaderopcode::getOp2p2(opc);
+      TEXTUREID tid = tex_reg(regs, ofs);
+      mark_managed_tex_lfu(tid, st.elem->tex_level);
+      S_DEBUG("ind=%d ofs=%d tid=0x%X", ind, ofs, unsigned(tid));
+      BaseTexture *tex = D3dResManagerData::getBaseTex(tid);
+      scripted_shader_element_on_before_resource_used(tex, st.elem->shClass.name.data());
+      d3d::set_tex(st.elem->stageDest, ind, tex);
+    }
+    break;
+    case SHCOD_TEXTURE_VS:
+    {
+      TEXTUREID tid = tex_reg(regs, shaderopcode::getOp2p2(opc));
+      mark_managed_tex_lfu(tid, st.elem->tex_level);
+      BaseTexture *tex = D3dResManagerData::getBaseTex(tid);
+      scripted_shader_element_on_before_resource_used(tex, st.elem->shClass.name.data());
+      d3d::set_tex(STAGE_VS, shaderopcode::getOp2p1(opc), tex);
+    }
+    break;
+    case SHCOD_BUFFER:
+    {
+      const uint32_t stage = shaderopcode::getOpStageSlot_Stage(opc);
+      const uint32_t slot = shaderopcode::getOpStageSlot_Slot(opc);
+      const uint32_t ofs = shaderopcode::getOpStageSlot_Reg(opc);
+      Sbuffer *buf = buf_reg(regs, ofs);
+      S_DEBUG("buf: stage = %d slot=%d ofs=%d buf=%X", stage, slot, ofs, buf);
+      scripted_shader_element_on_before_resource_used(buf, st.elem->shClass.name.data());
+      d3d::set_buffer(stage, slot, buf);
+    }
+    break;
+    case SHCOD_CONST_BUFFER:
+    {
+      const uint32_t stage = shaderopcode::getOpStageSlot_Stage(opc);
+      const uint32_t slot = shaderopcode::getOpStageSlot_Slot(opc);
+      const uint32_t ofs = shaderopcode::getOpStageSlot_Reg(opc);
+      Sbuffer *buf = buf_reg(regs, ofs);
+      S_DEBUG("cb: stage = %d slot=%d ofs=%d buf=%X", stage, slot, ofs, buf);
+      scripted_shader_element_on_before_resource_used(buf, st.elem->shClass.name.data());
+      d3d::set_const_buffer(stage, slot, buf);
+    }
+    break;
+    case SHCOD_RWTEX:
+    {
+      const uint32_t ind = shaderopcode::getOp2p1(opc);
+      const uint32_t ofs = shaderopcode::getOp2p2(opc);
+      TEXTUREID tid = tex_reg(regs, ofs);
+      BaseTexture *tex = D3dResManagerData::getBaseTex(tid);
+      scripted_shader_element_on_before_resource_used(tex, st.elem->shClass.name.data());
+      S_DEBUG("rwtex: ind=%d ofs=%d tex=%X", ind, ofs, tex);
+      d3d::set_rwtex(st.elem->stageDest, ind, tex, 0, 0);
+    }
+    break;
+    case SHCOD_RWBUF:
+    {
+      const uint32_t ind = shaderopcode::getOp2p1(opc);
+      const uint32_t ofs = shaderopcode::getOp2p2(opc);
+      Sbuffer *buf = buf_reg(regs, ofs);
+      scripted_shader_element_on_before_resource_used(buf, st.elem->shClass.name.data());
+      S_DEBUG("rwbuf: ind=%d ofs=%d buf=%X", ind, ofs, buf);
+      d3d::set_rwbuffer(st.elem->stageDest, ind, buf);
+    }
+    break;
+    case SHCOD_LVIEW:
+    {
+      real *reg = get_reg_ptr<real>(regs, shaderopcode::getOp2p1(opc));
+      if (!st.tmLview)
+        st.tmLview = &d3d::gettm_cref(TM_VIEW2LOCAL).col0;
+      v_stu(reg, st.tmLview[shaderopcode::getOp2p2(opc)]);
+    }
+    break;
+    case SHCOD_GET_GTEX:
+    {
+      const uint32_t reg = shaderopcode::getOp2p1(opc);
+      const uint32_t index = shaderopcode::getOp2p2(opc);
+      tex_reg(regs, reg) = shBinDump().globVars.getTex(index).texId;
+    }
+    break;
+    case SHCOD_GET_GBUF:
+    {
+      const uint32_t reg = shaderopcode::getOp2p1(opc);
+      const uint32_t index = shaderopcode::getOp2p2(opc);
+      Sbuffer *&tex = buf_reg(regs, reg);
+      tex = shBinDump().globVars.getBuf(index).buf;
+    }
+    break;
+    case SHCOD_G_TM:
+    {
+      int ind = shaderopcode::getOp2p2_16(opc);
+      TMatrix4_vec4 gtm;
+      switch (shaderopcode::getOp2p1_8(opc))
+      {
+        case P1_SHCOD_G_TM_GLOBTM: d3d::getglobtm(gtm); break;
+        case P1_SHCOD_G_TM_PROJTM: d3d::gettm(TM_PROJ, &gtm); break;
+        case P1_SHCOD_G_TM_VIEWPROJTM:
+        {
+          TMatrix4_vec4 v, p;
+          d3d::gettm(TM_VIEW, &v);
+          d3d::gettm(TM_PROJ, &p);
+          gtm = v * p;
+        }
+        break;
+        default: G_ASSERTF(0, "SHCOD_G_TM(%d, %d)", shaderopcode::getOp2p1_8(opc), ind);
+      }
+
+      process_tm_for_drv_consts(gtm);
+
+      if (ind < 29)
+      {
+        memcpy(&st.vprConst[ind << 2], gtm[0], sizeof(real) * 4 * 4);
+        st.vprMask |= 0xF << ind;
+      }
+      else
+      {
+        d3d::set_vs_const(ind, gtm[0], 4);
+      }
+    }
+    break;
+    case SHCOD_DIV_REAL:
+    {
+      const uint32_t regDst = shaderopcode::getOp3p1(opc);
+      const uint32_t regL = shaderopcode::getOp3p2(opc);
+      const uint32_t regR = shaderopcode::getOp3p3(opc);
+      if (int_reg(regs, regR) == 0)
+      {
+#if DAGOR_DBGLEVEL > 0
+        debug("shclass: %s", (const char *)st.elem->shClass.name);
+        ShUtils::shcod_dump(st.cod, &shBinDump().globVars, &st.elem->shClass.localVars, st.elem->code.stVarMap);
+        fatal("divide by zero [real] while exec shader code. stopped at operand #%d", idx);
+#endif
+        real_reg(regs, regDst) = real_reg(regs, regL);
+      }
+      else
+        real_reg(regs, regDst) = real_reg(regs, regL) / real_reg(regs, regR);
+    }
+    break;
+    case SHCOD_CALL_FUNCTION:
+    {
+      int functionName = shaderopcode::getOp3p1(opc);
+      int rOut = shaderopcode::getOp3p2(opc);
+      int paramCount = shaderopcode::getOp3p3(opc);
+      functional::callFunction((functional::FunctionId)functionName, rOut, cod + idx + 1, regs);
+      return paramCount;
+    }
+    case SHCOD_GET_TEX:
+    {
+      const uint32_t reg = shaderopcode::getOp2p1(opc);
+      const uint32_t ofs = shaderopcode::getOp2p2(opc);
+      ScriptedShaderElement::Tex &t = *(ScriptedShaderElement::Tex *)&vars[ofs];
+      tex_reg(regs, reg) = t.texId;
+      t.get();
+    }
+    break;
+    case SHCOD_TMWORLD:
+    {
+      real *reg = get_reg_ptr<real>(regs, shaderopcode::getOp2p1(opc));
+      if (!st.tmWorld)
+        st.tmWorld = &d3d::gettm_cref(TM_WORLD).col0;
+      v_stu(reg, st.tmWorld[shaderopcode::getOp2p2(opc)]);
+    }
+    break;
+    case SHCOD_COPY_REAL: int_reg(regs, shaderopcode::getOp2p1(opc)) = int_reg(regs, shaderopcode::getOp2p2(opc)); break;
+    case SHCOD_COPY_VEC: color4_reg(regs, shaderopcode::getOp2p1(opc)) = color4_reg(regs, shaderopcode::getOp2p2(opc)); break;
+    case SHCOD_SUB_REAL:
+    {
+      const uint32_t regDst = shaderopcode::getOp3p1(opc);
+      const uint32_t regL = shaderopcode::getOp3p2(opc);
+      const uint32_t regR = shaderopcode::getOp3p3(opc);
+      real_reg(regs, regDst) = real_reg(regs, regL) - real_reg(regs, regR);
+    }
+    break;
+    case SHCOD_ADD_REAL:
+    {
+      const uint32_t regDst = shaderopcode::getOp3p1(opc);
+      const uint32_t regL = shaderopcode::getOp3p2(opc);
+      const uint32_t regR = shaderopcode::getOp3p3(opc);
+      real_reg(regs, regDst) = real_reg(regs, regL) + real_reg(regs, regR);
+    }
+    break;
+    case SHCOD_SUB_VEC:
+    {
+      const uint32_t regDst = shaderopcode::getOp3p1(opc);
+      const uint32_t regL = shaderopcode::getOp3p2(opc);
+      const uint32_t regR = shaderopcode::getOp3p3(opc);
+      set_vec_reg(v_sub(get_vec_reg(regs, regL), get_vec_reg(regs, regR)), regs, regDst);
+    }
+    break;
+    case SHCOD_MUL_VEC:
+    {
+      const uint32_t regDst = shaderopcode::getOp3p1(opc);
+      const uint32_t regL = shaderopcode::getOp3p2(opc);
+      const uint32_t regR = shaderopcode::getOp3p3(opc);
+      set_vec_reg(v_mul(get_vec_reg(regs, regL), get_vec_reg(regs, regR)), regs, regDst);
+    }
+    break;
+    case SHCOD_IMM_VEC:
+    {
+      const uint32_t ro = shaderopcode::getOp1p1(opc);
+      set_vec_reg(v_ldu((const float *)&cod[idx + 1]), regs, ro);
+      return 4;
+    }
+    case SHCOD_GET_INT_TOREAL:
+    {
+      const uint32_t ro = shaderopcode::getOp2p1(opc);
+      const uint32_t ofs = shaderopcode::getOp2p2(opc);
+      real_reg(regs, ro) = *(int *)&vars[ofs];
+    }
+    break;
+    case SHCOD_GET_INT:
+    {
+      const uint32_t ro = shaderopcode::getOp2p1(opc);
+      const uint32_t ofs = shaderopcode::getOp2p2(opc);
+      int_reg(regs, ro) = *(int *)&vars[ofs];
+    }
+    break;
+    case SHCOD_INVERSE:
+    {
+      real *r = get_reg_ptr<real>(regs, shaderopcode::getOp2p1(opc));
+      r[0] = -r[0];
+      if (shaderopcode::getOp2p2(opc) == 4)
+        r[1] = -r[1], r[2] = -r[2], r[3] = -r[3];
+    }
+    break;
+    case SHCOD_ADD_VEC:
+    {
+      const uint32_t regDst = shaderopcode::getOp3p1(opc);
+      const uint32_t regL = shaderopcode::getOp3p2(opc);
+      const uint32_t regR = shaderopcode::getOp3p3(opc);
+      set_vec_reg(v_add(get_vec_reg(regs, regL), get_vec_reg(regs, regR)), regs, regDst);
+    }
+    break;
+    case SHCOD_DIV_VEC:
+    {
+      const uint32_t regDst = shaderopcode::getOp3p1(opc);
+      const uint32_t regL = shaderopcode::getOp3p2(opc);
+      const uint32_t regR = shaderopcode::getOp3p3(opc);
+      vec4f lval = get_vec_reg(regs, regL);
+      vec4f rval = get_vec_reg(regs, regR);
+      rval = v_sel(rval, V_C_ONE, v_cmp_eq(rval, v_zero()));
+      set_vec_reg(v_div(lval, rval), regs, regDst);
+
+#if DAGOR_DBGLEVEL > 0
+      Color4 rvalS = color4_reg(regs, regR);
+
+      for (int j = 0; j < 4; j++)
+        if (rvalS[j] == 0)
+        {
+          debug("shclass: %s", (const char *)st.elem->shClass.name);
+          ShUtils::shcod_dump(st.cod, &shBinDump().globVars, &st.elem->shClass.localVars, st.elem->code.stVarMap);
+          fatal("divide by zero [color4[%d]] while exec shader code. stopped at operand #%d", j, idx);
+        }
+#endif
+    }
+    break;
+
+    case SHCOD_GET_GINT:
+    {
+      const uint32_t ro = shaderopcode::getOp2p1(opc);
+      const uint32_t index = shaderopcode::getOp2p2(opc);
+      int_reg(regs, ro) = shBinDump().globVars.get<int>(index);
+    }
+    break;
+    case SHCOD_GET_GINT_TOREAL:
+    {
+      const uint32_t ro = shaderopcode::getOp2p1(opc);
+      const uint32_t index = shaderopcode::getOp2p2(opc);
+      real_reg(regs, ro) = shBinDump().globVars.get<int>(index);
+    }
+    break;
+    default:
+      fatal("exec_stcode: illegal instruction %u %s (index=%d)", shaderopcode::getOp(opc),
+        ShUtils::shcod_tokname(shaderopcode::getOp(opc)), idx);
+  }
+  return 0;
+}
+
+inline void exec_stcode_ops(StcodeExecState &st, dag::ConstSpan<int> cod)
+{
+  for (int i = 0, n = cod.size(); i < n; i++)
+    i += exec_stcode_op(st, cod.data(), i);
+}
+
+typedef void (*stcode_native_routine_t)(StcodeExecState &st);
+
+// Table of native stcode routines, generated by shader compiler with -stcodeCpp option. It is used only for shaders dump
+// with same stcode hash (see StcodeHash in shaders/shStcodeHash.h), routines are indexed by stcodeId, null for stcode which
+// is not used.
+struct StcodeNativeTable
+{
+  uint64_t stcodeHash;
+  const stcode_native_routine_t *routines;
+  int count;
+  StcodeNativeTable *next;
+};
+
+// called from static constructor of generated file
+void register_native_stcode(StcodeNativeTable &table);
+const StcodeNativeTable *find_native_stcode(uint64_t stcode_hash);
+
+namespace shaderbindump
+{
+// routines of registered table which matches main dump, empty when there is no such table or it is disabled
+extern dag::ConstSpan<stcode_native_routine_t> nativeStcode;
+} // namespace shaderbindump
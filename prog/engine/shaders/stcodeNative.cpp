@@ -0,0 +1,47 @@
+#include "stcodeExec.h"
+#include <shaders/shStcodeHash.h>
+#include <startup/dag_globalSettings.h>
+#include <ioSys/dag_dataBlock.h>
+#include <debug/dag_debug.h>
+
+static StcodeNativeTable *native_tables = nullptr;
+
+dag::ConstSpan<stcode_native_routine_t> shaderbindump::nativeStcode;
+
+void register_native_stcode(StcodeNativeTable &table)
+{
+  table.next = native_tables;
+  native_tables = &table;
+}
+
+const StcodeNativeTable *find_native_stcode(uint64_t stcode_hash)
+{
+  for (const StcodeNativeTable *t = native_tables; t; t = t->next)
+    if (t->stcodeHash == stcode_hash)
+      return t;
+  return nullptr;
+}
+
+void shaderbindump::init_native_stcode(const ScriptedShadersBinDump *dump)
+{
+  nativeStcode.reset();
+  if (!dump || !native_tables)
+    return;
+  if (dgs_get_settings() && !dgs_get_settings()->getBlockByNameEx("graphics")->getBool("nativeStcode", true))
+  {
+    debug("[SH] native stcode is disabled");
+    return;
+  }
+
+  StcodeHash hash;
+  for (int i = 0; i < dump->stcode.size(); i++)
+    hash.add(dump->stcode[i]);
+  const StcodeNativeTable *table = find_native_stcode(hash.val);
+  if (!table || table->count != dump->stcode.size())
+  {
+    logwarn("[SH] no native stcode for shaders dump with stcode hash %016llX, stcode is interpreted", (unsigned long long)hash.val);
+    return;
+  }
+  nativeStcode.set(table->routines, table->count);
+  debug("[SH] using native stcode for %d stcode entries", table->count);
+}
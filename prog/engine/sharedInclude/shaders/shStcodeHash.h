@@ -0,0 +1,18 @@
+#pragma once
+
+#include <util/dag_hash.h>
+#include <generic/dag_span.h>
+
+// Hash of all stcode of shaders dump, calculated by shader compiler when it generates native stcode routines and by engine
+// when dump is loaded. Routines are used only when hashes match, as they are compiled from exactly this stcode.
+struct StcodeHash
+{
+  uint64_t val = FNV1Params<64>::offset_basis;
+
+  void add(dag::ConstSpan<int> cod)
+  {
+    val = fnv1a_step<64>(cod.size(), val);
+    for (int c : cod)
+      val = fnv1a_step<64>(uint32_t(c), val);
+  }
+};
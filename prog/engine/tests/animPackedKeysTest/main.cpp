@@ -0,0 +1,209 @@
+// Round trip of packed (KEYFMT_PACKED16) animation keys: known position and rotation tracks are quantized with
+// AnimV20Math::encode_packed_key() and sampled back with AnimV20Math::sample_chan() (vecmath decode and interpolation), both
+// at key times and between keys; error must stay within bounds given by 16-bit quantization step.
+// usage: testAnimPackedKeys-dev
+#include <startup/dag_mainCon.inc.cpp>
+#include <math/dag_Point3.h>
+#include <anim/dag_animKeyInterp.h>
+#include <math/random/dag_random.h>
+#include <math.h>
+#include <stdio.h>
+
+using namespace AnimV20;
+
+static int failed = 0;
+#define TEST_CHECK(c)                                            \
+  do                                                             \
+    if (!(c))                                                    \
+    {                                                            \
+      printf("FAILED: %s (%s:%d)\n", #c, __FUNCTION__, __LINE__); \
+      failed++;                                                  \
+    }                                                            \
+  while (0)
+
+static constexpr int KEY_NUM = 256;
+
+// key times with uneven spacing, in keyTime16 units
+static void make_key_times(uint16_t *times, int &seed)
+{
+  times[0] = 2;
+  for (int i = 1; i < KEY_NUM; i++)
+    times[i] = times[i - 1] + _rnd_int(seed, 1, 6);
+}
+
+// sample times: every key, several points between keys, before first and after last key
+template <class CB>
+static void for_each_sample(const uint16_t *times, CB cb)
+{
+  cb(0, 0, 0.f);
+  for (int i = 0; i < KEY_NUM; i++)
+  {
+    const int t0 = times[i] << TIME_SubdivExp;
+    cb(t0, i, 0.f);
+    if (i + 1 == KEY_NUM)
+      break;
+    const int t1 = times[i + 1] << TIME_SubdivExp;
+    for (int s = 1; s < 4; s++)
+    {
+      const int t32 = t0 + (t1 - t0) * s / 4 + (s == 2 ? 1 : 0);
+      cb(t32, i, float(t32 - t0) / float(t1 - t0));
+    }
+  }
+  cb((times[KEY_NUM - 1] + 10) << TIME_SubdivExp, KEY_NUM - 1, 0.f);
+}
+
+static void test_point3(const char *name, const vec3f *src, float *out_max_err_in_steps)
+{
+  int seed = 100;
+  uint16_t times[KEY_NUM];
+  make_key_times(times, seed);
+
+  vec3f bmin = src[0], bmax = src[0];
+  for (int i = 1; i < KEY_NUM; i++)
+    bmin = v_min(bmin, src[i]), bmax = v_max(bmax, src[i]);
+  struct
+  {
+    AnimPackedKeyRange range;
+    AnimPackedKey keys[KEY_NUM];
+  } data;
+  data.range.ofs = v_perm_xyzd(bmin, v_zero());
+  data.range.scale = v_perm_xyzd(v_div(v_sub(bmax, bmin), v_splats(65535.f)), v_zero());
+  for (int i = 0; i < KEY_NUM; i++)
+    data.keys[i] = AnimV20Math::encode_packed_key(data.range, src[i]);
+
+  AnimChanPoint3 ch;
+  ch.key.setPtr(&data);
+  ch.keyTime16 = times;
+  ch.keyNum = KEY_NUM;
+  ch.keyFmt = KEYFMT_PACKED16;
+
+  // half of quantization step per component, plus float rounding of ofs + v * scale
+  alignas(16) float step[4], lim[4];
+  v_st(step, data.range.scale);
+  v_st(lim, v_max(v_abs(bmin), v_abs(bmax)));
+  float bound[3];
+  for (int c = 0; c < 3; c++)
+    bound[c] = step[c] * 0.5f + lim[c] * 4 * FLT_EPSILON;
+
+  float maxErr = 0;
+  int samples = 0;
+  for_each_sample(times, [&](int t32, int key, float t) {
+    vec3f ref = t != 0.f ? v_lerp_vec4f(v_splats(t), src[key], src[key + 1]) : src[key];
+    alignas(16) float d[4];
+    v_st(d, v_abs(v_sub(AnimV20Math::sample_chan(ch, t32), ref)));
+    for (int c = 0; c < 3; c++)
+    {
+      TEST_CHECK(d[c] <= bound[c]);
+      if (step[c] > 0)
+        maxErr = max(maxErr, d[c] / step[c]);
+    }
+    samples++;
+  });
+  printf("point3 %-8s: %d samples, max error %.3f of quantization step\n", name, samples, maxErr);
+  *out_max_err_in_steps = maxErr;
+}
+
+// rotation angle between quats, q and -q are the same rotation
+static float quat_angle(quat4f a, quat4f b)
+{
+  vec4f d = v_extract_x(v_dot4_x(a, b)) < 0 ? v_add(a, b) : v_sub(a, b);
+  return 4 * asinf(min(v_extract_x(v_length4_x(d)) * 0.5f, 1.f));
+}
+
+static void test_quat()
+{
+  int seed = 200;
+  uint16_t times[KEY_NUM];
+  make_key_times(times, seed);
+
+  // smooth rotation plus keys dominated by each component with both signs, to cover all encodings of largest component
+  quat4f src[KEY_NUM];
+  for (int i = 0; i < KEY_NUM; i++)
+  {
+    alignas(16) float q[4];
+    if (i < KEY_NUM / 2)
+    {
+      const float a = i * 0.05f;
+      Point3 axis = normalize(Point3(sinf(a), 1.f, cosf(a * 0.7f)));
+      const float s = sinf(a * 0.5f);
+      q[0] = axis.x * s, q[1] = axis.y * s, q[2] = axis.z * s, q[3] = cosf(a * 0.5f);
+    }
+    else
+    {
+      for (int c = 0; c < 4; c++)
+        q[c] = _rnd_float(seed, -0.5f, 0.5f);
+      q[i & 3] = (i & 4) ? -1.f : 1.f;
+    }
+    src[i] = v_norm4(v_ld(q));
+  }
+
+  AnimPackedKey keys[KEY_NUM];
+  int largestUsed[8] = {};
+  for (int i = 0; i < KEY_NUM; i++)
+  {
+    keys[i] = AnimV20Math::encode_packed_key(src[i]);
+    alignas(16) float q[4];
+    v_st(q, src[i]);
+    largestUsed[keys[i].v[0] * 2 + (q[keys[i].v[0]] < 0 ? 1 : 0)]++;
+  }
+  for (int n : largestUsed)
+    TEST_CHECK(n > 0);
+
+  AnimChanQuat ch;
+  ch.key.setPtr(keys);
+  ch.keyTime16 = times;
+  ch.keyNum = KEY_NUM;
+  ch.keyFmt = KEYFMT_PACKED16;
+
+  // 3 stored components are off by at most half step e, restored largest one (>= 1/2) by at most 3e,
+  // so chord between quats is within sqrt(12)*e and rotation angle within twice of it; plus float rounding
+  const float e = AnimV20Math::PACKED_QUAT_COMP_SCALE * 0.5f;
+  const float keyBound = 2 * sqrtf(12.f) * e + 2e-6f;
+  float maxKeyErr = 0, maxInterpErr = 0;
+  for_each_sample(times, [&](int t32, int key, float t) {
+    quat4f v = AnimV20Math::sample_chan(ch, t32);
+    TEST_CHECK(fabsf(v_extract_x(v_length4_x(v)) - 1.f) < 1e-5f);
+    if (t == 0.f)
+    {
+      const float err = quat_angle(v, src[key]);
+      TEST_CHECK(err <= keyBound);
+      maxKeyErr = max(maxKeyErr, err);
+    }
+    else
+    {
+      // interpolation of packed keys (qslerp of endpoints, each within keyBound) vs the same interpolation of source keys
+      const float err = quat_angle(v, v_quat_qslerp(t, src[key], src[key + 1]));
+      TEST_CHECK(err <= keyBound);
+      maxInterpErr = max(maxInterpErr, err);
+    }
+  });
+  printf("quat          : max error %.5f deg at keys, %.5f deg between keys, bound %.5f deg\n", maxKeyErr * RAD_TO_DEG,
+    maxInterpErr * RAD_TO_DEG, keyBound * RAD_TO_DEG);
+}
+
+int DagorWinMain(bool /*debugmode*/)
+{
+  int seed = 300;
+  vec3f src[KEY_NUM];
+  float maxErr = 0;
+
+  // large offset and range, small range (nearly constant component) and negative values
+  for (int i = 0; i < KEY_NUM; i++)
+    src[i] = v_make_vec4f(1000.f + sinf(i * 0.1f) * 250.f, 0.001f * cosf(i * 0.07f), -5.f - i * 0.5f, 0);
+  test_point3("smooth", src, &maxErr);
+  TEST_CHECK(maxErr > 0.f);
+
+  for (int i = 0; i < KEY_NUM; i++)
+    src[i] = v_make_vec4f(_rnd_float(seed, -1.f, 1.f), _rnd_float(seed, -100.f, 100.f), _rnd_float(seed, 0.f, 0.01f), 0);
+  test_point3("random", src, &maxErr);
+
+  // constant component has zero range and must be restored exactly
+  for (int i = 0; i < KEY_NUM; i++)
+    src[i] = v_make_vec4f(1.f, 3.25f, i * 0.125f, 0);
+  test_point3("const", src, &maxErr);
+
+  test_quat();
+
+  printf("%s\n", failed ? "FAILED" : "OK");
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,125 @@
+// Read throughput of async file reading backends (POSIX AIO vs io_uring) over set of files, e.g. GRP packs and vromfs.
+// usage: testAsyncReadBench-dev <file1> [file2 ...]
+// For cold-cache numbers drop page cache before each run (sync; echo 3 > /proc/sys/vm/drop_caches), otherwise
+// second pass over same files measures per-request overhead of backend rather than device speed.
+#include <startup/dag_mainCon.inc.cpp>
+#include <osApiWrappers/dag_asyncRead.h>
+#include <ioSys/dag_fastSeqRead.h>
+#include <perfMon/dag_cpuFreq.h>
+#include <debug/dag_log.h>
+#include <generic/dag_tab.h>
+#include <util/dag_string.h>
+#include <stdio.h>
+
+static char read_buf[64 << 10];
+
+static int64_t read_fast_seq(const char *fn)
+{
+  FastSeqReadCB crd;
+  if (!crd.open(fn))
+  {
+    printf("  cannot open %s\n", fn);
+    return 0;
+  }
+  int64_t total = 0;
+  for (int sz = crd.getSize(); sz > 0;)
+  {
+    int chunk = sz < (int)sizeof(read_buf) ? sz : (int)sizeof(read_buf);
+    crd.read(read_buf, chunk);
+    sz -= chunk;
+    total += chunk;
+  }
+  return total;
+}
+
+// like AsyncLoadCB users: several independent outstanding requests of fixed size
+static int64_t read_parallel(const char *fn, int inflight, int block_sz)
+{
+  void *h = dfa_open_for_read(fn, false);
+  if (!h)
+    return 0;
+  int len = dfa_file_length(h);
+  Tab<char *> bufs;
+  Tab<int> handles, sizes;
+  for (int i = 0; i < inflight; i++)
+  {
+    bufs.push_back((char *)tmpmem->allocAligned(block_sz, 4096));
+    handles.push_back(dfa_alloc_asyncdata());
+    sizes.push_back(-1);
+  }
+  int64_t total = 0;
+  int next = 0, pending = 0;
+  do
+  {
+    dfa_begin_read_batch();
+    for (int i = 0; i < inflight; i++)
+      if (sizes[i] < 0 && next < len && dfa_read_async(h, handles[i], next, bufs[i], block_sz))
+      {
+        sizes[i] = 0, pending++;
+        next += block_sz;
+      }
+    dfa_end_read_batch();
+    for (int i = 0; i < inflight; i++)
+      if (sizes[i] >= 0 && dfa_check_complete(handles[i], &sizes[i]))
+      {
+        if (sizes[i] < 0)
+          fatal("read error %d in %s", sizes[i], fn);
+        int again = 0; // completion must be reported again until handle is reused
+        if (!dfa_check_complete(handles[i], &again) || again != sizes[i])
+          fatal("repeated dfa_check_complete gave %d instead of %d in %s", again, sizes[i], fn);
+        total += sizes[i];
+        sizes[i] = -1, pending--;
+      }
+  } while (pending || next < len);
+
+  for (int i = 0; i < inflight; i++)
+  {
+    dfa_free_asyncdata(handles[i]);
+    tmpmem->freeAligned(bufs[i]);
+  }
+  dfa_close(h);
+  return total;
+}
+
+static void report(const char *backend, const char *mode, int64_t bytes, int64_t ref)
+{
+  int usec = get_time_usec(ref);
+  printf("%-9s %-26s %8.1f MB in %8.1f ms: %8.1f MB/s\n", backend, mode, bytes / 1048576.0, usec / 1000.0,
+    usec ? bytes / 1048576.0 / (usec / 1e6) : 0.0);
+}
+
+int DagorWinMain(bool /*debugmode*/)
+{
+  if (dgs_argc < 2)
+  {
+    printf("usage: %s <file1> [file2 ...]\n", dgs_argv[0]);
+    return 1;
+  }
+
+  for (int pass = 0; pass < 2; pass++)
+    for (bool uring : {false, true})
+    {
+      bool used = dfa_use_io_uring(uring);
+      if (uring && !used)
+      {
+        printf("io_uring is not available, skipped\n");
+        continue;
+      }
+      const char *backend = used ? "io_uring" : "posix_aio";
+      printf("-- pass %d, %s\n", pass, backend);
+
+      int64_t ref = ref_time_ticks(), bytes = 0;
+      for (int i = 1; i < dgs_argc; i++)
+        bytes += read_fast_seq(dgs_argv[i]);
+      report(backend, "FastSeqReader", bytes, ref);
+
+      for (int inflight : {1, 8, 32})
+      {
+        ref = ref_time_ticks(), bytes = 0;
+        for (int i = 1; i < dgs_argc; i++)
+          bytes += read_parallel(dgs_argv[i], inflight, 256 << 10);
+        report(backend, String(0, "dfa_read_async x%d 256K", inflight), bytes, ref);
+      }
+    }
+  return 0;
+}
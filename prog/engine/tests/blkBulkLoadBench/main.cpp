@@ -0,0 +1,143 @@
+// Serial dblk::load() vs dblk::load_many() over BLK corpus; also verifies that both paths give identical BLKs.
+// usage: testBlkBulkLoadBench-dev [corpus_dir]
+// Without corpus_dir synthetic corpus (templates-like BLKs sharing common includes) is generated in ./_blkBulkCorpus
+#include <startup/dag_mainCon.inc.cpp>
+#include <ioSys/dag_dataBlock.h>
+#include <ioSys/dag_findFiles.h>
+#include <ioSys/dag_fileIo.h>
+#include <ioSys/dag_memIo.h>
+#include <osApiWrappers/dag_direct.h>
+#include <osApiWrappers/dag_cpuJobs.h>
+#include <util/dag_threadPool.h>
+#include <perfMon/dag_cpuFreq.h>
+#include <math/random/dag_random.h>
+#include <generic/dag_tab.h>
+#include <util/dag_simpleString.h>
+#include <util/dag_string.h>
+#include <EASTL/algorithm.h>
+#include <stdio.h>
+
+static constexpr int SYNTH_FILES = 4000;
+static constexpr int SYNTH_INCLUDES = 24;
+
+static void write_text(const char *fn, const String &text)
+{
+  FullFileSaveCB cwr(fn);
+  if (!cwr.fileHandle)
+    fatal("cannot write %s", fn);
+  cwr.write(text.data(), text.length());
+}
+
+static void gen_params(String &out, int &seed, int cnt, int indent)
+{
+  for (int i = 0; i < cnt; i++)
+  {
+    out.aprintf(0, "%*s", indent, "");
+    switch (_rnd_int(seed, 0, 4))
+    {
+      case 0: out.aprintf(0, "real%d:r=%g\n", _rnd_int(seed, 0, 300), _frnd(seed) * 100); break;
+      case 1: out.aprintf(0, "int%d:i=%d\n", _rnd_int(seed, 0, 300), _rnd(seed)); break;
+      case 2: out.aprintf(0, "pos%d:p3=%g, %g, %g\n", _rnd_int(seed, 0, 300), _frnd(seed), _frnd(seed), _frnd(seed)); break;
+      case 3: out.aprintf(0, "flag%d:b=%s\n", _rnd_int(seed, 0, 300), _rnd(seed) & 1 ? "yes" : "no"); break;
+      default: out.aprintf(0, "name%d:t=\"value_%d\"\n", _rnd_int(seed, 0, 300), _rnd_int(seed, 0, 10000)); break;
+    }
+  }
+}
+
+static void gen_corpus(const char *dir, Tab<SimpleString> &files)
+{
+  dd_mkpath(String(0, "%s/common/", dir));
+  int seed = 12345;
+  for (int i = 0; i < SYNTH_INCLUDES; i++)
+  {
+    String text;
+    gen_params(text, seed, 60, 0);
+    text.aprintf(0, "common_block%d{\n", i);
+    gen_params(text, seed, 40, 2);
+    text.aprintf(0, "}\n");
+    write_text(String(0, "%s/common/inc%d.blk", dir, i), text);
+  }
+  for (int i = 0; i < SYNTH_FILES; i++)
+  {
+    String text;
+    text.aprintf(0, "include \"common/inc%d.blk\"\n", _rnd_int(seed, 0, SYNTH_INCLUDES - 1));
+    gen_params(text, seed, 30, 0);
+    for (int b = 0, bn = _rnd_int(seed, 2, 6); b < bn; b++)
+    {
+      text.aprintf(0, "block%d{\n", _rnd_int(seed, 0, 40));
+      gen_params(text, seed, _rnd_int(seed, 5, 30), 2);
+      if (_rnd(seed) & 1)
+        text.aprintf(0, "  include \"common/inc%d.blk\"\n", _rnd_int(seed, 0, SYNTH_INCLUDES - 1));
+      text.aprintf(0, "}\n");
+    }
+    String fn(0, "%s/file%04d.blk", dir, i);
+    write_text(fn, text);
+    files.push_back() = fn.str();
+  }
+}
+
+static String dump_text(const DataBlock &blk)
+{
+  DynamicMemGeneralSaveCB cwr(tmpmem, 0, 64 << 10);
+  blk.saveToTextStream(cwr);
+  return String::mk_sub_str((const char *)cwr.data(), (const char *)cwr.data() + cwr.size());
+}
+
+int DagorWinMain(bool /*debugmode*/)
+{
+  cpujobs::init();
+  threadpool::init(eastl::min(cpujobs::get_core_count(), 64), 2048, 128 << 10);
+
+  Tab<SimpleString> files;
+  if (dgs_argc > 1)
+    find_files_in_folder(files, dgs_argv[1], ".blk", false, true, true);
+  else
+    gen_corpus("_blkBulkCorpus", files);
+  if (files.empty())
+  {
+    printf("no BLK files found\n");
+    return 1;
+  }
+
+  Tab<const char *> fnames;
+  for (const SimpleString &fn : files)
+    fnames.push_back(fn.str());
+  printf("%d BLK files, %d threadpool workers\n", (int)fnames.size(), threadpool::get_num_workers());
+
+  Tab<DataBlock> serial, bulk;
+  Tab<DataBlock *> bulkPtr;
+  for (int pass = 0; pass < 3; pass++) // first pass warms up file cache
+  {
+    serial.clear();
+    serial.resize(fnames.size());
+    int64_t ref = ref_time_ticks();
+    int serialOk = 0;
+    for (int i = 0; i < fnames.size(); i++)
+      serialOk += dblk::load(serial[i], fnames[i], dblk::ReadFlag::ROBUST);
+    int serialUs = get_time_usec(ref);
+
+    bulk.clear();
+    bulk.resize(fnames.size());
+    bulkPtr.clear();
+    for (DataBlock &b : bulk)
+      bulkPtr.push_back(&b);
+    ref = ref_time_ticks();
+    int bulkOk = dblk::load_many(bulkPtr, fnames, dblk::ReadFlag::ROBUST);
+    int bulkUs = get_time_usec(ref);
+
+    printf("pass %d: serial %d files in %.1f ms, load_many %d files in %.1f ms (x%.2f)\n", pass, serialOk, serialUs / 1000.0, bulkOk,
+      bulkUs / 1000.0, bulkUs ? double(serialUs) / bulkUs : 0.0);
+  }
+
+  int mismatches = 0;
+  for (int i = 0; i < fnames.size(); i++)
+    if (serial[i] != bulk[i] || dump_text(serial[i]) != dump_text(bulk[i]))
+    {
+      if (++mismatches < 10)
+        printf("MISMATCH: %s\n", fnames[i]);
+    }
+  printf("%d mismatches\n", mismatches);
+
+  threadpool::shutdown();
+  return mismatches ? 1 : 0;
+}
@@ -0,0 +1,228 @@
+// Checks dblk::Schema reading against plain DataBlock::getXXX() calls: values of all supported types, defaults of absent
+// fields, required/bad-typed/unknown params report, and that cached name ids follow changes of BLK name map.
+// usage: testBlkSchema-dev
+#include <startup/dag_mainCon.inc.cpp>
+#include <ioSys/dag_dataBlock.h>
+#include <ioSys/dag_dataBlockSchema.h>
+#include <math/dag_Point2.h>
+#include <math/dag_Point3.h>
+#include <math/dag_Point4.h>
+#include <math/integer/dag_IPoint2.h>
+#include <math/integer/dag_IPoint3.h>
+#include <math/dag_TMatrix.h>
+#include <math/dag_e3dColor.h>
+#include <util/dag_string.h>
+#include <string.h>
+#include <stdio.h>
+
+static int failed = 0;
+#define TEST_CHECK(c)                                            \
+  do                                                             \
+    if (!(c))                                                    \
+    {                                                            \
+      printf("FAILED: %s (%s:%d)\n", #c, __FUNCTION__, __LINE__); \
+      failed++;                                                  \
+    }                                                            \
+  while (0)
+
+struct Props
+{
+  int count = -1;
+  float speed = -1.f;
+  bool enabled = false;
+  E3DCOLOR color = E3DCOLOR(1, 2, 3, 4);
+  int64_t big = -1;
+  IPoint2 cell = IPoint2(-1, -1);
+  IPoint3 cell3 = IPoint3(-1, -1, -1);
+  Point2 uv = Point2(-1, -1);
+  Point3 pos = Point3(-1, -1, -1);
+  Point4 plane = Point4(-1, -1, -1, -1);
+  TMatrix tm = TMatrix::IDENT;
+  const char *name = "def";
+};
+
+// exposes count of name map bindings (cache misses) of schema
+struct ProbedSchema : public dblk::Schema<Props>
+{
+  using dblk::Schema<Props>::Schema;
+  uint32_t bindCount() const { return cacheNext; }
+};
+
+static const ProbedSchema schema{{"count", &Props::count, true}, {"speed", &Props::speed}, {"enabled", &Props::enabled},
+  {"color", &Props::color}, {"big", &Props::big}, {"cell", &Props::cell}, {"cell3", &Props::cell3}, {"uv", &Props::uv},
+  {"pos", &Props::pos}, {"plane", &Props::plane}, {"tm", &Props::tm}, {"name", &Props::name}};
+
+static int field_idx(const char *name)
+{
+  for (int i = 0; i < schema.fieldCount(); i++)
+    if (strcmp(schema.getFieldName(i), name) == 0)
+      return i;
+  return -1;
+}
+static uint64_t field_bit(const char *name) { return uint64_t(1) << field_idx(name); }
+
+static bool load_text(DataBlock &blk, const char *text) { return blk.loadText(text, (int)strlen(text)); }
+
+// what getXXX(name, def) chain gives, with defaults taken from Props
+static Props read_with_getters(const DataBlock &blk)
+{
+  Props p, d;
+  p.count = blk.getInt("count", d.count);
+  p.speed = blk.getReal("speed", d.speed);
+  p.enabled = blk.getBool("enabled", d.enabled);
+  p.color = blk.getE3dcolor("color", d.color);
+  p.big = blk.getInt64("big", d.big);
+  p.cell = blk.getIPoint2("cell", d.cell);
+  p.cell3 = blk.getIPoint3("cell3", d.cell3);
+  p.uv = blk.getPoint2("uv", d.uv);
+  p.pos = blk.getPoint3("pos", d.pos);
+  p.plane = blk.getPoint4("plane", d.plane);
+  p.tm = blk.getTm("tm", d.tm);
+  p.name = blk.getStr("name", d.name);
+  return p;
+}
+
+static bool same_props(const Props &a, const Props &b)
+{
+  bool same = a.count == b.count && a.speed == b.speed && a.enabled == b.enabled && a.color == b.color && a.big == b.big &&
+              a.cell == b.cell && a.cell3 == b.cell3 && a.uv == b.uv && a.pos == b.pos && a.plane == b.plane &&
+              strcmp(a.name, b.name) == 0;
+  for (int i = 0; i < 4; i++)
+    same &= a.tm.getcol(i) == b.tm.getcol(i);
+  return same;
+}
+
+static const char *full_blk = "unknown1:i=7\n"
+                              "tm:m=[[1, 0, 0] [0, 0, 1] [0, -1, 0] [10, 20, 30]]\n"
+                              "name:t=\"tank\"\n"
+                              "plane:p4=0, 1, 0, -5\n"
+                              "pos:p3=1.5, -2, 3.25\n"
+                              "uv:p2=0.25, 0.75\n"
+                              "cell3:ip3=4, 5, 6\n"
+                              "cell:ip2=-7, 8\n"
+                              "big:i64=1099511627776\n"
+                              "color:c=10, 20, 30, 40\n"
+                              "enabled:b=yes\n"
+                              "speed:r=12.5\n"
+                              "count:i=42\n"
+                              "count:i=43\n" // only first param with given name is used
+                              "unknown2:r=1\n"
+                              "sub{ count:i=100; }\n";
+
+static void test_values()
+{
+  DataBlock blk;
+  TEST_CHECK(load_text(blk, full_blk));
+
+  Props p;
+  dblk::SchemaReadReport report;
+  TEST_CHECK(schema.read(blk, p, &report));
+  TEST_CHECK(report.ok());
+  TEST_CHECK(report.readMask == (uint64_t(1) << schema.fieldCount()) - 1);
+  TEST_CHECK(report.unknownCount == 2); // params of sub-block are not counted
+  TEST_CHECK(same_props(p, read_with_getters(blk)));
+  TEST_CHECK(p.count == 42 && p.big == (int64_t(1) << 40) && strcmp(p.name, "tank") == 0);
+  TEST_CHECK(p.name == blk.getStr("name", nullptr)); // string points into BLK data, as getStr() does
+}
+
+static void test_defaults()
+{
+  DataBlock blk;
+  TEST_CHECK(load_text(blk, "speed:r=3\nextra:t=\"x\"\n"));
+
+  Props p;
+  dblk::SchemaReadReport report;
+  TEST_CHECK(!schema.read(blk, p, &report)); // required count is missing
+  TEST_CHECK(report.missingMask == field_bit("count"));
+  TEST_CHECK(report.readMask == field_bit("speed") && !report.badTypeMask && report.unknownCount == 1);
+  TEST_CHECK(same_props(p, read_with_getters(blk)));
+
+  DataBlock empty;
+  Props e;
+  TEST_CHECK(!schema.read(empty, e, &report));
+  TEST_CHECK(!report.readMask && report.missingMask == field_bit("count") && !report.unknownCount);
+  TEST_CHECK(same_props(e, Props()));
+}
+
+static void test_bad_type()
+{
+  DataBlock blk;
+  TEST_CHECK(load_text(blk, "count:i64=-5\nbig:i=-6\nspeed:i=1\npos:p2=1, 2\n"));
+
+  // int64 that fits into int and int into int64 field are converted exactly as DataBlock::getInt()/getInt64() do
+  Props p;
+  dblk::SchemaReadReport report;
+  TEST_CHECK(!schema.read(blk, p, &report));
+  TEST_CHECK(report.badTypeMask == (field_bit("speed") | field_bit("pos")));
+  TEST_CHECK(report.readMask == (field_bit("count") | field_bit("big")));
+  TEST_CHECK(p.count == -5 && p.count == blk.getInt("count", 0) && p.big == blk.getInt64("big", 0));
+  TEST_CHECK(p.speed == Props().speed && p.pos == Props().pos); // left unchanged
+
+  DataBlock overflow;
+  TEST_CHECK(load_text(overflow, "count:i64=4294967296\n"));
+  Props o;
+  TEST_CHECK(!schema.read(overflow, o, &report));
+  TEST_CHECK(report.badTypeMask == field_bit("count") && o.count == Props().count);
+}
+
+static void test_name_cache()
+{
+  DataBlock blk;
+  TEST_CHECK(load_text(blk, full_blk));
+
+  // repeated reads of block and of its sub-blocks (same name map) bind names once
+  const uint32_t bind0 = schema.bindCount();
+  Props p;
+  for (int i = 0; i < 3; i++)
+    TEST_CHECK(schema.read(blk, p));
+  Props sub;
+  dblk::SchemaReadReport report;
+  schema.read(*blk.getBlockByName("sub"), sub, &report);
+  TEST_CHECK(report.ok() && sub.count == 100 && sub.count == blk.getBlockByName("sub")->getInt("count", 0));
+  TEST_CHECK(schema.bindCount() == bind0 + 1);
+
+  // new names in name map rebind, values stay the same
+  blk.setInt("unknown3", 1);
+  blk.setReal("speed", 77.f);
+  TEST_CHECK(schema.read(blk, p));
+  TEST_CHECK(schema.bindCount() == bind0 + 2);
+  TEST_CHECK(same_props(p, read_with_getters(blk)) && p.speed == 77.f);
+
+  // reloading gives different name ids for the same names; ids cached for previous name map must not be used
+  TEST_CHECK(load_text(blk, "zzz:i=1\nname:t=\"plane\"\ncount:i=9\nspeed:r=0.5\nunknown1:i=7\n"));
+  Props r;
+  TEST_CHECK(schema.read(blk, r, &report));
+  TEST_CHECK(schema.bindCount() == bind0 + 3);
+  TEST_CHECK(report.readMask == (field_bit("count") | field_bit("speed") | field_bit("name")) && report.unknownCount == 2);
+  TEST_CHECK(same_props(r, read_with_getters(blk)) && r.count == 9 && strcmp(r.name, "plane") == 0);
+
+  // more name maps than cache slots, read in turn; every read must match getters
+  static constexpr int BLK_COUNT = 7;
+  DataBlock blks[BLK_COUNT];
+  for (int i = 0; i < BLK_COUNT; i++)
+  {
+    String text;
+    for (int j = 0; j < i; j++) // shifts name ids of fields
+      text.aprintf(0, "pad%d:i=%d\n", j, j);
+    text.aprintf(0, "%s\ncount:i=%d\npos:p3=%d, 0, 0\n", i & 1 ? "enabled:b=yes" : "name:t=\"n\"", i, i);
+    TEST_CHECK(load_text(blks[i], text));
+  }
+  for (int pass = 0; pass < 3; pass++)
+    for (int i = 0; i < BLK_COUNT; i++)
+    {
+      Props b;
+      TEST_CHECK(schema.read(blks[i], b, &report));
+      TEST_CHECK(report.unknownCount == i);
+      TEST_CHECK(same_props(b, read_with_getters(blks[i])) && b.count == i && b.pos.x == i);
+    }
+}
+
+int DagorWinMain(bool /*debugmode*/)
+{
+  test_values();
+  test_defaults();
+  test_bad_type();
+  test_name_cache();
+  printf("%s\n", failed ? "FAILED" : "OK");
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,192 @@
+// Ray by ray CollisionResource::traceRay() vs packet CollisionResource::traceMultiRay() on synthetic collision resource, shots of
+// many rays against one instance like shotgun hits or fragmentation; also verifies that both give identical results.
+// usage: testCollResTraceBench-dev [rays_per_shot]
+#include <startup/dag_mainCon.inc.cpp>
+#include <gameRes/dag_collisionResource.h>
+#include <perfMon/dag_cpuFreq.h>
+#include <math/random/dag_random.h>
+#include <math/dag_mathBase.h>
+#include <vecmath/dag_vecMath.h>
+#include <generic/dag_tab.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+static constexpr int NODES_COUNT = 24;
+static constexpr int SHOTS_COUNT = 4000;
+static constexpr float SHOT_DIST = 40.f;
+
+// uv spheres of different tessellation, both light and heavy (with batch bounding checks) nodes
+static void gen_collres(CollisionResource &res)
+{
+  int seed = 12345;
+  bbox3f fullBox;
+  v_bbox3_init_empty(fullBox);
+  for (int n = 0; n < NODES_COUNT; n++)
+  {
+    const Point3 c(_rnd_float(seed, -4.f, 4.f), _rnd_float(seed, -1.5f, 1.5f), _rnd_float(seed, -2.f, 2.f));
+    const float r = _rnd_float(seed, 0.3f, 1.5f);
+    const int slices = _rnd_int(seed, 4, 32), stacks = slices / 2 + 1;
+
+    // closed mesh (seam vertices are shared), so rays can't pass between triangles
+    const int vertsCount = slices * (stacks + 1), indicesCount = slices * stacks * 6;
+    Point3_vec4 *verts = memalloc_typed<Point3_vec4>(vertsCount, midmem);
+    uint16_t *indices = memalloc_typed<uint16_t>(indicesCount, midmem);
+    for (int i = 0; i <= stacks; i++)
+      for (int j = 0; j < slices; j++)
+      {
+        const float theta = PI * i / stacks, phi = TWOPI * j / slices;
+        const float ringR = i == 0 || i == stacks ? 0.f : sinf(theta);
+        verts[i * slices + j] = c + Point3(ringR * cosf(phi), i == 0 ? 1.f : (i == stacks ? -1.f : cosf(theta)), ringR * sinf(phi)) * r;
+      }
+    uint16_t *ind = indices;
+    for (int i = 0; i < stacks; i++)
+      for (int j = 0; j < slices; j++)
+      {
+        const uint16_t a = i * slices + j, a1 = i * slices + (j + 1) % slices, b = a + slices, b1 = a1 + slices;
+        const uint16_t quad[6] = {a, a1, b, a1, b1, b};
+        memcpy(ind, quad, sizeof(quad));
+        ind += 6;
+      }
+
+    CollisionNode &node = res.createNode();
+    node.type = COLLISION_NODE_TYPE_MESH;
+    node.flags = CollisionNode::IDENT | CollisionNode::ORTHONORMALIZED;
+    node.physMatId = n;
+    node.tm.identity();
+    node.resetVertices({verts, vertsCount});
+    node.resetIndices({indices, indicesCount});
+    node.modelBBox = BBox3(c - Point3(r, r, r), c + Point3(r, r, r));
+    node.boundingSphere = BSphere3(c, r);
+    v_bbox3_add_box(fullBox, v_ldu_bbox3(node.modelBBox));
+  }
+  res.rebuildNodesLL();
+
+  res.vFullBBox = fullBox;
+  v_stu_bbox3(res.boundingBox, fullBox);
+  const float rad = v_extract_x(v_length3_x(v_bbox3_size(fullBox))) * 0.5f;
+  res.vBoundingSphere = v_perm_xyzd(v_bbox3_center(fullBox), v_splats(rad * rad));
+  res.boundingSphereRad = rad;
+}
+
+// shots from random points around resource to random points on it, rays are spread in cone
+static void gen_shots(int rays_per_shot, Tab<CollisionTrace> &traces)
+{
+  int seed = 54321;
+  for (int s = 0; s < SHOTS_COUNT; s++)
+  {
+    Point3 dir(_rnd_float(seed, -1.f, 1.f), _rnd_float(seed, -0.5f, 0.5f), _rnd_float(seed, -1.f, 1.f));
+    dir.normalize();
+    const Point3 target(_rnd_float(seed, -4.f, 4.f), _rnd_float(seed, -1.5f, 1.5f), _rnd_float(seed, -2.f, 2.f));
+    const Point3 from = target - dir * SHOT_DIST;
+    for (int i = 0; i < rays_per_shot; i++)
+    {
+      Point3 rayDir = dir + Point3(_rnd_float(seed, -1.f, 1.f), _rnd_float(seed, -1.f, 1.f), _rnd_float(seed, -1.f, 1.f)) * 0.05f;
+      rayDir.normalize();
+      CollisionTrace &trace = traces.push_back();
+      trace.vFrom = v_ldu(&from.x);
+      trace.vDir = v_ldu(&rayDir.x);
+      trace.t = SHOT_DIST * 2.f;
+      trace.capsuleRadius = 0.f;
+    }
+  }
+}
+
+int DagorWinMain(bool /*debugmode*/)
+{
+  const int raysPerShot = dgs_argc > 1 ? max(atoi(dgs_argv[1]), 1) : 32;
+  CollisionResource res;
+  gen_collres(res);
+  Tab<CollisionTrace> shots;
+  gen_shots(raysPerShot, shots);
+  const int raysCount = shots.size();
+
+  TMatrix instanceTm = rotyTM(0.3f) * rotxTM(0.1f);
+  instanceTm.setcol(3, Point3(100.f, 5.f, -50.f));
+  alignas(16) mat44f tm;
+  v_mat44_make_from_43cu_unsafe(tm, instanceTm.array);
+  for (CollisionTrace &trace : shots)
+  {
+    trace.vFrom = v_mat44_mul_vec3p(tm, trace.vFrom);
+    trace.vDir = v_mat44_mul_vec3v(tm, trace.vDir);
+  }
+
+  // nearest hit
+  Tab<CollisionTrace> rayTraces(shots), multiTraces(shots);
+  int64_t ref = ref_time_ticks();
+  for (CollisionTrace &trace : rayTraces)
+  {
+    Point3 from, dir, norm;
+    v_stu_p3(&from.x, trace.vFrom);
+    v_stu_p3(&dir.x, trace.vDir);
+    trace.isHit = res.traceRay(tm, from, dir, trace.t, &norm, trace.outMatId);
+    trace.norm = norm;
+  }
+  const int rayUs = get_time_usec(ref);
+  ref = ref_time_ticks();
+  for (int s = 0; s < raysCount; s += raysPerShot)
+  {
+    dag::Span<CollisionTrace> traces(multiTraces.data() + s, raysPerShot);
+    res.traceMultiRay(tm, traces);
+  }
+  const int multiUs = get_time_usec(ref);
+
+  int hits = 0, mismatches = 0;
+  for (int i = 0; i < raysCount; i++)
+  {
+    const CollisionTrace &a = rayTraces[i], &b = multiTraces[i];
+    hits += a.isHit;
+    if (a.isHit != b.isHit || (a.isHit && (a.t != b.t || a.outMatId != b.outMatId || a.norm != b.norm)))
+      if (++mismatches < 10)
+        printf("MISMATCH: ray %d hit %d/%d t %g/%g mat %d/%d\n", i, a.isHit, b.isHit, a.t, b.t, a.outMatId, b.outMatId);
+  }
+  printf("nearest hit: %d rays by %d, %d hits, %d mismatches; traceRay %.1f ms, traceMultiRay %.1f ms (x%.2f)\n", raysCount,
+    raysPerShot, hits, mismatches, rayUs / 1000.0, multiUs / 1000.0, multiUs ? double(rayUs) / multiUs : 0.0);
+
+  // all intersections
+  int allHits = 0, allMismatches = 0;
+  CollResIntersectionsType rayIsects;
+  MultirayCollResIntersectionsType multiIsects;
+  ref = ref_time_ticks();
+  for (const CollisionTrace &trace : shots)
+  {
+    Point3 from, dir;
+    v_stu_p3(&from.x, trace.vFrom);
+    v_stu_p3(&dir.x, trace.vDir);
+    res.traceRay(tm, nullptr, from, dir, trace.t, rayIsects, false);
+    allHits += rayIsects.size();
+  }
+  const int allRayUs = get_time_usec(ref);
+  int allMultiUs = 0;
+  for (int s = 0; s < raysCount; s += raysPerShot)
+  {
+    memcpy(multiTraces.data() + s, shots.data() + s, sizeof(CollisionTrace) * raysPerShot);
+    dag::Span<CollisionTrace> traces(multiTraces.data() + s, raysPerShot);
+    ref = ref_time_ticks();
+    res.traceMultiRay(instanceTm, nullptr, traces, multiIsects, true);
+    allMultiUs += get_time_usec(ref);
+
+    for (int i = 0, j = 0; i < raysPerShot; i++)
+    {
+      const CollisionTrace &trace = shots[s + i];
+      Point3 from, dir;
+      v_stu_p3(&from.x, trace.vFrom);
+      v_stu_p3(&dir.x, trace.vDir);
+      res.traceRay(tm, nullptr, from, dir, trace.t, rayIsects, true);
+      for (const IntersectedNode &isect : rayIsects)
+      {
+        const bool same = j < multiIsects.size() && multiIsects[j].rayId == i && multiIsects[j].intersectionT == isect.intersectionT &&
+                          multiIsects[j].collisionNodeId == isect.collisionNodeId;
+        if (!same && ++allMismatches < 10)
+          printf("MISMATCH: all hits of ray %d, intersection %d\n", s + i, j);
+        j++;
+      }
+      if (i == raysPerShot - 1 && j != multiIsects.size() && ++allMismatches < 10)
+        printf("MISMATCH: all hits of shot %d, %d/%d intersections\n", s / raysPerShot, j, (int)multiIsects.size());
+    }
+  }
+  printf("all hits: %d intersections, %d mismatches; traceRay %.1f ms, traceMultiRay %.1f ms (x%.2f)\n", allHits, allMismatches,
+    allRayUs / 1000.0, allMultiUs / 1000.0, allMultiUs ? double(allRayUs) / allMultiUs : 0.0);
+
+  return mismatches || allMismatches ? 1 : 0;
+}
@@ -0,0 +1,313 @@
+// Checks DDSxDecodeQueue (pool and queue of DDSx decoder jobs) with fake jobs, no texture packs needed: order of picked jobs,
+// refresh of cached priorities outside of queue lock, dropping of jobs that are not needed anymore and read-ahead budget,
+// including concurrent allocJob() from several threads.
+// usage: testDDSxDecodeQueue-dev
+#include <startup/dag_mainCon.inc.cpp>
+#include <ddsxDecQueue.h>
+#include <osApiWrappers/dag_cpuJobs.h>
+#include <util/dag_threadPool.h>
+#include <math/random/dag_random.h>
+#include <util/dag_globDef.h>
+#include <EASTL/algorithm.h>
+#include <stdio.h>
+
+// priority of job is taken from tex_prio[] by texture index, as real jobs read it from texture manager
+static constexpr int TEX_COUNT = 16;
+static int tex_prio[TEX_COUNT];
+static int prio_calc_count = 0;
+static void (*on_calc_priorities)() = NULL; // called while priorities are calculated, to change queue meanwhile
+
+struct TestJob
+{
+  typedef int PrioKey;
+
+  volatile int done = 1, queued = 0;
+  int reservedSize = 0;
+  int decodePrio = 0;
+  unsigned queueGen = 0;
+  int tex = 0;
+
+  PrioKey getPrioKey() const { return tex; }
+  static void calcDecodePriorities(const PrioKey *keys, int *out_prio, int cnt)
+  {
+    if (on_calc_priorities)
+      on_calc_priorities();
+    for (int i = 0; i < cnt; i++, prio_calc_count++)
+      out_prio[i] = tex_prio[keys[i]];
+  }
+};
+typedef DDSxDecodeQueue<TestJob> TestQueue;
+
+static int failed = 0;
+#define TEST_CHECK(c)                                            \
+  do                                                             \
+    if (!(c))                                                    \
+    {                                                            \
+      printf("FAILED: %s (%s:%d)\n", #c, __FUNCTION__, __LINE__); \
+      failed++;                                                  \
+    }                                                            \
+  while (0)
+
+static constexpr int JOBS_COUNT = 16;
+
+static void init_queue(TestQueue &queue, TestJob *jobs)
+{
+  queue.jobs = jobs;
+  queue.numJobs = JOBS_COUNT;
+}
+
+static TestJob *alloc_and_queue(TestQueue &queue, int data_sz, int tex, int prio)
+{
+  TestJob *j = queue.allocJob(data_sz, INT_MAX);
+  if (!j)
+    return NULL;
+  j->tex = tex;
+  tex_prio[tex] = prio;
+  OSSpinlockScopedLock lock(queue.queueSL);
+  queue.queueJob(j, prio);
+  return j;
+}
+
+static void test_pick_order()
+{
+  TestJob jobs[JOBS_COUNT];
+  TestQueue queue;
+  init_queue(queue, jobs);
+
+  bool drop = true;
+  TEST_CHECK(!queue.pickJob(drop));
+
+  const int prios[] = {5, INT_MIN, 100, 7, 100 << 16, -3};
+  for (int i = 0; i < countof(prios); i++)
+    alloc_and_queue(queue, 10, i, prios[i]);
+  TEST_CHECK(queue.queuedCount == countof(prios));
+
+  // priority cached at queue time is used until refresh, then change made after job was queued reorders decoding
+  const int calc0 = prio_calc_count;
+  tex_prio[0] = 1000;
+  TestJob *j = queue.pickJob(drop);
+  TEST_CHECK(j && j->tex == 4 && !drop && !j->queued);
+  queue.releaseJob(j);
+  TEST_CHECK(prio_calc_count == calc0); // picking doesn't evaluate priorities
+  TEST_CHECK(queue.refreshPriorities());
+  TEST_CHECK(prio_calc_count == calc0 + countof(prios) - 1);
+
+  const int expected[] = {1000, 100, 7, -3, INT_MIN};
+  for (int e : expected)
+  {
+    j = queue.pickJob(drop);
+    TEST_CHECK(j && j->decodePrio == e && tex_prio[j->tex] == e && !drop && !j->queued);
+    if (j)
+      queue.releaseJob(j);
+  }
+  TEST_CHECK(!queue.refreshPriorities()); // nothing to refresh
+  TEST_CHECK(prio_calc_count == calc0 + countof(prios) - 1);
+  TEST_CHECK(!queue.pickJob(drop));
+  TEST_CHECK(queue.queuedCount == 0 && queue.reservedDataSize == 0);
+  for (const TestJob &j : jobs)
+    TEST_CHECK(j.done && !j.queued && !j.reservedSize);
+}
+
+static void test_drop()
+{
+  TestJob jobs[JOBS_COUNT];
+  TestQueue queue;
+  init_queue(queue, jobs);
+
+  TestJob *a = alloc_and_queue(queue, 10, 0, 1);
+  TestJob *b = alloc_and_queue(queue, 20, 1, TestQueue::DROP_PRIO);
+  TestJob *c = alloc_and_queue(queue, 30, 2, 2);
+  TestJob *d = alloc_and_queue(queue, 40, 3, TestQueue::DROP_PRIO);
+
+  // jobs not needed anymore go first and are reported to be dropped without decoding
+  bool drop = false;
+  TestJob *j = queue.pickJob(drop);
+  TEST_CHECK(j == b && drop);
+  queue.releaseJob(j);
+  TEST_CHECK(queue.reservedDataSize == 10 + 30 + 40);
+
+  // reader unqueues the rest of them before reading more; c is not needed too, but its cached priority is stale till refresh
+  tex_prio[c->tex] = TestQueue::DROP_PRIO;
+  TestJob *dropped[JOBS_COUNT];
+  int cnt = queue.unqueueDropped(dropped, countof(dropped));
+  TEST_CHECK(cnt == 1 && dropped[0] == d);
+  queue.refreshPriorities();
+  cnt += queue.unqueueDropped(dropped + cnt, countof(dropped) - cnt);
+  TEST_CHECK(cnt == 2 && dropped[1] == c);
+  TEST_CHECK(queue.queuedCount == 1);
+  for (int i = 0; i < cnt; i++)
+    queue.releaseJob(dropped[i]);
+  TEST_CHECK(queue.reservedDataSize == 10);
+  TEST_CHECK(queue.unqueueDropped(dropped, countof(dropped)) == 0);
+
+  j = queue.pickJob(drop);
+  TEST_CHECK(j == a && !drop);
+  queue.releaseJob(j);
+  TEST_CHECK(queue.queuedCount == 0 && queue.reservedDataSize == 0);
+}
+
+// priorities are calculated without queue lock, so job may be picked and queued again meanwhile; its stale priority must be ignored
+static TestQueue *requeue_queue = NULL;
+static TestJob *requeue_job = NULL;
+static void requeue_while_calculating()
+{
+  bool drop = false;
+  TestJob *j = requeue_queue->pickJob(drop);
+  TEST_CHECK(j == requeue_job);
+  tex_prio[j->tex] = 500;
+  OSSpinlockScopedLock lock(requeue_queue->queueSL);
+  requeue_queue->queueJob(j, 500);
+}
+
+static void test_refresh_race()
+{
+  TestJob jobs[JOBS_COUNT];
+  TestQueue queue;
+  init_queue(queue, jobs);
+
+  TestJob *a = alloc_and_queue(queue, 10, 0, 300);
+  TestJob *b = alloc_and_queue(queue, 10, 1, 200);
+  tex_prio[a->tex] = 1;
+  tex_prio[b->tex] = 100;
+
+  requeue_queue = &queue;
+  requeue_job = a;
+  on_calc_priorities = &requeue_while_calculating;
+  TEST_CHECK(queue.refreshPriorities());
+  on_calc_priorities = NULL;
+
+  // a was re-queued with 500 during refresh, so refreshed value 1 is stale and is not applied; b is refreshed
+  TEST_CHECK(a->queued && a->decodePrio == 500);
+  TEST_CHECK(b->queued && b->decodePrio == 100);
+  bool drop = false;
+  TestJob *j = queue.pickJob(drop);
+  TEST_CHECK(j == a);
+  queue.releaseJob(j);
+  j = queue.pickJob(drop);
+  TEST_CHECK(j == b);
+  queue.releaseJob(j);
+  TEST_CHECK(queue.queuedCount == 0 && queue.reservedDataSize == 0);
+}
+
+static void test_budget()
+{
+  TestJob jobs[JOBS_COUNT];
+  TestQueue queue;
+  init_queue(queue, jobs);
+  const int budget = 100;
+
+  // single job is allowed to exceed budget, so large texture can't stall reading forever
+  TestJob *big = queue.allocJob(150, budget);
+  TEST_CHECK(big && queue.reservedDataSize == 150);
+  TEST_CHECK(!queue.allocJob(1, budget));
+  queue.releaseJob(big);
+
+  // size is reserved by allocJob(), not when job is queued, and is returned by releaseJob() only
+  TestJob *a = queue.allocJob(40, budget);
+  TestJob *b = queue.allocJob(40, budget);
+  TEST_CHECK(a && b && a != b && queue.reservedDataSize == 80);
+  TEST_CHECK(!queue.allocJob(40, budget));
+  TestJob *c = queue.allocJob(20, budget);
+  TEST_CHECK(c && queue.reservedDataSize == 100);
+  TEST_CHECK(!queue.allocJob(1, budget));
+
+  {
+    OSSpinlockScopedLock lock(queue.queueSL);
+    queue.queueJob(a, 0);
+  }
+  bool drop = false;
+  TEST_CHECK(queue.pickJob(drop) == a && queue.reservedDataSize == 100); // still in budget while decoded
+  queue.releaseJob(a);
+  TEST_CHECK(queue.reservedDataSize == 60);
+
+  // budget shrink (e.g. memory quota decrease) stops reading until reserved data is released
+  TEST_CHECK(!queue.allocJob(1, 50));
+  queue.releaseJob(b);
+  TEST_CHECK(!queue.allocJob(31, 50));
+  TestJob *d = queue.allocJob(30, 50);
+  TEST_CHECK(d && queue.reservedDataSize == 50);
+  queue.releaseJob(c);
+
+  // unpacked data replaces packed one and holds more of budget
+  queue.resizeReserved(d, 70);
+  TEST_CHECK(queue.reservedDataSize == 70 && d->reservedSize == 70);
+  TEST_CHECK(!queue.allocJob(1, 50));
+  queue.releaseJob(d);
+  TEST_CHECK(queue.reservedDataSize == 0);
+
+  // pool is exhausted regardless of budget
+  for (int i = 0; i < JOBS_COUNT; i++)
+    TEST_CHECK(queue.allocJob(0, budget));
+  TEST_CHECK(!queue.allocJob(0, budget));
+}
+
+// several readers allocate jobs concurrently; data held by more than one job must never exceed budget
+struct AllocStressJob final : public cpujobs::IJob
+{
+  static constexpr int BUDGET = 1000, ITERATIONS = 200000;
+  TestQueue *queue = NULL;
+  int seed = 0;
+  static volatile int inUseCount, inUseSize, overshoots, allocated;
+
+  void doJob() override
+  {
+    for (int i = 0; i < ITERATIONS; i++)
+    {
+      const int sz = _rnd_int(seed, 1, BUDGET * 5 / 4);
+      TestJob *j = queue->allocJob(sz, BUDGET);
+      if (!j)
+        continue;
+      const int cnt = interlocked_increment(inUseCount);
+      if (interlocked_add(inUseSize, sz) > BUDGET && cnt > 1)
+        interlocked_increment(overshoots);
+      interlocked_increment(allocated);
+      interlocked_add(inUseSize, -sz);
+      interlocked_decrement(inUseCount);
+      queue->releaseJob(j);
+    }
+  }
+};
+volatile int AllocStressJob::inUseCount = 0, AllocStressJob::inUseSize = 0, AllocStressJob::overshoots = 0,
+             AllocStressJob::allocated = 0;
+
+static void test_concurrent_budget()
+{
+  TestJob jobs[JOBS_COUNT];
+  TestQueue queue;
+  init_queue(queue, jobs);
+
+  AllocStressJob stress[8];
+  const int cnt = eastl::min<int>(countof(stress), threadpool::get_num_workers() + 1);
+  for (int i = 0; i < cnt; i++)
+  {
+    stress[i].queue = &queue;
+    stress[i].seed = 1000 + i;
+  }
+  for (int i = 1; i < cnt; i++)
+    threadpool::add(&stress[i]);
+  stress[0].doJob();
+  for (int i = 1; i < cnt; i++)
+    threadpool::wait(&stress[i]);
+
+  printf("%d readers: %d jobs allocated, %d budget overshoots\n", cnt, interlocked_acquire_load(AllocStressJob::allocated),
+    interlocked_acquire_load(AllocStressJob::overshoots));
+  TEST_CHECK(interlocked_acquire_load(AllocStressJob::overshoots) == 0);
+  TEST_CHECK(interlocked_acquire_load(AllocStressJob::allocated) > 0);
+  TEST_CHECK(queue.reservedDataSize == 0);
+}
+
+int DagorWinMain(bool /*debugmode*/)
+{
+  cpujobs::init();
+  threadpool::init(eastl::min(cpujobs::get_core_count(), 8), 64, 128 << 10);
+
+  test_pick_order();
+  test_drop();
+  test_refresh_race();
+  test_budget();
+  test_concurrent_budget();
+  printf("%s\n", failed ? "FAILED" : "OK");
+
+  threadpool::shutdown();
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,227 @@
+// Headless benchmark of DDSx pack loading pipeline with stub driver: writes synthetic zstd-packed DxP2 pack, then loads all its
+// textures with ddsx::tex_pack2_perform_delayed_data_loading() serially, with decoder threads (read, unpack and upload on
+// decoders) and with decoder threads and threadpool (mip chains are unpacked on threadpool, decoders only upload them);
+// checks that every texture is fully loaded and prints timings of each mode.
+// usage: testDDSxStreaming-dev [tex_count]
+#include <startup/dag_mainCon.inc.cpp>
+#include <startup/dag_globalSettings.h>
+#include <3d/dag_drv3d.h>
+#include <3d/dag_texMgr.h>
+#include <3d/dag_texPackMgr2.h>
+#include <3d/ddsxTex.h>
+#include <texMgrData.h>
+#include <ioSys/dag_dataBlock.h>
+#include <ioSys/dag_fileIo.h>
+#include <ioSys/dag_zstdIo.h>
+#include <osApiWrappers/dag_cpuJobs.h>
+#include <osApiWrappers/dag_direct.h>
+#include <util/dag_threadPool.h>
+#include <util/dag_string.h>
+#include <generic/dag_patchTab.h>
+#include <generic/dag_tab.h>
+#include <math/random/dag_random.h>
+#include <perfMon/dag_perfTimer.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+static int failed = 0;
+#define TEST_CHECK(c)                                            \
+  do                                                             \
+    if (!(c))                                                    \
+    {                                                            \
+      printf("FAILED: %s (%s:%d)\n", #c, __FUNCTION__, __LINE__); \
+      failed++;                                                  \
+    }                                                            \
+  while (0)
+
+static constexpr int TEX_SIZE = 512, TEX_LEVELS = 10;
+static constexpr int DECODER_WORKERS = 4;
+static const char *PACK_FNAME = "ddsxStreamingTest.dxp.bin";
+
+static DataBlock settings;
+static const DataBlock *get_settings() { return &settings; }
+
+// layout of DDSxTexturePack2 dump (DxP2 v3) as read by load_tex_pack2()
+struct PackRec
+{
+  TEXTUREID texId;
+  int ofs;
+  int packedDataSize;
+};
+struct PackDump
+{
+  PatchableTab<PatchablePtr<const char>> texNames;
+  PatchableTab<ddsx::Header> texHdr;
+  PatchableTab<PackRec> texRec;
+  uint64_t fileResv; // DDSxTexturePack2::file is placed here on load
+};
+
+template <class T>
+static void init_tab(PatchableTab<T> &t, int ofs, int cnt)
+{
+#if _TARGET_64BIT
+  t.init((void *)(intptr_t(ofs) | (intptr_t(cnt) << 32)), cnt);
+#else
+  t.init((void *)intptr_t(ofs), cnt);
+#endif
+}
+
+// RGBA texture with full mip chain: smooth gradients with some noise, so it is compressed about as well as real textures are
+static void make_tex(int seed, ddsx::Header &hdr, Tab<char> &packed)
+{
+  memset(&hdr, 0, sizeof(hdr));
+  hdr.label = _MAKE4C('DDSx');
+  hdr.d3dFormat = 0x15; // D3DFMT_A8R8G8B8
+  hdr.w = hdr.h = TEX_SIZE;
+  hdr.depth = 1;
+  hdr.levels = TEX_LEVELS;
+  hdr.bitsPerPixel = 32;
+  for (int l = 0; l < TEX_LEVELS; l++)
+    hdr.memSz += hdr.getSurfaceSz(l);
+
+  Tab<char> src;
+  src.resize(hdr.memSz);
+  uint8_t *p = (uint8_t *)src.data();
+  for (int l = 0; l < TEX_LEVELS; l++)
+    for (int y = 0, sz = max(TEX_SIZE >> l, 1); y < sz; y++)
+      for (int x = 0; x < sz; x++, p += 4)
+        p[0] = x << l, p[1] = y << l, p[2] = (x ^ y) + seed, p[3] = _rnd(seed) & 7;
+
+  packed.resize(zstd_compress_bound(hdr.memSz));
+  packed.resize(zstd_compress(packed.data(), packed.size(), src.data(), src.size(), 3));
+  hdr.flags = ddsx::Header::FLG_ZSTD;
+  hdr.packedSz = packed.size();
+}
+
+static bool write_pack(const char *fn, int tex_count, Tab<String> &out_names)
+{
+  out_names.resize(tex_count);
+  int namesSize = 0;
+  for (int i = 0; i < tex_count; i++)
+  {
+    out_names[i].printf(0, "ddsx_bench_%04d*", i); // names must be sorted
+    namesSize += out_names[i].length() + 1;
+  }
+  const int namePtrOfs = sizeof(PackDump);
+  const int namesOfs = namePtrOfs + tex_count * sizeof(PatchablePtr<const char>);
+  const int hdrOfs = (namesOfs + namesSize + 15) & ~15;
+  const int recOfs = hdrOfs + tex_count * sizeof(ddsx::Header);
+  Tab<char> dump;
+  dump.resize(recOfs + tex_count * sizeof(PackRec));
+  memset(dump.data(), 0, dump.size());
+
+  PackDump &d = *(PackDump *)dump.data();
+  init_tab(d.texNames, namePtrOfs, tex_count);
+  init_tab(d.texHdr, hdrOfs, tex_count);
+  init_tab(d.texRec, recOfs, tex_count);
+  PatchablePtr<const char> *namePtr = (PatchablePtr<const char> *)&dump[namePtrOfs];
+  ddsx::Header *hdr = (ddsx::Header *)&dump[hdrOfs];
+  PackRec *rec = (PackRec *)&dump[recOfs];
+  for (int i = 0, nameOfs = namesOfs; i < tex_count; i++)
+  {
+    namePtr[i].setPtr((void *)intptr_t(nameOfs));
+    memcpy(&dump[nameOfs], out_names[i].str(), out_names[i].length() + 1);
+    nameOfs += out_names[i].length() + 1;
+  }
+
+  FullFileSaveCB cwr(fn);
+  if (!cwr.fileHandle)
+    return false;
+  const unsigned fileHdr[4] = {_MAKE4C('DxP2'), 3, (unsigned)tex_count, (unsigned)dump.size()};
+  cwr.write(fileHdr, sizeof(fileHdr));
+  cwr.write(dump.data(), dump.size()); // placeholder, written again when data offsets are known
+
+  Tab<char> packed;
+  for (int i = 0; i < tex_count; i++)
+  {
+    make_tex(i * 7 + 1, hdr[i], packed);
+    rec[i].texId = BAD_TEXTUREID;
+    rec[i].ofs = cwr.tell();
+    rec[i].packedDataSize = packed.size();
+    cwr.write(packed.data(), packed.size());
+  }
+  cwr.seekto(sizeof(fileHdr));
+  cwr.write(dump.data(), dump.size());
+  cwr.close();
+  return true;
+}
+
+static int load_all(dag::ConstSpan<TEXTUREID> tids, const char *mode)
+{
+  for (TEXTUREID tid : tids)
+    TEST_CHECK(!check_managed_texture_loaded(tid));
+  for (TEXTUREID tid : tids)
+    TEST_CHECK(acquire_managed_tex(tid));
+
+  const int64_t reft = profile_ref_ticks();
+  ddsx::tex_pack2_perform_delayed_data_loading(0);
+  const int usec = profile_time_usec(reft);
+
+  int loaded = 0;
+  for (TEXTUREID tid : tids)
+    loaded += check_managed_texture_loaded(tid, true) ? 1 : 0;
+  TEST_CHECK(loaded == tids.size());
+  printf("%-40s: %d of %d textures loaded in %.1f ms\n", mode, loaded, (int)tids.size(), usec / 1000.0);
+
+  for (TEXTUREID tid : tids)
+    release_managed_tex(tid);
+  discard_unused_managed_textures();
+  return usec;
+}
+
+int DagorWinMain(bool /*debugmode*/)
+{
+  const int texCount = dgs_argc > 1 ? max(atoi(dgs_argv[1]), 2) : 128;
+  DataBlock &b = *settings.addBlock("texStreaming");
+  b.setBool("enableStreaming", false);
+  b.setInt("decoderReadAheadKB", 64 << 10);
+  b.setBool("decoderUnpackOnThreadpool", true);
+  ::dgs_get_settings = &get_settings;
+
+  cpujobs::init();
+  Tab<String> names;
+  if (!write_pack(PACK_FNAME, texCount, names))
+  {
+    printf("cannot write %s\nFAILED\n", PACK_FNAME);
+    return 1;
+  }
+
+  void *n = NULL;
+  d3d::init_driver();
+  d3d::init_video(NULL, NULL, NULL, 0, n, NULL, NULL, NULL, NULL);
+  texmgr_internal::register_ddsx_load_implementation(); // stub driver leaves DDSx loading as skip of data
+  enable_tex_mgr_mt(true, texCount + 64);
+
+  TEST_CHECK(ddsx::load_tex_pack2(PACK_FNAME));
+  Tab<TEXTUREID> tids;
+  for (const String &nm : names)
+  {
+    tids.push_back(get_managed_texture_id(nm));
+    TEST_CHECK(tids.back() != BAD_TEXTUREID);
+  }
+
+  if (!failed)
+  {
+    ddsx::set_decoder_workers_count(0);
+    const int serialUsec = load_all(tids, "serial");
+
+    ddsx::set_decoder_workers_count(DECODER_WORKERS);
+    const int decodersUsec = load_all(tids, "decoders");
+
+    threadpool::init(max(cpujobs::get_core_count() - 1, 2), 256, 128 << 10);
+    const int threadpoolUsec = load_all(tids, "decoders + threadpool unpack");
+
+    printf("speedup vs serial: decoders %.2fx, decoders + threadpool %.2fx\n", double(serialUsec) / max(decodersUsec, 1),
+      double(serialUsec) / max(threadpoolUsec, 1));
+  }
+
+  ddsx::release_tex_pack2(PACK_FNAME);
+  ddsx::set_decoder_workers_count(0);
+  threadpool::shutdown();
+  d3d::release_driver();
+  dd_erase(PACK_FNAME);
+
+  printf("%s\n", failed ? "FAILED" : "OK");
+  return failed ? 1 : 0;
+}
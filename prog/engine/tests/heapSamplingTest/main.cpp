@@ -0,0 +1,192 @@
+// Checks allocation sampling hooks of memory manager and sampled bytes estimator used by sampling heap profiler:
+// estimations of allocated and live bytes must be unbiased for any mix of block sizes, every sampled block must be reported
+// freed exactly once, block that failed to resize in place must keep its sample and address filter must not fill up.
+// usage: testHeapSampling-dev
+#include <startup/dag_mainCon.inc.cpp>
+#include <memory/dag_memSampling.h>
+#include <math/random/dag_random.h>
+#include <generic/dag_tab.h>
+#include <EASTL/hash_map.h>
+#include <stdio.h>
+#include <math.h>
+
+static size_t sampling_interval = 0;
+static eastl::hash_map<uintptr_t, size_t> live_samples; // sampled block -> size
+static uint64_t est_alloc_bytes = 0, est_live_bytes = 0;
+static int samples_cnt = 0, double_samples = 0, filtered_frees = 0;
+
+static bool on_alloc(void *p, size_t sz)
+{
+  const uint64_t bytes = dagor_memory_sampling::estimate_sampled_bytes(sz, double(sampling_interval));
+  auto ins = live_samples.insert(uintptr_t(p));
+  if (!ins.second)
+  {
+    double_samples++;
+    est_live_bytes -= dagor_memory_sampling::estimate_sampled_bytes(ins.first->second, double(sampling_interval));
+  }
+  ins.first->second = sz;
+  est_alloc_bytes += bytes;
+  est_live_bytes += bytes;
+  samples_cnt++;
+  return ins.second;
+}
+static bool on_free(void *p)
+{
+  filtered_frees++;
+  auto it = live_samples.find(uintptr_t(p));
+  if (it == live_samples.end()) // false positive of address filter
+    return false;
+  est_live_bytes -= dagor_memory_sampling::estimate_sampled_bytes(it->second, double(sampling_interval));
+  live_samples.erase(it);
+  return true;
+}
+
+static void reset_samples()
+{
+  live_samples.clear();
+  est_alloc_bytes = est_live_bytes = 0;
+  samples_cnt = double_samples = filtered_frees = 0;
+}
+
+static void set_sampling(size_t interval)
+{
+  dagor_memory_sampling::set_hooks(nullptr, nullptr, 0);
+  reset_samples();
+  sampling_interval = interval;
+  if (!interval)
+    return;
+  dagor_memory_sampling::set_hooks(&on_alloc, &on_free, interval);
+  // countdown on thread is restarted (without sample) on first trigger after hooks are set, so warm up until sampling starts
+  for (int i = 0; i < 1000 && !samples_cnt; i++)
+    memfree(memalloc(64 << 10, tmpmem), tmpmem);
+  reset_samples();
+}
+
+static bool check(bool ok, const char *what)
+{
+  printf("%s: %s\n", ok ? "OK  " : "FAIL", what);
+  return ok;
+}
+
+// allocates and frees blocks of random size in [min_sz, max_sz], keeping last live_window blocks alive
+static bool test_estimation(const char *name, int min_sz, int max_sz, int count, int live_window)
+{
+  set_sampling(4096);
+  Tab<void *> window;
+  window.resize(live_window);
+  mem_set_0(window);
+  Tab<size_t> windowSz;
+  windowSz.resize(live_window);
+  mem_set_0(windowSz);
+  uint64_t allocBytes = 0, liveBytes = 0;
+  int seed = 12345;
+  for (int i = 0; i < count; i++)
+  {
+    const int w = i % live_window;
+    if (window[w])
+    {
+      memfree(window[w], tmpmem);
+      liveBytes -= windowSz[w];
+    }
+    const size_t sz = _rnd_int(seed, min_sz, max_sz);
+    window[w] = memalloc(sz, tmpmem);
+    windowSz[w] = sz;
+    allocBytes += sz;
+    liveBytes += sz;
+  }
+  const uint64_t estLiveInWindow = est_live_bytes;
+  for (int w = 0; w < live_window; w++)
+    if (window[w])
+      memfree(window[w], tmpmem);
+  const uint64_t estLiveAfterFree = est_live_bytes;
+  const size_t leftSamples = live_samples.size();
+  set_sampling(0);
+
+  if (!samples_cnt)
+  {
+    printf("SKIP: %s, allocations are not sampled by this memory manager\n", name);
+    return true;
+  }
+  const double allocErr = fabs(double(est_alloc_bytes) / double(allocBytes) - 1.0);
+  const double liveErr = fabs(double(estLiveInWindow) / double(liveBytes) - 1.0);
+  printf("%s: %d samples, allocated %lluK (est. %lluK, err %.2f%%), live %lluK (est. %lluK, err %.2f%%)\n", name, samples_cnt,
+    (unsigned long long)(allocBytes >> 10), (unsigned long long)(est_alloc_bytes >> 10), allocErr * 100,
+    (unsigned long long)(liveBytes >> 10), (unsigned long long)(estLiveInWindow >> 10), liveErr * 100);
+
+  bool ok = true;
+  ok &= check(allocErr < 0.03, "allocated bytes estimation is unbiased");
+  ok &= check(liveErr < 0.1, "live bytes estimation is unbiased");
+  ok &= check(!double_samples, "sampled blocks are not sampled again before free");
+  ok &= check(!leftSamples && !estLiveAfterFree, "all sampled blocks are reported freed");
+  return ok;
+}
+
+// with 1 byte interval every allocation is sampled
+static bool test_resize_inplace()
+{
+  set_sampling(1);
+  bool ok = true;
+  void *p = memalloc(64, tmpmem);
+  if (live_samples.find(uintptr_t(p)) == live_samples.end())
+  {
+    memfree(p, tmpmem);
+    set_sampling(0);
+    printf("SKIP: resizeInplace, allocations are not sampled by this memory manager\n");
+    return true;
+  }
+  if (!tmpmem->resizeInplace(p, 1 << 30))
+  {
+    auto it = live_samples.find(uintptr_t(p));
+    ok &= check(it != live_samples.end() && it->second == 64, "failed resizeInplace keeps sample of block");
+  }
+  if (tmpmem->resizeInplace(p, 32))
+  {
+    auto it = live_samples.find(uintptr_t(p));
+    ok &= check(it != live_samples.end() && it->second == 32, "resizeInplace updates size of sample");
+  }
+  memfree(p, tmpmem);
+  ok &= check(live_samples.find(uintptr_t(p)) == live_samples.end(), "resized block is reported freed");
+  set_sampling(0);
+  return ok;
+}
+
+// address filter must forget freed samples: after many short-lived sampled blocks frees of not sampled blocks don't reach hook
+static bool test_free_filter()
+{
+  static constexpr int CHURN = 4000000, CHECK = 100000;
+  set_sampling(0);
+  Tab<void *> blocks; // allocated with sampling off, so none of them is sampled
+  blocks.resize(CHECK);
+  for (void *&p : blocks)
+    p = memalloc(64, tmpmem);
+
+  set_sampling(1024);
+  for (int i = 0; i < CHURN; i++)
+    memfree(memalloc(64, tmpmem), tmpmem);
+  const int churnSamples = samples_cnt, churnFrees = filtered_frees;
+  for (void *p : blocks)
+    memfree(p, tmpmem);
+  const int falsePositives = filtered_frees - churnFrees;
+  set_sampling(0);
+
+  if (!churnSamples)
+  {
+    printf("SKIP: free filter, allocations are not sampled by this memory manager\n");
+    return true;
+  }
+  printf("free filter: %d samples during churn, %d of %d frees of not sampled blocks reached hook\n", churnSamples,
+    falsePositives, CHECK);
+  return check(falsePositives < CHECK / 100, "frees of not sampled blocks are filtered out after churn");
+}
+
+int DagorWinMain(bool /*debugmode*/)
+{
+  bool ok = true;
+  ok &= test_estimation("small blocks", 16, 64, 2000000, 400000);
+  ok &= test_estimation("mixed blocks", 16, 64 << 10, 100000, 1024);
+  ok &= test_estimation("large blocks", 32 << 10, 256 << 10, 20000, 64);
+  ok &= test_resize_inplace();
+  ok &= test_free_filter();
+  printf(ok ? "all tests passed\n" : "some tests FAILED\n");
+  return ok ? 0 : 1;
+}
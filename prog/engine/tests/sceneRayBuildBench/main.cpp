@@ -0,0 +1,147 @@
+// Serial vs threadpool BuildableStaticSceneRayTracer::rebuild() on synthetic terrain-like mesh; also verifies that both trees
+// give identical trace results and that serialized dump and trace results of default mesh are the same as ones of builder
+// before parallel build (BASELINE_* hashes).
+// usage: testSceneRayBuildBench-dev [grid_size]
+#include <startup/dag_mainCon.inc.cpp>
+#include <sceneRay/dag_sceneRayBuildable.h>
+#include <osApiWrappers/dag_cpuJobs.h>
+#include <util/dag_threadPool.h>
+#include <perfMon/dag_cpuFreq.h>
+#include <math/random/dag_random.h>
+#include <math/dag_mathBase.h>
+#include <generic/dag_tab.h>
+#include <ioSys/dag_memIo.h>
+#include <util/dag_hash.h>
+#include <EASTL/algorithm.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+static constexpr float CELL_SIZE = 2.f;
+static constexpr int RAYS_COUNT = 200000;
+static constexpr int DEFAULT_GRID_SIZE = 1024;
+// of default mesh, built by serial builder before parallel build was added
+static constexpr uint64_t BASELINE_DUMP_HASH = 0x7D1C7250737BE147ull, BASELINE_TRACE_HASH = 0xFA350D37EB890FB2ull;
+
+// heightfield with hills and some boxes on it, so that leaves of grid have both large flat and dense areas
+static void gen_mesh(int grid_size, Tab<Point3> &verts, Tab<unsigned> &faces)
+{
+  for (int y = 0; y <= grid_size; y++)
+    for (int x = 0; x <= grid_size; x++)
+    {
+      const float ht = sinf(x * 0.05f) * cosf(y * 0.07f) * 20.f + sinf(x * 0.31f + y * 0.17f) * 2.f;
+      verts.push_back(Point3(x * CELL_SIZE, ht, y * CELL_SIZE));
+    }
+  for (int y = 0; y < grid_size; y++)
+    for (int x = 0; x < grid_size; x++)
+    {
+      const unsigned i = y * (grid_size + 1) + x;
+      const unsigned quad[6] = {i, i + grid_size + 1, i + 1, i + 1, i + grid_size + 1, i + grid_size + 2};
+      append_items(faces, 6, quad);
+    }
+
+  int seed = 12345;
+  static const unsigned box_faces[36] = {
+    0, 2, 1, 1, 2, 3, 4, 5, 6, 5, 7, 6, 0, 1, 4, 1, 5, 4, 2, 6, 3, 3, 6, 7, 0, 4, 2, 2, 4, 6, 1, 3, 5, 3, 7, 5};
+  for (int i = 0, ie = grid_size * 4; i < ie; i++)
+  {
+    const Point3 c(_frnd(seed) * grid_size * CELL_SIZE, _frnd(seed) * 20.f - 10.f, _frnd(seed) * grid_size * CELL_SIZE);
+    const Point3 half(_rnd_float(seed, 1.f, 8.f), _rnd_float(seed, 1.f, 15.f), _rnd_float(seed, 1.f, 8.f));
+    const unsigned base = verts.size();
+    for (int v = 0; v < 8; v++)
+      verts.push_back(c + Point3(v & 1 ? half.x : -half.x, v & 2 ? half.y : -half.y, v & 4 ? half.z : -half.z));
+    for (unsigned f : box_faces)
+      faces.push_back(base + f);
+  }
+}
+
+static BuildableStaticSceneRayTracer *build(const Tab<Point3> &verts, const Tab<unsigned> &faces, int &out_usec)
+{
+  // large leaves, so that most of work is done in subtrees of few grid leaves
+  BuildableStaticSceneRayTracer *rt = create_buildable_staticmeshscene_raytracer(Point3(256, 256, 256), 5);
+  rt->addmesh(verts.data(), verts.size(), faces.data(), sizeof(unsigned) * 3, faces.size() / 3, nullptr, false);
+  const int64_t ref = ref_time_ticks();
+  rt->rebuild();
+  out_usec = get_time_usec(ref);
+  return rt;
+}
+
+static uint64_t dump_hash(BuildableStaticSceneRayTracer *rt)
+{
+  DynamicMemGeneralSaveCB cwr(tmpmem, 0, 16 << 20);
+  rt->serialize(cwr, false, nullptr, false);
+  return mem_hash_fnv1<64>((const char *)cwr.data(), cwr.size());
+}
+
+static uint64_t hash_trace_result(uint64_t h, int face, float t)
+{
+  h = mem_hash_fnv1<64>((const char *)&face, sizeof(face), h);
+  return face >= 0 ? mem_hash_fnv1<64>((const char *)&t, sizeof(t), h) : h;
+}
+
+int DagorWinMain(bool /*debugmode*/)
+{
+  const int gridSize = dgs_argc > 1 ? atoi(dgs_argv[1]) : DEFAULT_GRID_SIZE;
+  Tab<Point3> verts;
+  Tab<unsigned> faces;
+  gen_mesh(gridSize, verts, faces);
+  printf("%d verts, %d faces\n", (int)verts.size(), (int)faces.size() / 3);
+
+  // no workers yet, so it is serial build
+  int serialUs = 0;
+  BuildableStaticSceneRayTracer *serial = build(verts, faces, serialUs);
+
+  cpujobs::init();
+  threadpool::init(eastl::min(cpujobs::get_core_count(), 64), 2048, 128 << 10);
+  int parallelUs = 0;
+  BuildableStaticSceneRayTracer *parallel = build(verts, faces, parallelUs);
+  printf("serial rebuild %.1f ms, parallel rebuild with %d workers %.1f ms (x%.2f)\n", serialUs / 1000.0,
+    threadpool::get_num_workers(), parallelUs / 1000.0, parallelUs ? double(serialUs) / parallelUs : 0.0);
+
+  // layout of nodes does not depend on number of workers
+  int mismatches = 0, hits = 0;
+  const uint64_t dumpHash = dump_hash(serial);
+  if (dump_hash(parallel) != dumpHash)
+  {
+    printf("MISMATCH: serialized dumps of serial and parallel build differ\n");
+    mismatches++;
+  }
+
+  uint64_t traceHash = FNV1Params<64>::offset_basis;
+  int seed = 54321;
+  const float worldSize = gridSize * CELL_SIZE;
+  for (int i = 0; i < RAYS_COUNT; i++)
+  {
+    const Point3 from(_frnd(seed) * worldSize, _rnd_float(seed, 5.f, 60.f), _frnd(seed) * worldSize);
+    Point3 dir(_rnd_float(seed, -1.f, 1.f), _rnd_float(seed, -1.f, 0.1f), _rnd_float(seed, -1.f, 1.f));
+    dir.normalize();
+    float t0 = 500.f, t1 = 500.f;
+    const int face0 = serial->tracerayNormalized(from, dir, t0);
+    const int face1 = parallel->tracerayNormalized(from, dir, t1);
+    hits += face0 >= 0;
+    traceHash = hash_trace_result(traceHash, face0, t0);
+    if (face0 != face1 || t0 != t1)
+    {
+      if (++mismatches < 10)
+        printf("MISMATCH: ray %d face %d/%d t %g/%g\n", i, face0, face1, t0, t1);
+    }
+  }
+  printf("%d rays, %d hits, dump hash %016llX, trace hash %016llX\n", RAYS_COUNT, hits, (unsigned long long)dumpHash,
+    (unsigned long long)traceHash);
+
+  // float rounding (i.e. of bounding spheres) and hash of signed chars may differ on other platforms
+#if _TARGET_SIMD_SSE
+  if (gridSize == DEFAULT_GRID_SIZE && (dumpHash != BASELINE_DUMP_HASH || traceHash != BASELINE_TRACE_HASH))
+  {
+    printf("MISMATCH: baseline builder gave dump hash %016llX, trace hash %016llX\n", (unsigned long long)BASELINE_DUMP_HASH,
+      (unsigned long long)BASELINE_TRACE_HASH);
+    mismatches++;
+  }
+#endif
+  printf("%d mismatches\n", mismatches);
+
+  delete serial;
+  delete parallel;
+  threadpool::shutdown();
+  return mismatches ? 1 : 0;
+}
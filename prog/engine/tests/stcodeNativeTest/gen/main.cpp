@@ -0,0 +1,32 @@
+// Writes testStcodeNative.cpp for programs of testPrograms.h with write_stcode_cpp() of shader compiler, i.e. the same code
+// which writes native stcode for shader dumps (-stcodeCpp option). Run it from stcodeNativeTest folder when programs change.
+// usage: genTestStcodeNative-dev [out_file]
+#include <startup/dag_mainCon.inc.cpp>
+#include "../testPrograms.h"
+#include "stcodeCpp.h"
+#include "shLog.h"
+#include <shaders/shStcodeHash.h>
+#include <stdio.h>
+
+// shader compiler log goes to console
+void sh_debug(ShLogMode mode, const char *fmt, const DagorSafeArg *arg, int anum)
+{
+  String s;
+  s.vprintf(0, fmt, arg, anum);
+  printf("%s%s\n", mode >= SHLOG_ERROR ? "ERROR: " : "", s.str());
+}
+
+int DagorWinMain(bool /*debugmode*/)
+{
+  const char *fn = dgs_argc > 1 ? dgs_argv[1] : "testStcodeNative.cpp";
+  Tab<Tab<int>> progs;
+  make_test_programs(progs);
+  StcodeHash hash;
+  Tab<dag::ConstSpan<int>> stcode;
+  for (const Tab<int> &p : progs)
+  {
+    hash.add(p);
+    stcode.push_back(p);
+  }
+  return write_stcode_cpp(fn, "prog/engine/tests/stcodeNativeTest/testPrograms.h", stcode, hash.val) ? 0 : 1;
+}
@@ -0,0 +1,99 @@
+// Checks that native stcode routines written by shader compiler (testStcodeNative.cpp) produce same registers and consts as
+// stcode interpreter. Test programs don't use driver and shaders dump, so it runs on CPU only.
+// usage: testStcodeNative-dev
+#include <startup/dag_mainCon.inc.cpp>
+#include "stcodeExec.h"
+#include "testPrograms.h"
+#include <shaders/shStcodeHash.h>
+#include <shaders/shLimits.h>
+#include <stdio.h>
+#include <string.h>
+
+struct StcodeOutputs
+{
+  alignas(16) real regs[MAX_TEMP_REGS];
+  alignas(16) real vprConst[32 * 4];
+  alignas(16) real fshConst[32 * 4];
+  uint32_t vprMask, fshMask;
+};
+
+static void run_stcode(dag::ConstSpan<int> cod, stcode_native_routine_t routine, const uint8_t *vars, StcodeOutputs &out)
+{
+  memset(&out, 0, sizeof(out));
+  StcodeExecState st;
+  st.elem = nullptr;
+  st.cod = cod;
+  st.regs = (char *)out.regs;
+  st.vars = vars;
+  st.vprConst = out.vprConst;
+  st.fshConst = out.fshConst;
+  if (routine)
+    routine(st);
+  else
+    exec_stcode_ops(st, cod);
+  out.vprMask = st.vprMask;
+  out.fshMask = st.fshMask;
+}
+
+int DagorWinMain(bool /*debugmode*/)
+{
+  Tab<Tab<int>> progs;
+  make_test_programs(progs);
+  StcodeHash hash;
+  for (const Tab<int> &p : progs)
+    hash.add(p);
+
+  const StcodeNativeTable *table = find_native_stcode(hash.val);
+  if (!table || table->count != progs.size())
+  {
+    printf("FAILED: no native stcode for test programs (hash %016llX), regenerate testStcodeNative.cpp with gen/ tool\n",
+      (unsigned long long)hash.val);
+    return 1;
+  }
+
+  // local vars: float4 at 0, float at 16, int at 20
+  alignas(16) uint8_t vars[32] = {};
+  const float vec[4] = {1.f, 2.f, -3.f, 4.f}, real_var = 0.75f;
+  const int int_var = 3;
+  memcpy(vars, vec, sizeof(vec));
+  memcpy(vars + 16, &real_var, sizeof(real_var));
+  memcpy(vars + 20, &int_var, sizeof(int_var));
+
+  int failed = 0, tested = 0;
+  for (int i = 0; i < progs.size(); i++)
+  {
+    if (progs[i].empty())
+    {
+      if (table->routines[i])
+      {
+        printf("FAILED: stcode %d is empty, but has native routine\n", i);
+        failed++;
+      }
+      continue;
+    }
+    if (!table->routines[i])
+    {
+      printf("FAILED: no native routine for stcode %d\n", i);
+      failed++;
+      continue;
+    }
+
+    StcodeOutputs interpreted, native;
+    run_stcode(progs[i], nullptr, vars, interpreted);
+    run_stcode(progs[i], table->routines[i], vars, native);
+    tested++;
+    const bool regsEqual = memcmp(interpreted.regs, native.regs, sizeof(native.regs)) == 0;
+    const bool masksEqual = interpreted.vprMask == native.vprMask && interpreted.fshMask == native.fshMask;
+    const bool constsEqual = memcmp(interpreted.vprConst, native.vprConst, sizeof(native.vprConst)) == 0 &&
+                             memcmp(interpreted.fshConst, native.fshConst, sizeof(native.fshConst)) == 0;
+    if (!regsEqual || !masksEqual || !constsEqual)
+    {
+      printf("FAILED: stcode %d differs: regs %s, const masks vs=%08X/%08X ps=%08X/%08X, consts %s\n", i, regsEqual ? "ok" : "differ",
+        interpreted.vprMask, native.vprMask, interpreted.fshMask, native.fshMask, constsEqual ? "ok" : "differ");
+      failed++;
+    }
+  }
+
+  printf("%d stcode programs tested, %d failures\n", tested, failed);
+  return failed ? 1 : 0;
+}
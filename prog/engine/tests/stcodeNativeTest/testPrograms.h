@@ -0,0 +1,91 @@
+#pragma once
+
+#include <shaders/shOpcode.h>
+#include <shaders/shOpcodeFormat.h>
+#include <shaders/shFunc.h>
+#include <generic/dag_tab.h>
+#include <string.h>
+
+// Stcode which doesn't need loaded shaders dump and driver: only local vars, registers and first 32 consts.
+// testStcodeNative.cpp is written for these programs by gen/ tool (write_stcode_cpp() of shader compiler), rerun it when they change.
+static inline int float_bits(float f)
+{
+  int i;
+  memcpy(&i, &f, sizeof(i));
+  return i;
+}
+
+static inline void make_test_programs(Tab<Tab<int>> &progs)
+{
+  using namespace shaderopcode;
+  progs.clear();
+  progs.resize(5);
+
+  // scalar arithmetic
+  Tab<int> &p0 = progs[0];
+  p0.push_back(makeOp2_8_16(SHCOD_IMM_REAL1, 0, float_bits(1.5f) >> 16));
+  p0.push_back(makeOp1(SHCOD_IMM_REAL, 1));
+  p0.push_back(float_bits(3.25f));
+  p0.push_back(makeOp3(SHCOD_MUL_REAL, 2, 0, 1));
+  p0.push_back(makeOp3(SHCOD_ADD_REAL, 3, 2, 0));
+  p0.push_back(makeOp3(SHCOD_SUB_REAL, 4, 3, 1));
+  p0.push_back(makeOp3(SHCOD_DIV_REAL, 5, 4, 1));
+  p0.push_back(makeOp3(SHCOD_MAKE_VEC, 8, 2, 3));
+  p0.push_back(makeData2(4, 5));
+  p0.push_back(makeOp2(SHCOD_FSH_CONST, 0, 8));
+  p0.push_back(makeOp2(SHCOD_INVERSE, 8, 4));
+  p0.push_back(makeOp2(SHCOD_VPR_CONST, 3, 8));
+  p0.push_back(makeOp2(SHCOD_COPY_REAL, 12, 5));
+  p0.push_back(makeOp2(SHCOD_INVERSE, 12, 1));
+  p0.push_back(makeOp2(SHCOD_FSH_CONST, 31, 12));
+
+  // local vars and vector arithmetic
+  Tab<int> &p1 = progs[1];
+  p1.push_back(makeOp2(SHCOD_GET_VEC, 0, 0));
+  p1.push_back(makeOp2(SHCOD_GET_REAL, 4, 16));
+  p1.push_back(makeOp2(SHCOD_GET_INT, 5, 20));
+  p1.push_back(makeOp2(SHCOD_GET_INT_TOREAL, 6, 20));
+  p1.push_back(makeOp1(SHCOD_IMM_VEC, 8));
+  p1.push_back(float_bits(2.f));
+  p1.push_back(float_bits(-0.5f));
+  p1.push_back(float_bits(8.f));
+  p1.push_back(float_bits(0.f));
+  p1.push_back(makeOp3(SHCOD_MUL_VEC, 12, 0, 8));
+  p1.push_back(makeOp3(SHCOD_ADD_VEC, 16, 12, 0));
+  p1.push_back(makeOp3(SHCOD_SUB_VEC, 20, 16, 8));
+  p1.push_back(makeOp3(SHCOD_DIV_VEC, 24, 20, 0));
+  p1.push_back(makeOp2(SHCOD_COPY_VEC, 28, 24));
+  p1.push_back(makeOp2_8_16(SHCOD_IMM_SVEC1, 32, float_bits(0.5f) >> 16));
+  p1.push_back(makeOp2(SHCOD_FSH_CONST, 1, 12));
+  p1.push_back(makeOp2(SHCOD_FSH_CONST, 2, 16));
+  p1.push_back(makeOp2(SHCOD_FSH_CONST, 3, 20));
+  p1.push_back(makeOp2(SHCOD_FSH_CONST, 5, 32));
+  p1.push_back(makeOp2(SHCOD_VPR_CONST, 31, 28));
+  p1.push_back(makeOp3(SHCOD_MAKE_VEC, 36, 4, 5));
+  p1.push_back(makeData2(6, 4));
+  p1.push_back(makeOp2(SHCOD_VPR_CONST, 0, 36));
+
+  // empty entry, like block stcode which is not executed by exec_stcode
+  // progs[2] is left empty
+
+  // built-in functions
+  Tab<int> &p3 = progs[3];
+  p3.push_back(makeOp2(SHCOD_GET_REAL, 0, 16));
+  p3.push_back(makeOp2_8_16(SHCOD_IMM_REAL1, 1, float_bits(2.f) >> 16));
+  p3.push_back(makeOp3(SHCOD_CALL_FUNCTION, functional::BF_POW, 2, 2));
+  p3.push_back(0);
+  p3.push_back(1);
+  p3.push_back(makeOp3(SHCOD_CALL_FUNCTION, functional::BF_SIN, 3, 1));
+  p3.push_back(0);
+  p3.push_back(makeOp3(SHCOD_CALL_FUNCTION, functional::BF_MAX, 4, 2));
+  p3.push_back(2);
+  p3.push_back(3);
+  p3.push_back(makeOp3(SHCOD_CALL_FUNCTION, functional::BF_SQRT, 5, 1));
+  p3.push_back(4);
+  p3.push_back(makeOp3(SHCOD_MAKE_VEC, 8, 2, 3));
+  p3.push_back(makeData2(4, 5));
+  p3.push_back(makeOp2(SHCOD_FSH_CONST, 7, 8));
+
+  // same code as first one, shares its native routine
+  progs[4] = progs[0];
+}
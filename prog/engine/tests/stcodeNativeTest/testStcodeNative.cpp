@@ -0,0 +1,81 @@
+// Native stcode routines generated by shader compiler for 'prog/engine/tests/stcodeNativeTest/testPrograms.h', do not edit.
+// Compile into game with $(Root)/prog/engine/shaders in AddIncludes.
+#include <stcodeExec.h>
+
+namespace
+{
+void stcode_0(StcodeExecState &st)
+{
+  static constexpr int cod[] = {
+    1069547525, 65543, 1078984704, 16777747, 131861, 16974870, 17040660, 50464797,
+    327684, 8388623, 4196405, 8389390, 5245976, 1051701, 12590863};
+  exec_stcode_op(st, cod, 0);
+  exec_stcode_op(st, cod, 1);
+  exec_stcode_op(st, cod, 3);
+  exec_stcode_op(st, cod, 4);
+  exec_stcode_op(st, cod, 5);
+  exec_stcode_op(st, cod, 6);
+  exec_stcode_op(st, cod, 7);
+  exec_stcode_op(st, cod, 9);
+  exec_stcode_op(st, cod, 10);
+  exec_stcode_op(st, cod, 11);
+  exec_stcode_op(st, cod, 12);
+  exec_stcode_op(st, cod, 13);
+  exec_stcode_op(st, cod, 14);
+}
+
+void stcode_1(StcodeExecState &st)
+{
+  static constexpr int cod[] = {
+    9, 16778250, 20972812, 20973069, 524296, 1073741824, -1090519040, 1090519040,
+    0, 134220825, 790555, 135271452, 1316890, 25173022, 1056972806, 12583183,
+    16777743, 20972303, 33555727, 29368078, 84157469, 262150, 37748750};
+  exec_stcode_op(st, cod, 0);
+  exec_stcode_op(st, cod, 1);
+  exec_stcode_op(st, cod, 2);
+  exec_stcode_op(st, cod, 3);
+  exec_stcode_op(st, cod, 4);
+  exec_stcode_op(st, cod, 9);
+  exec_stcode_op(st, cod, 10);
+  exec_stcode_op(st, cod, 11);
+  exec_stcode_op(st, cod, 12);
+  exec_stcode_op(st, cod, 13);
+  exec_stcode_op(st, cod, 14);
+  exec_stcode_op(st, cod, 15);
+  exec_stcode_op(st, cod, 16);
+  exec_stcode_op(st, cod, 17);
+  exec_stcode_op(st, cod, 18);
+  exec_stcode_op(st, cod, 19);
+  exec_stcode_op(st, cod, 20);
+  exec_stcode_op(st, cod, 22);
+}
+
+void stcode_3(StcodeExecState &st)
+{
+  static constexpr int cod[] = {
+    16777226, 1073742085, 33686308, 0, 1, 16974116, 0, 33818404,
+    2, 3, 17106212, 4, 50464797, 327684, 8390415};
+  exec_stcode_op(st, cod, 0);
+  exec_stcode_op(st, cod, 1);
+  exec_stcode_op(st, cod, 2);
+  exec_stcode_op(st, cod, 5);
+  exec_stcode_op(st, cod, 7);
+  exec_stcode_op(st, cod, 10);
+  exec_stcode_op(st, cod, 12);
+  exec_stcode_op(st, cod, 14);
+}
+
+const stcode_native_routine_t routines[] = {
+  &stcode_0,
+  &stcode_1,
+  nullptr,
+  &stcode_3,
+  &stcode_0,
+};
+
+StcodeNativeTable table = {0x0C3B12732765EE9Full, routines, 5, nullptr};
+struct RegisterTable
+{
+  RegisterTable() { register_native_stcode(table); }
+} register_table;
+} // namespace
@@ -0,0 +1,247 @@
+// Checks TiledScene::frustumCullMultiView() against frustumCull() called for each of its views on random scene: every node should
+// be reported once with the views where single view cull finds it, both in serial walk and distributed between threadpool workers.
+// Also prints time of both ways (culling only, best of several runs) and gain of multi view cull.
+// usage: testTiledSceneMultiView-dev [nodes_count]
+#include <startup/dag_mainCon.inc.cpp>
+#include <scene/dag_tiledScene.h>
+#include <osApiWrappers/dag_cpuJobs.h>
+#include <util/dag_threadPool.h>
+#include <perfMon/dag_cpuFreq.h>
+#include <math/random/dag_random.h>
+#include <math/dag_TMatrix4.h>
+#include <math/dag_mathBase.h>
+#include <math/dag_bits.h>
+#include <generic/dag_tab.h>
+#include <EASTL/algorithm.h>
+#include <EASTL/sort.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static constexpr float WORLD_SIZE = 2048.f;
+static constexpr int POOLS_COUNT = 16;
+static constexpr int SCENES_COUNT = 8; // different random views for each
+static constexpr int TIMING_RUNS = 7;
+static constexpr uint16_t FLAG_SHADOW = 1, FLAG_SMALL = 2;
+
+// pools of different size and visible distance, nodes are rotated around y and uniformly scaled, like rendinsts
+static void gen_scene(scene::TiledScene &scene, int nodes_count)
+{
+  int seed = 12345;
+  scene.init(128.f);
+  for (int p = 0; p < POOLS_COUNT; p++)
+  {
+    const float hx = _rnd_float(seed, 0.3f, 12.f), hz = _rnd_float(seed, 0.3f, 12.f);
+    bbox3f box;
+    box.bmin = v_make_vec4f(-hx, 0.f, -hz, 0.f);
+    box.bmax = v_make_vec4f(hx, _rnd_float(seed, 0.5f, 30.f), hz, 0.f);
+    scene.setPoolBBox(p, box);
+    const float distScale = _rnd_float(seed, 20.f, 200.f); // visible up to this count of bounding radii
+    scene.setPoolDistanceSqScale(p, distScale * distScale);
+  }
+  for (int i = 0; i < nodes_count; i++)
+  {
+    const int pool = _rnd_int(seed, 0, POOLS_COUNT - 1);
+    TMatrix tm = rotyTM(_rnd_float(seed, 0.f, TWOPI)) * _rnd_float(seed, 0.5f, 2.f);
+    tm.setcol(3, Point3(_frnd(seed) * WORLD_SIZE, _rnd_float(seed, -5.f, 20.f), _frnd(seed) * WORLD_SIZE));
+    mat44f m;
+    v_mat44_make_from_43cu_unsafe(m, tm.array);
+    const uint16_t flags = (_rnd_int(seed, 0, 3) ? FLAG_SHADOW : 0) | (scene.getPoolSphereRad(pool) < 4.f ? FLAG_SMALL : 0);
+    scene.allocate(m, pool, flags);
+  }
+  scene.flushDeferredTransformUpdates();
+  while (!scene.doMaintenance(ref_time_ticks(), 1000000)) {}
+}
+
+static void make_view(scene::TiledSceneCullView &view, const Point3 &pos, const Point3 &at, const TMatrix4 &proj, float dist_scale)
+{
+  const TMatrix4 globtm = matrix_look_at_lh(pos, at, fabsf(normalize(at - pos).y) > 0.99f ? Point3(0, 0, 1) : Point3(0, 1, 0)) * proj;
+  v_mat44_make_from_44cu(view.globtm, globtm.m[0]);
+  view.pos_distscale = v_make_vec4f(pos.x, pos.y, pos.z, dist_scale);
+}
+
+// main camera with lod distance scale, csm cascades (shadow casters only) and local light shadows (shadow casters, not small)
+static int gen_views(scene::TiledSceneCullView *views, int &seed)
+{
+  int cnt = 0;
+  const Point3 camPos(_rnd_float(seed, 200.f, WORLD_SIZE - 200.f), _rnd_float(seed, 2.f, 60.f),
+    _rnd_float(seed, 200.f, WORLD_SIZE - 200.f));
+  const Point3 camDir = normalize(Point3(_rnd_float(seed, -1.f, 1.f), _rnd_float(seed, -0.4f, 0.1f), _rnd_float(seed, -1.f, 1.f)));
+  make_view(views[cnt++], camPos, camPos + camDir, matrix_perspective(1.f, 1.6f, 0.1f, 2000.f), _rnd_float(seed, 0.5f, 2.f));
+
+  float cascadeSize = 40.f;
+  for (int c = 0; c < 4; c++, cascadeSize *= 3.f)
+  {
+    scene::TiledSceneCullView &view = views[cnt++];
+    const Point3 center = camPos + camDir * cascadeSize * 0.4f;
+    make_view(view, center + Point3(0.3f, 1.f, 0.2f) * 1000.f, center, matrix_ortho_lh_forward(cascadeSize, cascadeSize, 0.f, 2000.f),
+      0.f);
+    view.test_flags = view.equal_flags = FLAG_SHADOW;
+  }
+
+  for (int l = _rnd_int(seed, 3, 11); l > 0; l--)
+  {
+    scene::TiledSceneCullView &view = views[cnt++];
+    const Point3 pos = camPos + Point3(_rnd_float(seed, -200.f, 200.f), _rnd_float(seed, 2.f, 20.f), _rnd_float(seed, -200.f, 200.f));
+    const Point3 dir = normalize(Point3(_rnd_float(seed, -1.f, 1.f), _rnd_float(seed, -1.f, 0.f), _rnd_float(seed, -1.f, 1.f)));
+    make_view(view, pos, pos + dir, matrix_perspective(1.f, 1.f, 0.1f, _rnd_float(seed, 10.f, 80.f)), 0.f);
+    view.test_flags = FLAG_SHADOW | FLAG_SMALL;
+    view.equal_flags = FLAG_SHADOW;
+  }
+  return cnt;
+}
+
+typedef Tab<Tab<scene::node_index>> VisibleLists; // per view, sorted
+
+template <bool use_flags, bool use_pools>
+static void cull_single(const scene::TiledScene &scene, dag::ConstSpan<scene::TiledSceneCullView> views, VisibleLists &out)
+{
+  out.clear();
+  out.resize(views.size());
+  for (int v = 0; v < views.size(); v++)
+  {
+    const scene::TiledSceneCullView &view = views[v];
+    scene.frustumCull<use_flags, use_pools, false>(view.globtm, view.pos_distscale, view.test_flags, view.equal_flags, nullptr,
+      [&](scene::node_index ni, mat44f_cref, vec4f) { out[v].push_back(ni); });
+    eastl::sort(out[v].begin(), out[v].end());
+  }
+}
+
+template <bool use_flags, bool use_pools>
+static void cull_multi(const scene::TiledScene &scene, dag::ConstSpan<scene::TiledSceneCullView> views, uint32_t tiles_per_job,
+  VisibleLists &out)
+{
+  Tab<Tab<eastl::pair<scene::node_index, uint32_t>>> perWorker;
+  perWorker.resize(threadpool::get_num_workers() + 1);
+  scene.frustumCullMultiView<use_flags, use_pools>(
+    views,
+    [&](scene::node_index ni, mat44f_cref, uint32_t views_mask, uint32_t worker_id) {
+      perWorker[worker_id].push_back(eastl::make_pair(ni, views_mask));
+    },
+    tiles_per_job);
+
+  out.clear();
+  out.resize(views.size());
+  for (const auto &list : perWorker)
+    for (const auto &visible : list)
+      for (uint32_t bits = visible.second; bits; bits &= bits - 1)
+        out[__bsf_unsafe(bits)].push_back(visible.first);
+  for (Tab<scene::node_index> &list : out)
+    eastl::sort(list.begin(), list.end());
+}
+
+// returns count of nodes which are reported by one way only, or are reported more than once.
+// Both ways are conservative, but per view cull selects tiles by region of frustum box and then tests planes only, while multi view
+// cull also tests tiles and kd-tree leaves against each frustum box. So node found by per view cull only is fine, if its box is
+// out of frustum box (it is not visible actually), such nodes are counted in culled_by_box.
+static int compare_lists(const scene::TiledScene &scene, dag::ConstSpan<scene::TiledSceneCullView> views, const VisibleLists &ref,
+  const VisibleLists &multi, const char *name, int &culled_by_box)
+{
+  int mismatches = 0;
+  for (int v = 0; v < ref.size(); v++)
+  {
+    vec4f p0, p1, p2, p3, p4, p5;
+    v_construct_camplanes(views[v].globtm, p0, p1, p2, p3, p4, p5);
+    bbox3f frustumBox;
+    v_frustum_box_unsafe(frustumBox, p0, p1, p2, p3, p4, p5);
+
+    Tab<scene::node_index> diff;
+    eastl::set_symmetric_difference(ref[v].begin(), ref[v].end(), multi[v].begin(), multi[v].end(), eastl::back_inserter(diff));
+    int differ = 0, duplicates = 0;
+    for (scene::node_index ni : diff)
+    {
+      const mat44f &m = scene.getNode(ni);
+      bbox3f nodeBox;
+      v_bbox3_init(nodeBox, m, scene.getPoolBbox(scene::get_node_pool(m)));
+      if (eastl::binary_search(ref[v].begin(), ref[v].end(), ni) && !v_bbox3_test_box_intersect(nodeBox, frustumBox))
+        culled_by_box++;
+      else
+        differ++;
+    }
+    for (int i = 1; i < multi[v].size(); i++)
+      duplicates += multi[v][i] == multi[v][i - 1] ? 1 : 0;
+    if (!differ && !duplicates)
+      continue;
+    printf("MISMATCH: %s view %d: %d nodes in single view cull, %d in multi view cull, %d differ, %d duplicates\n", name, v,
+      (int)ref[v].size(), (int)multi[v].size(), differ, duplicates);
+    mismatches += differ + duplicates;
+  }
+  return mismatches;
+}
+
+// time of culling only, callbacks just count visible nodes; best of several runs.
+// Returns 1 if multi view cull finds more nodes than single view cull (it can only find less, see compare_lists)
+template <bool use_flags, bool use_pools>
+static int time_cull(const scene::TiledScene &scene, dag::ConstSpan<scene::TiledSceneCullView> views, int64_t &single_ticks,
+  int64_t &multi_ticks)
+{
+  int64_t bestSingle = INT64_MAX, bestMulti = INT64_MAX;
+  int singleVisible = 0, multiVisible = 0;
+  for (int r = 0; r < TIMING_RUNS; r++)
+  {
+    int64_t reft = ref_time_ticks();
+    for (const scene::TiledSceneCullView &view : views)
+      scene.frustumCull<use_flags, use_pools, false>(view.globtm, view.pos_distscale, view.test_flags, view.equal_flags, nullptr,
+        [&](scene::node_index, mat44f_cref, vec4f) { singleVisible++; });
+    bestSingle = min(bestSingle, ref_time_ticks() - reft);
+    reft = ref_time_ticks();
+    scene.frustumCullMultiView<use_flags, use_pools>(
+      views, [&](scene::node_index, mat44f_cref, uint32_t views_mask, uint32_t) { multiVisible += __popcount(views_mask); }, 0);
+    bestMulti = min(bestMulti, ref_time_ticks() - reft);
+  }
+  single_ticks += bestSingle;
+  multi_ticks += bestMulti;
+  return multiVisible > singleVisible ? 1 : 0;
+}
+
+template <bool use_flags, bool use_pools>
+static int test_cull(const scene::TiledScene &scene, dag::ConstSpan<scene::TiledSceneCullView> views, int &visible,
+  int &culled_by_box, int64_t &single_ticks, int64_t &multi_ticks)
+{
+  VisibleLists ref, multi;
+  cull_single<use_flags, use_pools>(scene, views, ref);
+  cull_multi<use_flags, use_pools>(scene, views, 0, multi);
+  for (const Tab<scene::node_index> &list : ref)
+    visible += list.size();
+
+  int mismatches = compare_lists(scene, views, ref, multi, "serial", culled_by_box);
+  mismatches += time_cull<use_flags, use_pools>(scene, views, single_ticks, multi_ticks);
+  if (threadpool::get_num_workers() > 0)
+  {
+    cull_multi<use_flags, use_pools>(scene, views, 1, multi);
+    int culledByBox = 0; // same as in serial walk
+    mismatches += compare_lists(scene, views, ref, multi, "threadpool", culledByBox);
+  }
+  return mismatches;
+}
+
+int DagorWinMain(bool /*debugmode*/)
+{
+  const int nodesCount = dgs_argc > 1 ? max(atoi(dgs_argv[1]), 1) : 200000;
+  cpujobs::init();
+  threadpool::init(eastl::min(cpujobs::get_core_count(), 64), 2048, 128 << 10);
+
+  scene::TiledScene scene;
+  gen_scene(scene, nodesCount);
+
+  int mismatches = 0, visible = 0, culledByBox = 0, viewsTotal = 0;
+  int64_t singleTicks = 0, multiTicks = 0;
+  int seed = 54321;
+  for (int s = 0; s < SCENES_COUNT; s++)
+  {
+    scene::TiledSceneCullView views[scene::TiledScene::MAX_MULTI_VIEWS];
+    const dag::ConstSpan<scene::TiledSceneCullView> viewsSpan(views, gen_views(views, seed));
+    viewsTotal += viewsSpan.size();
+    mismatches += test_cull<true, true>(scene, viewsSpan, visible, culledByBox, singleTicks, multiTicks);
+    mismatches += test_cull<true, false>(scene, viewsSpan, visible, culledByBox, singleTicks, multiTicks);
+    mismatches += test_cull<false, true>(scene, viewsSpan, visible, culledByBox, singleTicks, multiTicks);
+  }
+  printf("%d nodes, %d views, %d visible in all views, %d out of frustum box in single view cull only, %d mismatches\n", nodesCount,
+    viewsTotal, visible, culledByBox, mismatches);
+  printf("single view cull %.2f ms, serial multi view cull %.2f ms, %.2fx faster (best of %d runs)\n",
+    ref_time_delta_to_usec(singleTicks) / 1000.0, ref_time_delta_to_usec(multiTicks) / 1000.0,
+    double(singleTicks) / double(max(multiTicks, int64_t(1))), TIMING_RUNS);
+
+  scene.term();
+  threadpool::shutdown();
+  return mismatches || !visible ? 1 : 0;
+}
@@ -1109,6 +1109,7 @@ int myMain()
   }
   debug("(cached)query in %gus, best =%gus", double(totalTime) / ECS_RUNS / profiler_ticks_to_us,
     double(bestTime) / profiler_ticks_to_us);
+
   g_entity_mgr->destroyQuery(persistentScalarQuery);
 
   {
@@ -1190,6 +1191,41 @@ int myMain()
   g_entity_mgr->tick();
   debug("destroy = %d us", profile_time_usec(reft));
 
+  {
+    // codegen'ed per-entity and chunk span (ECS_CHUNK_SPAN) es from integrateES.cpp.inl, each over its own set of entities
+    auto measureUpdate = [&](const char *name) {
+      totalTime = 0, bestTime = ~uint64_t(0);
+      for (int i = 0; i < ECS_RUNS; ++i)
+      {
+        reft = profile_ref_ticks();
+        g_entity_mgr->update(ecs::UpdateStageInfoAct(dt, dt));
+        const uint64_t ctime = profile_ref_ticks() - reft;
+        bestTime = min(ctime, bestTime);
+        totalTime += ctime;
+      }
+      debug("%s update in %gus, best =%gus", name, double(totalTime) / ECS_RUNS / profiler_ticks_to_us,
+        double(bestTime) / profiler_ticks_to_us);
+    };
+    measureUpdate("no integrate es");
+    for (const char *tag : {"integrate_per_entity", "integrate_chunk_span"})
+    {
+      ecs::ComponentsMap map;
+      map[ECS_HASH("integrate__pos")] = Point3(0, 0, 0);
+      map[ECS_HASH("integrate__vel")] = Point3(1, 0, 0);
+      map[ECS_HASH_SLOW(tag)] = ecs::Tag();
+      templ = create_template(eastl::move(map));
+      for (int i = 0; i < TESTS; ++i)
+        eid.data()[i] = g_entity_mgr->createEntitySync(templ);
+      g_entity_mgr->tick();
+      prune_cache();
+      measureUpdate(tag);
+      G_ASSERT(fabsf(g_entity_mgr->get<Point3>(eid.data()[TESTS - 1], ECS_HASH("integrate__pos")).x - ECS_RUNS * dt) < 1e-4f);
+      for (int i = 0; i < TESTS; ++i)
+        g_entity_mgr->destroyEntity(eid.data()[i]);
+      g_entity_mgr->tick();
+    }
+  }
+
   prune_cache();
   reft = profile_ref_ticks();
   g_entity_mgr->tick();
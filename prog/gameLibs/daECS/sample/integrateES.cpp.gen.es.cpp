@@ -0,0 +1,63 @@
+#include "integrateES.cpp.inl"
+ECS_DEF_PULL_VAR(integrate);
+//built with ECS codegen version 1.0
+#include <daECS/core/internal/performQuery.h>
+static constexpr ecs::ComponentDesc integrate_per_entity_es_comps[] =
+{
+//start of 1 rw components at [0]
+  {ECS_HASH("integrate__pos"), ecs::ComponentTypeInfo<Point3>()},
+//start of 1 ro components at [1]
+  {ECS_HASH("integrate__vel"), ecs::ComponentTypeInfo<Point3>()},
+//start of 1 rq components at [2]
+  {ECS_HASH("integrate_per_entity"), ecs::ComponentTypeInfo<ecs::Tag>()}
+};
+static void integrate_per_entity_es_all(const ecs::UpdateStageInfo &__restrict info, const ecs::QueryView & __restrict components)
+{
+  auto comp = components.begin(), compE = components.end(); G_ASSERT(comp!=compE);
+  do
+    integrate_per_entity_es(*info.cast<ecs::UpdateStageInfoAct>()
+    , ECS_RW_COMP(integrate_per_entity_es_comps, "integrate__pos", Point3)
+    , ECS_RO_COMP(integrate_per_entity_es_comps, "integrate__vel", Point3)
+    );
+  while (++comp != compE);
+}
+static ecs::EntitySystemDesc integrate_per_entity_es_es_desc
+(
+  "integrate_per_entity_es",
+  "prog/gameLibs/daECS/sample/integrateES.cpp.inl",
+  ecs::EntitySystemOps(integrate_per_entity_es_all),
+  make_span(integrate_per_entity_es_comps+0, 1)/*rw*/,
+  make_span(integrate_per_entity_es_comps+1, 1)/*ro*/,
+  make_span(integrate_per_entity_es_comps+2, 1)/*rq*/,
+  empty_span(),
+  ecs::EventSetBuilder<>::build(),
+  (1<<ecs::UpdateStageInfoAct::STAGE)
+);
+static constexpr ecs::ComponentDesc integrate_chunk_span_es_comps[] =
+{
+//start of 1 rw components at [0]
+  {ECS_HASH("integrate__pos"), ecs::ComponentTypeInfo<Point3>()},
+//start of 1 ro components at [1]
+  {ECS_HASH("integrate__vel"), ecs::ComponentTypeInfo<Point3>()},
+//start of 1 rq components at [2]
+  {ECS_HASH("integrate_chunk_span"), ecs::ComponentTypeInfo<ecs::Tag>()}
+};
+static void integrate_chunk_span_es_all(const ecs::UpdateStageInfo &__restrict info, const ecs::QueryView & __restrict components)
+{
+  integrate_chunk_span_es(*info.cast<ecs::UpdateStageInfoAct>(), components.getEntitiesCount()
+  , ECS_RW_COMP_SPAN(integrate_chunk_span_es_comps, "integrate__pos", Point3)
+  , ECS_RO_COMP_SPAN(integrate_chunk_span_es_comps, "integrate__vel", Point3)
+  );
+}
+static ecs::EntitySystemDesc integrate_chunk_span_es_es_desc
+(
+  "integrate_chunk_span_es",
+  "prog/gameLibs/daECS/sample/integrateES.cpp.inl",
+  ecs::EntitySystemOps(integrate_chunk_span_es_all),
+  make_span(integrate_chunk_span_es_comps+0, 1)/*rw*/,
+  make_span(integrate_chunk_span_es_comps+1, 1)/*ro*/,
+  make_span(integrate_chunk_span_es_comps+2, 1)/*rq*/,
+  empty_span(),
+  ecs::EventSetBuilder<>::build(),
+  (1<<ecs::UpdateStageInfoAct::STAGE)
+);
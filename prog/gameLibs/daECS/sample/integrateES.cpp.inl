@@ -0,0 +1,27 @@
+// Same integration of components as codegen calls it per entity and per chunk (ECS_CHUNK_SPAN); benchmark.cpp measures both
+#include <daECS/core/entitySystem.h>
+#include <daECS/core/componentTypes.h>
+#include <daECS/core/updateStage.h>
+#include <math/dag_Point3.h>
+
+ECS_AUTO_REGISTER_COMPONENT(Point3, "integrate__pos", nullptr, 0);
+ECS_AUTO_REGISTER_COMPONENT(Point3, "integrate__vel", nullptr, 0);
+
+ECS_REQUIRE(ecs::Tag integrate_per_entity)
+static __forceinline void integrate_per_entity_es(const ecs::UpdateStageInfoAct &info, Point3 &integrate__pos,
+  const Point3 &integrate__vel)
+{
+  integrate__pos += integrate__vel * info.dt;
+}
+
+ECS_CHUNK_SPAN
+ECS_REQUIRE(ecs::Tag integrate_chunk_span)
+static __forceinline void integrate_chunk_span_es(const ecs::UpdateStageInfoAct &info, uint32_t count,
+  Point3 *__restrict integrate__pos, const Point3 *__restrict integrate__vel)
+{
+  float *__restrict p = &integrate__pos->x;
+  const float *__restrict v = &integrate__vel->x;
+  const float dt = info.dt;
+  for (uint32_t i = 0, ei = count * 3; i < ei; ++i) // plain float loop, vectorized by compiler
+    p[i] += v[i] * dt;
+}
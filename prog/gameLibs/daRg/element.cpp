@@ -34,6 +34,7 @@
 #include "eventData.h"
 #include "behaviorHelpers.h"
 #include "elementRef.h"
+#include "renderList.h"
 
 
 #define DEBUG_XMB_OVERLAY 0
@@ -106,6 +107,7 @@ Element::~Element()
     eastl::destroy_at(ro);
   delete robjParams;
   delete transform;
+  delete renderCache;
 
   G_ASSERT(!ref || !ref->elem);
   G_ASSERT(!xmb);
@@ -393,6 +395,15 @@ void Element::setup(const Component &comp, GuiScene *gui_scene, SetupMode setup_
     dbgColor = E3DCOLOR(grnd() % 255, grnd() % 255, grnd() % 255);
 #endif
 
+  ++setupGeneration;
+  if (scriptDesc.RawGetSlotValue(csk->renderCache, false))
+  {
+    if (!renderCache)
+      renderCache = new RenderCache();
+  }
+  else
+    del_it(renderCache);
+
   if (setup_mode != SM_REALTIME_UPDATE)
   {
     for (Behavior *bhv : behaviors)
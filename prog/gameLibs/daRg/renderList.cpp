@@ -8,8 +8,14 @@
 #include <daRg/dag_element.h>
 #include <daRg/dag_renderObject.h>
 #include <daRg/dag_sceneRender.h>
+#include <daRg/dag_behavior.h>
+#include <daRg/dag_transform.h>
 
 #include <util/dag_convar.h>
+#include <util/dag_hash.h>
+#include <util/dag_bitwise_cast.h>
+
+#include "animation.h"
 
 #define DEBUG_BOX_CALC 0
 #define P2FMT          "%.1f, %.1f"
@@ -25,6 +31,24 @@ namespace darg
 
 
 CONSOLE_BOOL_VAL("darg", debug_blur_overlaps, false);
+CONSOLE_BOOL_VAL("darg", render_cache, true);
+
+
+static inline uint32_t hash_val(uint32_t v, uint32_t h) { return fnv1a_step<32>(v, h); }
+static inline uint32_t hash_val(float v, uint32_t h) { return fnv1a_step<32>(bitwise_cast<uint32_t>(v), h); }
+static inline uint32_t hash_val(const Point2 &v, uint32_t h) { return hash_val(v.y, hash_val(v.x, h)); }
+
+static bool is_box_inside(const BBox2 &outer, const BBox2 &inner)
+{
+  return inner.lim[0].x >= outer.lim[0].x && inner.lim[0].y >= outer.lim[0].y && inner.lim[1].x <= outer.lim[1].x &&
+         inner.lim[1].y <= outer.lim[1].y;
+}
+
+static void move_box(BBox2 &box, const Point2 &delta)
+{
+  box.lim[0] += delta;
+  box.lim[1] += delta;
+}
 
 
 void RenderList::push(const RenderEntry &e)
@@ -43,7 +67,158 @@ void RenderList::clear()
 }
 
 
-void RenderList::afterRebuild() { eastl::insertion_sort(list.begin(), list.end(), RenderEntryCompare()); }
+void RenderList::afterRebuild()
+{
+  eastl::insertion_sort(list.begin(), list.end(), RenderEntryCompare());
+
+  for (int i = 0, n = list.size(); i < n; ++i)
+  {
+    const RenderEntry &re = list[i];
+    RenderCache *rc = re.elem->renderCache;
+    if (!rc)
+      continue;
+    if (re.cmd == RCMD_ELEM_RENDER)
+    {
+      rc->listBegin = i;
+      rc->listEnd = -1;
+    }
+    else if (re.cmd == RCMD_ELEM_POSTRENDER && rc->listBegin >= 0)
+    {
+      // children with their own zOrder are rendered apart from the subtree, it can't be cached then
+      const RenderEntry &first = list[rc->listBegin];
+      if (first.elem == re.elem && first.zOrder == re.zOrder && re.hierOrder - first.hierOrder == i - rc->listBegin)
+        rc->listEnd = i;
+    }
+  }
+}
+
+
+// Returns false if subtree contents may change without setup (animations, behaviors updated every frame)
+bool RenderList::calcCachedSubtreeSignature(const RenderCache &rc, uint32_t &signature) const
+{
+  const Point2 rootPos = list[rc.listBegin].elem->screenCoord.screenPos;
+  uint32_t h = FNV1Params<32>::offset_basis;
+  for (int i = rc.listBegin; i <= rc.listEnd; ++i)
+  {
+    const RenderEntry &re = list[i];
+    h = hash_val(uint32_t(re.cmd), h);
+    if (re.cmd != RCMD_ELEM_RENDER)
+      continue;
+
+    const Element *elem = re.elem;
+    for (const Behavior *bhv : elem->behaviors)
+      if (bhv->updateStages)
+        return false;
+    for (const eastl::unique_ptr<Animation> &anim : elem->animations)
+      if (!anim->isFinished() || anim->isPlayingLoop)
+        return false;
+    for (const Transition &trans : elem->transitions)
+      if (!trans.isFinished())
+        return false;
+
+    const uint64_t ptr = uint64_t(uintptr_t(elem));
+    h = hash_val(uint32_t(ptr >> 32), hash_val(uint32_t(ptr), h));
+    h = hash_val(elem->setupGeneration, h);
+    h = hash_val(uint32_t(elem->getStateFlags()), h);
+    h = hash_val(elem->screenCoord.screenPos - rootPos, h);
+    h = hash_val(elem->screenCoord.size, h);
+    h = hash_val(elem->screenCoord.scrollOffs, h);
+    h = hash_val(elem->props.getCurrentOpacity(), h);
+    if (const Transform *tr = elem->transform)
+    {
+      h = hash_val(tr->pivot, h);
+      h = hash_val(tr->getCurTranslate(), h);
+      h = hash_val(tr->getCurScale(), h);
+      h = hash_val(tr->getCurRotate(), h);
+    }
+  }
+  signature = h;
+  return true;
+}
+
+
+// Called for subtree root after its boxes are calculated.
+// Returns true if recorded commands were replayed, otherwise starts recording if possible
+bool RenderList::replayCachedSubtree(StdGuiRender::GuiContext &ctx, int idx)
+{
+  Element *root = list[idx].elem;
+  RenderCache &rc = *root->renderCache;
+  if (ctx.currentViewPort.isNull || ctx.isRecording() || root->transformedBbox.isempty() || root->bboxIsClippedOut())
+    return false;
+
+  uint32_t signature;
+  if (!calcCachedSubtreeSignature(rc, signature))
+    return false;
+
+  GuiVertexTransform gvtm;
+  root->calcFullTransform(gvtm);
+  const float linearTm[2][2] = {{gvtm.vtm[0][0], gvtm.vtm[0][1]}, {gvtm.vtm[1][0], gvtm.vtm[1][1]}};
+  const Point2 origin = root->transformedBbox.leftTop();
+  const BBox2 vp(ctx.currentViewPort.leftTop, ctx.currentViewPort.rightBottom);
+
+  if (signature == rc.signature && renderState.opacity == rc.opacity && memcmp(linearTm, rc.linearTm, sizeof(linearTm)) == 0 &&
+      rc.cmdBuf.canReplay())
+  {
+    // Boxes are used for input handling, so they are moved along with the subtree.
+    // Root box is already calculated for this frame
+    const Point2 delta = origin - rc.lastOrigin;
+    bool visible = is_box_inside(vp, root->transformedBbox);
+    for (int i = idx + 1; i < rc.listEnd && visible; ++i)
+    {
+      const Element *elem = list[i].elem;
+      if (list[i].cmd != RCMD_ELEM_RENDER || elem->transformedBbox.isempty())
+        continue;
+      BBox2 box = elem->transformedBbox;
+      move_box(box, delta);
+      visible = is_box_inside(vp, box);
+    }
+
+    if (visible)
+    {
+      for (int i = idx + 1; i < rc.listEnd; ++i)
+      {
+        Element *elem = list[i].elem;
+        if (list[i].cmd != RCMD_ELEM_RENDER || elem->transformedBbox.isempty())
+          continue;
+        move_box(elem->transformedBbox, delta);
+        elem->clippedScreenRect = elem->transformedBbox;
+        elem->updFlags(Element::F_SCREEN_BOX_CLIPPED_OUT, false);
+      }
+      rc.lastOrigin = origin;
+      ctx.replay(rc.cmdBuf, origin - rc.recordOrigin);
+      return true;
+    }
+  }
+
+  rc.signature = signature;
+  rc.opacity = renderState.opacity;
+  memcpy(rc.linearTm, linearTm, sizeof(linearTm));
+  rc.recordOrigin = rc.lastOrigin = origin;
+  recordingCache = &rc;
+  recordingViewport = vp;
+  ctx.beginRecording(rc.cmdBuf);
+  return false;
+}
+
+
+void RenderList::finishCachedSubtree(StdGuiRender::GuiContext &ctx)
+{
+  ctx.endRecording();
+  RenderCache &rc = *recordingCache;
+  recordingCache = nullptr;
+
+  // Replay doesn't clip, so subtree must have been rendered without clipping
+  for (int i = rc.listBegin; i <= rc.listEnd && rc.cmdBuf.replayable; ++i)
+  {
+    const Element *elem = list[i].elem;
+    if (list[i].cmd != RCMD_ELEM_RENDER || elem->transformedBbox.isempty())
+      continue;
+    if (elem->bboxIsClippedOut() || !is_box_inside(recordingViewport, elem->transformedBbox) ||
+        elem->clippedScreenRect.lim[0] != elem->transformedBbox.lim[0] ||
+        elem->clippedScreenRect.lim[1] != elem->transformedBbox.lim[1])
+      rc.cmdBuf.replayable = false;
+  }
+}
 
 
 void RenderList::render(StdGuiRender::GuiContext &ctx)
@@ -126,6 +301,13 @@ void RenderList::render(StdGuiRender::GuiContext &ctx)
     {
       case RCMD_ELEM_RENDER:
       {
+        RenderCache *rc = re.elem->renderCache;
+        if (rc && rc->listEnd >= 0 && render_cache && replayCachedSubtree(ctx, it - list.begin()))
+        {
+          it = list.begin() + rc->listEnd;
+          break;
+        }
+
         if (!re.elem->bboxIsClippedOut())
           re.elem->render(ctx, this, hierBreak);
         else
@@ -175,10 +357,14 @@ void RenderList::render(StdGuiRender::GuiContext &ctx)
       default: G_ASSERTF(0, "Unexpected render command %d", re.cmd);
     }
 
-    prevHierOrder = re.hierOrder;
+    if (recordingCache && it - list.begin() == recordingCache->listEnd)
+      finishCachedSubtree(ctx);
+
+    prevHierOrder = it->hierOrder;
   }
 
   G_ASSERT(transformStack.empty());
+  G_ASSERT(!recordingCache);
   G_ASSERT(opacityStack.empty());
   BOXDBG("\n\n");
 
@@ -55,6 +55,21 @@ struct OpacityStackItem
 };
 
 
+// Draw commands of element subtree recorded on previous frame.
+// Replayed instead of rendering while nothing that affects output has changed
+// (checked with signature of subtree elements) and subtree was only moved.
+struct RenderCache
+{
+  StdGuiRender::GuiCommandBuffer cmdBuf;
+  int listBegin = -1, listEnd = -1; // subtree range in render list, listEnd < 0 if subtree is not contiguous in it
+  uint32_t signature = 0;
+  float linearTm[2][2] = {};
+  Point2 recordOrigin = Point2(0, 0); // subtree origin on screen at the moment of recording
+  Point2 lastOrigin = Point2(0, 0);   // and when boxes were calculated for the last time
+  float opacity = 1.f;
+};
+
+
 class RenderList
 {
 public:
@@ -66,6 +81,9 @@ public:
 
 private:
   void debugBlurPanelsOverlap(StdGuiRender::GuiContext &ctx);
+  bool replayCachedSubtree(StdGuiRender::GuiContext &ctx, int idx);
+  void finishCachedSubtree(StdGuiRender::GuiContext &ctx);
+  bool calcCachedSubtreeSignature(const RenderCache &rc, uint32_t &signature) const;
 
 public:
   typedef dag::Vector<RenderEntry> RListData;
@@ -77,6 +95,10 @@ public:
   RenderState renderState;
 
   dag::Vector<Element *> worldBlurElems;
+
+private:
+  RenderCache *recordingCache = nullptr;
+  BBox2 recordingViewport;
 };
 
 
@@ -155,6 +155,8 @@ void RobjDasCanvas::renderCustom(GuiContext &ctx, const Element *elem, const Ele
   if (!params->drawFunc)
     return;
 
+  ctx.invalidateRecording(); // script draw function may produce different output each frame
+
   GuiVertexTransform xf;
   ctx.getViewTm(xf.vtm);
 
@@ -285,6 +285,7 @@ void RenderObjectText::renderCustom(StdGuiRender::GuiContext &ctx, const Element
     params->strWidth = strWidth;
     if (has_focus)
     {
+      ctx.invalidateRecording(); // cursor position is not a part of element setup
       int cursorPos = elem->props.storage.RawGetSlotValue(elem->csk->cursorPos, textLength);
 
       int len = clamp(cursorPos, 0, textLength);
@@ -621,7 +622,9 @@ void RenderObjectImage::renderCustom(StdGuiRender::GuiContext &ctx, const Elemen
     return;
 
   Picture *image = params->image;
-  if (!image->isLoading() && params->fallbackImage)
+  if (image->isLoading())
+    ctx.invalidateRecording();
+  else if (params->fallbackImage)
   {
     if (image->getPic().pic == BAD_PICTUREID)
       image = params->fallbackImage;
@@ -735,6 +738,9 @@ void RenderObjectVectorCanvas::renderCustom(StdGuiRender::GuiContext &ctx, const
     return;
   }
 
+  if (!params->draw.IsNull())
+    ctx.invalidateRecording(); // script draw function may produce different output each frame
+
   ctx.set_texture(BAD_TEXTUREID);
   ctx.set_alpha_blend(PREMULTIPLIED);
 
@@ -1007,7 +1013,10 @@ void RenderObject9rect::renderCustom(StdGuiRender::GuiContext &ctx, const Elemen
     return;
 
   if (params->image && params->image->isLoading())
+  {
+    ctx.invalidateRecording();
     return;
+  }
 
   ctx.set_color(color);
 
@@ -1834,7 +1843,9 @@ void RenderObjectBox::renderNoRadius(StdGuiRender::GuiContext &ctx, const Elemen
       Picture *image = params->image;
       if (image)
       {
-        if (image->getPic().pic == BAD_PICTUREID && !image->isLoading() && params->fallbackImage)
+        if (image->isLoading())
+          ctx.invalidateRecording();
+        else if (image->getPic().pic == BAD_PICTUREID && params->fallbackImage)
           image = params->fallbackImage;
         const PictureManager::PicDesc &pic = image->getPic();
         pic.updateTc();
@@ -1915,7 +1926,9 @@ void RenderObjectBox::renderCustom(StdGuiRender::GuiContext &ctx, const Element
 
   if (image)
   {
-    if (image->getPic().pic == BAD_PICTUREID && !image->isLoading() && params->fallbackImage)
+    if (image->isLoading())
+      ctx.invalidateRecording();
+    else if (image->getPic().pic == BAD_PICTUREID && params->fallbackImage)
       image = params->fallbackImage;
     const PictureManager::PicDesc &pic = image->getPic();
 
@@ -1998,7 +2011,7 @@ bool RobjParamsMovie::getAnimFloat(AnimProp prop, float **ptr)
 void RenderObjectMovie::renderCustom(StdGuiRender::GuiContext &ctx, const Element *elem, const ElemRenderData *rdata,
   const RenderState &render_state)
 {
-  G_UNUSED(ctx);
+  ctx.invalidateRecording();
   IGenVideoPlayer *player = elem->props.storage.RawGetSlotValue<IGenVideoPlayer *>(elem->csk->moviePlayer, nullptr);
   if (!player)
     return;
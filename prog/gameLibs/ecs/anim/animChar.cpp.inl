@@ -257,7 +257,7 @@ void anim::animchar_act(float dt, float *accum_dt, const float *dt_threshold, An
       *accum_dt = 0.f;
     }
     else
-      animchar.recalcWtm();
+      animchar.interpolatePose(*accum_dt / *dt_threshold); // same as recalcWtm() unless ULF_INTERP_POSE is set by LOD scheduler
   }
   if (!animchar_node_wtm)
     return;
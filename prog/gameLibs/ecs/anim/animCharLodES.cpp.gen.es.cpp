@@ -0,0 +1,109 @@
+#include "animCharLodES.cpp.inl"
+ECS_DEF_PULL_VAR(animCharLod);
+//built with ECS codegen version 1.0
+#include <daECS/core/internal/performQuery.h>
+//static constexpr ecs::ComponentDesc animchar_lod_scheduler_es_comps[] ={};
+static void animchar_lod_scheduler_es_all_events(const ecs::Event &__restrict evt, const ecs::QueryView &__restrict components)
+{
+  G_UNUSED(components);
+  G_FAST_ASSERT(evt.is<UpdateAnimcharEvent>());
+  animchar_lod_scheduler_es(static_cast<const UpdateAnimcharEvent&>(evt)
+        );
+}
+static ecs::EntitySystemDesc animchar_lod_scheduler_es_es_desc
+(
+  "animchar_lod_scheduler_es",
+  "prog/gameLibs/ecs/anim/animCharLodES.cpp.inl",
+  ecs::EntitySystemOps(nullptr, animchar_lod_scheduler_es_all_events),
+  empty_span(),
+  empty_span(),
+  empty_span(),
+  empty_span(),
+  ecs::EventSetBuilder<UpdateAnimcharEvent>::build(),
+  0
+,nullptr,nullptr,"animchar__updater_es","before_animchar_update_sync");
+static constexpr ecs::ComponentDesc animchar_lod_viewers_ecs_query_comps[] =
+{
+//start of 1 ro components at [0]
+  {ECS_HASH("transform"), ecs::ComponentTypeInfo<TMatrix>()},
+//start of 1 rq components at [1]
+  {ECS_HASH("animchar_lod__viewer"), ecs::ComponentTypeInfo<ecs::Tag>()}
+};
+static ecs::CompileTimeQueryDesc animchar_lod_viewers_ecs_query_desc
+(
+  "animchar_lod_viewers_ecs_query",
+  empty_span(),
+  make_span(animchar_lod_viewers_ecs_query_comps+0, 1)/*ro*/,
+  make_span(animchar_lod_viewers_ecs_query_comps+1, 1)/*rq*/,
+  empty_span());
+template<typename Callable>
+inline void animchar_lod_viewers_ecs_query(Callable function)
+{
+  perform_query(g_entity_mgr, animchar_lod_viewers_ecs_query_desc.getHandle(),
+    [&function](const ecs::QueryView& __restrict components)
+    {
+        auto comp = components.begin(), compE = components.end(); G_ASSERT(comp != compE); do
+        {
+          function(
+              ECS_RO_COMP(animchar_lod_viewers_ecs_query_comps, "transform", TMatrix)
+            );
+
+        }while (++comp != compE);
+    }
+  );
+}
+static constexpr ecs::ComponentDesc animchar_lod_ecs_query_comps[] =
+{
+//start of 3 rw components at [0]
+  {ECS_HASH("animchar"), ecs::ComponentTypeInfo<AnimV20::AnimcharBaseComponent>()},
+  {ECS_HASH("animchar__dtThreshold"), ecs::ComponentTypeInfo<float>()},
+  {ECS_HASH("animchar_lod__level"), ecs::ComponentTypeInfo<int>()},
+//start of 11 ro components at [3]
+  {ECS_HASH("transform"), ecs::ComponentTypeInfo<TMatrix>()},
+  {ECS_HASH("animchar_lod__distances"), ecs::ComponentTypeInfo<Point3>()},
+  {ECS_HASH("animchar_lod__intervals"), ecs::ComponentTypeInfo<Point3>()},
+  {ECS_HASH("animchar_visbits"), ecs::ComponentTypeInfo<uint8_t>(), ecs::CDF_OPTIONAL},
+  {ECS_HASH("animchar__accumDt"), ecs::ComponentTypeInfo<float>(), ecs::CDF_OPTIONAL},
+  {ECS_HASH("animchar_lod__forcedLevel"), ecs::ComponentTypeInfo<int>(), ecs::CDF_OPTIONAL},
+  {ECS_HASH("animchar_lod__distMul"), ecs::ComponentTypeInfo<float>(), ecs::CDF_OPTIONAL},
+  {ECS_HASH("animchar_lod__postBlendMaxLod"), ecs::ComponentTypeInfo<int>(), ecs::CDF_OPTIONAL},
+  {ECS_HASH("animchar_lod__sharePoseMinLod"), ecs::ComponentTypeInfo<int>(), ecs::CDF_OPTIONAL},
+  {ECS_HASH("animchar_lod__invisibleMinLod"), ecs::ComponentTypeInfo<int>(), ecs::CDF_OPTIONAL},
+  {ECS_HASH("animchar_lod__interpolate"), ecs::ComponentTypeInfo<bool>(), ecs::CDF_OPTIONAL}
+};
+static ecs::CompileTimeQueryDesc animchar_lod_ecs_query_desc
+(
+  "animchar_lod_ecs_query",
+  make_span(animchar_lod_ecs_query_comps+0, 3)/*rw*/,
+  make_span(animchar_lod_ecs_query_comps+3, 11)/*ro*/,
+  empty_span(),
+  empty_span());
+template<typename Callable>
+inline void animchar_lod_ecs_query(Callable function)
+{
+  perform_query(g_entity_mgr, animchar_lod_ecs_query_desc.getHandle(),
+    [&function](const ecs::QueryView& __restrict components)
+    {
+        auto comp = components.begin(), compE = components.end(); G_ASSERT(comp != compE); do
+        {
+          function(
+              ECS_RW_COMP(animchar_lod_ecs_query_comps, "animchar", AnimV20::AnimcharBaseComponent)
+            , ECS_RO_COMP(animchar_lod_ecs_query_comps, "transform", TMatrix)
+            , ECS_RO_COMP(animchar_lod_ecs_query_comps, "animchar_lod__distances", Point3)
+            , ECS_RO_COMP(animchar_lod_ecs_query_comps, "animchar_lod__intervals", Point3)
+            , ECS_RW_COMP(animchar_lod_ecs_query_comps, "animchar__dtThreshold", float)
+            , ECS_RW_COMP(animchar_lod_ecs_query_comps, "animchar_lod__level", int)
+            , ECS_RO_COMP_PTR(animchar_lod_ecs_query_comps, "animchar_visbits", uint8_t)
+            , ECS_RO_COMP_PTR(animchar_lod_ecs_query_comps, "animchar__accumDt", float)
+            , ECS_RO_COMP_OR(animchar_lod_ecs_query_comps, "animchar_lod__forcedLevel", int(-1))
+            , ECS_RO_COMP_OR(animchar_lod_ecs_query_comps, "animchar_lod__distMul", float(1.f))
+            , ECS_RO_COMP_OR(animchar_lod_ecs_query_comps, "animchar_lod__postBlendMaxLod", int(1))
+            , ECS_RO_COMP_OR(animchar_lod_ecs_query_comps, "animchar_lod__sharePoseMinLod", int(-1))
+            , ECS_RO_COMP_OR(animchar_lod_ecs_query_comps, "animchar_lod__invisibleMinLod", int(2))
+            , ECS_RO_COMP_OR(animchar_lod_ecs_query_comps, "animchar_lod__interpolate", bool(true))
+            );
+
+        }while (++comp != compE);
+    }
+  );
+}
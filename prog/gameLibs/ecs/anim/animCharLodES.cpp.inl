@@ -0,0 +1,80 @@
+#include <ecs/core/entitySystem.h>
+#include <ecs/core/attributeEx.h>
+#include <ecs/anim/anim.h>
+#include <ecs/anim/animcharUpdateEvent.h>
+#include <animChar/dag_animCharacter2.h>
+#include <math/dag_Point3.h>
+#include <math/dag_TMatrix.h>
+#include <memory/dag_framemem.h>
+#include <EASTL/fixed_vector.h>
+
+// Animation update LOD scheduler.
+// LOD of animchar is selected by distance to nearest viewer (entity with animchar_lod__viewer tag, e.g. active camera on client
+// or player's hero on server) and by visibility; LOD 0 is updated every frame, LOD 1..3 are updated with animchar_lod__intervals
+// and are shown interpolated between evaluated poses. Post-blend controllers are skipped above animchar_lod__postBlendMaxLod and
+// from animchar_lod__sharePoseMinLod animchars with equal graph state reuse single blended pose.
+// Scripts may pin LOD with animchar_lod__forcedLevel or tune importance with animchar_lod__distMul (0 means always LOD 0).
+
+static constexpr int ANIMCHAR_LOD_MAX = 3;
+
+template <typename Callable>
+static void animchar_lod_viewers_ecs_query(Callable c);
+template <typename Callable>
+static void animchar_lod_ecs_query(Callable c);
+
+static int calc_animchar_lod(float dist, const Point3 &lod_dist)
+{
+  for (int lod = 0; lod < ANIMCHAR_LOD_MAX; lod++)
+    if (dist < lod_dist[lod])
+      return lod;
+  return ANIMCHAR_LOD_MAX;
+}
+
+ECS_AFTER(before_animchar_update_sync)
+ECS_BEFORE(animchar__updater_es)
+static void animchar_lod_scheduler_es(const UpdateAnimcharEvent &)
+{
+  AnimV20::AnimcharBaseComponent::resetSharedPoses();
+
+  eastl::fixed_vector<Point3, 8, /*bOverflow*/ true, framemem_allocator> viewers;
+  animchar_lod_viewers_ecs_query(
+    [&](ECS_REQUIRE(ecs::Tag animchar_lod__viewer) const TMatrix &transform) { viewers.push_back(transform.getcol(3)); });
+
+  animchar_lod_ecs_query(
+    [&](AnimV20::AnimcharBaseComponent &animchar, const TMatrix &transform, const Point3 &animchar_lod__distances,
+      const Point3 &animchar_lod__intervals, float &animchar__dtThreshold, int &animchar_lod__level,
+      const uint8_t *animchar_visbits,  // never on server
+      const float *animchar__accumDt, // without it animchar is updated every frame and there is nothing to interpolate
+      int animchar_lod__forcedLevel = -1, float animchar_lod__distMul = 1.f, int animchar_lod__postBlendMaxLod = 1,
+      int animchar_lod__sharePoseMinLod = -1, int animchar_lod__invisibleMinLod = 2, bool animchar_lod__interpolate = true) {
+      int lod = 0;
+      if (animchar_lod__forcedLevel >= 0)
+        lod = min(animchar_lod__forcedLevel, ANIMCHAR_LOD_MAX);
+      else
+      {
+        if (!viewers.empty())
+        {
+          const Point3 pos = transform.getcol(3);
+          float minDistSq = lengthSq(viewers[0] - pos);
+          for (int i = 1; i < viewers.size(); i++)
+            minDistSq = min(minDistSq, lengthSq(viewers[i] - pos));
+          lod = calc_animchar_lod(sqrtf(minDistSq) * animchar_lod__distMul, animchar_lod__distances);
+        }
+        if (animchar_visbits && !*animchar_visbits)
+          lod = max(lod, min(animchar_lod__invisibleMinLod, ANIMCHAR_LOD_MAX));
+      }
+
+      unsigned flags = 0;
+      if (lod > animchar_lod__postBlendMaxLod)
+        flags |= animchar.ULF_SKIP_POST_BLEND;
+      if (lod > 0 && animchar_lod__interpolate && animchar__accumDt)
+        flags |= animchar.ULF_INTERP_POSE;
+      if (animchar_lod__sharePoseMinLod >= 0 && lod >= animchar_lod__sharePoseMinLod)
+        flags |= animchar.ULF_SHARE_POSE;
+      if (flags != animchar.getUpdateLodFlags())
+        animchar.setUpdateLodFlags(flags);
+
+      animchar__dtThreshold = lod > 0 ? animchar_lod__intervals[lod - 1] : 0.f;
+      animchar_lod__level = lod;
+    });
+}
@@ -2,6 +2,7 @@
 
 #include <scene/dag_physMat.h>
 #include <sceneRay/dag_sceneRayDecl.h>
+#include <osApiWrappers/dag_spinlock.h>
 
 class LandMeshManager;
 class Point2;
@@ -17,4 +18,23 @@ dag::ConstSpan<unsigned char> get_pmid();
 bool has_only_water2d();
 void get_landmesh_mirroring(int &cells_x_pos, int &cells_x_neg, int &cells_z_pos, int &cells_z_neg);
 float get_collision_object_collapse_threshold(const CollisionObject &co);
+
+// nullptr unless parallel queries are active
+OSSpinlock *get_parallel_queries_lock();
+
+// serializes access to physics world contact dispatcher and rendinst collision instances from threadpool workers
+struct ParallelQueriesScopedLock
+{
+  OSSpinlock *mutex;
+  ParallelQueriesScopedLock() : mutex(get_parallel_queries_lock())
+  {
+    if (mutex)
+      mutex->lock();
+  }
+  ~ParallelQueriesScopedLock()
+  {
+    if (mutex)
+      mutex->unlock();
+  }
+};
 }; // namespace dacoll
@@ -26,6 +26,9 @@
 
 #include <util/dag_lookup.h>
 #include <util/dag_roNameMap.h>
+#include <util/dag_threadPool.h>
+#include <osApiWrappers/dag_miscApi.h>
+#include <dag/dag_vector.h>
 
 #include <scene/dag_physMat.h>
 #include <physMap/physMap.h>
@@ -61,17 +64,136 @@ static bool only_water2d = false;
 
 static float collapse_contact_threshold = 0.f;
 
+// temporary shapes of casts and contact tests for each threadpool worker, main thread uses the ones above
+struct WorkerQueryShapes
+{
+  PhysBody *sphereCast = nullptr;
+  PhysBody *boxCast = nullptr;
+  CollisionObject sphere;
+  CollisionObject box;
+  // copies of bodies of other objects placed to tm of pair test, their own tm is not changed; valid during one parallel phase
+  dag::Vector<eastl::pair<const PhysBody *, CollisionObject>> pairTestCopies;
+};
+static dag::Vector<WorkerQueryShapes> worker_query_shapes;
+static bool parallel_queries = false;
+static OSSpinlock parallel_queries_mutex;
+
 
-static void create_cast_shapes()
+static void create_cast_shapes(PhysBody *&sphere_cast, PhysBody *&box_cast)
 {
   PhysSphereCollision sphShape(1.f);
   PhysBoxCollision boxShape(1.f, 1.f, 1.f);
   PhysBodyCreationData pbcd;
   pbcd.addToWorld = false;
-  sphere_cast_shape = new PhysBody(dacoll::get_phys_world(), 0.f, &sphShape, TMatrix::IDENT, pbcd);
-  box_cast_shape = new PhysBody(dacoll::get_phys_world(), 0.f, &boxShape, TMatrix::IDENT, pbcd);
+  sphere_cast = new PhysBody(dacoll::get_phys_world(), 0.f, &sphShape, TMatrix::IDENT, pbcd);
+  box_cast = new PhysBody(dacoll::get_phys_world(), 0.f, &boxShape, TMatrix::IDENT, pbcd);
+}
+
+static void create_cast_shapes() { create_cast_shapes(sphere_cast_shape, box_cast_shape); }
+
+static void destroy_pair_test_copies()
+{
+  for (WorkerQueryShapes &shapes : worker_query_shapes)
+  {
+    for (auto &copy : shapes.pairTestCopies)
+      dacoll::destroy_dynamic_collision(copy.second);
+    shapes.pairTestCopies.clear();
+  }
+}
+
+static void destroy_worker_query_shapes()
+{
+  G_ASSERT(!parallel_queries);
+  destroy_pair_test_copies();
+  for (WorkerQueryShapes &shapes : worker_query_shapes)
+  {
+    del_it(shapes.sphereCast);
+    del_it(shapes.boxCast);
+    dacoll::destroy_dynamic_collision(shapes.sphere);
+    dacoll::destroy_dynamic_collision(shapes.box);
+  }
+  worker_query_shapes.clear();
+}
+
+static WorkerQueryShapes *get_worker_query_shapes()
+{
+  if (!parallel_queries)
+    return nullptr;
+  const int workerId = threadpool::get_current_worker_id();
+  return workerId >= 0 && workerId < worker_query_shapes.size() ? &worker_query_shapes[workerId] : nullptr;
+}
+
+static PhysBody *get_sphere_cast_shape()
+{
+  WorkerQueryShapes *shapes = get_worker_query_shapes();
+  return shapes ? shapes->sphereCast : sphere_cast_shape;
+}
+
+static PhysBody *get_box_cast_shape()
+{
+  WorkerQueryShapes *shapes = get_worker_query_shapes();
+  return shapes ? shapes->boxCast : box_cast_shape;
+}
+
+// body of co placed to tm for pair test; on threadpool worker it is worker's copy of body, as the same object may be tested
+// by other workers (and its owner) at the same time. Must be called under ParallelQueriesScopedLock
+static PhysBody *get_pair_test_body(const CollisionObject &co, const TMatrix &tm)
+{
+  WorkerQueryShapes *shapes = get_worker_query_shapes();
+  if (!shapes)
+  {
+    co.body->setTmInstant(tm);
+    return co.body;
+  }
+  for (auto &copy : shapes->pairTestCopies)
+    if (copy.first == co.body)
+    {
+      copy.second.body->setTmInstant(tm);
+      return copy.second.body;
+    }
+  PhysCollision *shape = co.body->getCollisionScaledCopy();
+  if (!shape)
+    return nullptr;
+  CollisionObject copy =
+    dacoll::create_coll_obj_from_shape(*shape, co.body->getUserData(), /*kinematic*/ false, /*add_to_world*/ false);
+  PhysCollision::clearAllocatedData(*shape);
+  delete shape;
+  copy.body->setTmInstant(tm);
+  shapes->pairTestCopies.emplace_back(co.body, copy);
+  return copy.body;
 }
 
+void dacoll::begin_parallel_queries()
+{
+  G_ASSERT(is_main_thread());
+  G_ASSERT_RETURN(!parallel_queries, );
+  if (!phys_world)
+    return;
+  // workers must never wait for simulation
+  phys_world->fetchSimRes(true);
+  const int numWorkers = threadpool::get_num_workers();
+  while (worker_query_shapes.size() < numWorkers)
+  {
+    WorkerQueryShapes &shapes = worker_query_shapes.push_back();
+    create_cast_shapes(shapes.sphereCast, shapes.boxCast);
+    shapes.sphere = add_dynamic_sphere_collision(TMatrix::IDENT, 1.f, /*up*/ nullptr, /*add_to_world*/ false);
+    shapes.box = add_dynamic_box_collision(TMatrix::IDENT, Point3(1.f, 1.f, 1.f), /*up*/ nullptr, /*add_to_world*/ false);
+  }
+  parallel_queries = true; // published to workers by threadpool job submission
+}
+
+void dacoll::end_parallel_queries()
+{
+  G_ASSERT(is_main_thread());
+  parallel_queries = false;
+  // copied bodies may be changed or destroyed by owners before next parallel phase
+  destroy_pair_test_copies();
+}
+
+bool dacoll::is_parallel_queries_active() { return parallel_queries; }
+
+OSSpinlock *dacoll::get_parallel_queries_lock() { return parallel_queries ? &parallel_queries_mutex : nullptr; }
+
 void dacoll::init_collision_world(dacoll::InitFlags flags, float collapse_contact_thr)
 {
   term_collision_world();
@@ -107,6 +229,7 @@ void dacoll::init_collision_world(dacoll::InitFlags flags, float collapse_contac
 
 void dacoll::term_collision_world()
 {
+  destroy_worker_query_shapes();
   del_it(sphere_cast_shape);
   del_it(box_cast_shape);
   del_it(phys_world);
@@ -120,6 +243,7 @@ void dacoll::term_collision_world()
 void dacoll::clear_collision_world()
 {
   fetch_sim_res(true);
+  destroy_worker_query_shapes();
   del_it(sphere_cast_shape);
   del_it(box_cast_shape);
 #if defined(USE_BULLET_PHYSICS)
@@ -160,6 +284,7 @@ void dacoll::destroy_static_collision()
   box_collision.clear_ptrs();
   destroy_dynamic_collision(capsule_collision);
   capsule_collision.clear_ptrs();
+  destroy_worker_query_shapes();
   fetch_sim_res(true);
 }
 
@@ -1065,6 +1190,7 @@ bool dacoll::test_collision_frt(const CollisionObject &co, Tab<gamephys::Collisi
   int prev_cont = out_contacts.size();
   WrapperContactResultCB collCb(out_contacts, mat_id, dacoll::get_collision_object_collapse_threshold(co));
   // TODO: per-face collision material id
+  ParallelQueriesScopedLock lock;
   for (int i = 0; i < frtObj.size(); i++)
     phys_world->contactTestPair(co.body, frtObj[i], collCb);
   return out_contacts.size() > prev_cont;
@@ -1078,6 +1204,7 @@ bool dacoll::test_collision_world(const CollisionObject &co, Tab<gamephys::Colli
   phys_world->fetchSimRes(true);
   int prev_cont = out_contacts.size();
   WrapperContactResultCB collCb(out_contacts, mat_id, dacoll::get_collision_object_collapse_threshold(co));
+  ParallelQueriesScopedLock lock;
   phys_world->contactTest(co.body, collCb, group, mask);
   return out_contacts.size() > prev_cont;
 }
@@ -1120,30 +1247,36 @@ bool dacoll::test_collision_world(dag::ConstSpan<CollisionObject> collision, flo
 bool dacoll::test_sphere_collision_world(const Point3 &pos, float radius, int mat_id,
   Tab<gamephys::CollisionContactData> &out_contacts, dacoll::PhysLayer group, int mask)
 {
-  if (!sphere_collision.isValid())
+  WorkerQueryShapes *shapes = get_worker_query_shapes();
+  CollisionObject &sphereColl = shapes ? shapes->sphere : sphere_collision;
+  if (!sphereColl.isValid())
   {
-    sphere_collision = add_dynamic_sphere_collision(TMatrix::IDENT, 1.f, /*up*/ nullptr, /*add_to_world*/ false);
-    if (!sphere_collision.isValid())
+    G_ASSERT_RETURN(!shapes, false);
+    sphereColl = add_dynamic_sphere_collision(TMatrix::IDENT, 1.f, /*up*/ nullptr, /*add_to_world*/ false);
+    if (!sphereColl.isValid())
       return false;
   }
   TMatrix tm = TMatrix::IDENT;
   tm.setcol(3, pos);
-  dacoll::set_collision_object_tm(sphere_collision, tm);
-  sphere_collision.body->setSphereShapeRad(radius);
-  return dacoll::test_collision_world(sphere_collision, out_contacts, mat_id, group, mask);
+  dacoll::set_collision_object_tm(sphereColl, tm);
+  sphereColl.body->setSphereShapeRad(radius);
+  return dacoll::test_collision_world(sphereColl, out_contacts, mat_id, group, mask);
 }
 
 bool dacoll::test_box_collision_world(const TMatrix &tm, int mat_id, Tab<gamephys::CollisionContactData> &out_contacts,
   dacoll::PhysLayer group, int mask)
 {
-  if (!box_collision.isValid())
+  WorkerQueryShapes *shapes = get_worker_query_shapes();
+  CollisionObject &boxColl = shapes ? shapes->box : box_collision;
+  if (!boxColl.isValid())
   {
-    box_collision = add_dynamic_box_collision(TMatrix::IDENT, Point3(1.f, 1.f, 1.f), /*up*/ nullptr, /*add_to_world*/ false);
-    if (!box_collision.isValid())
+    G_ASSERT_RETURN(!shapes, false);
+    boxColl = add_dynamic_box_collision(TMatrix::IDENT, Point3(1.f, 1.f, 1.f), /*up*/ nullptr, /*add_to_world*/ false);
+    if (!boxColl.isValid())
       return false;
   }
-  dacoll::set_collision_object_tm(box_collision, tm);
-  return dacoll::test_collision_world(box_collision, out_contacts, mat_id, group, mask);
+  dacoll::set_collision_object_tm(boxColl, tm);
+  return dacoll::test_collision_world(boxColl, out_contacts, mat_id, group, mask);
 }
 
 bool dacoll::test_collision_lmesh(const CollisionObject &co, const TMatrix &tm, float max_rad, int def_mat_id,
@@ -1155,6 +1288,7 @@ bool dacoll::test_collision_lmesh(const CollisionObject &co, const TMatrix &tm,
   int prev_cont = out_contacts.size();
   WrapperContactResultCB collCb(out_contacts, mat_id, dacoll::get_collision_object_collapse_threshold(co));
   collCb.collMatId = def_mat_id;
+  ParallelQueriesScopedLock lock;
   int land_idx[256];
   for (int j = 0, je = lmeshMgr->getLandTracer()->getCellIdxNear(land_idx, countof(land_idx), tm[3][0], tm[3][2], max_rad); j < je;
        j++)
@@ -1175,6 +1309,7 @@ bool dacoll::test_pair_collision(dag::ConstSpan<CollisionObject> co_a, uint64_t
   int prev_cont = out_contacts.size();
   physWorld->fetchSimRes(true);
 
+  ParallelQueriesScopedLock lock;
   for (int i = 0; i < co_a.size(); ++i)
   {
     const CollisionObject &coA = co_a[i];
@@ -1192,17 +1327,20 @@ bool dacoll::test_pair_collision(dag::ConstSpan<CollisionObject> co_a, uint64_t
 
       if (!coA || !coB)
         continue;
+      if ((flags & TestPairFlags::CheckInWorld) != TestPairFlags::None && (!coA.body->isInWorld() || !coB.body->isInWorld()))
+        continue;
+
+      PhysBody *bodyB = coB.body;
       if (set_co_tms)
       {
         coA.body->setTmInstant(tm_a);
-        coB.body->setTmInstant(tm_b);
+        bodyB = get_pair_test_body(coB, tm_b);
+        if (!bodyB)
+          continue;
       }
 
-      if ((flags & TestPairFlags::CheckInWorld) != TestPairFlags::None && (!coA.body->isInWorld() || !coB.body->isInWorld()))
-        continue;
-
       WrapperContactResultCB collCb(out_contacts, -1, dacoll::get_collision_object_collapse_threshold(coA));
-      physWorld->contactTestPair(coA.body, coB.body, collCb);
+      physWorld->contactTestPair(coA.body, bodyB, collCb);
     }
   }
   return out_contacts.size() > prev_cont;
@@ -1226,6 +1364,7 @@ bool dacoll::test_pair_collision_continuous(dag::ConstSpan<CollisionObject> co_a
   const int prevCount = out_contacts.size();
   physWorld->fetchSimRes(true);
 
+  ParallelQueriesScopedLock lock;
   for (int i = 0; i < co_a.size(); ++i)
   {
     const CollisionObject &coA = co_a[i];
@@ -1243,15 +1382,17 @@ bool dacoll::test_pair_collision_continuous(dag::ConstSpan<CollisionObject> co_a
 
       if (!coA || !coB)
         continue;
-      coA.body->setTmInstant(tm_a);
-      coB.body->setTmInstant(tm_b);
-
       if (!coA.body->isInWorld() || !coB.body->isInWorld())
         continue;
 
+      coA.body->setTmInstant(tm_a);
+      PhysBody *bodyB = get_pair_test_body(coB, tm_b);
+      if (!bodyB)
+        continue;
+
       const int prevCountPair = out_contacts.size();
       WrapperContactResultCB collCb(out_contacts, -1, dacoll::get_collision_object_collapse_threshold(coA));
-      physWorld->contactTestPair(coA.body, coB.body, collCb);
+      physWorld->contactTestPair(coA.body, bodyB, collCb);
 
       if (out_contacts.size() == prevCountPair)
       {
@@ -1260,12 +1401,10 @@ bool dacoll::test_pair_collision_continuous(dag::ConstSpan<CollisionObject> co_a
         if (dir.lengthSq() < distMinSq)
           continue;
 
-        coB.body->setTmInstant(tm_b);
-
         G_ASSERT_CONTINUE(coA.body->isConvexCollisionShape());
 
         PhysShapeQueryResult out;
-        physWorld->shapeQuery(coA.body, tmAPrev, tm_a, make_span_const(&coB.body, 1), out);
+        physWorld->shapeQuery(coA.body, tmAPrev, tm_a, make_span_const(&bodyB, 1), out);
         if (out.t >= 0.0f && out.t < 1.0f)
         {
           gamephys::CollisionContactData &contactData = out_contacts.push_back();
@@ -1329,7 +1468,8 @@ void dacoll::shape_query_lmesh(const PhysSphereCollision &shape, const TMatrix &
 bool dacoll::sphere_query_ri(const Point3 &from, const Point3 &to, float rad, dacoll::ShapeQueryOutput &out, int cast_mat_id,
   Tab<rendinst::RendInstDesc> *out_desc, const TraceMeshFaces *handle)
 {
-  if (!phys_world || !phys_world->getScene() || !sphere_cast_shape)
+  PhysBody *castShape = get_sphere_cast_shape();
+  if (!phys_world || !phys_world->getScene() || !castShape)
     return false;
 
   TMatrix fromTm = TMatrix::IDENT;
@@ -1338,9 +1478,9 @@ bool dacoll::sphere_query_ri(const Point3 &from, const Point3 &to, float rad, da
   toTm.setcol(3, to);
 
   phys_world->fetchSimRes(true);
-  sphere_cast_shape->setSphereShapeRad(rad);
+  castShape->setSphereShapeRad(rad);
 
-  shape_query_ri(sphere_cast_shape, fromTm, toTm, rad, out, cast_mat_id, out_desc, handle);
+  shape_query_ri(castShape, fromTm, toTm, rad, out, cast_mat_id, out_desc, handle);
 
   return out.t < 1.f;
 }
@@ -1370,7 +1510,6 @@ static bool shape_cast_ex(PhysBody *shape_body, const TMatrix &from_tm, const TM
 
   // frt
   phys_world->shapeQuery(shape_body, from_tm, to_tm, frtObj, out);
-  const int prevStep = hmap_step > 0 ? dacoll::set_hmap_step(hmap_step) : -1;
   // lmesh
   if (lmeshMgr)
   {
@@ -1383,7 +1522,14 @@ static bool shape_cast_ex(PhysBody *shape_body, const TMatrix &from_tm, const TM
         phys_world->shapeQuery(shape_body, from_tm, to_tm, make_span_const(&lmeshObj[land_idx[j]], 1), out);
   }
   if (hmapObj)
+  {
+    // step is a state of shared heightmap body, so other workers must not see it changed
+    dacoll::ParallelQueriesScopedLock lock;
+    const int prevStep = hmap_step > 0 ? dacoll::set_hmap_step(hmap_step) : -1;
     phys_world->shapeQuery(shape_body, from_tm, to_tm, make_span_const(&hmapObj, 1), out);
+    if (prevStep > 0)
+      dacoll::set_hmap_step(prevStep);
+  }
   if (gather_game_objs_cb)
   {
     MatAndGroupConvexCallback matCb{cast_mat_id, ignore_objs, dacoll::EPL_DEFAULT, mask};
@@ -1394,8 +1540,6 @@ static bool shape_cast_ex(PhysBody *shape_body, const TMatrix &from_tm, const TM
     });
     phys_world->shapeQuery(shape_body, from_tm, to_tm, bodies, out);
   }
-  if (prevStep > 0)
-    dacoll::set_hmap_step(prevStep);
 
   dacoll::shape_query_ri(shape_body, from_tm, to_tm, rad, out, cast_mat_id, nullptr, handle);
 
@@ -1405,7 +1549,8 @@ static bool shape_cast_ex(PhysBody *shape_body, const TMatrix &from_tm, const TM
 bool dacoll::sphere_cast_ex(const Point3 &from, const Point3 &to, float rad, dacoll::ShapeQueryOutput &out, int cast_mat_id,
   dag::ConstSpan<CollisionObject> ignore_objs, const TraceMeshFaces *handle, int mask, int hmap_step /*  = -1 */)
 {
-  if (!phys_world || !phys_world->getScene() || !sphere_cast_shape)
+  PhysBody *castShape = get_sphere_cast_shape();
+  if (!phys_world || !phys_world->getScene() || !castShape)
     return false;
 
   TIME_PROFILE_DEV(sphere_cast);
@@ -1415,9 +1560,9 @@ bool dacoll::sphere_cast_ex(const Point3 &from, const Point3 &to, float rad, dac
   TMatrix toTm = TMatrix::IDENT;
   toTm.setcol(3, to);
 
-  sphere_cast_shape->setSphereShapeRad(rad);
+  castShape->setSphereShapeRad(rad);
 
-  return shape_cast_ex(sphere_cast_shape, fromTm, toTm, rad, out, cast_mat_id, ignore_objs, handle, mask, hmap_step);
+  return shape_cast_ex(castShape, fromTm, toTm, rad, out, cast_mat_id, ignore_objs, handle, mask, hmap_step);
 }
 
 bool dacoll::is_debug_draw_forced() { return debugDrawerForced; }
@@ -1436,13 +1581,14 @@ struct ScopeSetForceDraw
 bool dacoll::box_cast_ex(const TMatrix &from, const TMatrix &to, Point3 dimensions, dacoll::ShapeQueryOutput &out, int cast_mat_id,
   dag::ConstSpan<CollisionObject> ignore_objs, const TraceMeshFaces *handle, int mask, int hmap_step)
 {
-  if (!phys_world || !phys_world->getScene() || !box_cast_shape)
+  PhysBody *castShape = get_box_cast_shape();
+  if (!phys_world || !phys_world->getScene() || !castShape)
     return false;
 
-  box_cast_shape->setBoxShapeExtents(dimensions);
+  castShape->setBoxShapeExtents(dimensions);
 
   const float rad = max(dimensions.x, max(dimensions.y, dimensions.z));
-  return shape_cast_ex(box_cast_shape, from, to, rad, out, cast_mat_id, ignore_objs, handle, mask, hmap_step);
+  return shape_cast_ex(castShape, from, to, rad, out, cast_mat_id, ignore_objs, handle, mask, hmap_step);
 }
 
 void dacoll::force_debug_draw(bool flag)
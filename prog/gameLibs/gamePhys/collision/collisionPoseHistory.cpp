@@ -0,0 +1,157 @@
+#include <gamePhys/collision/collisionPoseHistory.h>
+#include <gameRes/dag_collisionResource.h>
+#include <math/dag_geomTree.h>
+#include <vecmath/dag_vecMath.h>
+#include <EASTL/algorithm.h>
+#include <math.h>
+
+using namespace dacoll;
+
+static constexpr float ROT_QUANT = 32767.f;
+static constexpr float SCALE_QUANT = 4096.f; // up to 8x scale
+
+static inline int16_t quantize(float v, float mul) { return (int16_t)eastl::clamp((int)floorf(v * mul + 0.5f), -32767, 32767); }
+
+static inline bool is_bound_to_geom_tree(const CollisionNode &node)
+{
+  // other types are placed with instance tm
+  return node.type == COLLISION_NODE_TYPE_MESH || node.type == COLLISION_NODE_TYPE_CONVEX || node.type == COLLISION_NODE_TYPE_CAPSULE;
+}
+
+VECTORCALL static inline void interpolate_tm(mat44f &out_tm, vec3f pos0, quat4f rot0, vec4f scl0, vec3f pos1, quat4f rot1,
+  vec4f scl1, vec4f t)
+{
+  if (v_extract_x(v_dot4_x(rot0, rot1)) < 0.f)
+    rot1 = v_neg(rot1);
+  v_mat44_compose(out_tm, v_lerp_vec4f(t, pos0, pos1), v_norm4(v_quat_lerp(t, rot0, rot1)), v_lerp_vec4f(t, scl0, scl1));
+}
+
+void CollisionPoseHistory::init(const CollisionResource &coll_res, const GeomNodeTree &tree, float history_time,
+  float sample_interval)
+{
+  term();
+  for (const CollisionNode &node : coll_res.getAllNodes())
+    if (is_bound_to_geom_tree(node) && tree.isIndexValid(node.geomNodeId) &&
+        eastl::find(nodes.begin(), nodes.end(), node.geomNodeId) == nodes.end())
+      nodes.push_back(node.geomNodeId);
+  // used for bounding sphere culling of traces
+  if (tree.isIndexValid(coll_res.bsphereCenterNode) &&
+      eastl::find(nodes.begin(), nodes.end(), coll_res.bsphereCenterNode) == nodes.end())
+    nodes.push_back(coll_res.bsphereCenterNode);
+
+  sampleInterval = eastl::max(sample_interval, 1e-3f);
+  const int capacity = eastl::max((int)ceilf(history_time / sampleInterval), 1) + 1;
+  samples.resize(capacity);
+  nodeTms.resize(capacity * nodes.size());
+
+  // nodes stay within bounds of resource (with some margin for animation), which gives sub-millimeter precision for characters
+  const float posRange = eastl::max(length(coll_res.boundingBox.center()) + coll_res.boundingSphereRad, 0.5f) * 4.f;
+  posQuant = posRange / 32767.f;
+}
+
+void CollisionPoseHistory::term()
+{
+  nodes.clear();
+  nodes.shrink_to_fit();
+  samples.clear();
+  samples.shrink_to_fit();
+  nodeTms.clear();
+  nodeTms.shrink_to_fit();
+  head = count = 0;
+}
+
+void CollisionPoseHistory::sample(float at_time, const TMatrix &instance_tm, const GeomNodeTree &tree)
+{
+  if (!isInited() || (count && at_time < getNewestTime() + sampleInterval))
+    return;
+
+  Sample &s = samples[head];
+  s.instanceTm = instance_tm;
+  s.time = at_time;
+  QuantizedNodeTm *q = nodeTms.data() + head * nodes.size();
+  head = (head + 1) % samples.size();
+  count = eastl::min(count + 1, (int)samples.size());
+
+  // node positions are kept relative to instance position
+  const vec3f origin = v_sub(v_ldu_p3(&instance_tm.m[3][0]), tree.getWtmOfs());
+  const float posMul = 1.f / posQuant;
+  for (int i = 0; i < nodes.size(); ++i, ++q)
+  {
+    vec3f pos;
+    quat4f rot;
+    vec4f scl;
+    v_mat4_decompose(tree.getNodeWtmRel(nodes[i]), pos, rot, scl);
+    alignas(16) float p[4], r[4], sc[4];
+    v_st(p, v_sub(pos, origin));
+    v_st(r, rot);
+    v_st(sc, scl);
+    for (int j = 0; j < 3; ++j)
+    {
+      q->pos[j] = quantize(p[j], posMul);
+      q->scale[j] = quantize(sc[j], SCALE_QUANT);
+    }
+    for (int j = 0; j < 4; ++j)
+      q->rot[j] = quantize(r[j], ROT_QUANT);
+  }
+}
+
+bool CollisionPoseHistory::rewind(float at_time, GeomNodeTree &out_tree, TMatrix &out_tm) const
+{
+  if (!count)
+    return false;
+
+  int idx0 = 0;
+  while (idx0 + 1 < count && getSample(idx0 + 1).time <= at_time)
+    ++idx0;
+  const Sample &s0 = getSample(idx0);
+  const Sample &s1 = getSample(eastl::min(idx0 + 1, count - 1));
+  const float t = s1.time > s0.time ? eastl::clamp((at_time - s0.time) / (s1.time - s0.time), 0.f, 1.f) : 0.f;
+  const vec4f vt = v_splats(t);
+
+  mat44f tm0, tm1, tm;
+  v_mat44_make_from_43cu_unsafe(tm0, s0.instanceTm.array);
+  v_mat44_make_from_43cu_unsafe(tm1, s1.instanceTm.array);
+  vec3f pos0, pos1;
+  quat4f rot0, rot1;
+  vec4f scl0, scl1;
+  v_mat4_decompose(tm0, pos0, rot0, scl0);
+  v_mat4_decompose(tm1, pos1, rot1, scl1);
+  interpolate_tm(tm, pos0, rot0, scl0, pos1, rot1, scl1, vt);
+  v_mat_43cu_from_mat44(out_tm.array, tm);
+
+  // interpolated node position is interpolated instance position plus interpolated relative one
+  out_tree.setWtmOfs(tm.col3);
+  const QuantizedNodeTm *q0 = getNodeTms(s0);
+  const QuantizedNodeTm *q1 = getNodeTms(s1);
+  const vec4f posScale = v_splats(posQuant);
+  const vec4f rotScale = v_splats(1.f / ROT_QUANT);
+  const vec4f sclScale = v_splats(1.f / SCALE_QUANT);
+  for (int i = 0; i < nodes.size(); ++i, ++q0, ++q1)
+  {
+    interpolate_tm(out_tree.getNodeWtmRel(nodes[i]), v_mul(v_make_vec4f(q0->pos[0], q0->pos[1], q0->pos[2], 0), posScale),
+      v_mul(v_make_vec4f(q0->rot[0], q0->rot[1], q0->rot[2], q0->rot[3]), rotScale),
+      v_mul(v_make_vec4f(q0->scale[0], q0->scale[1], q0->scale[2], 0), sclScale),
+      v_mul(v_make_vec4f(q1->pos[0], q1->pos[1], q1->pos[2], 0), posScale),
+      v_mul(v_make_vec4f(q1->rot[0], q1->rot[1], q1->rot[2], q1->rot[3]), rotScale),
+      v_mul(v_make_vec4f(q1->scale[0], q1->scale[1], q1->scale[2], 0), sclScale), vt);
+  }
+  return true;
+}
+
+bool CollisionPoseHistory::traceRay(float at_time, const CollisionResource &coll_res, GeomNodeTree &scratch_tree, const Point3 &from,
+  const Point3 &dir, float &in_out_t, Point3 *out_normal, int &out_mat_id, int &out_node_id) const
+{
+  TMatrix tm;
+  if (!rewind(at_time, scratch_tree, tm))
+    return false;
+  return coll_res.traceRay(tm, &scratch_tree, from, dir, in_out_t, out_normal, out_mat_id, out_node_id);
+}
+
+float CollisionPoseHistory::getOldestTime() const { return count ? getSample(0).time : 0.f; }
+
+float CollisionPoseHistory::getNewestTime() const { return count ? getSample(count - 1).time : 0.f; }
+
+size_t CollisionPoseHistory::getMemoryUsage() const
+{
+  return nodes.capacity() * sizeof(nodes[0]) + samples.capacity() * sizeof(Sample) + nodeTms.capacity() * sizeof(QuantizedNodeTm);
+}
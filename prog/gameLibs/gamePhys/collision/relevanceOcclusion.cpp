@@ -0,0 +1,229 @@
+#include <gamePhys/collision/relevanceOcclusion.h>
+#include <3d/dag_maskedOcclusionCulling.h>
+#include <gameRes/dag_collisionResource.h>
+#include <math/dag_bounds3.h>
+#include <math/dag_mathBase.h>
+#include <vecmath/dag_vecMath.h>
+#include <perfMon/dag_cpuFreq.h>
+#include <perfMon/dag_statDrv.h>
+#include <EASTL/algorithm.h>
+#include <math.h>
+
+using namespace dacoll;
+
+// same corner order as in box_corners(), i.e. bit 0 is x, bit 1 is y, bit 2 is z
+static const uint16_t box_indices[36] = {
+  1, 3, 2, 0, 1, 2, 7, 5, 6, 5, 4, 6, 0, 6, 4, 0, 2, 6, 1, 5, 7, 1, 7, 3, 0, 4, 5, 0, 5, 1, 2, 7, 6, 2, 3, 7};
+
+static void box_corners(vec4f *out, vec3f bmin, vec3f bmax)
+{
+  for (int i = 0; i < 8; ++i)
+    out[i] = v_perm_xyzd(v_sel(bmin, bmax, v_make_vec4f_mask(i)), V_C_ONE);
+}
+
+// forward is horizontal, right is cross(up, forward) and w equals distance along forward
+static void make_view_clip(mat44f &out, const Point3 &pos, const Point3 &fwd, float y_scale)
+{
+  const Point3 right(fwd.z, 0.f, -fwd.x);
+  const float fwdOfs = -(fwd * pos);
+  out.col0 = v_make_vec4f(right.x, 0.f, fwd.x, fwd.x);
+  out.col1 = v_make_vec4f(0.f, y_scale, 0.f, 0.f);
+  out.col2 = v_make_vec4f(right.z, 0.f, fwd.z, fwd.z);
+  out.col3 = v_make_vec4f(-(right * pos), -pos.y * y_scale, fwdOfs, fwdOfs);
+}
+
+void RelevanceOcclusion::init() { init(Config()); }
+
+void RelevanceOcclusion::init(const Config &config)
+{
+  term();
+  cfg = config;
+  for (MaskedOcclusionCulling *&moc : views)
+  {
+    moc = MaskedOcclusionCulling::Create();
+    moc->SetResolution(cfg.width, cfg.height);
+    moc->SetNearClipPlane(cfg.nearPlane);
+  }
+}
+
+void RelevanceOcclusion::term()
+{
+  for (MaskedOcclusionCulling *&moc : views)
+    if (moc)
+    {
+      MaskedOcclusionCulling::Destroy(moc);
+      moc = nullptr;
+    }
+  prepared = false;
+  hmapVerts.clear();
+  hmapIndices.clear();
+  hmapGridSize = 0;
+  hmapVersion = -1;
+  boxVerts.clear();
+  clipVerts.clear();
+}
+
+void RelevanceOcclusion::clear(const Point3 &observer_pos)
+{
+  if (!isInited())
+    return;
+  static const Point3 forwards[VIEWS_COUNT] = {Point3(0, 0, 1), Point3(1, 0, 0), Point3(0, 0, -1), Point3(-1, 0, 0)};
+  const float yScale = 1.f / tanf(DegToRad(cfg.verticalFov * 0.5f));
+  for (int i = 0; i < VIEWS_COUNT; ++i)
+  {
+    make_view_clip(viewClip[i], observer_pos, forwards[i], yScale);
+    views[i]->ClearBuffer();
+  }
+  observerPos = observer_pos;
+  prepared = true;
+}
+
+int RelevanceOcclusion::addOccluder(const CollisionResource &coll_res, const TMatrix &tm)
+{
+  if (!prepared)
+    return 0;
+  boxVerts.clear();
+  appendBoxOccluders(coll_res, tm);
+  const int tris = rasterizeBoxOccluders();
+  stats.occluderTris += tris;
+  return tris;
+}
+
+int RelevanceOcclusion::rasterizeTriangles(const vec4f *verts, int verts_count, const uint16_t *indices, int tris_count)
+{
+  clipVerts.resize(verts_count);
+  for (int i = 0; i < VIEWS_COUNT; ++i)
+  {
+    for (int j = 0; j < verts_count; ++j)
+      clipVerts[j] = v_mat44_mul_vec3p(viewClip[i], verts[j]);
+    views[i]->RenderTriangles((const float *)clipVerts.data(), indices, tris_count, nullptr, MaskedOcclusionCulling::BACKFACE_NONE,
+      MaskedOcclusionCulling::CLIP_PLANE_ALL);
+  }
+  return tris_count;
+}
+
+int RelevanceOcclusion::appendBoxOccluders(const CollisionResource &coll_res, const TMatrix &tm)
+{
+  // mesh nodes are hollow (buildings) or full of gaps (trees, fences), capsules and spheres are trunks and poles,
+  // so only explicit box nodes are known to be solid
+  int boxes = 0;
+  const vec3f observer = v_ldu_p3(&observerPos.x);
+  for (const CollisionNode *node = coll_res.boxNodesHead; node; node = node->nextNode)
+  {
+    if (!node->checkBehaviorFlags(CollisionNode::TRACEABLE) || node->modelBBox.isempty())
+      continue;
+    const TMatrix nodeTm = tm * node->tm;
+    const Point3 size = node->modelBBox.width();
+    const float sx = size.x * nodeTm.getcol(0).length(), sy = size.y * nodeTm.getcol(1).length(),
+                sz = size.z * nodeTm.getcol(2).length();
+    // thin walls are good occluders, but both larger extents should be big enough
+    if (eastl::max(eastl::min(sx, sy), eastl::min(eastl::max(sx, sy), sz)) < cfg.minBoxSize)
+      continue;
+
+    const Point3 boxCenter = node->modelBBox.center();
+    const vec3f center = v_ldu_p3(&boxCenter.x);
+    const vec3f ext = v_mul(v_ldu_p3(&size.x), v_splats(0.5f - cfg.boxShrink));
+    mat44f vtm;
+    v_mat44_make_from_43cu_unsafe(vtm, nodeTm.array);
+    vec4f corners[8];
+    box_corners(corners, v_sub(center, ext), v_add(center, ext));
+    bbox3f worldBox;
+    v_bbox3_init_empty(worldBox);
+    for (vec4f &c : corners)
+    {
+      c = v_perm_xyzd(v_mat44_mul_vec3p(vtm, c), V_C_ONE);
+      v_bbox3_add_pt(worldBox, c);
+    }
+    // box around observer would hide everything
+    if (v_bbox3_test_pt_inside(worldBox, observer))
+      continue;
+    boxVerts.insert(boxVerts.end(), eastl::begin(corners), eastl::end(corners));
+    boxes++;
+  }
+  return boxes;
+}
+
+int RelevanceOcclusion::rasterizeBoxOccluders()
+{
+  int tris = 0;
+  for (int i = 0; i < boxVerts.size(); i += 8)
+    tris += rasterizeTriangles(boxVerts.data() + i, 8, box_indices, 12);
+  return tris;
+}
+
+bool RelevanceOcclusion::isVisible(bbox3f_cref box) const
+{
+  if (!prepared)
+    return true;
+
+  vec4f corners[8];
+  box_corners(corners, box.bmin, box.bmax);
+  bool occluded = false;
+  for (int i = 0; i < VIEWS_COUNT; ++i)
+  {
+    alignas(16) float p[8][4];
+    int behind = 0;
+    for (int c = 0; c < 8; ++c)
+    {
+      v_st(p[c], v_mat44_mul_vec3p(viewClip[i], corners[c]));
+      behind += p[c][3] < cfg.nearPlane ? 1 : 0;
+    }
+    if (behind == 8)
+      continue;
+
+    float xmin = FLT_MAX, ymin = FLT_MAX, xmax = -FLT_MAX, ymax = -FLT_MAX, wmin = FLT_MAX;
+    auto addPoint = [&](float x, float y, float w) {
+      const float invW = 1.f / w;
+      xmin = eastl::min(xmin, x * invW);
+      xmax = eastl::max(xmax, x * invW);
+      ymin = eastl::min(ymin, y * invW);
+      ymax = eastl::max(ymax, y * invW);
+      wmin = eastl::min(wmin, w);
+    };
+    for (int c = 0; c < 8; ++c)
+      if (p[c][3] >= cfg.nearPlane)
+        addPoint(p[c][0], p[c][1], p[c][3]);
+    // part behind near plane is cut off, points where box edges cross it bound the rest (i.e. box ahead of observer crosses
+    // near planes of side views, but it is far out of them)
+    if (behind)
+      for (int c = 0; c < 8; ++c)
+        for (int bit = 1; bit < 8; bit <<= 1)
+        {
+          const float *a = p[c], *b = p[c | bit];
+          if ((c & bit) || (a[3] < cfg.nearPlane) == (b[3] < cfg.nearPlane))
+            continue;
+          const float t = (cfg.nearPlane - a[3]) / (b[3] - a[3]);
+          addPoint(a[0] + (b[0] - a[0]) * t, a[1] + (b[1] - a[1]) * t, cfg.nearPlane);
+        }
+    // rest of it is tested by neighbour views
+    if (xmax < -1.f || xmin > 1.f)
+      continue;
+    // crosses near plane within view, i.e. it's too close to observer
+    if (behind)
+      return true;
+    // part above or below fov is not covered by any view
+    if (ymin < -1.f || ymax > 1.f)
+      return true;
+    const MaskedOcclusionCulling::CullingResult res = views[i]->TestRect(xmin, ymin, xmax, ymax, wmin);
+    if (res == MaskedOcclusionCulling::VISIBLE)
+      return true;
+    occluded |= res == MaskedOcclusionCulling::OCCLUDED;
+  }
+  return !occluded;
+}
+
+int RelevanceOcclusion::testBoxes(const bbox3f *boxes, int cnt, bool *out_visible)
+{
+  TIME_PROFILE(relevance_occlusion_test);
+  const int64_t startTicks = ref_time_ticks();
+  int hidden = 0;
+  for (int i = 0; i < cnt; ++i)
+  {
+    out_visible[i] = isVisible(boxes[i]);
+    hidden += out_visible[i] ? 0 : 1;
+  }
+  stats.testedBoxes += cnt;
+  stats.occludedBoxes += hidden;
+  stats.testUsec += get_time_usec(startTicks);
+  return hidden;
+}
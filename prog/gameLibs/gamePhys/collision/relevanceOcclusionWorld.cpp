@@ -0,0 +1,109 @@
+#include <gamePhys/collision/relevanceOcclusion.h>
+#include "collisionGlobals.h"
+#include <landMesh/lmeshManager.h>
+#include <heightmap/heightmapHandler.h>
+#include <rendInst/rendInstCollision.h>
+#include <rendInst/rendInstAccess.h>
+#include <math/dag_bounds3.h>
+#include <vecmath/dag_vecMath.h>
+#include <perfMon/dag_cpuFreq.h>
+#include <perfMon/dag_statDrv.h>
+#include <EASTL/algorithm.h>
+#include <math.h>
+
+using namespace dacoll;
+
+static constexpr int MAX_HMAP_GRID_SIZE = 128; // vertices per side, so indices fit in 16 bit
+
+void RelevanceOcclusion::prepare(const Point3 &observer_pos)
+{
+  if (!isInited())
+    return;
+  TIME_PROFILE(relevance_occlusion_prepare);
+  const int64_t startTicks = ref_time_ticks();
+  clear(observer_pos);
+  stats.occluderTris += rasterizeHeightmap(observer_pos);
+  stats.occluderTris += rasterizeRendInsts(observer_pos);
+  stats.prepares++;
+  stats.prepareUsec += get_time_usec(startTicks);
+}
+
+int RelevanceOcclusion::rasterizeHeightmap(const Point3 &pos)
+{
+  LandMeshManager *lmesh = get_lmesh();
+  const HeightmapHandler *hmap = lmesh ? lmesh->getHmapHandler() : nullptr;
+  if (!hmap)
+    return 0;
+
+  const float step = eastl::max(cfg.hmapStep, 2.f * cfg.radius / (MAX_HMAP_GRID_SIZE - 1));
+  const int gridSize = eastl::min((int)ceilf(2.f * cfg.radius / step) + 1, MAX_HMAP_GRID_SIZE);
+  const IPoint2 origin((int)floorf(pos.x / step) - gridSize / 2, (int)floorf(pos.z / step) - gridSize / 2);
+  if (gridSize != hmapGridSize || step != hmapGridStep || origin != hmapGridOrigin || hmap->getTerrainStateVersion() != hmapVersion)
+  {
+    TIME_PROFILE(relevance_occlusion_build_hmap);
+    hmapGridOrigin = origin;
+    hmapGridStep = step;
+    hmapVersion = hmap->getTerrainStateVersion();
+
+    // heights out of heightmap are at its bottom, so they don't occlude anything above terrain
+    const float noHeight = hmap->getWorldBox().lim[0].y;
+    dag::Vector<float> heights(gridSize * gridSize);
+    for (int y = 0, i = 0; y < gridSize; ++y)
+      for (int x = 0; x < gridSize; ++x, ++i)
+        if (!hmap->getHeight(Point2(origin.x + x, origin.y + y) * step, heights[i], nullptr))
+          heights[i] = noHeight;
+
+    // terrain between grid points can be lower than both of them, so each vertex takes lowest height around it
+    hmapVerts.resize(gridSize * gridSize);
+    for (int y = 0, i = 0; y < gridSize; ++y)
+      for (int x = 0; x < gridSize; ++x, ++i)
+      {
+        float ht = heights[i];
+        for (int ny = eastl::max(y - 1, 0); ny <= eastl::min(y + 1, gridSize - 1); ++ny)
+          for (int nx = eastl::max(x - 1, 0); nx <= eastl::min(x + 1, gridSize - 1); ++nx)
+            ht = eastl::min(ht, heights[ny * gridSize + nx]);
+        hmapVerts[i] = v_make_vec4f((origin.x + x) * step, ht - cfg.hmapBias, (origin.y + y) * step, 1.f);
+      }
+
+    if (gridSize != hmapGridSize)
+    {
+      hmapGridSize = gridSize;
+      hmapIndices.clear();
+      hmapIndices.reserve((gridSize - 1) * (gridSize - 1) * 6);
+      for (int y = 0; y < gridSize - 1; ++y)
+        for (int x = 0; x < gridSize - 1; ++x)
+        {
+          const uint16_t i = y * gridSize + x;
+          const uint16_t quad[6] = {i, uint16_t(i + gridSize), uint16_t(i + 1), uint16_t(i + 1), uint16_t(i + gridSize),
+            uint16_t(i + gridSize + 1)};
+          hmapIndices.insert(hmapIndices.end(), eastl::begin(quad), eastl::end(quad));
+        }
+    }
+  }
+
+  TIME_PROFILE(relevance_occlusion_rasterize_hmap);
+  return rasterizeTriangles(hmapVerts.data(), hmapVerts.size(), hmapIndices.data(), hmapIndices.size() / 3);
+}
+
+struct RelevanceOcclusion::GatherRiOccludersCB : public rendinst::ForeachCB
+{
+  RelevanceOcclusion &owner;
+
+  explicit GatherRiOccludersCB(RelevanceOcclusion &owner) : owner(owner) {}
+
+  void executeForTm(RendInstGenData *, const rendinst::RendInstDesc &desc, const TMatrix &tm) override
+  {
+    if (const CollisionResource *collRes = rendinst::getRiGenCollisionResource(desc))
+      owner.appendBoxOccluders(*collRes, tm);
+  }
+};
+
+int RelevanceOcclusion::rasterizeRendInsts(const Point3 &pos)
+{
+  TIME_PROFILE(relevance_occlusion_rasterize_ri);
+  boxVerts.clear();
+  GatherRiOccludersCB cb(*this);
+  const BBox3 box(pos, cfg.radius * 2.f);
+  rendinst::foreachRIGenInBox(box, rendinst::GatherRiTypeFlag::RiGenTmAndExtra, cb);
+  return rasterizeBoxOccluders();
+}
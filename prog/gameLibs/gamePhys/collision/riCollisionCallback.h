@@ -1,6 +1,7 @@
 #pragma once
 #include <rendInst/rendInstGen.h>
 #include <gamePhys/collision/rendinstCollision.h>
+#include "collisionGlobals.h"
 
 template <typename T>
 struct RICollisionCB : public rendinst::RendInstCollisionCB
@@ -27,6 +28,7 @@ struct RICollisionCB : public rendinst::RendInstCollisionCB
     if (!info.handle)
       return;
 
+    dacoll::ParallelQueriesScopedLock lock;
     CollisionObject riObj = processCollisionInstance(info);
     callback.onContact(riObj, info.desc);
   }
@@ -36,6 +38,7 @@ struct RICollisionCB : public rendinst::RendInstCollisionCB
     if (!info.handle)
       return;
 
+    dacoll::ParallelQueriesScopedLock lock;
     CollisionObject riObj = processCollisionInstance(info);
     callback.onContact(riObj, info.desc);
   }
@@ -0,0 +1,271 @@
+#include <UnitTest++/UnitTestPP.h>
+#include <gamePhys/collision/collisionPoseHistory.h>
+#include <gameRes/dag_collisionResource.h>
+#include <math/dag_geomTree.h>
+#include <ioSys/dag_memIo.h>
+#include <generic/dag_patchTab.h>
+#include <generic/dag_tab.h>
+#include <vecmath/dag_vecMath.h>
+#include <math.h>
+#include <string.h>
+
+using namespace dacoll;
+
+static constexpr float INTERVAL = 0.125f; // exact in float, so sample times i * INTERVAL are never closer than interval
+static constexpr float HISTORY_TIME = 10 * INTERVAL;
+static constexpr int CAPACITY = 11; // HISTORY_TIME / INTERVAL + 1
+static constexpr float POS_EPS = 2e-3f, AXIS_EPS = 2e-3f;
+static const vec3f TREE_WOFS = v_make_vec4f(1000.f, 0.f, 2000.f, 0.f);
+
+enum
+{
+  NODE_ROOT,
+  NODE_BODY,
+  NODE_HEAD,
+  NODE_BOX,
+  NODE_COUNT
+};
+static const char *const NODE_NAMES[NODE_COUNT] = {"root", "body", "head", "box"};
+
+// geom tree dump layout read by GeomNodeTree::load(), children of root are placed right after it
+struct DumpNode
+{
+  mat44f tm, wtm;
+  PatchableTab<DumpNode> child;
+  PatchablePtr<DumpNode> parent;
+  PatchablePtr<const char> name;
+};
+
+static void make_tree(GeomNodeTree &tree)
+{
+  Tab<char> dump;
+  int namesSize = 0;
+  for (const char *n : NODE_NAMES)
+    namesSize += (int)strlen(n) + 1;
+  dump.resize(sizeof(DumpNode) * NODE_COUNT + namesSize);
+  memset(dump.data(), 0, dump.size());
+
+  DumpNode *nodes = (DumpNode *)dump.data();
+  for (int i = 0, nameOfs = sizeof(DumpNode) * NODE_COUNT; i < NODE_COUNT; i++)
+  {
+    v_mat44_ident(nodes[i].tm);
+    v_mat44_ident(nodes[i].wtm);
+    nodes[i].parent.setPtr((void *)intptr_t(i ? 0 : -1));
+    nodes[i].name.setPtr((void *)intptr_t(nameOfs));
+    memcpy(&dump[nameOfs], NODE_NAMES[i], strlen(NODE_NAMES[i]) + 1);
+    nameOfs += (int)strlen(NODE_NAMES[i]) + 1;
+  }
+#if _TARGET_64BIT
+  nodes[0].child.init((void *)(intptr_t(sizeof(DumpNode)) | (intptr_t(NODE_COUNT - 1) << 32)), NODE_COUNT - 1);
+#else
+  nodes[0].child.init((void *)intptr_t(sizeof(DumpNode)), NODE_COUNT - 1);
+#endif
+
+  Tab<char> file;
+  file.resize(sizeof(int) * 2 + dump.size());
+  const int hdr[2] = {(int)dump.size(), NODE_COUNT};
+  memcpy(file.data(), hdr, sizeof(hdr));
+  memcpy(file.data() + sizeof(hdr), dump.data(), dump.size());
+  InPlaceMemLoadCB crd(file.data(), file.size());
+  tree.load(crd);
+  tree.setWtmOfs(TREE_WOFS);
+}
+
+static CollisionNode &add_node(CollisionResource &res, CollisionResourceNodeType type, int geom_node)
+{
+  CollisionNode &node = res.createNode();
+  node.type = type;
+  node.geomNodeId = dag::Index16(geom_node);
+  return node;
+}
+
+// capsule and two meshes bound to body and head, box is placed with instance tm and its node is not needed
+static void make_coll_res(CollisionResource &res)
+{
+  add_node(res, COLLISION_NODE_TYPE_CAPSULE, NODE_BODY);
+  add_node(res, COLLISION_NODE_TYPE_MESH, NODE_HEAD);
+  add_node(res, COLLISION_NODE_TYPE_MESH, NODE_HEAD);
+  add_node(res, COLLISION_NODE_TYPE_BOX, NODE_BOX);
+  res.setBsphereCenterNode(NODE_ROOT);
+  res.boundingBox = BBox3(Point3(-1.f, 0.f, -1.f), Point3(1.f, 2.f, 1.f));
+  res.boundingSphereRad = 1.5f;
+}
+
+static float sample_time(int i) { return 3.f + i * INTERVAL; }
+
+// instance moves and turns around y, nodes turn relative to it and body bends; so neither positions nor rotations are constant
+static TMatrix instance_tm_at(float i)
+{
+  TMatrix tm = rotyTM(0.2f * i);
+  tm.setcol(3, Point3(10.f + 2.f * i, 0.5f * i, -3.f));
+  return tm;
+}
+
+static Point3 node_pos_at(int i, int node)
+{
+  const Point3 ofs = node == NODE_ROOT ? Point3(0, 0, 0) : node == NODE_BODY ? Point3(0.f, 1.f, 0.1f * i) : Point3(0.f, 1.7f, 0.1f);
+  return instance_tm_at(float(i)) * ofs;
+}
+
+// between samples node position is linear and rotation around the same axis is exact in the middle only
+static void node_wtm_at(float i, int node, mat44f &out_wtm)
+{
+  const int i0 = (int)floorf(i);
+  const Point3 pos = lerp(node_pos_at(i0, node), node_pos_at(i0 + 1, node), i - i0);
+  const float yaw = 0.2f * i + (node == NODE_HEAD ? 0.3f * i : 0.f);
+  const float scale = node == NODE_HEAD ? 1.5f : 1.f;
+  v_mat44_compose(out_wtm, v_ldu_p3(&pos.x), v_quat_from_unit_vec_ang(V_C_UNIT_0100, v_splats(yaw)), v_splats(scale));
+}
+
+static void pose_tree_at(float i, GeomNodeTree &tree)
+{
+  for (int n = 0; n < NODE_COUNT; n++)
+  {
+    mat44f wtm;
+    node_wtm_at(i, n, wtm);
+    tree.setNodeWtm(dag::Index16(n), wtm);
+  }
+}
+
+static bool near(vec4f a, vec4f b, float eps) { return v_extract_x(v_length3_x(v_sub(a, b))) <= eps; }
+
+static bool same_tm(const TMatrix &a, const TMatrix &b)
+{
+  for (int c = 0; c < 4; c++)
+    if (length(a.getcol(c) - b.getcol(c)) > (c == 3 ? POS_EPS : AXIS_EPS))
+      return false;
+  return true;
+}
+
+static bool same_node_wtm(const GeomNodeTree &tree, int node, float i)
+{
+  mat44f got, expected;
+  tree.getNodeWtm(dag::Index16(node), got);
+  node_wtm_at(i, node, expected);
+  return near(got.col0, expected.col0, AXIS_EPS) && near(got.col1, expected.col1, AXIS_EPS) &&
+         near(got.col2, expected.col2, AXIS_EPS) && near(got.col3, expected.col3, POS_EPS);
+}
+
+// sample index is passed as float, so that poses between samples are described with the same functions
+static bool check_rewind(const CollisionPoseHistory &history, float at_time, float i)
+{
+  GeomNodeTree scratch;
+  make_tree(scratch);
+  TMatrix tm;
+  if (!history.rewind(at_time, scratch, tm))
+    return false;
+  return same_tm(tm, instance_tm_at(i)) && same_node_wtm(scratch, NODE_ROOT, i) && same_node_wtm(scratch, NODE_BODY, i) &&
+         same_node_wtm(scratch, NODE_HEAD, i);
+}
+
+static void record(CollisionPoseHistory &history, GeomNodeTree &tree, int first, int last)
+{
+  for (int i = first; i <= last; i++)
+  {
+    pose_tree_at(float(i), tree);
+    history.sample(sample_time(i), instance_tm_at(float(i)), tree);
+  }
+}
+
+struct PoseHistoryFixture
+{
+  CollisionResource res;
+  GeomNodeTree tree;
+  CollisionPoseHistory history;
+
+  PoseHistoryFixture()
+  {
+    make_coll_res(res);
+    make_tree(tree);
+    history.init(res, tree, HISTORY_TIME, INTERVAL);
+  }
+};
+
+TEST_FIXTURE(PoseHistoryFixture, RewindsToRecordedPoses)
+{
+  CHECK(history.isInited());
+  GeomNodeTree scratch(tree);
+  TMatrix tm;
+  CHECK(!history.rewind(sample_time(0), scratch, tm)); // nothing is recorded yet
+
+  const size_t mem = history.getMemoryUsage();
+  record(history, tree, 0, 4);
+  CHECK_EQUAL(5, history.getSamplesCount());
+  CHECK_EQUAL(mem, history.getMemoryUsage());
+  CHECK_EQUAL(sample_time(0), history.getOldestTime());
+  CHECK_EQUAL(sample_time(4), history.getNewestTime());
+  for (int i = 0; i <= 4; i++)
+    CHECK(check_rewind(history, sample_time(i), float(i)));
+}
+
+TEST_FIXTURE(PoseHistoryFixture, InterpolatesBetweenSamples)
+{
+  record(history, tree, 0, 4);
+  for (int i = 0; i < 4; i++)
+    CHECK(check_rewind(history, sample_time(i) + INTERVAL * 0.5f, i + 0.5f));
+
+  GeomNodeTree scratch(tree);
+  TMatrix tm;
+  CHECK(history.rewind(sample_time(1) + INTERVAL * 0.25f, scratch, tm));
+  CHECK(length(tm.getcol(3) - instance_tm_at(1.25f).getcol(3)) <= POS_EPS);
+  for (int n : {NODE_BODY, NODE_HEAD})
+  {
+    mat44f w0, w1;
+    node_wtm_at(1.f, n, w0);
+    node_wtm_at(2.f, n, w1);
+    CHECK(near(scratch.getNodeWpos(dag::Index16(n)), v_lerp_vec4f(v_splats(0.25f), w0.col3, w1.col3), POS_EPS));
+  }
+}
+
+TEST_FIXTURE(PoseHistoryFixture, ClampsTimeToRecordedRange)
+{
+  record(history, tree, 0, 4);
+  CHECK(check_rewind(history, sample_time(-10), 0.f));
+  CHECK(check_rewind(history, sample_time(100), 4.f));
+
+  history.reset();
+  CHECK_EQUAL(0, history.getSamplesCount());
+  GeomNodeTree scratch(tree);
+  TMatrix tm;
+  CHECK(!history.rewind(sample_time(0), scratch, tm));
+}
+
+TEST_FIXTURE(PoseHistoryFixture, SkipsSamplesSoonerThanInterval)
+{
+  record(history, tree, 0, 0);
+  pose_tree_at(5.f, tree);
+  history.sample(sample_time(0) + INTERVAL * 0.5f, instance_tm_at(5.f), tree);
+  history.sample(sample_time(0), instance_tm_at(5.f), tree);
+  CHECK_EQUAL(1, history.getSamplesCount());
+  CHECK(check_rewind(history, sample_time(0), 0.f));
+}
+
+TEST_FIXTURE(PoseHistoryFixture, OnlyCollisionNodesAreRewound)
+{
+  record(history, tree, 0, 1);
+  GeomNodeTree scratch(tree);
+  mat44f sentinel;
+  v_mat44_ident(sentinel);
+  sentinel.col3 = v_make_vec4f(-7.f, -7.f, -7.f, 1.f);
+  scratch.getNodeWtmRel(dag::Index16(NODE_BOX)) = sentinel;
+  TMatrix tm;
+  CHECK(history.rewind(sample_time(0), scratch, tm));
+  CHECK(near(scratch.getNodeWtmRel(dag::Index16(NODE_BOX)).col3, sentinel.col3, 0.f));
+}
+
+TEST_FIXTURE(PoseHistoryFixture, RingWrapsAround)
+{
+  const size_t mem = history.getMemoryUsage();
+  const int last = CAPACITY * 2 + 5;
+  record(history, tree, 0, last);
+  CHECK_EQUAL(CAPACITY, history.getSamplesCount());
+  CHECK_EQUAL(mem, history.getMemoryUsage());
+  CHECK_EQUAL(sample_time(last - CAPACITY + 1), history.getOldestTime());
+  CHECK_EQUAL(sample_time(last), history.getNewestTime());
+
+  // overwritten samples are gone, older time is clamped to oldest kept sample
+  for (int i = last - CAPACITY + 1; i <= last; i++)
+    CHECK(check_rewind(history, sample_time(i), float(i)));
+  CHECK(check_rewind(history, sample_time(last - CAPACITY - 3), float(last - CAPACITY + 1)));
+  CHECK(check_rewind(history, sample_time(last - 1) + INTERVAL * 0.5f, last - 0.5f));
+}
@@ -0,0 +1,120 @@
+#include <UnitTest++/UnitTestPP.h>
+#include <gamePhys/collision/relevanceOcclusion.h>
+#include <gameRes/dag_collisionResource.h>
+#include <math/dag_bounds3.h>
+#include <vecmath/dag_vecMath.h>
+
+using namespace dacoll;
+
+// observer looks along +z, targets are ~30m ahead of it, occluders are between them
+static const Point3 OBSERVER_POS(0.f, 2.f, 0.f);
+
+static bbox3f target_box(float x, float z)
+{
+  bbox3f box;
+  box.bmin = v_make_vec4f(x - 1.f, 0.f, z - 1.f, 0.f);
+  box.bmax = v_make_vec4f(x + 1.f, 3.f, z + 1.f, 0.f);
+  return box;
+}
+
+static CollisionNode &add_node(CollisionResource &res, CollisionResourceNodeType type, const BBox3 &box)
+{
+  CollisionNode &node = res.createNode();
+  node.type = type;
+  node.flags = CollisionNode::IDENT | CollisionNode::ORTHONORMALIZED;
+  node.tm.identity();
+  node.modelBBox = box;
+  node.boundingSphere = BSphere3(box.center(), length(box.width()) * 0.5f);
+  return node;
+}
+
+static TMatrix place_at(float z)
+{
+  TMatrix tm = TMatrix::IDENT;
+  tm.setcol(3, Point3(0.f, 0.f, z));
+  return tm;
+}
+
+// two walls with aligned doorways (x in -2..2, y below 6) and side walls, all of them are solid box nodes
+static void make_box_building(CollisionResource &res)
+{
+  for (float z : {-4.f, 4.f})
+  {
+    add_node(res, COLLISION_NODE_TYPE_BOX, BBox3(Point3(-10.f, 0.f, z - 0.25f), Point3(-2.f, 8.f, z + 0.25f)));
+    add_node(res, COLLISION_NODE_TYPE_BOX, BBox3(Point3(2.f, 0.f, z - 0.25f), Point3(10.f, 8.f, z + 0.25f)));
+    add_node(res, COLLISION_NODE_TYPE_BOX, BBox3(Point3(-2.f, 6.f, z - 0.25f), Point3(2.f, 8.f, z + 0.25f)));
+  }
+  for (float x : {-10.f, 10.f})
+    add_node(res, COLLISION_NODE_TYPE_BOX, BBox3(Point3(x - 0.25f, 0.f, -4.f), Point3(x + 0.25f, 8.f, 4.f)));
+  res.rebuildNodesLL();
+}
+
+TEST(SolidBoxHidesTargetBehindIt)
+{
+  RelevanceOcclusion occlusion;
+  occlusion.init();
+  CollisionResource res;
+  add_node(res, COLLISION_NODE_TYPE_BOX, BBox3(Point3(-5.f, -2.f, -0.5f), Point3(5.f, 8.f, 0.5f))); // partially under ground
+  res.rebuildNodesLL();
+
+  CHECK(occlusion.isVisible(target_box(0.f, 30.f))); // nothing is hidden before preparation
+  occlusion.clear(OBSERVER_POS);
+  CHECK(occlusion.addOccluder(res, place_at(15.f)) > 0);
+  CHECK(!occlusion.isVisible(target_box(0.f, 30.f)));
+  CHECK(occlusion.isVisible(target_box(0.f, 10.f)));  // in front of wall
+  CHECK(occlusion.isVisible(target_box(20.f, 30.f))); // aside of it
+}
+
+TEST(TreeDoesNotHideTargetBehindIt)
+{
+  RelevanceOcclusion occlusion;
+  occlusion.init();
+  // trunk capsule and crown mesh, render box of such tree would cover the target completely
+  CollisionResource res;
+  add_node(res, COLLISION_NODE_TYPE_CAPSULE, BBox3(Point3(-0.5f, 0.f, -0.5f), Point3(0.5f, 10.f, 0.5f)));
+  add_node(res, COLLISION_NODE_TYPE_MESH, BBox3(Point3(-5.f, 0.f, -5.f), Point3(5.f, 12.f, 5.f)));
+  res.rebuildNodesLL();
+
+  occlusion.clear(OBSERVER_POS);
+  CHECK_EQUAL(0, occlusion.addOccluder(res, place_at(15.f)));
+  CHECK(occlusion.isVisible(target_box(0.f, 30.f)));
+}
+
+TEST(HollowMeshBuildingDoesNotHideTargetBehindIt)
+{
+  RelevanceOcclusion occlusion;
+  occlusion.init();
+  CollisionResource res;
+  add_node(res, COLLISION_NODE_TYPE_MESH, BBox3(Point3(-10.f, 0.f, -4.f), Point3(10.f, 8.f, 4.f)));
+  res.rebuildNodesLL();
+
+  occlusion.clear(OBSERVER_POS);
+  CHECK_EQUAL(0, occlusion.addOccluder(res, place_at(16.f)));
+  CHECK(occlusion.isVisible(target_box(0.f, 30.f)));
+}
+
+TEST(TargetSeenThroughDoorwaysOfBoxBuildingIsVisible)
+{
+  RelevanceOcclusion occlusion;
+  occlusion.init();
+  CollisionResource res;
+  make_box_building(res);
+
+  occlusion.clear(OBSERVER_POS);
+  CHECK(occlusion.addOccluder(res, place_at(16.f)) > 0);
+  CHECK(occlusion.isVisible(target_box(0.f, 30.f)));   // through both doorways
+  CHECK(!occlusion.isVisible(target_box(-14.f, 30.f))); // behind walls
+}
+
+TEST(BoxAroundObserverIsNotOccluder)
+{
+  RelevanceOcclusion occlusion;
+  occlusion.init();
+  CollisionResource res;
+  add_node(res, COLLISION_NODE_TYPE_BOX, BBox3(Point3(-20.f, -5.f, -20.f), Point3(20.f, 20.f, 20.f)));
+  res.rebuildNodesLL();
+
+  occlusion.clear(OBSERVER_POS);
+  CHECK_EQUAL(0, occlusion.addOccluder(res, TMatrix::IDENT));
+  CHECK(occlusion.isVisible(target_box(0.f, 30.f)));
+}
@@ -23,6 +23,8 @@
 #include <ioSys/dag_dataBlock.h>
 
 #include <util/dag_string.h>
+#include <util/dag_parallelForInline.h>
+#include <dag/dag_vector.h>
 
 namespace pathfinder
 {
@@ -369,7 +371,7 @@ struct RendinstVertexDataCbGame : public rendinst::RendinstVertexDataCbBase
 };
 
 static bool finalize_navmesh_tilecached_tile(rcContext &ctx, const rcConfig &cfg, recastnavmesh::RecastTileContext &tile_ctx, int tx,
-  int ty, const Tab<MarkData> &obstacles, Tab<recastnavmesh::BuildTileData> &tile_data)
+  int ty, const Tab<MarkData> &obstacles, Tab<recastnavmesh::BuildTileData> &tile_data, dtTileCacheCompressor *comp)
 {
   auto fn = [](const Tab<MarkData> &obstacles, const rcConfig &cfg, dtTileCacheLayer &layer, const dtTileCacheLayerHeader &header) {
     for (const auto &obs : obstacles)
@@ -382,7 +384,7 @@ static bool finalize_navmesh_tilecached_tile(rcContext &ctx, const rcConfig &cfg
     }
   };
 
-  return finalize_navmesh_tilecached_tile(ctx, cfg, tileCache->getAlloc(), tileCache->getCompressor(), nullptr, tile_ctx, tx, ty,
+  return finalize_navmesh_tilecached_tile(ctx, cfg, tileCache->getAlloc(), comp, nullptr, tile_ctx, tx, ty,
     tileCache->getParams()->walkableClimb, tileCache->getParams()->walkableHeight, tileCache->getParams()->walkableRadius, obstacles,
     tile_data, fn);
 }
@@ -669,100 +671,129 @@ void rebuildNavMesh_update_removeTiles()
   navMesh->reconstructFreeList();
 }
 
-bool rebuildNavMesh_update_buildTiles(int n)
+struct RebuildTileJob
 {
-  Tab<IPoint2> transparent;
+  int tx, ty;
+  BBox3 bbox;
   Tab<MarkData> obstacles;
+  Tab<recastnavmesh::BuildTileData> tileData;
+};
 
-  for (int i = 0; i < n && !rebuildedTiles.empty(); ++i)
-  {
-    const float tileSize = tileCache->getParams()->cs * tileCache->getParams()->width;
-
-    int tx = rebuildedTiles.begin()->first.first;
-    int ty = rebuildedTiles.begin()->first.second;
+// doesn't touch navmesh and tile cache, so it can be run for different tiles concurrently
+static void build_tile(RebuildTileJob &job, dtTileCacheCompressor *comp)
+{
+  Tab<Point3> vertices;
+  Tab<int> indices;
+  Tab<IPoint2> transparent;
 
-    BBox3 bbox;
+  BBox3 extGeomBox(job.bbox);
+  extGeomBox.inflate(tileCache->getParams()->width * tileCache->getParams()->cs);
 
-    bbox.lim[0] = Point3(tileCache->getParams()->orig[0] + tx * tileSize, rebuildedTiles.begin()->second.first,
-      tileCache->getParams()->orig[2] + ty * tileSize);
+  collect_height_map_geometry(extGeomBox, vertices, indices);
+  collect_rendinst(extGeomBox, vertices, indices, transparent, job.obstacles);
+  const Tab<IPoint2> noTransparent;
 
-    bbox.lim[1] = Point3(tileCache->getParams()->orig[0] + (tx + 1) * tileSize, rebuildedTiles.begin()->second.second,
-      tileCache->getParams()->orig[2] + (ty + 1) * tileSize);
+  rcContext ctx;
+  rcConfig cfg;
 
-    Tab<Point3> vertices;
-    Tab<int> indices;
+  init_tile_config(cfg, vertices);
 
-    BBox3 extGeomBox(bbox);
-    extGeomBox.inflate(tileCache->getParams()->width * tileCache->getParams()->cs);
+  recastnavmesh::RecastTileContext tile_ctx;
 
-    collect_height_map_geometry(extGeomBox, vertices, indices);
-    collect_rendinst(extGeomBox, vertices, indices, transparent, obstacles);
-    const Tab<IPoint2> noTransparent;
+  if (!prepare_tile_context(ctx, cfg, tile_ctx, job.tx, job.ty, vertices, indices, noTransparent))
+  {
+    logerr("Rebuild NavMesh: failed to prepare tile context at (%d,%d)", job.tx, job.ty);
+    return;
+  }
 
-    // build tiles
-    {
-      rcContext ctx;
-      rcConfig cfg;
+  // TODO LATER Use transparent array to build heightmap for covers tracing without transparent geometry
+  // TODO LATER when covers generation added here.
 
-      init_tile_config(cfg, vertices);
+  if (!finalize_navmesh_tilecached_tile(ctx, cfg, tile_ctx, job.tx, job.ty, job.obstacles, job.tileData, comp))
+  {
+    logerr("Rebuild NavMesh: failed to generate navmesh tiles at (%d,%d)", job.tx, job.ty);
+    job.tileData.clear();
+    return;
+  }
+  tile_ctx.clearIntermediate(nullptr);
+}
 
-      recastnavmesh::RecastTileContext tile_ctx;
-      Tab<recastnavmesh::BuildTileData> tile_data;
+bool rebuildNavMesh_update_buildTiles(int n)
+{
+  const float tileSize = tileCache->getParams()->cs * tileCache->getParams()->width;
+  dag::Vector<RebuildTileJob> jobs;
+  jobs.reserve(min(n, (int)rebuildedTiles.size()));
+  for (auto it = rebuildedTiles.begin(); it != rebuildedTiles.end() && (int)jobs.size() < n; ++it)
+  {
+    RebuildTileJob &job = jobs.push_back();
+    job.tx = it->first.first;
+    job.ty = it->first.second;
+    job.bbox.lim[0] = Point3(tileCache->getParams()->orig[0] + job.tx * tileSize, it->second.first,
+      tileCache->getParams()->orig[2] + job.ty * tileSize);
+    job.bbox.lim[1] = Point3(tileCache->getParams()->orig[0] + (job.tx + 1) * tileSize, it->second.second,
+      tileCache->getParams()->orig[2] + (job.ty + 1) * tileSize);
+  }
 
-      if (!prepare_tile_context(ctx, cfg, tile_ctx, tx, ty, vertices, indices, noTransparent))
-      {
-        logerr("Rebuild NavMesh: failed to prepare tile context at (%d,%d)", tx, ty);
-        continue;
-      }
+  // layers are loaded lazily on first use
+  navmeshLayers.load();
 
-      // TODO LATER Use transparent array to build heightmap for covers tracing without transparent geometry
-      // TODO LATER when covers generation added here.
+  // Tiles are rasterized and built on threadpool, each worker with its own decompression context, as tile cache one is stateful.
+  // Navmesh and tile cache are only changed below on this thread, in the same order as tiles were taken.
+  const int numWorkers = threadpool::get_num_workers();
+  if (jobs.size() > 1 && numWorkers > 0)
+  {
+    TileCacheCompressor *tcComp = static_cast<TileCacheCompressor *>(tileCache->getCompressor());
+    dag::Vector<TileCacheCompressor> workerComps(numWorkers + 1);
+    for (TileCacheCompressor &comp : workerComps)
+      comp.resetAsCopyOf(*tcComp);
+    threadpool::parallel_for_inline(0, jobs.size(), 1, [&](uint32_t begin, uint32_t end, uint32_t thread_id) {
+      for (uint32_t i = begin; i < end; ++i)
+        build_tile(jobs[i], &workerComps[thread_id]);
+    });
+  }
+  else
+    for (RebuildTileJob &job : jobs)
+      build_tile(job, tileCache->getCompressor());
 
-      if (!finalize_navmesh_tilecached_tile(ctx, cfg, tile_ctx, tx, ty, obstacles, tile_data))
-      {
-        logerr("Rebuild NavMesh: failed to generate navmesh tiles at (%d,%d)", tx, ty);
+  Tab<MarkData> obstacles;
+  for (RebuildTileJob &job : jobs)
+  {
+    for (int i = 0; i < job.tileData.size(); ++i)
+    {
+      const recastnavmesh::BuildTileData &td = job.tileData[i];
+      if (td.tileCacheDataSz == 0 || td.navMeshDataSz == 0)
         continue;
-      }
 
-      for (int i = 0; i < tile_data.size(); ++i)
-      {
-        if (tile_data[i].tileCacheDataSz == 0 || tile_data[i].navMeshDataSz == 0)
-          continue;
+      rebuildedTilesTotalSz += td.tileCacheDataSz;
+      rebuildedTilesTotalSz += td.navMeshDataSz;
 
-        rebuildedTilesTotalSz += tile_data[i].tileCacheDataSz;
-        rebuildedTilesTotalSz += tile_data[i].navMeshDataSz;
+      dtCompressedTileRef res = 0;
+      dtTileRef nav = 0;
 
-        dtCompressedTileRef res = 0;
-        dtTileRef nav = 0;
+      {
+        dtStatus status = tileCache->addTile(td.tileCacheData, td.tileCacheDataSz, DT_COMPRESSEDTILE_FREE_DATA, &res);
 
+        if (dtStatusSucceed(status) && res != 0)
+          tileCToSave.push_back(res);
+        else
         {
-          dtStatus status =
-            tileCache->addTile(tile_data[i].tileCacheData, tile_data[i].tileCacheDataSz, DT_COMPRESSEDTILE_FREE_DATA, &res);
-
-          if (dtStatusSucceed(status) && res != 0)
-            tileCToSave.push_back(res);
-          else
-          {
-            logerr("Rebuild NavMesh: failed to add tilecache tile at (%d,%d)", tx, ty);
-          }
+          logerr("Rebuild NavMesh: failed to add tilecache tile at (%d,%d)", job.tx, job.ty);
         }
+      }
 
+      {
+        dtStatus status = getNavMeshPtr()->addTile(td.navMeshData, td.navMeshDataSz, DT_TILE_FREE_DATA, 0, &nav);
+
+        if (dtStatusSucceed(status) && nav != 0)
+          tilesToSave.push_back(nav);
+        else
         {
-          dtStatus status = getNavMeshPtr()->addTile(tile_data[i].navMeshData, tile_data[i].navMeshDataSz, DT_TILE_FREE_DATA, 0, &nav);
-
-          if (dtStatusSucceed(status) && nav != 0)
-            tilesToSave.push_back(nav);
-          else
-          {
-            logerr("Rebuild NavMesh: failed to add navmesh tile at (%d,%d)", tx, ty);
-          }
+          logerr("Rebuild NavMesh: failed to add navmesh tile at (%d,%d)", job.tx, job.ty);
         }
-
-        tile_ctx.clearIntermediate(nullptr);
       }
     }
-
-    rebuildedTiles.erase(rebuildedTiles.begin());
+    append_items(obstacles, job.obstacles.size(), job.obstacles.data());
+    rebuildedTiles.erase(eastl::pair<int, int>(job.tx, job.ty));
   }
 
   Tab<obstacle_handle_t> removedHandles;
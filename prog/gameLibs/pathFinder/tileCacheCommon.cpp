@@ -81,15 +81,18 @@ static inline bool is_pt_in_obstacle(const float *center, const float *half_exte
 TileCacheCompressor::~TileCacheCompressor()
 {
   ZSTD_freeDCtx(dctx);
-  ZSTD_freeDDict(dDict);
+  if (ownDict)
+    ZSTD_freeDDict(dDict);
 }
 
 void TileCacheCompressor::reset(bool isZSTD, const Tab<char> &zstdDictBuff)
 {
   ZSTD_freeDCtx(dctx);
-  ZSTD_freeDDict(dDict);
+  if (ownDict)
+    ZSTD_freeDDict(dDict);
   dctx = nullptr;
   dDict = nullptr;
+  ownDict = true;
 
   if (!isZSTD)
     return;
@@ -103,6 +106,18 @@ void TileCacheCompressor::reset(bool isZSTD, const Tab<char> &zstdDictBuff)
   }
 }
 
+void TileCacheCompressor::resetAsCopyOf(const TileCacheCompressor &src)
+{
+  reset(false);
+  if (!src.dctx)
+    return;
+  // decompression context is the only state, which can't be shared between threads
+  dctx = ZSTD_createDCtx();
+  G_ASSERT(dctx);
+  dDict = src.dDict;
+  ownDict = false;
+}
+
 int TileCacheCompressor::maxCompressedSize(const int bufferSize)
 {
   return (dctx != nullptr) ? (int)ZSTD_compressBound(bufferSize) : (int)(bufferSize * fastlzMaxCompressedSizeFactor);
@@ -120,6 +120,23 @@ struct QueryView
     auto p = getComponentRawRW<T>(compId);
     return p ? &PtrComponentType<T>::ref(p + idInChunk) : nullptr;
   }
+  // contiguous components of all entities in view (not boxed types only, as boxed are stored as pointers)
+  template <class T>
+  DECL_RESTRICT const T *__restrict getComponentSpanRO(uint16_t compId) const
+  {
+    static_assert(!PtrComponentType<T>::is_boxed, "boxed components can't be accessed as span");
+    auto p = getComponentRawRO<T>(compId);
+    QUERY_FAST_ASSERT(p);
+    return p + chunkEntitiesStart;
+  }
+  template <class T>
+  DECL_RESTRICT T *__restrict getComponentSpanRW(uint16_t compId) const
+  {
+    static_assert(!PtrComponentType<T>::is_boxed, "boxed components can't be accessed as span");
+    auto p = getComponentRawRW<T>(compId);
+    QUERY_FAST_ASSERT(p);
+    return p + chunkEntitiesStart;
+  }
   uint32_t getWorkerId() const { return workerId; }
   EntityManager &__restrict manager() const { return *mgr; }
   QueryId getQueryId() const { return id; }
@@ -291,6 +308,8 @@ struct ComponentSystemIndex
 #define ECS_RO_COMP_OR(carr, cname, def) components.getComponentRODef(ECS_QUERY_COMP_RO_INDEX(carr, cname), comp, def)
 #define ECS_RO_COMP_PTR(carr, cname, T)  components.getComponentROOpt<T>(ECS_QUERY_COMP_RO_INDEX(carr, cname), comp)
 #define ECS_RW_COMP_PTR(carr, cname, T)  components.getComponentRWOpt<T>(ECS_QUERY_COMP_RW_INDEX(carr, cname), comp)
+#define ECS_RO_COMP_SPAN(carr, cname, T) components.getComponentSpanRO<T>(ECS_QUERY_COMP_RO_INDEX(carr, cname))
+#define ECS_RW_COMP_SPAN(carr, cname, T) components.getComponentSpanRW<T>(ECS_QUERY_COMP_RW_INDEX(carr, cname))
 
 //#define ECS_QUERY_COMP_PTR(T, name, RORW, chunk, carr, query)\
 //  query.getComponentRaw_##RORW##<T>(ECS_QUERY_COMP_INDEX(carr##_##RORW, name), chunk)
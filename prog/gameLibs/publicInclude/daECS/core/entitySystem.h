@@ -208,6 +208,8 @@ inline void clear_component_manager_registry()
 #define ECS_TRACK_ONE(a)  __attribute__((annotate("@track:" #a)))
 #define ECS_TRACK(...)    ECS_FOR_EACH(ECS_TRACK_ONE, __VA_ARGS__)
 #define ECS_NO_ORDER      __attribute__((annotate("@before:*")))
+// update es is called once per chunk as es(info, uint32_t count, T *__restrict comp, const T2 *__restrict comp2...), for SIMD loops
+#define ECS_CHUNK_SPAN    __attribute__((annotate("@chunk_span")))
 #else
 #define ECS_BEFORE_ONE(a)
 #define ECS_BEFORE(...)
@@ -218,4 +220,5 @@ inline void clear_component_manager_registry()
 #define ECS_TRACK_ONE(a)
 #define ECS_TRACK(...)
 #define ECS_NO_ORDER
+#define ECS_CHUNK_SPAN
 #endif
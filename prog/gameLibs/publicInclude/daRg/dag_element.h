@@ -63,6 +63,7 @@ class ScrollHandler;
 class Transition;
 class ElementTree;
 class ElementRef;
+struct RenderCache;
 
 
 struct ElemStacks
@@ -328,6 +329,9 @@ public:
   Point2 scrollVel = Point2(0, 0);
   ElementRef *ref = nullptr;
 
+  uint32_t setupGeneration = 0;        // incremented on each setup() to invalidate cached rendering
+  RenderCache *renderCache = nullptr; // recorded draw commands of subtree, if enabled with 'renderCache' property
+
 private:
   int flags = 0;
   int stateFlags = 0;
@@ -195,6 +195,7 @@ namespace darg
   KEY(priority)               \
   KEY(priorityOffset)         \
   KEY(prop)                   \
+  KEY(renderCache)            \
   KEY(rendObj)                \
   KEY(rotate)                 \
   KEY(rtAlwaysUpdate)         \
@@ -275,6 +275,14 @@ bool is_debug_draw_forced();
 
 void fetch_sim_res(bool wait);
 
+// Between these calls (made on main thread with no jobs using collision running) casts, traces and contact tests may also be
+// called from threadpool workers. Workers get own temporary cast shapes and own copies of bodies passed to test_pair_collision*()
+// (valid until end_parallel_queries()), contact tests and heightmap queries are serialized. Collision world must not be changed
+// meanwhile.
+void begin_parallel_queries();
+void end_parallel_queries();
+bool is_parallel_queries_active();
+
 void set_obj_motion(CollisionObject obj, const TMatrix &tm, const Point3 &vel, const Point3 &omega);
 void set_obj_active(CollisionObject &coll_obj, bool active, bool is_kinematic = false);
 bool is_obj_active(const CollisionObject &coll_obj);
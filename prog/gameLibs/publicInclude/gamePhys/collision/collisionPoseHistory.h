@@ -0,0 +1,70 @@
+//
+// Dagor Engine 6.5 - Game Libraries
+// Copyright (C) 2023  Gaijin Games KFT.  All rights reserved
+// (for conditions of use see prog/license.txt)
+//
+#pragma once
+
+#include <math/dag_TMatrix.h>
+#include <math/dag_Point3.h>
+#include <util/dag_index16.h>
+#include <dag/dag_vector.h>
+
+class CollisionResource;
+class GeomNodeTree;
+
+namespace dacoll
+{
+// Ring of recent collision poses of one entity for server side lag compensated hit tests, so that shot is tested against
+// pose which shooter saw, without re-running animation. Only geom nodes which collision nodes depend on are kept, quantized
+// relative to instance position, so memory is fixed by init() and reported with getMemoryUsage().
+class CollisionPoseHistory
+{
+public:
+  // history_time is how far back poses can be rewound, sample_interval is min time between kept samples
+  void init(const CollisionResource &coll_res, const GeomNodeTree &tree, float history_time, float sample_interval);
+  void term();
+  // drops recorded poses, i.e. on teleport or respawn
+  void reset() { head = count = 0; }
+  bool isInited() const { return !samples.empty(); }
+
+  // call each tick, calls made sooner than sample_interval after last kept sample are ignored
+  void sample(float at_time, const TMatrix &instance_tm, const GeomNodeTree &tree);
+
+  // Writes pose interpolated at given time to out_tree (copy of entity's tree, only wtm of kept nodes and wofs are changed)
+  // and out_tm. Time is clamped to recorded range, returns false when nothing is recorded.
+  bool rewind(float at_time, GeomNodeTree &out_tree, TMatrix &out_tm) const;
+
+  // traces ray against pose at given time, scratch_tree is used for rewound pose
+  bool traceRay(float at_time, const CollisionResource &coll_res, GeomNodeTree &scratch_tree, const Point3 &from, const Point3 &dir,
+    float &in_out_t, Point3 *out_normal, int &out_mat_id, int &out_node_id) const;
+
+  float getOldestTime() const;
+  float getNewestTime() const;
+  int getSamplesCount() const { return count; }
+  size_t getMemoryUsage() const;
+
+private:
+  struct QuantizedNodeTm
+  {
+    int16_t pos[3];
+    int16_t rot[4];
+    int16_t scale[3];
+  };
+  struct Sample
+  {
+    TMatrix instanceTm;
+    float time;
+  };
+
+  const Sample &getSample(int idx) const { return samples[(head + samples.size() - count + idx) % samples.size()]; }
+  const QuantizedNodeTm *getNodeTms(const Sample &s) const { return nodeTms.data() + (&s - samples.data()) * nodes.size(); }
+
+  dag::Vector<dag::Index16> nodes;
+  dag::Vector<Sample> samples;          // ring of samples.size() capacity
+  dag::Vector<QuantizedNodeTm> nodeTms; // nodes.size() per sample
+  int head = 0, count = 0;
+  float sampleInterval = 0.f;
+  float posQuant = 1.f; // meters per unit of quantized position
+};
+} // namespace dacoll
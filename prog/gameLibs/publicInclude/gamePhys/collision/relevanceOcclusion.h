@@ -0,0 +1,103 @@
+//
+// Dagor Engine 6.5 - Game Libraries
+// Copyright (C) 2023  Gaijin Games KFT.  All rights reserved
+// (for conditions of use see prog/license.txt)
+//
+#pragma once
+
+#include <vecmath/dag_vecMathDecl.h>
+#include <math/dag_Point3.h>
+#include <math/dag_TMatrix.h>
+#include <math/integer/dag_IPoint2.h>
+#include <generic/dag_carray.h>
+#include <dag/dag_vector.h>
+
+class MaskedOcclusionCulling;
+class CollisionResource;
+
+namespace dacoll
+{
+// Coarse software occlusion from one observer point, used on server to leave entities hidden behind terrain and large rendinsts
+// out of replication scope. Only solid box nodes of rendinst collision are occluders, render boxes of trees, fences or hollow
+// buildings would hide what is seen through them. Server doesn't know (and can't wait for) observer's view direction, so occluders are rasterized
+// into 4 low resolution views around observer. Tests are conservative: boxes which can't be proven hidden (i.e. close to
+// observer or out of vertical fov) are visible.
+// Typical use is from scope query: prepare() for connection's observer, then testBoxes() for candidates found by distance
+// before adding them to scope. Instance is not thread safe, use one per worker thread.
+class RelevanceOcclusion
+{
+public:
+  struct Config
+  {
+    int width = 128, height = 64; // per view, should be multiple of 8 and 4
+    float verticalFov = 90.f;     // degrees, horizontal is always 90
+    float nearPlane = 1.f;
+    float radius = 800.f;    // occluders are gathered within this distance
+    float hmapStep = 8.f;    // terrain grid step, grows when radius doesn't fit in grid
+    float hmapBias = 1.f;    // terrain occluder is lowered by this, so it stays under real terrain between grid points
+    float minBoxSize = 4.f;  // collision boxes with two largest extents smaller than this are not used as occluders
+    float boxShrink = 0.1f;  // part of box extent cut from each side, keeps coarse rasterization conservative
+  };
+
+  struct Stats
+  {
+    int prepares = 0;
+    int occluderTris = 0;
+    int testedBoxes = 0;
+    int occludedBoxes = 0;
+    int prepareUsec = 0;
+    int testUsec = 0;
+  };
+
+  RelevanceOcclusion() = default;
+  RelevanceOcclusion(const RelevanceOcclusion &) = delete;
+  RelevanceOcclusion &operator=(const RelevanceOcclusion &) = delete;
+  ~RelevanceOcclusion() { term(); }
+
+  void init();
+  void init(const Config &config);
+  void term();
+  bool isInited() const { return views[0] != nullptr; }
+
+  // rasterizes terrain and rendinsts around observer, everything is visible until first call
+  void prepare(const Point3 &observer_pos);
+  // sets observer and clears occlusion without gathering any occluders, prepare() starts with it
+  void clear(const Point3 &observer_pos);
+  // rasterizes solid box nodes of collision placed with tm (i.e. dynamic objects), call after prepare() or clear()
+  int addOccluder(const CollisionResource &coll_res, const TMatrix &tm);
+  // boxes are in world space, out_visible[i] is set to false for hidden boxes, returns number of hidden boxes
+  int testBoxes(const bbox3f *boxes, int cnt, bool *out_visible);
+  bool isVisible(bbox3f_cref box) const;
+
+  const Stats &getStats() const { return stats; }
+  void resetStats() { stats = Stats(); }
+
+private:
+  static constexpr int VIEWS_COUNT = 4;
+  struct GatherRiOccludersCB;
+
+  int rasterizeHeightmap(const Point3 &pos);
+  int rasterizeRendInsts(const Point3 &pos);
+  int rasterizeTriangles(const vec4f *verts, int verts_count, const uint16_t *indices, int tris_count);
+  int appendBoxOccluders(const CollisionResource &coll_res, const TMatrix &tm); // to boxVerts, returns boxes count
+  int rasterizeBoxOccluders();
+
+  Config cfg;
+  carray<MaskedOcclusionCulling *, VIEWS_COUNT> views = {};
+  carray<mat44f, VIEWS_COUNT> viewClip;
+  Point3 observerPos = Point3(0, 0, 0);
+  bool prepared = false;
+
+  // terrain grid is kept while observer stays in the same grid cell
+  dag::Vector<vec4f> hmapVerts;
+  dag::Vector<uint16_t> hmapIndices;
+  IPoint2 hmapGridOrigin = IPoint2(0, 0);
+  int hmapGridSize = 0;
+  float hmapGridStep = 0.f;
+  int hmapVersion = -1;
+
+  dag::Vector<vec4f> boxVerts;
+  dag::Vector<vec4f> clipVerts;
+  Stats stats;
+};
+} // namespace dacoll
@@ -28,6 +28,8 @@ struct TileCacheCompressor : public dtTileCacheCompressor
   ~TileCacheCompressor();
 
   void reset(bool isZSTD, const Tab<char> &zstdDictBuff = Tab<char>());
+  // makes compressor for use from other thread, dictionary is shared, so src should outlive it
+  void resetAsCopyOf(const TileCacheCompressor &src);
 
   int maxCompressedSize(const int bufferSize) override;
 
@@ -40,6 +42,7 @@ struct TileCacheCompressor : public dtTileCacheCompressor
 private:
   ZSTD_DCtx_s *dctx = nullptr;
   ZSTD_DDict_s *dDict = nullptr;
+  bool ownDict = true;
 };
 
 struct TileCacheMeshProcess : public dtTileCacheMeshProcess
@@ -95,6 +95,16 @@ void gatherRIGenExtraCollidable(riex_collidable_t &out_handles, const BBox3 &box
 void gatherRIGenExtraCollidable(riex_collidable_t &out_handles, const Point3 &p0, const Point3 &dir, float len, bool read_lock);
 void gatherRIGenExtraCollidableMin(riex_collidable_t &out_handles, bbox3f_cref box, float min_bsph_rad);
 
+// Lock-free access to riExtra collision, enabled with riExtraGrid{ lockFreeSnapshot:b=yes; } in game params.
+// Readers never wait for riExtra writers, but see only changes published with publishRIGenExtraSnapshot(); it is called
+// after level load and once per frame from updateRIGen(), game may call it at other sync points (e.g. after batch of spawns).
+// When enabled, riExtra part of rendinst traces is done on the snapshot; gatherRIGenExtraCollidable() always uses riExtraGrid.
+bool isRIGenExtraSnapshotEnabled();
+bool publishRIGenExtraSnapshot();
+void gatherRIGenExtraCollidableSnapshot(riex_collidable_t &out_handles, bbox3f_cref box);
+bool traceRayRIGenExtraSnapshot(const Point3 &from, const Point3 &dir, float &in_out_t, riex_handle_t &out_handle,
+  Point3 *out_norm = nullptr, int ray_mat_id = -1);
+
 // if res_idx == nullptr, would get all, otherwise only those with res_idx in sorted_res_idx array.
 // if fast, it will be checked using spheres only
 void gatherRIGenExtraRenderable(Tab<riex_render_info_t> &out_handles, const int *sorted_res_idx, int count, bbox3f_cref box, bool fast,
@@ -2566,6 +2566,7 @@ void rendinst::updateRIGen(uint32_t curFrame, float dt)
   FOR_EACH_PRIMARY_RG_LAYER_DO (rgl)
     if (rgl->rtData)
       rgl->rtData->updateDebris(curFrame, dt);
+  rendinst::publishRIGenExtraSnapshot();
 }
 void rendinst::initRiGenDebris(const DataBlock &ri_blk, FxTypeByNameCallback get_fx_type_by_name, bool init_sec_ri_extra_here)
 {
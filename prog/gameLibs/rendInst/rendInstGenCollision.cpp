@@ -6,6 +6,8 @@
 #include "riGen/riGenExtra.h"
 #include "riGen/riUtil.h"
 #include "riGen/riRotationPalette.h"
+#include "riGen/riRayBinning.h"
+#include "riGen/riExtraSnapshot.h"
 
 #include <gameRes/dag_collisionResource.h>
 #include <math/dag_mathUtils.h>
@@ -14,6 +16,7 @@
 #include <memory/dag_framemem.h>
 #include <gameMath/traceUtils.h>
 #include <util/dag_bitArray.h>
+#include <math/dag_bits.h>
 
 #define LOGLEVEL_DEBUG _MAKE4C('RGEN')
 
@@ -470,6 +473,46 @@ struct RayTransparencyStrat
   }
 };
 
+typedef dag::RelocatableFixedVector<RayPacket4, 4, true, framemem_allocator> RayPackets;
+
+// ray lengths are captured at cell entry, that is conservative for strategies which only shorten rays
+template <typename TraceT>
+static void init_ray_packets(RayPackets &packets, dag::Span<TraceT> traces)
+{
+  packets.resize((traces.size() + 3) / 4);
+  for (int i = 0; i < traces.size(); i += 4)
+  {
+    vec4f from[4], dir[4];
+    float t[4];
+    int cnt = min<int>(4, traces.size() - i);
+    for (int j = 0; j < cnt; j++)
+    {
+      from[j] = v_ldu(&traces[i + j].pos.x);
+      dir[j] = v_ldu(&traces[i + j].dir.x);
+      t[j] = traces[i + j].pos.outT;
+    }
+    packets[i / 4].init(from, dir, t, cnt);
+  }
+}
+
+// calls cb(ray_id) for rays which can hit box (for all rays if packets are empty), stops when cb returns true
+template <typename CB>
+static __forceinline bool for_each_ray_in_box(const RayPackets &packets, int traces_cnt, bbox3f_cref box, CB cb)
+{
+  if (packets.empty())
+  {
+    for (int rayId = 0; rayId < traces_cnt; ++rayId)
+      if (cb(rayId))
+        return true;
+    return false;
+  }
+  for (int pi = 0; pi < packets.size(); pi++)
+    for (unsigned mask = packets[pi].testBox(box); mask; mask &= mask - 1)
+      if (cb(pi * 4 + __ctz_unsafe(mask)))
+        return true;
+  return false;
+}
+
 template <typename Strategy>
 static bool traverseRayCell(RendInstGenData::Cell &cell, bbox3f_cref rayBox, dag::Span<Trace> traces, bool /*trace_meshes*/,
   int layer_idx, rendinst::RendInstDesc *ri_desc, Strategy &strategy, int cell_idx)
@@ -501,6 +544,9 @@ static bool traverseRayCell(RendInstGenData::Cell &cell, bbox3f_cref rayBox, dag
   G_STATIC_ASSERT(SUBCELL_DIV * SUBCELL_DIV <= 64);
   bool haveCollision = false;
   const int tracesCnt = traces.size();
+  RayPackets packets;
+  if (tracesCnt > 1)
+    init_ray_packets(packets, traces);
   for (int i = 0; i < tracesCnt; ++i)
   {
     vec3f rayStart = v_ldu(&traces[i].pos.x);
@@ -575,14 +621,12 @@ static bool traverseRayCell(RendInstGenData::Cell &cell, bbox3f_cref rayBox, dag
           // globalBoxCollided = (tm * collRes->boundingBox) & _objWorldBB;
           if (!v_bbox3_test_box_intersect(transformedBox, rayBox))
             continue;
-          for (int rayId = 0; rayId < tracesCnt; ++rayId)
-          {
-            bool stop =
-              strategy.executeForMesh(collRes, tm, traces[rayId].pos, traces[rayId].dir, traces[rayId].pos.outT, traces[rayId].outNorm,
-                ri_desc, haveCollision, layer_idx, idx, p, int(intptr_t(data) - intptr_t(data_s)), traces[rayId].outMatId, cell_idx);
-            if (stop)
-              return haveCollision;
-          }
+          if (for_each_ray_in_box(packets, tracesCnt, transformedBox, [&](int rayId) {
+                return strategy.executeForMesh(collRes, tm, traces[rayId].pos, traces[rayId].dir, traces[rayId].pos.outT,
+                  traces[rayId].outNorm, ri_desc, haveCollision, layer_idx, idx, p, int(intptr_t(data) - intptr_t(data_s)),
+                  traces[rayId].outMatId, cell_idx);
+              }))
+            return haveCollision;
         }
       }
       else if (bool paletteRotation = (riPaletteRotationData[p / (sizeof(riPosInstBit) * CHAR_BIT)] & riPosInstBit) != 0)
@@ -627,9 +671,9 @@ static bool traverseRayCell(RendInstGenData::Cell &cell, bbox3f_cref rayBox, dag
           v_bbox3_init(riBBox, tm, collRes->vFullBBox);
           BBox3 riWorldCollisionBox, treeWithCanopyWorldCollisionBox;
           v_stu_bbox3(riWorldCollisionBox, riBBox);
+          bbox3f allBBox = riBBox;
           if (checkBBoxAll)
           {
-            bbox3f allBBox;
             v_bbox3_init(allBBox, tm, rgl->rtData->riResBb[p]);
             v_stu_bbox3(treeWithCanopyWorldCollisionBox, allBBox);
 
@@ -645,14 +689,12 @@ static bool traverseRayCell(RendInstGenData::Cell &cell, bbox3f_cref rayBox, dag
               continue;
           }
 
-          for (int rayId = 0; rayId < tracesCnt; ++rayId)
-          {
-            bool stop = strategy.executeForPos(collRes, tm, riWorldCollisionBox, traces[rayId].pos, traces[rayId].dir,
-              traces[rayId].pos.outT, traces[rayId].outNorm, ri_desc, haveCollision, layer_idx, idx, p,
-              int(intptr_t(data) - intptr_t(data_s)), traces[rayId].outMatId, cell_idx, treeWithCanopyWorldCollisionBox);
-            if (stop)
-              return haveCollision;
-          }
+          if (for_each_ray_in_box(packets, tracesCnt, allBBox, [&](int rayId) {
+                return strategy.executeForPos(collRes, tm, riWorldCollisionBox, traces[rayId].pos, traces[rayId].dir,
+                  traces[rayId].pos.outT, traces[rayId].outNorm, ri_desc, haveCollision, layer_idx, idx, p,
+                  int(intptr_t(data) - intptr_t(data_s)), traces[rayId].outMatId, cell_idx, treeWithCanopyWorldCollisionBox);
+              }))
+            return haveCollision;
         }
       }
       else
@@ -697,14 +739,13 @@ static bool traverseRayCell(RendInstGenData::Cell &cell, bbox3f_cref rayBox, dag
 
           mat44f tm;
           v_mat44_compose(tm, v_pos, V_C_UNIT_0001, v_scale);
-          for (int rayId = 0; rayId < tracesCnt; ++rayId)
-          {
-            bool stop = strategy.executeForPos(collRes, tm, worldBoxCollision, traces[rayId].pos, traces[rayId].dir,
-              traces[rayId].pos.outT, traces[rayId].outNorm, ri_desc, haveCollision, layer_idx, idx, p,
-              int(intptr_t(data) - intptr_t(data_s)), traces[rayId].outMatId, cell_idx, worldBoxAll);
-            if (stop)
-              return haveCollision;
-          }
+          // treeBBox is box with canopy here when checkBBoxAll, collision box otherwise
+          if (for_each_ray_in_box(packets, tracesCnt, treeBBox, [&](int rayId) {
+                return strategy.executeForPos(collRes, tm, worldBoxCollision, traces[rayId].pos, traces[rayId].dir,
+                  traces[rayId].pos.outT, traces[rayId].outNorm, ri_desc, haveCollision, layer_idx, idx, p,
+                  int(intptr_t(data) - intptr_t(data_s)), traces[rayId].outMatId, cell_idx, worldBoxAll);
+              }))
+            return haveCollision;
         }
       }
     }
@@ -714,16 +755,10 @@ static bool traverseRayCell(RendInstGenData::Cell &cell, bbox3f_cref rayBox, dag
 
 extern void getRIGenExtra44NoLock(riex_handle_t id, mat44f &out_tm);
 
-template <typename Strategy, bool CHK_BOX, bool READ_LOCK = true>
-bool rayTestRiExtraInstance(dag::Span<Trace> traces, bbox3f_cref ray_box, bbox3f_cref coll_res_bbox, rendinst::riex_handle_t handle,
-  CollisionResource *res, bool &have_collision, Strategy &strategy, dag::Span<rendinst::RendInstDesc> out_ri_desc)
+template <typename Strategy, bool CHK_BOX>
+bool rayTestRiExtraInstanceTm(dag::Span<Trace> traces, bbox3f_cref ray_box, bbox3f_cref coll_res_bbox, rendinst::riex_handle_t handle,
+  mat44f_cref tm, CollisionResource *res, bool &have_collision, Strategy &strategy, dag::Span<rendinst::RendInstDesc> out_ri_desc)
 {
-  mat44f tm;
-  if (READ_LOCK)
-    rendinst::getRIGenExtra44(handle, tm);
-  else
-    rendinst::getRIGenExtra44NoLock(handle, tm);
-
   if (CHK_BOX)
   {
     bbox3f transformedFullBox;
@@ -749,6 +784,19 @@ bool rayTestRiExtraInstance(dag::Span<Trace> traces, bbox3f_cref ray_box, bbox3f
   return false;
 }
 
+template <typename Strategy, bool CHK_BOX, bool READ_LOCK = true>
+bool rayTestRiExtraInstance(dag::Span<Trace> traces, bbox3f_cref ray_box, bbox3f_cref coll_res_bbox, rendinst::riex_handle_t handle,
+  CollisionResource *res, bool &have_collision, Strategy &strategy, dag::Span<rendinst::RendInstDesc> out_ri_desc)
+{
+  mat44f tm;
+  if (READ_LOCK)
+    rendinst::getRIGenExtra44(handle, tm);
+  else
+    rendinst::getRIGenExtra44NoLock(handle, tm);
+  return rayTestRiExtraInstanceTm<Strategy, CHK_BOX>(traces, ray_box, coll_res_bbox, handle, tm, res, have_collision, strategy,
+    out_ri_desc);
+}
+
 static inline void init_raybox_from_trace(bbox3f &box, Trace &trace)
 {
   verify_trace(trace);
@@ -779,10 +827,65 @@ static bool rayHit1RiExtra(Trace &trace, rendinst::RendInstDesc *ri_desc, Materi
   return false;
 }
 
+// same as rayTraverseRiExtra(), but instances (with their tm and collision) are taken from lock-free riExtra snapshot
+template <typename Strategy>
+bool rayTraverseRiExtraSnapshot(bbox3f_cref ray_box, dag::Span<Trace> traces, rendinst::RendInstDesc *ri_desc, Strategy &strategy,
+  bool &haveCollision, riex_handle_t skip_riex_handle)
+{
+  RiExtraSnapshotEntries entries;
+  rendinst::gatherRIGenExtraSnapshotEntries(entries, ray_box);
+
+  dag::RelocatableFixedVector<rendinst::RendInstDesc, 4, true, framemem_allocator> descriptions;
+  descriptions.push_back_uninitialized(traces.size());
+  for (const RiExtraCollSnapshot::Entry &e : entries)
+  {
+    if (EASTL_UNLIKELY(e.handle == skip_riex_handle) || !e.collRes)
+      continue;
+
+    uint32_t res_idx = rendinst::handle_to_ri_type(e.handle);
+    int poolRef = rendinst::riExtra[res_idx].riPoolRef;
+    if (RendInstGenData *rgl = (poolRef >= 0) ? rendinst::getRgLayer(rendinst::riExtra[res_idx].riPoolRefLayer) : nullptr)
+    {
+      const RendInstGenData::RendinstProperties &riProp = rgl->rtData->riProperties[poolRef];
+      if (strategy.shouldIgnoreRendinst(/*isPos*/ false, riProp.immortal, riProp.matId))
+        continue;
+    }
+
+    mat44f tm;
+    v_mat43_transpose_to_mat44(tm, e.tm);
+    for (auto &desc : descriptions)
+      desc.reset();
+    CollisionResource *collRes = const_cast<CollisionResource *>(e.collRes);
+    bool shouldReturn = rayTestRiExtraInstanceTm<Strategy, false>(traces, ray_box, collRes->vFullBBox, e.handle, tm, collRes,
+      haveCollision, strategy, make_span(descriptions));
+    if (ri_desc)
+      for (int j = 0; j < descriptions.size(); ++j)
+        if (descriptions[j].pool >= 0)
+        {
+          *ri_desc = descriptions[0]; // just first one, should be good enough
+          break;
+        }
+
+    if (shouldReturn)
+      return true;
+  }
+  if (haveCollision)
+  {
+    if (ri_desc)
+      ri_desc->setRiExtra();
+    if (strategy.executeForCell(true))
+      return true;
+  }
+  return false;
+}
+
 template <typename Strategy>
 bool rayTraverseRiExtra(bbox3f_cref ray_box, dag::Span<Trace> traces, rendinst::RendInstDesc *ri_desc, Strategy &strategy,
   bool &haveCollision, riex_handle_t skip_riex_handle = rendinst::RIEX_HANDLE_NULL) // pos bbox here!
 {
+  if (rendinst::isRIGenExtraSnapshotEnabled())
+    return rayTraverseRiExtraSnapshot(ray_box, traces, ri_desc, strategy, haveCollision, skip_riex_handle);
+
   riex_collidable_t ri_h;
   if (traces.size() == 1)
     rendinst::gatherRIGenExtraCollidable(ri_h, traces[0].pos, traces[0].dir, traces[0].pos.outT, true /*read_lock*/);
@@ -900,6 +1003,81 @@ bool rayTraverseRendinst(bbox3f_cref rayBox, dag::Span<Trace> traces, bool trace
   return false;
 }
 
+typedef dag::RelocatableFixedVector<uint64_t, 64, true, framemem_allocator> RayCellBins;
+
+// bins traces by cells of layer grid, must be called under layer read lock
+static void bin_traces_by_cells(RayCellBins &bins, const RendInstGenData *rgl, dag::Span<Trace> traces)
+{
+  dag::RelocatableFixedVector<bbox3f, 16, true, framemem_allocator> rayBoxes;
+  rayBoxes.resize(traces.size());
+  for (int i = 0; i < traces.size(); i++)
+    init_raybox_from_trace(rayBoxes[i], traces[i]);
+  const IBBox2 &ldBox = rgl->rtData->loadedCellsBBox;
+  int clipRegion[4] = {ldBox[0].x, ldBox[0].y, ldBox[1].x, ldBox[1].y};
+  bin_rays_by_cells(rayBoxes.data(), rayBoxes.size(), rgl->world0Vxz, rgl->invGridCellSzV, rgl->lastCellXZXZ, clipRegion,
+    rgl->cellNumW, bins);
+}
+
+// calls cb(cell_idx, cell_ray_ids) once per cell for all rays which boxes overlap that cell; stops when cb returns true
+template <typename CB>
+static bool for_each_binned_cell(const RayCellBins &bins, CB cb)
+{
+  dag::RelocatableFixedVector<int, 16, true, framemem_allocator> cellRays;
+  for (int b = 0; b < bins.size();)
+  {
+    int cellI = ray_bin_cell(bins[b]);
+    cellRays.clear();
+    for (; b < bins.size() && ray_bin_cell(bins[b]) == cellI; b++)
+      cellRays.push_back(ray_bin_ray(bins[b]));
+    if (cb(cellI, dag::ConstSpan<int>(cellRays.data(), cellRays.size())))
+      return true;
+  }
+  return false;
+}
+
+// multi-ray version of rayTraverseRendinst: scattered rays do not degrade to visiting every cell of their combined box,
+// each cell is visited once with only rays that touch it
+template <typename Strategy>
+bool rayTraverseRendinstBinned(dag::Span<Trace> traces, bool trace_meshes, int layer_idx, rendinst::RendInstDesc *ri_desc,
+  Strategy &strategy, bool &haveCollision)
+{
+  RendInstGenData *rgl = rendinst::rgLayer[layer_idx];
+  ScopedLockRead lock(rgl->rtData->riRwCs);
+  RayCellBins bins;
+  bin_traces_by_cells(bins, rgl, traces);
+
+  dag::RelocatableFixedVector<Trace, 16, true, framemem_allocator> cellTraces;
+  return for_each_binned_cell(bins, [&](int cellI, dag::ConstSpan<int> cell_rays) {
+    cellTraces.clear();
+    bbox3f cellRayBox;
+    for (int rayId : cell_rays)
+    {
+      bbox3f box;
+      init_raybox_from_trace(box, traces[rayId]); // up to date length, rays could be shortened in previous cells
+      if (cellTraces.empty())
+        cellRayBox = box;
+      else
+        v_bbox3_add_box(cellRayBox, box);
+      cellTraces.push_back(traces[rayId]);
+    }
+    bool cellHit = traverseRayCell(rgl->cells[cellI], cellRayBox, make_span(cellTraces), trace_meshes, layer_idx, ri_desc, strategy,
+      cellI);
+    for (int i = 0; i < cell_rays.size(); i++)
+    {
+      Trace &trace = traces[cell_rays[i]];
+      trace.pos.outT = cellTraces[i].pos.outT;
+      trace.outNorm = cellTraces[i].outNorm;
+      trace.outMatId = cellTraces[i].outMatId;
+    }
+    if (!cellHit)
+      return false;
+    if (ri_desc)
+      ri_desc->cellIdx = cellI;
+    haveCollision = true;
+    return strategy.executeForCell(true);
+  });
+}
+
 template <typename Strategy>
 bool rayTraverse(dag::Span<Trace> traces, bool trace_meshes, rendinst::RendInstDesc *ri_desc, Strategy &strategy,
   riex_handle_t skip_riex_handle = rendinst::RIEX_HANDLE_NULL) // pos bbox here!
@@ -911,7 +1089,8 @@ bool rayTraverse(dag::Span<Trace> traces, bool trace_meshes, rendinst::RendInstD
     return true;
   FOR_EACH_PRIMARY_RG_LAYER_DO (rgl)
   {
-    if (rayTraverseRendinst(rayBox, traces, trace_meshes, _layer, ri_desc, strategy, haveCollision))
+    if (traces.size() > 1 ? rayTraverseRendinstBinned(traces, trace_meshes, _layer, ri_desc, strategy, haveCollision)
+                          : rayTraverseRendinst(rayBox, traces, trace_meshes, _layer, ri_desc, strategy, haveCollision))
     {
       if (ri_desc)
         ri_desc->layer = _layer;
@@ -1118,6 +1297,8 @@ static bool traceDownMultiRayCell(int layer_idx, int cell_idx, dag::Span<Trace>
     collisionTraces[rayId].outMatId = PHYSMAT_INVALID;
   }
   dag::Span<CollisionTrace> tracesSlice(collisionTraces.data(), collisionTraces.size());
+  RayPackets packets;
+  init_ray_packets(packets, traces);
 
   const eastl::BitvectorWordType *riPosInstData = rgl->rtData->riPosInst.data();
   for (int stride_subCell = SUBCELL_DIV - (subCell[2] - subCell[0] + 1), idx = subCell[1] * SUBCELL_DIV + subCell[0];
@@ -1157,6 +1338,11 @@ static bool traceDownMultiRayCell(int layer_idx, int cell_idx, dag::Span<Trace>
           mat44f tm;
           rendinst::gen::unpack_tm_full(tm, data, v_cell_add, v_cell_mul);
 
+          bbox3f transformedBox;
+          v_bbox3_init(transformedBox, tm, collRes->vFullBBox);
+          if (!for_each_ray_in_box(packets, traces.size(), transformedBox, [](int) { return true; }))
+            continue;
+
           haveCollision |= collRes->traceMultiRay(tm, tracesSlice, ray_mat_id, behaviorFlags);
           for (int rayId = 0; rayId < traces.size(); rayId++)
           {
@@ -1263,28 +1449,42 @@ bool traceDownMultiRay(dag::Span<Trace> traces, bbox3f_cref ray_box, dag::Span<r
     }
   }
 
+  dag::RelocatableFixedVector<Trace, 16, true, framemem_allocator> cellTraces;
+  dag::RelocatableFixedVector<rendinst::RendInstDesc, 16, true, framemem_allocator> cellDescs;
   FOR_EACH_PRIMARY_RG_LAYER_DO (rgl)
   {
-    vec4f worldBboxXZ = v_perm_xzac(ray_box.bmin, ray_box.bmax);
-    vec4f regionV = v_sub(worldBboxXZ, rgl->world0Vxz);
-    regionV = v_max(v_mul(regionV, rgl->invGridCellSzV), v_zero());
-    regionV = v_min(regionV, rgl->lastCellXZXZ);
-    vec4i regionI = v_cvt_floori(regionV);
-    DECL_ALIGN16(int, regions[4]);
-    v_sti(regions, regionI);
-
     ScopedLockRead lock(rgl->rtData->riRwCs);
-    rgl->rtData->loadedCellsBBox.clip(regions[0], regions[1], regions[2], regions[3]);
-
-    int cellXStride = rgl->cellNumW - (regions[2] - regions[0] + 1);
-    for (int z = regions[1], cellI = regions[1] * rgl->cellNumW + regions[0]; z <= regions[3]; z++, cellI += cellXStride)
-    {
-      for (int x = regions[0]; x <= regions[2]; x++, cellI++)
+    RayCellBins bins;
+    bin_traces_by_cells(bins, rgl, traces);
+
+    for_each_binned_cell(bins, [&](int cellI, dag::ConstSpan<int> cell_rays) {
+      cellTraces.clear();
+      cellDescs.clear();
+      bbox3f cellRayBox;
+      for (int rayId : cell_rays)
       {
-        if (traceDownMultiRayCell(_layer, cellI, traces, ri_descs, ray_box, ray_mat_id, behaviorFlags, filter_pools))
-          haveCollision = true;
+        bbox3f box;
+        init_raybox_from_trace(box, traces[rayId]);
+        if (cellTraces.empty())
+          cellRayBox = box;
+        else
+          v_bbox3_add_box(cellRayBox, box);
+        cellTraces.push_back(traces[rayId]);
+        cellDescs.push_back(ri_descs[rayId]);
       }
-    }
+      if (traceDownMultiRayCell(_layer, cellI, make_span(cellTraces), make_span(cellDescs), cellRayBox, ray_mat_id, behaviorFlags,
+            filter_pools))
+        haveCollision = true;
+      for (int i = 0; i < cell_rays.size(); i++)
+      {
+        Trace &trace = traces[cell_rays[i]];
+        trace.pos.outT = cellTraces[i].pos.outT;
+        trace.outNorm = cellTraces[i].outNorm;
+        trace.outMatId = cellTraces[i].outMatId;
+        ri_descs[cell_rays[i]] = cellDescs[i];
+      }
+      return false;
+    });
   }
 
   return haveCollision;
@@ -6,6 +6,7 @@
 #include "riGen/riGenExtraMaxHeight.h"
 #include "riGen/riGrid.h"
 #include "riGen/riGridDebug.h"
+#include "riGen/riExtraSnapshot.h"
 #include "render/extraRender.h"
 #include "render/gpuObjects.h"
 #include "visibility/genVisibility.h"
@@ -24,6 +25,7 @@
 #include <util/dag_console.h>
 #include <util/dag_hash.h>
 #include <math/dag_mathUtils.h>
+#include <EASTL/unique_ptr.h>
 
 
 #if DAGOR_DBGLEVEL > 0
@@ -77,6 +79,7 @@ static void update_max_ri_extra_height(int value)
 static IPoint2 to_ipoint2(Point2 p) { return IPoint2(p.x, p.y); }
 
 static RiGrid riExtraGrid;
+static eastl::unique_ptr<rendinst::RiExtraCollSnapshotWriter> riExtraSnapshot; // lock-free mirror of riExtraGrid (optional)
 
 static void init_ri_extra_grid(const DataBlock *level_blk)
 {
@@ -90,6 +93,8 @@ static void init_ri_extra_grid(const DataBlock *level_blk)
     riExtraGrid.configObjectsToCreateSubGrid = riExGrid->getInt("objectsToCreateSubGrid", riExtraGrid.configObjectsToCreateSubGrid);
     riExtraGrid.configMaxLeafObjects = riExGrid->getInt("maxLeafObjects", riExtraGrid.configMaxLeafObjects);
     riExtraGrid.configReserveObjectsOnGrow = riExGrid->getInt("reserveObjectsOnGrow", riExtraGrid.configReserveObjectsOnGrow);
+    if (riExGrid->getBool("lockFreeSnapshot", false))
+      riExtraSnapshot.reset(new rendinst::RiExtraCollSnapshotWriter(riExGrid->getReal("snapshotCellSize", 64.f)));
   }
 
   rendinst::init_tiled_scenes(level_blk);
@@ -99,6 +104,7 @@ static void term_ri_extra_grids()
 {
   rendinst::term_tiled_scenes();
   riExtraGrid.clear();
+  riExtraSnapshot.reset();
 }
 
 static vec4f make_pos_and_rad(mat44f_cref tm, vec4f center_and_rad)
@@ -119,9 +125,15 @@ void rendinst::initRIGenExtra(bool need_render, const DataBlock *level_blk)
 
 void rendinst::optimizeRIGenExtra()
 {
-  ScopedLockWrite lock(ccExtra);
-  debug(riExtraGrid.isOptimized() ? "Re-optimizing RiGrid on update" : "Optimizing RiGrid");
-  riExtraGrid.optimizeCells();
+  rendinst::RiExtraCollSnapshotWriter::Retired retired;
+  {
+    ScopedLockWrite lock(ccExtra);
+    debug(riExtraGrid.isOptimized() ? "Re-optimizing RiGrid on update" : "Optimizing RiGrid");
+    riExtraGrid.optimizeCells();
+    if (!riExtraSnapshot || !riExtraSnapshot->publish(retired))
+      return;
+  }
+  riExtraSnapshot->reclaim(retired); // outside of lock, so writers don't wait for slow readers
 }
 
 namespace rendinst
@@ -750,6 +762,17 @@ static void unload_ri_extra_game_resources(int res_idx)
   {
     if (unregCollCb)
       unregCollCb(riExtraPool.collHandle);
+    if (riExtraSnapshot)
+    {
+      // lock-free readers may still trace this collision, so it is removed from snapshot and released only after them
+      rendinst::RiExtraCollSnapshotWriter::Retired retired;
+      {
+        ScopedRIExtraWriteLock wr;
+        riExtraSnapshot->replaceCollRes(riExtraPool.collRes, nullptr);
+        riExtraSnapshot->publish(retired);
+      }
+      riExtraSnapshot->reclaim(retired);
+    }
     release_game_resource((GameResource *)riExtraPool.collRes);
     riExtraPool.collRes = nullptr;
   }
@@ -1003,6 +1026,8 @@ riex_handle_t rendinst::addRIGenExtra43(int res_idx, bool /*m*/, mat43f_cref tm,
     if (has_collision && pool.collRes)
     {
       riExtraGrid.insert(h, pool.riXYZR[idx], wabb, on_loading);
+      if (riExtraSnapshot)
+        riExtraSnapshot->insert(h, tm, wabb, pool.collRes);
       riutil::world_version_inc(wabb);
 
       update_max_ri_extra_height(static_cast<int>(v_extract_y(wabb.bmax) - v_extract_y(wabb.bmin)) + 1);
@@ -1094,6 +1119,8 @@ bool rendinst::moveRIGenExtra43(riex_handle_t id, mat43f_cref tm, bool moved, bo
 
     pool.riXYZR[idx] = bsphere;
     riExtraGrid.update(id, oldWbsph, pool.riXYZR[idx], wabb1);
+    if (riExtraSnapshot)
+      riExtraSnapshot->update(id, tm, wabb1);
     update_max_ri_extra_height(static_cast<int>(v_extract_y(wabb1.bmax) - v_extract_y(wabb1.bmin)) + 1);
 
     v_bbox3_add_box(pool.fullWabb, wabb1);
@@ -1155,6 +1182,8 @@ bool rendinst::delRIGenExtra(riex_handle_t id)
     v_bbox3_init(wabb, tm44, pool.collBb);
 
     riExtraGrid.erase(id, pool.riXYZR[idx]);
+    if (riExtraSnapshot)
+      riExtraSnapshot->erase(id);
     pool.riXYZR[idx] = v_perm_xyzd(pool.riXYZR[idx], v_or(pool.riXYZR[idx], V_CI_SIGN_MASK));
 
     riutil::world_version_inc(wabb);
@@ -1241,6 +1270,8 @@ bool rendinst::removeRIGenExtraFromGrid(riex_handle_t id)
     v_mat43_transpose_to_mat44(tm44, pool.riTm[idx]);
     v_bbox3_init(wabb, tm44, pool.collBb);
     riExtraGrid.erase(id, pool.riXYZR[idx]);
+    if (riExtraSnapshot)
+      riExtraSnapshot->erase(id);
     pool.riXYZR[idx] = v_perm_xyzd(pool.riXYZR[idx], v_or(pool.riXYZR[idx], V_CI_SIGN_MASK));
     riutil::world_version_inc(wabb);
     return true;
@@ -1401,6 +1432,80 @@ void rendinst::gatherRIGenExtraCollidable(riex_collidable_t &out_handles, const
     eastl::sort(out_handles.begin(), out_handles.end());
 }
 
+bool rendinst::isRIGenExtraSnapshotEnabled() { return riExtraSnapshot != nullptr; }
+
+bool rendinst::publishRIGenExtraSnapshot()
+{
+  if (!riExtraSnapshot)
+    return false;
+  TIME_PROFILE(publish_riex_snapshot);
+  rendinst::RiExtraCollSnapshotWriter::Retired retired;
+  {
+    ScopedRIExtraWriteLock wr;
+    if (!riExtraSnapshot->publish(retired))
+      return false;
+  }
+  riExtraSnapshot->reclaim(retired); // outside of lock, so writers don't wait for slow readers
+  return true;
+}
+
+void rendinst::gatherRIGenExtraCollidableSnapshot(riex_collidable_t &out_handles, bbox3f_cref box)
+{
+  G_ASSERT_RETURN(riExtraSnapshot, );
+  TIME_PROFILE_DEV(gather_riex_collidable_snapshot);
+  {
+    RiExtraSnapshotReadScope rd(*riExtraSnapshot);
+    if (const RiExtraCollSnapshot *snapshot = rd.get())
+      snapshot->forEachInBox(box, [&](const RiExtraCollSnapshot::Entry &e) { out_handles.push_back(e.handle); });
+  }
+  if (out_handles.empty())
+    return;
+  eastl::sort(out_handles.begin(), out_handles.end());
+  out_handles.erase(eastl::unique(out_handles.begin(), out_handles.end()), out_handles.end()); // objects spanning several cells
+}
+
+void rendinst::gatherRIGenExtraSnapshotEntries(RiExtraSnapshotEntries &out_entries, bbox3f_cref box)
+{
+  G_ASSERT_RETURN(riExtraSnapshot, );
+  TIME_PROFILE_DEV(gather_riex_entries_snapshot);
+  {
+    RiExtraSnapshotReadScope rd(*riExtraSnapshot);
+    if (const RiExtraCollSnapshot *snapshot = rd.get())
+      snapshot->forEachInBox(box, [&](const RiExtraCollSnapshot::Entry &e) { out_entries.push_back(e); });
+  }
+  if (out_entries.size() < 2)
+    return;
+  auto byHandle = [](const RiExtraCollSnapshot::Entry &a, const RiExtraCollSnapshot::Entry &b) { return a.handle < b.handle; };
+  auto sameHandle = [](const RiExtraCollSnapshot::Entry &a, const RiExtraCollSnapshot::Entry &b) { return a.handle == b.handle; };
+  eastl::sort(out_entries.begin(), out_entries.end(), byHandle);
+  out_entries.erase(eastl::unique(out_entries.begin(), out_entries.end(), sameHandle), out_entries.end());
+}
+
+bool rendinst::traceRayRIGenExtraSnapshot(const Point3 &from, const Point3 &dir, float &in_out_t, riex_handle_t &out_handle,
+  Point3 *out_norm, int ray_mat_id)
+{
+  G_ASSERT_RETURN(riExtraSnapshot, false);
+  TIME_PROFILE_DEV(trace_riex_snapshot);
+  RiExtraSnapshotReadScope rd(*riExtraSnapshot);
+  const RiExtraCollSnapshot *snapshot = rd.get();
+  if (!snapshot)
+    return false;
+  bool hit = false;
+  snapshot->forEachOnRay(v_ldu_p3(&from.x), v_ldu_p3(&dir.x), in_out_t, [&](const RiExtraCollSnapshot::Entry &e, float &t) {
+    if (!e.collRes)
+      return;
+    mat44f tm;
+    v_mat43_transpose_to_mat44(tm, e.tm);
+    int matId = -1;
+    if (e.collRes->traceRay(tm, from, dir, t, out_norm, matId, ray_mat_id))
+    {
+      out_handle = e.handle;
+      hit = true;
+    }
+  });
+  return hit;
+}
+
 void rendinst::addRiExtraRefs(DataBlock *b, const DataBlock *riConf, const char *name)
 {
   if (!riConf && name && riConfig)
@@ -0,0 +1,250 @@
+#include "riGen/riExtraSnapshot.h"
+#include <osApiWrappers/dag_miscApi.h>
+#include <memory/dag_mem.h>
+#include <debug/dag_assert.h>
+#include <EASTL/sort.h>
+#include <EASTL/algorithm.h>
+
+using namespace rendinst;
+
+void SnapshotEpoch::synchronize()
+{
+  WinAutoLock lock(syncCS);
+  int e = interlocked_acquire_load(epoch);
+  interlocked_exchange(epoch, e + 1);
+  for (int spins = 0; interlocked_acquire_load(readers[e & 1]) != 0; spins++)
+    if (spins < 64)
+      cpu_yield();
+    else
+      sleep_msec(0);
+}
+
+
+RiExtraCollSnapshot::Cell *RiExtraCollSnapshot::Cell::create(const Entry *e, uint32_t cnt)
+{
+  G_ASSERT(cnt > 0);
+  Cell *c = (Cell *)midmem->allocAligned(sizeof(Cell) + sizeof(Entry) * (cnt - 1), 16);
+  c->count = cnt;
+  memcpy(c->entries, e, sizeof(Entry) * cnt);
+  c->bbox = e[0].wbb;
+  for (uint32_t i = 1; i < cnt; i++)
+    v_bbox3_add_box(c->bbox, e[i].wbb);
+  return c;
+}
+
+void RiExtraCollSnapshot::Cell::destroy(const Cell *c)
+{
+  if (!c)
+    return;
+#if DAGOR_DBGLEVEL > 0
+  memset((void *)c, 0xFE, sizeof(Cell) + sizeof(Entry) * (c->count - 1)); // make late (unprotected) reads noticeable
+#endif
+  midmem->freeAligned((void *)c);
+}
+
+const RiExtraCollSnapshot::Cell *RiExtraCollSnapshot::findCell(cell_key_t key) const
+{
+  auto it = eastl::lower_bound(keys.begin(), keys.end(), key);
+  return (it != keys.end() && *it == key) ? cells[it - keys.begin()] : nullptr;
+}
+
+
+RiExtraCollSnapshotWriter::RiExtraCollSnapshotWriter(float cell_size) : cellSize(cell_size) {}
+
+RiExtraCollSnapshotWriter::~RiExtraCollSnapshotWriter()
+{
+  clear();
+  publish();
+  delete interlocked_exchange_ptr(current, (RiExtraCollSnapshot *)nullptr);
+}
+
+template <typename CB>
+void RiExtraCollSnapshotWriter::forEachObjCell(bbox3f_cref wbb, CB cb)
+{
+  RiExtraCollSnapshot tmp;
+  tmp.invCellSize = 1.f / cellSize;
+  int x0, z0, x1, z1;
+  tmp.getCellsRange(wbb, x0, z0, x1, z1);
+  if (x1 - x0 >= RiExtraCollSnapshot::MAX_CELLS_PER_OBJECT_SIDE || z1 - z0 >= RiExtraCollSnapshot::MAX_CELLS_PER_OBJECT_SIDE)
+  {
+    cb(HUGE_CELL_KEY);
+    return;
+  }
+  for (int z = z0; z <= z1; z++)
+    for (int x = x0; x <= x1; x++)
+      cb(RiExtraCollSnapshot::make_key(x, z));
+}
+
+void RiExtraCollSnapshotWriter::addToCells(const Entry &e)
+{
+  forEachObjCell(e.wbb, [&](RiExtraCollSnapshot::cell_key_t key) {
+    WCell &c = wcells[key];
+    c.entries.push_back(e);
+    if (!c.dirty)
+    {
+      c.dirty = true;
+      dirtyKeys.push_back(key);
+    }
+  });
+}
+
+void RiExtraCollSnapshotWriter::removeFromCells(riex_handle_t h, bbox3f_cref wbb)
+{
+  forEachObjCell(wbb, [&](RiExtraCollSnapshot::cell_key_t key) {
+    auto it = wcells.find(key);
+    if (it == wcells.end())
+      return;
+    WCell &c = it->second;
+    for (auto e = c.entries.begin(); e != c.entries.end(); ++e)
+      if (e->handle == h)
+      {
+        *e = c.entries.back();
+        c.entries.pop_back();
+        if (!c.dirty)
+        {
+          c.dirty = true;
+          dirtyKeys.push_back(key);
+        }
+        break;
+      }
+  });
+}
+
+void RiExtraCollSnapshotWriter::insert(riex_handle_t h, mat43f_cref tm, bbox3f_cref wbb, const CollisionResource *coll_res)
+{
+  auto ins = objCells.emplace(h, wbb);
+  if (!ins.second) // reinsertion of same handle, remove stale data first
+  {
+    removeFromCells(h, ins.first->second);
+    ins.first->second = wbb;
+  }
+  Entry e;
+  e.tm = tm;
+  e.wbb = wbb;
+  e.handle = h;
+  e.collRes = coll_res;
+  addToCells(e);
+}
+
+void RiExtraCollSnapshotWriter::update(riex_handle_t h, mat43f_cref tm, bbox3f_cref wbb)
+{
+  auto it = objCells.find(h);
+  if (it == objCells.end())
+    return;
+  const CollisionResource *collRes = nullptr;
+  forEachObjCell(it->second, [&](RiExtraCollSnapshot::cell_key_t key) {
+    auto c = wcells.find(key);
+    if (!collRes && c != wcells.end())
+      for (const Entry &e : c->second.entries)
+        if (e.handle == h)
+        {
+          collRes = e.collRes;
+          break;
+        }
+  });
+  removeFromCells(h, it->second);
+  it->second = wbb;
+  Entry e;
+  e.tm = tm;
+  e.wbb = wbb;
+  e.handle = h;
+  e.collRes = collRes;
+  addToCells(e);
+}
+
+void RiExtraCollSnapshotWriter::erase(riex_handle_t h)
+{
+  auto it = objCells.find(h);
+  if (it == objCells.end())
+    return;
+  removeFromCells(h, it->second);
+  objCells.erase(it);
+}
+
+void RiExtraCollSnapshotWriter::clear()
+{
+  for (auto &kv : wcells)
+  {
+    kv.second.entries.clear();
+    if (!kv.second.dirty)
+    {
+      kv.second.dirty = true;
+      dirtyKeys.push_back(kv.first);
+    }
+  }
+  objCells.clear();
+}
+
+void RiExtraCollSnapshotWriter::replaceCollRes(const CollisionResource *from, const CollisionResource *to)
+{
+  for (auto &kv : wcells)
+    for (Entry &e : kv.second.entries)
+      if (e.collRes == from)
+      {
+        e.collRes = to;
+        if (!kv.second.dirty)
+        {
+          kv.second.dirty = true;
+          dirtyKeys.push_back(kv.first);
+        }
+      }
+}
+
+bool RiExtraCollSnapshotWriter::publish(Retired &out_retired)
+{
+  if (dirtyKeys.empty())
+    return false;
+
+  dag::Vector<const RiExtraCollSnapshot::Cell *> &retired = out_retired.cells;
+  for (RiExtraCollSnapshot::cell_key_t key : dirtyKeys)
+  {
+    auto it = wcells.find(key);
+    WCell &c = it->second;
+    if (c.published)
+      retired.push_back(c.published);
+    c.published = c.entries.empty() ? nullptr : RiExtraCollSnapshot::Cell::create(c.entries.data(), c.entries.size());
+    c.dirty = false;
+    if (c.entries.empty())
+      wcells.erase(it);
+  }
+  dirtyKeys.clear();
+
+  RiExtraCollSnapshot *s = new RiExtraCollSnapshot;
+  s->cellSize = cellSize;
+  s->invCellSize = 1.f / cellSize;
+  s->keys.reserve(wcells.size());
+  for (auto &kv : wcells)
+    if (kv.first == HUGE_CELL_KEY)
+      s->hugeObjects = kv.second.published;
+    else
+      s->keys.push_back(kv.first);
+  eastl::sort(s->keys.begin(), s->keys.end());
+  s->cells.resize(s->keys.size());
+  for (int i = 0; i < s->keys.size(); i++)
+    s->cells[i] = wcells[s->keys[i]].published;
+
+  if (RiExtraCollSnapshot *prev = interlocked_exchange_ptr(current, s))
+    out_retired.snapshots.push_back(prev);
+  publishCount++;
+  return true;
+}
+
+void RiExtraCollSnapshotWriter::reclaim(Retired &retired)
+{
+  epoch.synchronize(); // no reader can reference retired snapshots or cells after this point
+  for (RiExtraCollSnapshot *s : retired.snapshots)
+    delete s;
+  for (const RiExtraCollSnapshot::Cell *c : retired.cells)
+    RiExtraCollSnapshot::Cell::destroy(c);
+  retired.snapshots.clear();
+  retired.cells.clear();
+}
+
+bool RiExtraCollSnapshotWriter::publish()
+{
+  Retired retired;
+  if (!publish(retired))
+    return false;
+  reclaim(retired);
+  return true;
+}
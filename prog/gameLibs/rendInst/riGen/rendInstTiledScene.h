@@ -41,6 +41,7 @@ public:
   using TiledScene::dumpSceneState;
   using TiledScene::flushDeferredTransformUpdates;
   using TiledScene::frustumCull;
+  using TiledScene::frustumCullMultiView;
   using TiledScene::frustumCullOneTile;
   using TiledScene::frustumCullTilesPass;
   using TiledScene::getNodeIndexInternal; // for faster visibility in dev
@@ -0,0 +1,210 @@
+#pragma once
+
+#include <rendInst/riexHandle.h>
+#include <vecmath/dag_vecMath.h>
+#include <dag/dag_vector.h>
+#include <memory/dag_framemem.h>
+#include <osApiWrappers/dag_atomic.h>
+#include <osApiWrappers/dag_critSec.h>
+#include <ska_hash_map/flat_hash_map2.hpp>
+
+class CollisionResource;
+
+namespace rendinst
+{
+
+// Minimal RCU-like protection for data read without locks.
+// Readers never wait: they only increment/decrement counter of current epoch parity.
+// Writer publishes new data first, then flips epoch and waits for readers of previous parity to leave,
+// after which data that was replaced by publish can be safely freed. Concurrent synchronize() calls are serialized,
+// since each of them relies on readers of the parity before previous flip to be gone already.
+class SnapshotEpoch
+{
+public:
+  int enterRead()
+  {
+    for (;;)
+    {
+      int e = interlocked_acquire_load(epoch);
+      interlocked_increment(readers[e & 1]);
+      if (interlocked_acquire_load(epoch) == e)
+        return e;
+      interlocked_decrement(readers[e & 1]); // writer flipped epoch meanwhile, retry with new parity
+    }
+  }
+  void leaveRead(int e) { interlocked_decrement(readers[e & 1]); }
+
+  // to be called by writer after publishing new data; must not be called from within read section
+  void synchronize();
+
+private:
+  volatile int epoch = 0;
+  volatile int readers[2] = {0, 0};
+  WinCritSec syncCS;
+};
+
+
+// Immutable (once published) set of riExtra collidable instances organized in uniform XZ cells.
+// Unchanged cells are shared between consecutive snapshots, so publish cost is proportional to amount of changes.
+class RiExtraCollSnapshot
+{
+public:
+  struct Entry
+  {
+    mat43f tm;
+    bbox3f wbb;
+    riex_handle_t handle;
+    const CollisionResource *collRes;
+  };
+  struct Cell
+  {
+    bbox3f bbox;
+    uint32_t count;
+    Entry entries[1];
+
+    static Cell *create(const Entry *e, uint32_t cnt);
+    static void destroy(const Cell *c);
+  };
+  typedef uint32_t cell_key_t;
+
+  float cellSize = 64.f, invCellSize = 1.f / 64.f;
+  dag::Vector<cell_key_t> keys;    // sorted
+  dag::Vector<const Cell *> cells; // parallel to keys
+  const Cell *hugeObjects = nullptr;
+
+  static cell_key_t make_key(int x, int z) { return (uint32_t(uint16_t(int16_t(x))) << 16) | uint16_t(int16_t(z)); }
+  static constexpr int MAX_CELLS_PER_OBJECT_SIDE = 4; // objects that span more cells go to hugeObjects
+
+  const Cell *findCell(cell_key_t key) const;
+
+  // calls cb(const Entry &) for every entry which wbb intersects box; entry can be reported several times if it spans several cells
+  template <typename CB>
+  void forEachInBox(bbox3f_cref box, CB cb) const
+  {
+    auto testCell = [&](const Cell *c) {
+      if (!c || !v_bbox3_test_box_intersect(c->bbox, box))
+        return;
+      for (const Entry *e = c->entries, *ee = e + c->count; e < ee; e++)
+        if (v_bbox3_test_box_intersect(e->wbb, box))
+          cb(*e);
+    };
+    testCell(hugeObjects);
+    if (keys.empty())
+      return;
+    int x0, z0, x1, z1;
+    getCellsRange(box, x0, z0, x1, z1);
+    for (int z = z0; z <= z1; z++)
+      for (int x = x0; x <= x1; x++)
+        testCell(findCell(make_key(x, z)));
+  }
+
+  // calls cb(const Entry &, float &in_out_t) for entries which wbb is hit by ray in [0..in_out_t]; cb may shorten in_out_t
+  template <typename CB>
+  void forEachOnRay(vec3f from, vec3f dir, float &in_out_t, CB cb) const
+  {
+    vec3f to = v_madd(dir, v_splats(in_out_t), from);
+    bbox3f rayBox;
+    rayBox.bmin = v_min(from, to);
+    rayBox.bmax = v_max(from, to);
+    forEachInBox(rayBox, [&](const Entry &e) {
+      if (!v_test_ray_box_intersection_unsafe(from, dir, v_splats(in_out_t), e.wbb))
+        return;
+      cb(e, in_out_t);
+    });
+  }
+
+  void getCellsRange(bbox3f_cref box, int &x0, int &z0, int &x1, int &z1) const
+  {
+    vec4f range = v_mul(v_perm_xzac(box.bmin, box.bmax), v_splats(invCellSize));
+    alignas(16) int r[4];
+    v_sti(r, v_cvt_floori(v_clamp(range, v_splats(-32767.f), v_splats(32767.f))));
+    x0 = r[0], z0 = r[1], x1 = r[2], z1 = r[3];
+  }
+};
+
+
+// Writer side of riExtra collision snapshot; all modifications are expected to be serialized by caller
+// (done under riExtra write lock), readers only access published snapshot via RiExtraSnapshotReadScope.
+// Data replaced by publish is freed by reclaim(), which waits for readers and so is better called outside of write lock
+class RiExtraCollSnapshotWriter
+{
+public:
+  typedef RiExtraCollSnapshot::Entry Entry;
+  struct Retired
+  {
+    dag::Vector<RiExtraCollSnapshot *> snapshots;
+    dag::Vector<const RiExtraCollSnapshot::Cell *> cells;
+  };
+
+  explicit RiExtraCollSnapshotWriter(float cell_size = 64.f);
+  ~RiExtraCollSnapshotWriter();
+
+  void insert(riex_handle_t h, mat43f_cref tm, bbox3f_cref wbb, const CollisionResource *coll_res);
+  void update(riex_handle_t h, mat43f_cref tm, bbox3f_cref wbb);
+  void erase(riex_handle_t h);
+  void clear();
+  // replaces collision resource of all instances (to unload it), readers see it after next publish()
+  void replaceCollRes(const CollisionResource *from, const CollisionResource *to);
+
+  // publishes all changes made since previous call as new snapshot and adds data not reachable anymore to out_retired;
+  // returns false when there were no changes
+  bool publish(Retired &out_retired);
+  // waits for readers which could still see retired data (or anything published before) and frees it
+  void reclaim(Retired &retired);
+  // publish() and reclaim() at once
+  bool publish();
+
+  const RiExtraCollSnapshot *acquire(int &out_epoch)
+  {
+    out_epoch = epoch.enterRead();
+    return interlocked_acquire_load_ptr(current);
+  }
+  void release(int e) { epoch.leaveRead(e); }
+
+  uint32_t getInstanceCount() const { return (uint32_t)objCells.size(); }
+  uint32_t getPublishedCount() const { return publishCount; }
+
+private:
+  struct WCell
+  {
+    dag::Vector<Entry> entries;
+    const RiExtraCollSnapshot::Cell *published = nullptr;
+    bool dirty = false;
+  };
+  static constexpr RiExtraCollSnapshot::cell_key_t HUGE_CELL_KEY = ~0u;
+
+  template <typename CB>
+  void forEachObjCell(bbox3f_cref wbb, CB cb);
+  void addToCells(const Entry &e);
+  void removeFromCells(riex_handle_t h, bbox3f_cref wbb);
+
+  float cellSize;
+  ska::flat_hash_map<RiExtraCollSnapshot::cell_key_t, WCell> wcells;
+  ska::flat_hash_map<riex_handle_t, bbox3f> objCells; // last inserted wbb of each object, to find its cells
+  dag::Vector<RiExtraCollSnapshot::cell_key_t> dirtyKeys;
+  RiExtraCollSnapshot *volatile current = nullptr;
+  SnapshotEpoch epoch;
+  uint32_t publishCount = 0;
+};
+
+typedef dag::Vector<RiExtraCollSnapshot::Entry, framemem_allocator> RiExtraSnapshotEntries;
+
+// copies entries of last published snapshot which wbb intersects box, sorted by handle (each instance is reported once);
+// used by riExtra trace paths when snapshot is enabled, so they see consistent tm and collision of instances
+void gatherRIGenExtraSnapshotEntries(RiExtraSnapshotEntries &out_entries, bbox3f_cref box);
+
+// RAII lock-free read access to last published snapshot
+class RiExtraSnapshotReadScope
+{
+public:
+  RiExtraSnapshotReadScope(RiExtraCollSnapshotWriter &w) : writer(w) { snapshot = writer.acquire(epoch); }
+  ~RiExtraSnapshotReadScope() { writer.release(epoch); }
+  const RiExtraCollSnapshot *get() const { return snapshot; }
+
+private:
+  RiExtraCollSnapshotWriter &writer;
+  const RiExtraCollSnapshot *snapshot;
+  int epoch;
+};
+
+} // namespace rendinst
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <vecmath/dag_vecMath.h>
+#include <EASTL/sort.h>
+#include <math.h>
+
+namespace rendinst
+{
+
+// Up to 4 rays in SoA layout, so instance bounds are tested against whole group with single slab test
+struct RayPacket4
+{
+  vec4f ox, oy, oz;
+  vec4f invDx, invDy, invDz;
+  vec4f tMax;
+  int activeMask = 0;
+
+  void init(const vec4f *from, const vec4f *dir, const float *t, int cnt)
+  {
+    alignas(16) float o[3][4], inv[3][4], tm[4];
+    activeMask = 0;
+    for (int i = 0; i < 4; i++)
+    {
+      int src = i < cnt ? i : 0; // pad with first ray, padding lanes are masked anyway
+      alignas(16) float f[4], d[4];
+      v_st(f, from[src]);
+      v_st(d, dir[src]);
+      for (int c = 0; c < 3; c++)
+      {
+        o[c][i] = f[c];
+        // finite inverse for axis-parallel rays: avoids 0*inf NaNs when ray origin lies on box plane
+        inv[c][i] = fabsf(d[c]) > 1e-12f ? 1.f / d[c] : copysignf(1e12f, d[c]);
+      }
+      tm[i] = t[src];
+      if (i < cnt)
+        activeMask |= 1 << i;
+    }
+    ox = v_ld(o[0]), oy = v_ld(o[1]), oz = v_ld(o[2]);
+    invDx = v_ld(inv[0]), invDy = v_ld(inv[1]), invDz = v_ld(inv[2]);
+    tMax = v_ld(tm);
+  }
+
+  // returns mask of rays which segment [0..tMax] intersects box
+  int testBox(bbox3f_cref box) const
+  {
+    vec4f t0x = v_mul(v_sub(v_splat_x(box.bmin), ox), invDx), t1x = v_mul(v_sub(v_splat_x(box.bmax), ox), invDx);
+    vec4f t0y = v_mul(v_sub(v_splat_y(box.bmin), oy), invDy), t1y = v_mul(v_sub(v_splat_y(box.bmax), oy), invDy);
+    vec4f t0z = v_mul(v_sub(v_splat_z(box.bmin), oz), invDz), t1z = v_mul(v_sub(v_splat_z(box.bmax), oz), invDz);
+    vec4f tNear = v_max(v_max(v_min(t0x, t1x), v_min(t0y, t1y)), v_max(v_min(t0z, t1z), v_zero()));
+    vec4f tFar = v_min(v_min(v_max(t0x, t1x), v_max(t0y, t1y)), v_min(v_max(t0z, t1z), tMax));
+    return v_signmask(v_cmp_ge(tFar, tNear)) & activeMask;
+  }
+};
+
+// Sorts rays into cells of uniform XZ grid. Every ray is put into each cell its own bounding box overlaps,
+// i.e. exactly the cells single ray traverse would visit, so one cell visit serves all rays that touch it
+// instead of visiting every cell of combined box of all rays.
+// Output is (cell << 32 | ray) keys sorted by cell, then by ray.
+template <typename KeysVec>
+inline void bin_rays_by_cells(const bbox3f *ray_boxes, int ray_cnt, vec4f grid_origin_xzxz, vec4f inv_cell_sz, vec4f last_cell_xzxz,
+  const int (&clip_region)[4], int cells_w, KeysVec &out_keys)
+{
+  out_keys.clear();
+  for (int rayId = 0; rayId < ray_cnt; rayId++)
+  {
+    vec4f regionV = v_sub(v_perm_xzac(ray_boxes[rayId].bmin, ray_boxes[rayId].bmax), grid_origin_xzxz);
+    regionV = v_min(v_max(v_mul(regionV, inv_cell_sz), v_zero()), last_cell_xzxz);
+    alignas(16) int r[4];
+    v_sti(r, v_cvt_floori(regionV));
+    r[0] = r[0] > clip_region[0] ? r[0] : clip_region[0];
+    r[1] = r[1] > clip_region[1] ? r[1] : clip_region[1];
+    r[2] = r[2] < clip_region[2] ? r[2] : clip_region[2];
+    r[3] = r[3] < clip_region[3] ? r[3] : clip_region[3];
+    for (int z = r[1]; z <= r[3]; z++)
+      for (int x = r[0], cellI = z * cells_w + r[0]; x <= r[2]; x++, cellI++)
+        out_keys.push_back((uint64_t(uint32_t(cellI)) << 32) | uint32_t(rayId));
+  }
+  eastl::sort(out_keys.begin(), out_keys.end());
+}
+
+inline int ray_bin_cell(uint64_t key) { return int(key >> 32); }
+inline int ray_bin_ray(uint64_t key) { return int(uint32_t(key)); }
+
+} // namespace rendinst
@@ -0,0 +1,218 @@
+#include <UnitTest++/UnitTestPP.h>
+#include "riGen/riExtraSnapshot.h"
+#include <osApiWrappers/dag_threads.h>
+#include <osApiWrappers/dag_miscApi.h>
+#include <math/random/dag_random.h>
+#include <dag/dag_vector.h>
+#include <EASTL/sort.h>
+#include <string.h>
+
+using namespace rendinst;
+
+static constexpr float WORLD_SIZE = 2048.f;
+
+// instance payload encodes its handle, so readers can detect torn or freed data
+static mat43f make_tm(riex_handle_t h, vec3f pos)
+{
+  mat43f tm;
+  tm.row0 = v_make_vec4f(1, 0, 0, v_extract_x(pos));
+  tm.row1 = v_make_vec4f(0, 1, 0, v_extract_y(pos));
+  tm.row2 = v_make_vec4f(0, 0, 1, v_extract_z(pos));
+  uint32_t lo = uint32_t(h), hi = uint32_t(h >> 32);
+  memcpy((char *)&tm.row0 + 4, &lo, 4);
+  memcpy((char *)&tm.row0 + 8, &hi, 4);
+  return tm;
+}
+
+static bool is_entry_valid(const RiExtraCollSnapshot::Entry &e)
+{
+  uint32_t lo, hi;
+  memcpy(&lo, (const char *)&e.tm.row0 + 4, 4);
+  memcpy(&hi, (const char *)&e.tm.row0 + 8, 4);
+  if ((uint64_t(hi) << 32 | lo) != e.handle)
+    return false;
+  return (v_signmask(v_cmp_gt(e.wbb.bmin, e.wbb.bmax)) & 7) == 0;
+}
+
+static bbox3f make_wbb(vec3f pos, float half_size)
+{
+  bbox3f b;
+  b.bmin = v_sub(pos, v_splats(half_size));
+  b.bmax = v_add(pos, v_splats(half_size));
+  return b;
+}
+
+static vec3f rnd_pos(int &seed)
+{
+  return v_make_vec4f(_rnd_float(seed, -WORLD_SIZE, WORLD_SIZE), _rnd_float(seed, 0, 50), _rnd_float(seed, -WORLD_SIZE, WORLD_SIZE), 0);
+}
+
+class SnapshotReaderThread final : public DaThread
+{
+public:
+  RiExtraCollSnapshotWriter &writer;
+  int seed;
+  volatile int errors = 0, queries = 0;
+
+  SnapshotReaderThread(RiExtraCollSnapshotWriter &w, int s) : DaThread("riexReader"), writer(w), seed(s) {}
+
+  void execute() override
+  {
+    while (!interlocked_acquire_load(terminating))
+    {
+      RiExtraSnapshotReadScope rd(writer);
+      const RiExtraCollSnapshot *s = rd.get();
+      if (!s)
+        continue;
+      if (_rnd(seed) & 1)
+      {
+        bbox3f box = make_wbb(rnd_pos(seed), _rnd_float(seed, 1, 200));
+        s->forEachInBox(box, [&](const RiExtraCollSnapshot::Entry &e) {
+          if (!is_entry_valid(e) || !v_bbox3_test_box_intersect(e.wbb, box))
+            interlocked_increment(errors);
+        });
+      }
+      else
+      {
+        vec3f from = rnd_pos(seed);
+        vec3f dir = v_norm3(v_make_vec4f(_srnd(seed), _srnd(seed) * 0.1f, _srnd(seed), 0));
+        float t = _rnd_float(seed, 10, 500);
+        s->forEachOnRay(from, dir, t, [&](const RiExtraCollSnapshot::Entry &e, float &) {
+          if (!is_entry_valid(e))
+            interlocked_increment(errors);
+        });
+      }
+      interlocked_increment(queries);
+    }
+  }
+};
+
+TEST(ConcurrentQueriesWhileSpawnAndDestroy)
+{
+  static constexpr int READERS = 4;
+  static constexpr int OPS = 200000;
+  static constexpr int OPS_PER_PUBLISH = 500; // batch of updates, like one server tick of mass destruction
+
+  RiExtraCollSnapshotWriter writer(64.f);
+  SnapshotReaderThread *readers[READERS];
+  for (int i = 0; i < READERS; i++)
+  {
+    readers[i] = new SnapshotReaderThread(writer, 17 + i * 31);
+    readers[i]->start();
+  }
+
+  int seed = 12345;
+  dag::Vector<riex_handle_t> alive;
+  uint32_t nextInst = 0;
+  for (int op = 0; op < OPS; op++)
+  {
+    int kind = _rnd_int(seed, 0, 9);
+    if (kind < 5 || alive.size() < 100) // spawn
+    {
+      riex_handle_t h = make_handle(_rnd_int(seed, 0, 63), nextInst++);
+      vec3f pos = rnd_pos(seed);
+      // few huge objects to exercise objects spanning many cells
+      float halfSize = (_rnd(seed) & 63) == 0 ? _rnd_float(seed, 100, 400) : _rnd_float(seed, 0.5f, 20);
+      writer.insert(h, make_tm(h, pos), make_wbb(pos, halfSize), nullptr);
+      alive.push_back(h);
+    }
+    else if (kind < 8) // move
+    {
+      riex_handle_t h = alive[_rnd_int(seed, 0, alive.size() - 1)];
+      vec3f pos = rnd_pos(seed);
+      writer.update(h, make_tm(h, pos), make_wbb(pos, _rnd_float(seed, 0.5f, 20)));
+    }
+    else // destroy
+    {
+      int idx = _rnd_int(seed, 0, alive.size() - 1);
+      writer.erase(alive[idx]);
+      alive[idx] = alive.back();
+      alive.pop_back();
+    }
+    if ((op % OPS_PER_PUBLISH) == OPS_PER_PUBLISH - 1)
+      writer.publish();
+  }
+  writer.publish();
+
+  int errors = 0, queries = 0;
+  for (SnapshotReaderThread *r : readers)
+  {
+    r->terminate(true);
+    errors += r->errors;
+    queries += r->queries;
+    r->destroy();
+  }
+  printf("%d concurrent queries during %d updates (%d publishes), %d instances alive\n", queries, OPS, writer.getPublishedCount(),
+    (int)alive.size());
+  CHECK_EQUAL(0, errors);
+  CHECK(queries > 0);
+
+  // final snapshot must contain exactly alive instances
+  dag::Vector<riex_handle_t> found;
+  {
+    RiExtraSnapshotReadScope rd(writer);
+    bbox3f all = make_wbb(v_zero(), WORLD_SIZE * 2);
+    rd.get()->forEachInBox(all, [&](const RiExtraCollSnapshot::Entry &e) { found.push_back(e.handle); });
+  }
+  eastl::sort(found.begin(), found.end());
+  found.erase(eastl::unique(found.begin(), found.end()), found.end());
+  eastl::sort(alive.begin(), alive.end());
+  CHECK_EQUAL(alive.size(), found.size());
+  CHECK(alive == found);
+  CHECK_EQUAL(alive.size(), writer.getInstanceCount());
+}
+
+TEST(NoPublishWithoutChanges)
+{
+  RiExtraCollSnapshotWriter writer;
+  CHECK(!writer.publish());
+  vec3f pos = v_make_vec4f(10, 0, 10, 0);
+  writer.insert(1, make_tm(1, pos), make_wbb(pos, 1), nullptr);
+  {
+    RiExtraSnapshotReadScope rd(writer);
+    CHECK(rd.get() == nullptr); // not published yet
+  }
+  CHECK(writer.publish());
+  CHECK(!writer.publish());
+  writer.erase(1);
+  CHECK(writer.publish());
+  int cnt = 0;
+  RiExtraSnapshotReadScope rd(writer);
+  rd.get()->forEachInBox(make_wbb(pos, 100), [&](const RiExtraCollSnapshot::Entry &) { cnt++; });
+  CHECK_EQUAL(0, cnt);
+}
+
+TEST(CollResReplacedBeforeUnload)
+{
+  RiExtraCollSnapshotWriter writer;
+  const CollisionResource *coll = (const CollisionResource *)&writer; // only compared, never dereferenced
+  vec3f pos = v_make_vec4f(10, 0, 10, 0);
+  writer.insert(1, make_tm(1, pos), make_wbb(pos, 1), coll);
+  writer.insert(2, make_tm(2, pos), make_wbb(pos, 200), coll); // huge one
+  CHECK(writer.publish());
+
+  auto countWithColl = [&](const RiExtraCollSnapshot *s) {
+    int cnt = 0;
+    s->forEachInBox(make_wbb(pos, 1000), [&](const RiExtraCollSnapshot::Entry &e) { cnt += e.collRes == coll ? 1 : 0; });
+    return cnt;
+  };
+
+  RiExtraCollSnapshotWriter::Retired retired;
+  {
+    RiExtraSnapshotReadScope old(writer);
+    writer.replaceCollRes(coll, nullptr);
+    CHECK(writer.publish(retired));
+    CHECK(!retired.snapshots.empty() && !retired.cells.empty());
+    CHECK(countWithColl(old.get()) > 0); // retired data is still valid for reader that acquired it before publish
+    RiExtraSnapshotReadScope cur(writer);
+    CHECK_EQUAL(0, countWithColl(cur.get()));
+  }
+  writer.reclaim(retired);
+  CHECK(retired.snapshots.empty() && retired.cells.empty());
+
+  writer.update(1, make_tm(1, pos), make_wbb(pos, 2)); // moved instance keeps replaced collision
+  CHECK(writer.publish());
+  RiExtraSnapshotReadScope rd(writer);
+  CHECK_EQUAL(0, countWithColl(rd.get()));
+  CHECK_EQUAL(2u, writer.getInstanceCount());
+}
@@ -0,0 +1,303 @@
+#include <UnitTest++/UnitTestPP.h>
+#include "riGen/riRayBinning.h"
+#include <perfMon/dag_cpuFreq.h>
+#include <math/random/dag_random.h>
+#include <math/dag_bits.h>
+#include <dag/dag_vector.h>
+#include <EASTL/algorithm.h>
+#include <stdio.h>
+#include <string.h>
+
+using namespace rendinst;
+
+namespace
+{
+// synthetic riGen-like grid: uniform XZ cells, each with list of instance boxes
+struct TestGrid
+{
+  static constexpr int CELLS_W = 64;
+  static constexpr float CELL_SZ = 64.f;
+  static constexpr int INST_PER_CELL = 48;
+
+  dag::Vector<bbox3f> instBoxes; // CELLS_W * CELLS_W * INST_PER_CELL
+  vec4f origin = v_zero(), invCellSz = v_splats(1.f / CELL_SZ), lastCell = v_splats(CELLS_W - 1);
+  int region[4] = {0, 0, CELLS_W - 1, CELLS_W - 1};
+
+  explicit TestGrid(int seed)
+  {
+    instBoxes.resize(CELLS_W * CELLS_W * INST_PER_CELL);
+    for (int cell = 0; cell < CELLS_W * CELLS_W; cell++)
+      for (int i = 0; i < INST_PER_CELL; i++)
+      {
+        float x = (cell % CELLS_W + _frnd(seed)) * CELL_SZ, z = (cell / CELLS_W + _frnd(seed)) * CELL_SZ;
+        vec3f c = v_make_vec4f(x, _rnd_float(seed, 0, 10), z, 0);
+        vec3f ext = v_make_vec4f(_rnd_float(seed, 0.3f, 6), _rnd_float(seed, 1, 12), _rnd_float(seed, 0.3f, 6), 0);
+        bbox3f &b = instBoxes[cell * INST_PER_CELL + i];
+        b.bmin = v_sub(c, ext);
+        b.bmax = v_add(c, ext);
+      }
+  }
+  const bbox3f *cellInst(int cell) const { return instBoxes.data() + cell * INST_PER_CELL; }
+};
+
+struct TraceSet
+{
+  const char *name;
+  dag::Vector<vec4f> from, dir;
+  dag::Vector<float> len;
+
+  void add(vec3f f, vec3f to)
+  {
+    vec3f d = v_sub(to, f);
+    float l = v_extract_x(v_length3_x(d));
+    from.push_back(f);
+    dir.push_back(v_div(d, v_splats(l)));
+    len.push_back(l);
+  }
+  int size() const { return (int)from.size(); }
+  bbox3f rayBox(int i) const
+  {
+    bbox3f b;
+    vec3f to = v_madd(dir[i], v_splats(len[i]), from[i]);
+    b.bmin = v_min(from[i], to);
+    b.bmax = v_max(from[i], to);
+    return b;
+  }
+};
+
+static constexpr float MAP = TestGrid::CELLS_W * TestGrid::CELL_SZ;
+
+static vec3f rnd_map_pos(int &seed, float margin)
+{
+  return v_make_vec4f(_rnd_float(seed, margin, MAP - margin), _rnd_float(seed, 1, 3), _rnd_float(seed, margin, MAP - margin), 0);
+}
+
+static vec3f rnd_offset(int &seed, float r)
+{
+  return v_make_vec4f(_srnd(seed) * r, _srnd(seed) * 2.f, _srnd(seed) * r, 0);
+}
+
+// trace sets shaped after typical game queries: dense fan, scattered agents and long rays to scattered sources
+static void make_trace_sets(dag::Vector<TraceSet> &sets, int seed)
+{
+  TraceSet &shotgun = sets.push_back();
+  shotgun.name = "shotgun pellets";
+  vec3f muzzle = rnd_map_pos(seed, 300);
+  vec3f aim = v_add(muzzle, v_make_vec4f(80, 0, 30, 0));
+  for (int i = 0; i < 12; i++)
+    shotgun.add(muzzle, v_add(aim, rnd_offset(seed, 4)));
+
+  TraceSet &aiLos = sets.push_back();
+  aiLos.name = "AI LOS checks";
+  for (int i = 0; i < 32; i++)
+  {
+    vec3f eye = rnd_map_pos(seed, 300);
+    aiLos.add(eye, v_add(eye, rnd_offset(seed, 120)));
+  }
+
+  TraceSet &sound = sets.push_back();
+  sound.name = "sound occlusion";
+  vec3f listener = v_make_vec4f(MAP * 0.5f, 2, MAP * 0.5f, 0);
+  for (int i = 0; i < 16; i++)
+    sound.add(listener, v_add(listener, rnd_offset(seed, 350)));
+}
+
+typedef dag::Vector<uint64_t> HitPairs; // (ray << 32 | instance)
+
+static void sort_unique(HitPairs &pairs)
+{
+  eastl::sort(pairs.begin(), pairs.end());
+  pairs.erase(eastl::unique(pairs.begin(), pairs.end()), pairs.end());
+}
+
+// reference: every ray traversed alone, through cells of its own box, scalar ray/box test
+static void trace_single(const TestGrid &grid, const TraceSet &ts, HitPairs &out)
+{
+  dag::Vector<uint64_t> keys;
+  for (int r = 0; r < ts.size(); r++)
+  {
+    bbox3f rb = ts.rayBox(r);
+    bin_rays_by_cells(&rb, 1, grid.origin, grid.invCellSz, grid.lastCell, grid.region, TestGrid::CELLS_W, keys);
+    for (uint64_t key : keys)
+    {
+      int cell = ray_bin_cell(key);
+      for (int i = 0; i < TestGrid::INST_PER_CELL; i++)
+        if (v_test_ray_box_intersection(ts.from[r], ts.dir[r], v_splats(ts.len[r]), grid.cellInst(cell)[i]))
+          out.push_back((uint64_t(r) << 32) | uint32_t(cell * TestGrid::INST_PER_CELL + i));
+    }
+  }
+}
+
+// previous multi-ray approach: all cells of combined box, all rays for each instance overlapping combined box
+static int trace_combined_box(const TestGrid &grid, const TraceSet &ts, HitPairs &out)
+{
+  bbox3f all = ts.rayBox(0);
+  for (int r = 1; r < ts.size(); r++)
+    v_bbox3_add_box(all, ts.rayBox(r));
+  dag::Vector<uint64_t> keys;
+  bin_rays_by_cells(&all, 1, grid.origin, grid.invCellSz, grid.lastCell, grid.region, TestGrid::CELLS_W, keys);
+  for (uint64_t key : keys)
+  {
+    int cell = ray_bin_cell(key);
+    for (int i = 0; i < TestGrid::INST_PER_CELL; i++)
+    {
+      const bbox3f &ib = grid.cellInst(cell)[i];
+      if (!v_bbox3_test_box_intersect(ib, all))
+        continue;
+      for (int r = 0; r < ts.size(); r++)
+        if (v_test_ray_box_intersection(ts.from[r], ts.dir[r], v_splats(ts.len[r]), ib))
+          out.push_back((uint64_t(r) << 32) | uint32_t(cell * TestGrid::INST_PER_CELL + i));
+    }
+  }
+  return (int)keys.size();
+}
+
+// binned: each cell once with rays touching it, instance bounds tested against 4 rays at once
+static int trace_binned(const TestGrid &grid, const TraceSet &ts, HitPairs &out)
+{
+  dag::Vector<bbox3f> boxes(ts.size());
+  for (int r = 0; r < ts.size(); r++)
+    boxes[r] = ts.rayBox(r);
+  dag::Vector<uint64_t> keys;
+  bin_rays_by_cells(boxes.data(), ts.size(), grid.origin, grid.invCellSz, grid.lastCell, grid.region, TestGrid::CELLS_W, keys);
+
+  int cellVisits = 0;
+  dag::Vector<int> cellRays;
+  dag::Vector<RayPacket4> packets;
+  for (int b = 0; b < keys.size();)
+  {
+    int cell = ray_bin_cell(keys[b]);
+    cellRays.clear();
+    bbox3f cellBox = boxes[ray_bin_ray(keys[b])];
+    for (; b < keys.size() && ray_bin_cell(keys[b]) == cell; b++)
+    {
+      cellRays.push_back(ray_bin_ray(keys[b]));
+      v_bbox3_add_box(cellBox, boxes[cellRays.back()]);
+    }
+    cellVisits++;
+    packets.resize((cellRays.size() + 3) / 4);
+    for (int p = 0; p < packets.size(); p++)
+    {
+      vec4f f[4], d[4];
+      float t[4];
+      int cnt = eastl::min<int>(4, cellRays.size() - p * 4);
+      for (int j = 0; j < cnt; j++)
+      {
+        int r = cellRays[p * 4 + j];
+        f[j] = ts.from[r], d[j] = ts.dir[r], t[j] = ts.len[r];
+      }
+      packets[p].init(f, d, t, cnt);
+    }
+    for (int i = 0; i < TestGrid::INST_PER_CELL; i++)
+    {
+      const bbox3f &ib = grid.cellInst(cell)[i];
+      if (!v_bbox3_test_box_intersect(ib, cellBox))
+        continue;
+      for (int p = 0; p < packets.size(); p++)
+        for (unsigned mask = packets[p].testBox(ib); mask; mask &= mask - 1)
+          out.push_back((uint64_t(cellRays[p * 4 + __ctz_unsafe(mask)]) << 32) | uint32_t(cell * TestGrid::INST_PER_CELL + i));
+    }
+  }
+  return cellVisits;
+}
+} // namespace
+
+TEST(RayPacketMatchesScalarRayBoxTest)
+{
+  int seed = 777;
+  int mismatches = 0, hits = 0, total = 0;
+  for (int iter = 0; iter < 20000; iter++)
+  {
+    vec4f from[4], dir[4];
+    float len[4];
+    int cnt = 1 + (iter & 3);
+    for (int j = 0; j < cnt; j++)
+    {
+      from[j] = v_make_vec4f(_srnd(seed) * 20, _srnd(seed) * 20, _srnd(seed) * 20, 0);
+      vec3f d = v_make_vec4f(_srnd(seed), _srnd(seed), _srnd(seed), 0);
+      if ((iter % 7) == 0) // axis parallel rays, e.g. trace down
+        d = v_make_vec4f(0, -1, 0, 0);
+      dir[j] = v_norm3(d);
+      len[j] = _rnd_float(seed, 0.1f, 40);
+    }
+    RayPacket4 packet;
+    packet.init(from, dir, len, cnt);
+    // box near some point of first ray, so that good part of rays hit it
+    vec3f c = v_madd(dir[0], v_splats(_frnd(seed) * len[0]), from[0]);
+    c = v_add(c, v_make_vec4f(_srnd(seed) * 6, _srnd(seed) * 6, _srnd(seed) * 6, 0));
+    vec3f ext = v_make_vec4f(_rnd_float(seed, 0.1f, 8), _rnd_float(seed, 0.1f, 8), _rnd_float(seed, 0.1f, 8), 0);
+    bbox3f box;
+    box.bmin = v_sub(c, ext);
+    box.bmax = v_add(c, ext);
+    int mask = packet.testBox(box);
+    CHECK_EQUAL(0, mask & ~packet.activeMask);
+    for (int j = 0; j < cnt; j++, total++)
+    {
+      bool ref = v_test_ray_box_intersection(from[j], dir[j], v_splats(len[j]), box);
+      hits += ref ? 1 : 0;
+      mismatches += ref != bool(mask & (1 << j)) ? 1 : 0;
+    }
+  }
+  printf("RayPacket4: %d rays, %d hits, %d mismatches vs scalar test\n", total, hits, mismatches);
+  CHECK(hits > total / 20);
+  CHECK(mismatches * 10000 <= total); // only boundary cases may differ because of rounding
+}
+
+TEST(BinnedTraversalMatchesSingleRayTraversal)
+{
+  TestGrid grid(12345);
+  for (int setSeed = 1; setSeed <= 64; setSeed++)
+  {
+    dag::Vector<TraceSet> sets;
+    make_trace_sets(sets, setSeed * 97);
+    for (const TraceSet &ts : sets)
+    {
+      HitPairs ref, binned;
+      trace_single(grid, ts, ref);
+      trace_binned(grid, ts, binned);
+      sort_unique(ref);
+      sort_unique(binned);
+      CHECK(ref == binned);
+    }
+  }
+}
+
+TEST(BinnedTraversalBenchmark)
+{
+  static constexpr int RECORDED_FRAMES = 32; // trace sets recorded with fixed seeds, one per simulated frame
+  TestGrid grid(12345);
+  dag::Vector<TraceSet> sets;
+  for (int frame = 0; frame < RECORDED_FRAMES; frame++)
+    make_trace_sets(sets, 1000 + frame);
+
+  const char *names[] = {"shotgun pellets", "AI LOS checks", "sound occlusion"};
+  for (const char *name : names)
+  {
+    int64_t combinedCells = 0, binnedCells = 0;
+    int64_t combinedUsec = 0, binnedUsec = 0;
+    size_t combinedHits = 0, binnedHits = 0;
+    HitPairs pairs;
+    for (const TraceSet &ts : sets)
+    {
+      if (strcmp(ts.name, name) != 0)
+        continue;
+      pairs.clear();
+      int64_t ref = ref_time_ticks();
+      combinedCells += trace_combined_box(grid, ts, pairs);
+      combinedUsec += get_time_usec(ref);
+      sort_unique(pairs);
+      combinedHits += pairs.size();
+
+      pairs.clear();
+      ref = ref_time_ticks();
+      binnedCells += trace_binned(grid, ts, pairs);
+      binnedUsec += get_time_usec(ref);
+      sort_unique(pairs);
+      binnedHits += pairs.size();
+    }
+    printf("%-16s combined box: %7lld cell visits %6lld us; binned: %6lld cell visits %6lld us; hits %d/%d\n", name,
+      (long long)combinedCells, (long long)combinedUsec, (long long)binnedCells, (long long)binnedUsec, (int)combinedHits,
+      (int)binnedHits);
+    CHECK(binnedCells <= combinedCells);
+  }
+}
@@ -31,6 +31,7 @@
 CONSOLE_BOOL_VAL("dabfg", recompile_graph, false);
 CONSOLE_BOOL_VAL("dabfg", recompile_graph_every_frame, false);
 CONSOLE_BOOL_VAL("dabfg", debug_graph_generation, DAGOR_DBGLEVEL > 0);
+CONSOLE_BOOL_VAL("dabfg", incremental_name_resolution, true);
 
 
 namespace dabfg
@@ -60,7 +61,12 @@ NodeTracker &NodeTracker::get() { return Backend::get().nodeTracker; }
 void Backend::resolveNames()
 {
   TIME_PROFILE(resolveNames);
-  nameResolver.update();
+  if (fullNameResolutionRequired || !incremental_name_resolution.get())
+    nameResolver.update();
+  else
+    nameResolver.update(changedNodes);
+  fullNameResolutionRequired = false;
+  changedNodes.clear();
   currentStage = CompilationStage::REQUIRES_NODE_DATA_GATHERING;
 }
 
@@ -293,7 +299,14 @@ void Backend::runNodes()
   std::lock_guard<NodeTracker> lock(nodeTracker);
 
   if (nodeTracker.acquireNodesChanged())
-    markStageDirty(CompilationStage::REQUIRES_FULL_RECOMPILATION);
+  {
+    // Only the changed nodes get declared again (see NodeTracker::declareNodes),
+    // so this does not require full name resolution by itself
+    for (auto nodeId : nodeTracker.acquireChangedNodes())
+      changedNodes.insert(nodeId);
+    if (CompilationStage::REQUIRES_NODES_DECLARATION < currentStage)
+      currentStage = CompilationStage::REQUIRES_NODES_DECLARATION;
+  }
 
   if (recompile_graph.get() || recompile_graph_every_frame.get())
   {
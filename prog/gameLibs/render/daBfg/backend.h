@@ -4,6 +4,7 @@
 
 #include <math/integer/dag_IPoint2.h>
 #include <dag/dag_vector.h>
+#include <dag/dag_vectorSet.h>
 #include <3d/dag_drv3d.h>
 #include <generic/dag_initOnDemand.h>
 
@@ -32,6 +33,11 @@ class Backend
   friend class NodeTracker;
 
   CompilationStage currentStage = CompilationStage::UP_TO_DATE;
+  // Nodes (un)registered since the last name resolution. When nothing
+  // else requested name resolution, only names affected by these are
+  // resolved again.
+  dag::VectorSet<NodeNameId> changedNodes;
+  bool fullNameResolutionRequired = true;
   multiplexing::Extents currentMultiplexingExtents;
 
   // === Components of FG backend ===
@@ -84,6 +90,8 @@ public:
   {
     if (stage < currentStage)
       currentStage = stage;
+    if (stage <= CompilationStage::REQUIRES_NAME_RESOLUTION)
+      fullNameResolutionRequired = true;
   }
 
   // NOTE: it's good to put this here as everything will be inlined,
@@ -3,6 +3,9 @@
 #include <id/idHierarchicalNameMap.h>
 #include <id/idIndexedFlags.h>
 #include <id/idRange.h>
+#include <dag/dag_vectorSet.h>
+#include <EASTL/string_view.h>
+#include <EASTL/span.h>
 
 
 namespace detail
@@ -11,6 +14,11 @@ template <class T>
 struct PerTypeResolver
 {
   IdIndexedMapping<T, T> resolved;
+  // Validity flags used for the last rebuild, a diff with them tells
+  // us what names might have changed their resolution
+  IdIndexedFlags<T> lastValidity;
+  // Ids whose resolution changed (or that appeared) during last rebuild
+  dag::Vector<T> changed;
 };
 } // namespace detail
 
@@ -20,6 +28,10 @@ class IdNameResolver : private detail::PerTypeResolver<Ts>...
 public:
   IdNameResolver() {}
 
+  // Resolution of a name only depends on the validity of names with
+  // the same short name in the enclosing folders, so only names that
+  // share a short name with something that appeared, disappeared or
+  // changed validity since the last rebuild get resolved again.
   template <class A>
   void rebuild(const IdHierarchicalNameMap<FolderT, Ts...> &name_map, const IdIndexedFlags<Ts, A> &...validity_flags_pack)
   {
@@ -37,12 +49,33 @@ public:
         G_ASSERT(validity_flags.size() == name_map.template nameCount<T>());
 
         auto &res = detail::PerTypeResolver<T>::resolved;
-        res.resize(name_map.template nameCount<T>());
+        auto &lastValidity = detail::PerTypeResolver<T>::lastValidity;
+        auto &changed = detail::PerTypeResolver<T>::changed;
+        const uint32_t prevCount = res.size();
+        const uint32_t count = name_map.template nameCount<T>();
+        res.resize(count, T::Invalid);
+        changed.clear();
+
+        dag::VectorSet<eastl::string_view> dirtyShortNames;
+        for (auto id : IdRange<T>(eastl::min(prevCount, count)))
+          if (validity_flags[id] != lastValidity.test(id, false))
+            dirtyShortNames.insert(name_map.getShortName(id));
+        for (auto id : IdRange<T>(count))
+          if (eastl::to_underlying(id) >= prevCount && validity_flags[id])
+            dirtyShortNames.insert(name_map.getShortName(id));
+
+        lastValidity.resize(count);
+        for (auto id : IdRange<T>(count))
+          lastValidity.set(id, validity_flags[id]);
 
         for (auto [from, to] : res.enumerate())
         {
           const auto targetShortName = name_map.getShortName(from);
+          const bool isNew = eastl::to_underlying(from) >= prevCount;
+          if (!isNew && dirtyShortNames.find(eastl::string_view(targetShortName)) == dirtyShortNames.end())
+            continue;
 
+          const T prevTo = to;
           auto currFolder = name_map.getParent(from);
           uint32_t stepUpCounter = 0;
           static constexpr uint32_t INFINITE_LOOP_THRESHOLD = 100;
@@ -65,11 +98,21 @@ public:
           }
           if (stepUpCounter == INFINITE_LOOP_THRESHOLD)
             logerr("Went up by %d levels of nested namespaces, probably an infinite loop in dabfg backend!", stepUpCounter);
+
+          if (isNew || to != prevTo)
+            changed.push_back(from);
         }
       }(),
       ...);
   }
 
+  // Ids that got a different resolution (or were added) during the last rebuild
+  template <class T>
+  eastl::span<const T> changedByLastRebuild() const
+  {
+    return detail::PerTypeResolver<T>::changed;
+  }
+
   template <class T>
   T resolve(T id) const
   {
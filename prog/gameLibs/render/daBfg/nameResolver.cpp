@@ -12,6 +12,35 @@ void NameResolver::update()
   updateInverseMapping();
 }
 
+void NameResolver::update(eastl::span<const NodeNameId> changed_nodes)
+{
+  updateMapping();
+
+  const uint32_t nodeCount = registry.knownNames.nameCount<NodeNameId>();
+  inverseMapping.resize(nodeCount);
+  inverseHistoryMapping.resize(nodeCount);
+
+  IdIndexedFlags<NodeNameId, framemem_allocator> nodeDirty(nodeCount, false);
+  for (auto nodeId : changed_nodes)
+    nodeDirty.set(nodeId, true);
+
+  IdIndexedFlags<ResNameId, framemem_allocator> resReresolved(registry.knownNames.nameCount<ResNameId>(), false);
+  for (auto resId : resolver.changedByLastRebuild<ResNameId>())
+    resReresolved.set(resId, true);
+
+  const auto anyReresolved = [&resReresolved](const auto &requests) {
+    for (const auto &[resId, _] : requests)
+      if (resReresolved.test(resId, true))
+        return true;
+    return false;
+  };
+
+  for (auto [nodeId, nodeData] : registry.nodes.enumerate())
+    if (nodeDirty.test(nodeId, true) || anyReresolved(nodeData.resourceRequests) ||
+        anyReresolved(nodeData.historyResourceReadRequests))
+      updateInverseMapping(nodeId, nodeData);
+}
+
 void NameResolver::updateMapping()
 {
   // This validity info simply tells us whether an entity was created
@@ -49,12 +78,17 @@ void NameResolver::updateInverseMapping()
   inverseHistoryMapping.clear();
   inverseHistoryMapping.resize(registry.knownNames.nameCount<NodeNameId>());
   for (auto [nodeId, nodeData] : registry.nodes.enumerate())
-  {
-    for (const auto &[resId, _] : nodeData.resourceRequests)
-      inverseMapping[nodeId][resolve(resId)].push_back(resId);
-    for (const auto &[resId, _] : nodeData.historyResourceReadRequests)
-      inverseHistoryMapping[nodeId][resolve(resId)].push_back(resId);
-  }
+    updateInverseMapping(nodeId, nodeData);
+}
+
+void NameResolver::updateInverseMapping(NodeNameId node_id, const NodeData &node_data)
+{
+  inverseMapping[node_id].clear();
+  for (const auto &[resId, _] : node_data.resourceRequests)
+    inverseMapping[node_id][resolve(resId)].push_back(resId);
+  inverseHistoryMapping[node_id].clear();
+  for (const auto &[resId, _] : node_data.historyResourceReadRequests)
+    inverseHistoryMapping[node_id][resolve(resId)].push_back(resId);
 }
 
 template <class T>
@@ -14,7 +14,12 @@ class NameResolver
 public:
   NameResolver(const InternalRegistry &reg) : registry{reg} {}
 
+  // Full update, required whenever something besides node declarations changed (e.g. slots)
   void update();
+  // Incremental update after (re)declaration of changed_nodes: only names affected by
+  // the changes get resolved again and only inverse mappings of nodes that could have
+  // been affected are rebuilt
+  void update(eastl::span<const NodeNameId> changed_nodes);
 
   template <class T>
   T resolve(T name_id) const;
@@ -39,6 +44,7 @@ public:
 private:
   void updateMapping();
   void updateInverseMapping();
+  void updateInverseMapping(NodeNameId node_id, const NodeData &node_data);
 
   const InternalRegistry &registry;
   IdNameResolver<NameSpaceNameId, ResNameId, NodeNameId, AutoResTypeNameId> resolver;
@@ -28,6 +28,7 @@ void NodeTracker::registerNode(NodeNameId nodeId)
   invalidate_graph_visualization();
 
   deferredDeclarationQueue.emplace(nodeId);
+  changedNodes.emplace(nodeId);
 
   // Make sure that the id is mapped, as the nodes map is the
   // single point of truth here.
@@ -50,6 +51,7 @@ void NodeTracker::unregisterNode(NodeNameId nodeId, uint32_t gen)
 
   nodesChanged = true;
   invalidate_graph_visualization();
+  changedNodes.emplace(nodeId);
 
   // In case the node didn't have a chance to declare resources yet,
   // clear from it the cache
@@ -51,6 +51,9 @@ public:
   intermediate::Graph emitIR(multiplexing::Extents extents) const;
 
   bool acquireNodesChanged() { return eastl::exchange(nodesChanged, false); }
+  // Nodes that were registered or unregistered since the last call,
+  // used to limit the scope of recompilation
+  dag::VectorSet<NodeNameId> acquireChangedNodes() { return eastl::exchange(changedNodes, {}); }
 
   intermediate::RequiredNodeState calcNodeState(NodeNameId node_id, intermediate::MultiplexingIndex multi_index,
     const intermediate::Mapping &mapping) const;
@@ -74,6 +77,7 @@ private:
   const NameResolver &nameResolver;
 
   dag::VectorSet<NodeNameId> deferredDeclarationQueue;
+  dag::VectorSet<NodeNameId> changedNodes;
 
   bool nodesChanged{false};
   bool nodeChangesLocked{false};
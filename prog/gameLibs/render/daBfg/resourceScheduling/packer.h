@@ -2,6 +2,7 @@
 
 #include <EASTL/span.h>
 #include <EASTL/fixed_function.h>
+#include <dag/dag_vector.h>
 
 // A packer is an algorithm that decides where to place resources in
 // memory based on their size and lifetime.
@@ -67,9 +68,61 @@ enum PackerType : int
   GreedyScanline,
   Boxing,
   AdHocBoxing,
-  COUNT = AdHocBoxing
+  // Keeps offsets of resources that didn't change since the last packing
+  // of the same heap and only places the changed ones, see PackerCache
+  WarmStart,
+  COUNT = WarmStart
 };
 
+// Remembers the last input and output of packing for a single heap.
+// Recompilation of the graph rarely changes resources of all heaps at
+// once (e.g. when a single node is toggled), so when the input is
+// exactly the same as the last time, the last result is reused and
+// the packer is not run at all.
+// With the WarmStart packer type, a changed input is packed starting
+// from the previous placement: only resources with a changed lifetime,
+// size or hint get relocated. When this takes longer than the time
+// budget or produces a notably worse layout than a cold packing would,
+// the greedy scanline packer is used instead.
+class PackerCache
+{
+public:
+  // Either returns the cached output or runs packer of type packer_type
+  // and caches it's output. Returned offsets reference memory stored
+  // inside of the cache.
+  PackerOutput pack(const PackerInput &input, int packer_type, int warm_start_budget_usec = 0);
+
+  bool wasLastPackCached() const { return lastPackCached; }
+  bool wasLastPackWarmStarted() const { return lastPackWarmStarted; }
+  void invalidate() { valid = false; }
+
+private:
+  bool sameInput(const PackerInput &input, int packer_type) const;
+  bool warmStart(const PackerInput &input, int budget_usec);
+
+  dag::Vector<PackerInput::Resource> resources;
+  uint32_t timelineSize = 0;
+  uint64_t maxHeapSize = 0;
+  int packerType = -1;
+
+  dag::Vector<uint64_t> offsets;
+  uint64_t heapSize = 0;
+
+  // heapSize / lower bound ratio of the last cold packing, warm started
+  // layouts are not allowed to drift too far away from it
+  float coldPackingRatio = 1.f;
+
+  bool valid = false;
+  bool lastPackCached = false;
+  bool lastPackWarmStarted = false;
+};
+
+// Max total size of resources alive at the same time, no packing can
+// produce a heap smaller than that
+uint64_t packing_lower_bound(const PackerInput &input);
+
+Packer make_packer(int packer_type);
+
 Packer make_greedy_scanline_packer();
 Packer make_boxing_packer();
 Packer make_adhoc_boxing_packer();
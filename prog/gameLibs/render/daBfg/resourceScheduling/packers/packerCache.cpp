@@ -0,0 +1,69 @@
+#include <resourceScheduling/packer.h>
+#include <debug/dag_assert.h>
+#include <EASTL/algorithm.h>
+
+namespace dabfg
+{
+
+Packer make_packer(int packer_type)
+{
+  switch (packer_type)
+  {
+    case PackerType::Baseline: return make_baseline_packer();
+    case PackerType::GreedyScanline: return make_greedy_scanline_packer();
+    case PackerType::Boxing: return make_boxing_packer();
+    case PackerType::AdHocBoxing: return make_adhoc_boxing_packer();
+    // Used when there is nothing to warm start from
+    case PackerType::WarmStart: return make_greedy_scanline_packer();
+    default: return {};
+  }
+}
+
+static bool operator==(const PackerInput::Resource &fst, const PackerInput::Resource &snd)
+{
+  return fst.start == snd.start && fst.end == snd.end && fst.size == snd.size && fst.align == snd.align &&
+         fst.offsetHint == snd.offsetHint;
+}
+
+bool PackerCache::sameInput(const PackerInput &input, int packer_type) const
+{
+  return valid && packerType == packer_type && timelineSize == input.timelineSize && maxHeapSize == input.maxHeapSize &&
+         resources.size() == input.resources.size() && eastl::equal(resources.begin(), resources.end(), input.resources.begin());
+}
+
+PackerOutput PackerCache::pack(const PackerInput &input, int packer_type, int warm_start_budget_usec)
+{
+  lastPackCached = sameInput(input, packer_type);
+  lastPackWarmStarted = false;
+  if (!lastPackCached)
+  {
+    const bool canWarmStart = packer_type == PackerType::WarmStart && warm_start_budget_usec > 0 && valid &&
+                              packerType == packer_type && timelineSize == input.timelineSize;
+    lastPackWarmStarted = canWarmStart && warmStart(input, warm_start_budget_usec);
+
+    if (!lastPackWarmStarted)
+    {
+      Packer packer = make_packer(packer_type);
+      G_ASSERT_RETURN(packer, (PackerOutput{{}, 0}));
+      const PackerOutput output = packer(input);
+      offsets.assign(output.offsets.begin(), output.offsets.end());
+      heapSize = output.heapSize;
+
+      const uint64_t lowerBound = packing_lower_bound(input);
+      coldPackingRatio = lowerBound != 0 ? static_cast<float>(heapSize) / lowerBound : 1.f;
+    }
+
+    resources.assign(input.resources.begin(), input.resources.end());
+    timelineSize = input.timelineSize;
+    maxHeapSize = input.maxHeapSize;
+    packerType = packer_type;
+    valid = true;
+  }
+
+  PackerOutput output;
+  output.offsets = offsets;
+  output.heapSize = heapSize;
+  return output;
+}
+
+} // namespace dabfg
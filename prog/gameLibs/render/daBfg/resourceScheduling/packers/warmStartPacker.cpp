@@ -0,0 +1,197 @@
+#include <resourceScheduling/packer.h>
+
+#include <memory/dag_framemem.h>
+#include <perfMon/dag_cpuFreq.h>
+#include <util/dag_stlqsort.h>
+#include <EASTL/algorithm.h>
+
+
+namespace dabfg
+{
+
+// How much worse than the last cold packing (relative to the lower bound)
+// a warm started layout is allowed to be before we give up on it
+static constexpr float WARM_START_MAX_DRIFT = 0.1f;
+
+template <class T>
+using FramememVector = dag::Vector<T, framemem_allocator>;
+
+struct PlacedResource
+{
+  uint32_t start;
+  uint32_t end;
+  uint64_t offset;
+  uint64_t size;
+};
+
+static bool is_wrapping(uint32_t start, uint32_t end) { return start >= end; }
+
+static bool lifetimes_disjoint(uint32_t a_start, uint32_t a_end, uint32_t b_start, uint32_t b_end)
+{
+  const bool aWraps = is_wrapping(a_start, a_end);
+  const bool bWraps = is_wrapping(b_start, b_end);
+  if (aWraps && bWraps)
+    return false;
+  if (aWraps || bWraps)
+    return a_end <= b_start && b_end <= a_start;
+  return a_end <= b_start || b_end <= a_start;
+}
+
+static uint64_t align_offset(uint64_t offset, uint64_t align) { return (offset + align - 1) / align * align; }
+
+// Offset hints are not a part of the key, they are checked separately
+static bool same_key_less(const PackerInput::Resource &fst, const PackerInput::Resource &snd)
+{
+  if (fst.start != snd.start)
+    return fst.start < snd.start;
+  if (fst.end != snd.end)
+    return fst.end < snd.end;
+  if (fst.size != snd.size)
+    return fst.size < snd.size;
+  return fst.align < snd.align;
+}
+
+static bool is_valid_offset(uint64_t offset) { return offset != PackerOutput::NOT_ALLOCATED && offset != PackerOutput::NOT_SCHEDULED; }
+
+uint64_t packing_lower_bound(const PackerInput &input)
+{
+  if (input.resources.empty() || input.timelineSize == 0)
+    return 0;
+
+  FRAMEMEM_REGION;
+  FramememVector<int64_t> balance(input.timelineSize + 1, 0);
+  for (const auto &res : input.resources)
+  {
+    const int64_t size = static_cast<int64_t>(res.size);
+    balance[res.start] += size;
+    balance[res.end] -= size;
+    if (is_wrapping(res.start, res.end))
+    {
+      balance[0] += size;
+      balance[input.timelineSize] -= size;
+    }
+  }
+
+  int64_t current = 0;
+  int64_t result = 0;
+  for (uint32_t i = 0; i < input.timelineSize; ++i)
+  {
+    current += balance[i];
+    result = eastl::max(result, current);
+  }
+  return static_cast<uint64_t>(result);
+}
+
+bool PackerCache::warmStart(const PackerInput &input, int budget_usec)
+{
+  const int64_t startTicks = ref_time_ticks();
+
+  dag::Vector<uint64_t> newOffsets(input.resources.size(), PackerOutput::NOT_ALLOCATED);
+  uint64_t newHeapSize = 0;
+  {
+    FRAMEMEM_REGION;
+
+    // Resources have no identity, so a resource is considered unchanged
+    // when the previous input had one with the same lifetime, size and
+    // alignment. Sorting both inputs allows to match them in a single pass.
+    FramememVector<uint32_t> prevOrder;
+    prevOrder.reserve(resources.size());
+    for (uint32_t i = 0; i < resources.size(); ++i)
+      if (is_valid_offset(offsets[i]))
+        prevOrder.push_back(i);
+    FramememVector<uint32_t> newOrder;
+    newOrder.reserve(input.resources.size());
+    for (uint32_t i = 0; i < input.resources.size(); ++i)
+      if (input.resources[i].size != 0)
+        newOrder.push_back(i);
+
+    stlsort::sort(prevOrder.begin(), prevOrder.end(),
+      [this](uint32_t a, uint32_t b) { return same_key_less(resources[a], resources[b]); });
+    stlsort::sort(newOrder.begin(), newOrder.end(),
+      [&input](uint32_t a, uint32_t b) { return same_key_less(input.resources[a], input.resources[b]); });
+
+    FramememVector<PlacedResource> placed;
+    placed.reserve(newOrder.size());
+    FramememVector<uint32_t> relocated;
+    for (uint32_t i = 0, j = 0; j < newOrder.size(); ++j)
+    {
+      const auto &res = input.resources[newOrder[j]];
+      while (i < prevOrder.size() && same_key_less(resources[prevOrder[i]], res))
+        ++i;
+
+      if (i < prevOrder.size() && !same_key_less(res, resources[prevOrder[i]]))
+      {
+        const uint64_t prevOffset = offsets[prevOrder[i++]];
+        const bool hintRespected = res.offsetHint == PackerInput::NO_HINT || res.offsetHint == prevOffset;
+        if (hintRespected && prevOffset + res.size <= input.maxHeapSize)
+        {
+          newOffsets[newOrder[j]] = prevOffset;
+          placed.push_back({res.start, res.end, prevOffset, res.size});
+          newHeapSize = eastl::max(newHeapSize, prevOffset + res.size);
+          continue;
+        }
+      }
+      relocated.push_back(newOrder[j]);
+    }
+
+    // Kept resources did not overlap in the previous layout and still
+    // don't, as their lifetimes are the same.
+    stlsort::sort(placed.begin(), placed.end(), [](const PlacedResource &a, const PlacedResource &b) { return a.offset < b.offset; });
+
+    // Hinted resources have no choice, so they go first. The rest are
+    // placed from large to small, as with a cold packing.
+    stlsort::sort(relocated.begin(), relocated.end(), [&input](uint32_t a, uint32_t b) {
+      const auto &fst = input.resources[a];
+      const auto &snd = input.resources[b];
+      const bool fstHinted = fst.offsetHint != PackerInput::NO_HINT;
+      const bool sndHinted = snd.offsetHint != PackerInput::NO_HINT;
+      if (fstHinted != sndHinted)
+        return fstHinted;
+      return fst.size != snd.size ? fst.size > snd.size : a < b;
+    });
+
+    for (const uint32_t idx : relocated)
+    {
+      if (get_time_usec(startTicks) > budget_usec)
+        return false;
+
+      const auto &res = input.resources[idx];
+      const bool hinted = res.offsetHint != PackerInput::NO_HINT;
+
+      // First fit among resources alive at the same time, which are
+      // visited in the order of their offsets
+      uint64_t offset = hinted ? res.offsetHint : 0;
+      for (const auto &other : placed)
+      {
+        if (lifetimes_disjoint(res.start, res.end, other.start, other.end))
+          continue;
+        if (offset + res.size <= other.offset)
+          break;
+        if (other.offset + other.size <= offset)
+          continue;
+        if (hinted)
+          return false;
+        offset = align_offset(other.offset + other.size, res.align);
+      }
+
+      if (offset + res.size > input.maxHeapSize)
+        return false;
+
+      newOffsets[idx] = offset;
+      const auto it = eastl::upper_bound(placed.begin(), placed.end(), offset,
+        [](uint64_t value, const PlacedResource &other) { return value < other.offset; });
+      placed.insert(it, PlacedResource{res.start, res.end, offset, res.size});
+      newHeapSize = eastl::max(newHeapSize, offset + res.size);
+    }
+  }
+
+  const uint64_t lowerBound = packing_lower_bound(input);
+  if (lowerBound != 0 && static_cast<float>(newHeapSize) > coldPackingRatio * (1.f + WARM_START_MAX_DRIFT) * lowerBound)
+    return false;
+
+  offsets = eastl::move(newOffsets);
+  heapSize = newHeapSize;
+  return true;
+}
+
+} // namespace dabfg
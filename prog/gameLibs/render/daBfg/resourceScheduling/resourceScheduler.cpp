@@ -23,6 +23,9 @@ CONSOLE_BOOL_VAL("dabfg", report_resource_statistics, false);
 CONSOLE_BOOL_VAL("dabfg", set_resource_names, DAGOR_DBGLEVEL > 0);
 
 CONSOLE_INT_VAL("dabfg", resource_packer, dabfg::PackerType::GreedyScanline, 0, dabfg::PackerType::COUNT);
+// Time limit for relocating changed resources with the warm start packer,
+// after which the greedy scanline packer does a full repack
+CONSOLE_INT_VAL("dabfg", warm_start_packer_budget_usec, 500, 0, 100000);
 
 namespace dabfg
 {
@@ -261,20 +264,13 @@ auto ResourceScheduler::scheduleResourcesIntoHeaps(const ResourceProperties &res
     if (heapHasHints && allocatedHeaps.isMapped(heapIdx) && allocatedHeaps[heapIdx].size != 0)
       input.maxHeapSize = allocatedHeaps[heapIdx].size;
 
-    Packer packer;
-    switch (resource_packer)
-    {
-      case PackerType::Baseline: packer = make_baseline_packer(); break;
-      case PackerType::GreedyScanline: packer = make_greedy_scanline_packer(); break;
-      case PackerType::Boxing: packer = make_boxing_packer(); break;
-      case PackerType::AdHocBoxing: packer = make_adhoc_boxing_packer(); break;
-      default: break;
-    }
-
+    // Heaps whose resources didn't change since the last compilation
+    // (which is most of them when a single node gets toggled) reuse
+    // the previous packing instead of running the packer again
     PackerOutput output;
     {
       TIME_PROFILE(dabfg_resource_packing)
-      output = packer(input);
+      output = packerCaches.get(heapIdx).pack(input, resource_packer.get(), warm_start_packer_budget_usec.get());
     }
 
 #if DABFG_STATISTICS_REPORTING
@@ -890,6 +886,7 @@ void ResourceScheduler::shutdown(int frame)
 
   heapToResourceList.clear();
   allocatedHeaps.clear();
+  packerCaches.clear();
   cachedIntermediateResources.clear();
 }
 
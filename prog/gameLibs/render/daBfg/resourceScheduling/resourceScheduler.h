@@ -11,6 +11,7 @@
 #include <id/idIndexedFlags.h>
 #include "intermediateRepresentation.h"
 #include "graphDumper.h"
+#include "packer.h"
 
 
 #define DABFG_STATISTICS_REPORTING DAGOR_DBGLEVEL > 0
@@ -209,6 +210,9 @@ protected:
     eastl::array<dag::FixedVectorMap<intermediate::ResourceIndex, HintedResource, 32>, SCHEDULE_FRAME_WINDOW>>
     hintedResources;
   eastl::array<IdIndexedFlags<intermediate::ResourceIndex>, SCHEDULE_FRAME_WINDOW> preservedResources;
+  // Results of the last packing for each heap, reused when the heap's
+  // packer input did not change during recompilation
+  IdIndexedMapping<HeapIndex, PackerCache> packerCaches;
   // Keep track of history resource flags,
   // because their change invalidates the preservation mechanism.
   dag::FixedVectorMap<ResNameId, uint32_t, 32> historyResourceFlags;
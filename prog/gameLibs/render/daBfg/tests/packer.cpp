@@ -216,3 +216,61 @@ OFFSET_HINT_TEST(100, 1000, 0.5);
 OFFSET_HINT_TEST(1000, 10000, 0.8);
 
 #undef OFFSET_HINT_TEST
+
+struct WarmStartTestsFixture : RandomTestsFixture
+{
+  dabfg::PackerCache cache;
+
+  void packWarm()
+  {
+    output = cache.pack(input, dabfg::PackerType::WarmStart, 1000000);
+    validateOutput();
+  }
+
+  void perturb(float changedFrac)
+  {
+    for (auto &res : resources)
+      if (dagor_random::rnd_float(0.0, 1.0) < changedFrac)
+      {
+        res.end = dagor_random::rnd_int(0, timelineSize - 1);
+        res.size = dagor_random::rnd_int(4096, 8192);
+      }
+    // Removed resources shift indices of the following ones
+    resources.erase(resources.begin());
+    resources.push_back({0, timelineSize / 2, 8192, ALIGNMENT, dabfg::PackerInput::NO_HINT});
+    input.resources = resources;
+  }
+};
+
+#define WARM_START_TEST(t, r)                                   \
+  TEST_FIXTURE(WarmStartTestsFixture, TestWarmStartT##t##R##r) \
+  {                                                             \
+    generate((t), (r));                                         \
+    packWarm();                                                 \
+    CHECK(!cache.wasLastPackWarmStarted());                     \
+    for (uint32_t i = 0; i < 10; ++i)                           \
+    {                                                           \
+      perturb(0.05f);                                           \
+      packWarm();                                               \
+    }                                                           \
+  }
+
+WARM_START_TEST(10, 50);
+WARM_START_TEST(100, 500);
+WARM_START_TEST(1000, 5000);
+
+#undef WARM_START_TEST
+
+TEST_FIXTURE(WarmStartTestsFixture, TestWarmStartKeepsUnchanged)
+{
+  generate(100, 500);
+  packWarm();
+  const dag::Vector<uint64_t> prevOffsets(output.offsets.begin(), output.offsets.end());
+
+  resources[0].end = (resources[0].end + 1) % timelineSize;
+  input.resources = resources;
+  packWarm();
+  CHECK(cache.wasLastPackWarmStarted());
+  for (uint32_t i = 1; i < resources.size(); ++i)
+    CHECK_EQUAL(prevOffsets[i], output.offsets[i]);
+}
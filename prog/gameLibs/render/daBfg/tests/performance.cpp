@@ -3,6 +3,8 @@
 #include <EASTL/vector_multiset.h>
 #include <EASTL/numeric.h>
 #include <EASTL/unordered_map.h>
+#include <perfMon/dag_cpuFreq.h>
+#include <id/idNameResolver.h>
 
 
 struct ProductionTestsFixture : PackerFixture
@@ -136,3 +138,191 @@ TEST_FIXTURE(ProductionTestsFixture, ProdTest)
     printf("%d, %f, %f, %f, %f\n", count, avg, p90, badavg, badp90);
   }
 }
+
+TEST_FIXTURE(ProductionTestsFixture, PackerCacheTimings)
+{
+  printf("Packer cache timings\n");
+  printf("Count, packing us, cached us\n");
+  measure_cpu_freq();
+
+  constexpr uint32_t RUNS = 20;
+  for (uint32_t count = 50; count <= 400; count += 50)
+  {
+    generate(count);
+
+    int64_t reft = ref_time_ticks();
+    for (uint32_t i = 0; i < RUNS; ++i)
+      pack();
+    const int packingUs = get_time_usec(reft) / RUNS;
+
+    dabfg::PackerCache cache;
+    cache.pack(input, dabfg::PackerType::GreedyScanline);
+    CHECK(!cache.wasLastPackCached());
+    reft = ref_time_ticks();
+    dabfg::PackerOutput cached;
+    for (uint32_t i = 0; i < RUNS; ++i)
+      cached = cache.pack(input, dabfg::PackerType::GreedyScanline);
+    const int cachedUs = get_time_usec(reft) / RUNS;
+    CHECK(cache.wasLastPackCached());
+
+    output = cached;
+    validateOutput();
+
+    // Any lifetime change must invalidate the cache
+    resources[count / 2].end = (resources[count / 2].end + 1) % timelineSize;
+    input.resources = resources;
+    cache.pack(input, dabfg::PackerType::GreedyScanline);
+    CHECK(!cache.wasLastPackCached());
+
+    printf("%d, %d, %d\n", count, packingUs, cachedUs);
+  }
+}
+
+enum class TestFolderNameId : uint32_t
+{
+  Invalid = ~0u
+};
+enum class TestNameId : uint32_t
+{
+  Invalid = ~0u
+};
+
+TEST(IncrementalNameResolutionTimings)
+{
+  printf("Name resolution timings\n");
+  printf("Names, full us, incremental us\n");
+  measure_cpu_freq();
+
+  using NameMap = IdHierarchicalNameMap<TestFolderNameId, TestNameId>;
+  using Resolver = IdNameResolver<TestFolderNameId, TestNameId>;
+
+  for (uint32_t folderCount = 8; folderCount <= 64; folderCount *= 2)
+  {
+    // Every folder has own versions of some names that shadow the root ones,
+    // which is how node namespaces usually look like
+    NameMap names;
+    constexpr uint32_t NAMES_PER_FOLDER = 64;
+    for (uint32_t i = 0; i < NAMES_PER_FOLDER; ++i)
+      names.addNameId<TestNameId>(names.root(), String(0, "res%d", i));
+    for (uint32_t f = 0; f < folderCount; ++f)
+    {
+      const auto folder = names.addNameId<TestFolderNameId>(names.root(), String(0, "ns%d", f));
+      const auto subFolder = names.addNameId<TestFolderNameId>(folder, "sub");
+      for (uint32_t i = 0; i < NAMES_PER_FOLDER; ++i)
+      {
+        names.addNameId<TestNameId>(folder, String(0, "res%d", i));
+        names.addNameId<TestNameId>(subFolder, String(0, "res%d", i));
+      }
+    }
+
+    const uint32_t nameCount = names.nameCount<TestNameId>();
+    IdIndexedFlags<TestNameId> validity(nameCount, false);
+    for (uint32_t i = 0; i < nameCount; ++i)
+      validity.set(static_cast<TestNameId>(i), dagor_random::rnd_int(0, 3) != 0);
+
+    Resolver resolver;
+    int64_t reft = ref_time_ticks();
+    resolver.rebuild(names, validity);
+    const int fullUs = get_time_usec(reft);
+
+    // Toggle a single name, as happens when a node gets (un)registered
+    const auto toggled = static_cast<TestNameId>(dagor_random::rnd_int(0, nameCount - 1));
+    validity.set(toggled, !validity[toggled]);
+    reft = ref_time_ticks();
+    resolver.rebuild(names, validity);
+    const int incrementalUs = get_time_usec(reft);
+
+    Resolver reference;
+    reference.rebuild(names, validity);
+    for (uint32_t i = 0; i < nameCount; ++i)
+      CHECK(resolver.resolve(static_cast<TestNameId>(i)) == reference.resolve(static_cast<TestNameId>(i)));
+    CHECK(resolver.changedByLastRebuild<TestNameId>().size() <= 2 * folderCount + 1);
+
+    printf("%d, %d, %d\n", nameCount, fullUs, incrementalUs);
+  }
+}
+
+struct WarmStartBenchmarkFixture : ProductionTestsFixture
+{
+  static constexpr uint32_t TIMELINE_SIZE = 140;
+
+  // overlap is the average fraction of the timeline a resource is alive for
+  void generateWithOverlap(uint32_t resCount, float overlap)
+  {
+    resources.clear();
+    timelineSize = TIMELINE_SIZE;
+    const uint32_t avgLifetime = eastl::max(1u, static_cast<uint32_t>(overlap * timelineSize));
+    for (uint32_t i = 0; i < resCount; ++i)
+    {
+      const uint32_t start = dagor_random::rnd_int(0, timelineSize - 1);
+      const uint32_t end = (start + dagor_random::rnd_int(1, 2 * avgLifetime - 1)) % timelineSize;
+      resources.push_back({start, end, generateFromDistr(sizeDistr), ALIGNMENT, dabfg::PackerInput::NO_HINT});
+    }
+    input.timelineSize = timelineSize;
+    input.resources = resources;
+    input.maxHeapSize = 1ull << 40;
+  }
+
+  // Emulates a node being toggled: a few resources change lifetimes and sizes
+  void perturb(float changedFrac)
+  {
+    for (auto &res : resources)
+      if (dagor_random::rnd_float(0.0, 1.0) < changedFrac)
+      {
+        res.start = (res.start + dagor_random::rnd_int(1, 3)) % timelineSize;
+        res.size = generateFromDistr(sizeDistr);
+      }
+    input.resources = resources;
+  }
+
+  float efficiency() const { return static_cast<float>(dabfg::packing_lower_bound(input)) / static_cast<float>(output.heapSize); }
+
+  template <class F>
+  int timeUs(F &&f)
+  {
+    const int64_t reft = ref_time_ticks();
+    f();
+    return get_time_usec(reft);
+  }
+};
+
+TEST_FIXTURE(WarmStartBenchmarkFixture, WarmStartPackerMatrix)
+{
+  printf("Warm start packer benchmark (efficiency is lower bound / heap size)\n");
+  printf("Count, overlap, greedy us, greedy eff, boxing us, boxing eff, warm us, warm eff, warm started %%\n");
+  measure_cpu_freq();
+
+  constexpr uint32_t RUNS = 10;
+  constexpr float CHANGED_FRAC = 0.05f;
+  const dabfg::Packer boxingPacker = dabfg::make_boxing_packer();
+
+  for (const uint32_t count : {100, 200, 400, 800})
+    for (const float overlap : {0.05f, 0.25f, 0.75f})
+    {
+      int greedyUs = 0, boxingUs = 0, warmUs = 0, warmStarted = 0;
+      float greedyEff = 0, boxingEff = 0, warmEff = 0;
+      for (uint32_t run = 0; run < RUNS; ++run)
+      {
+        generateWithOverlap(count, overlap);
+        dabfg::PackerCache cache;
+        cache.pack(input, dabfg::PackerType::WarmStart, 1000);
+
+        perturb(CHANGED_FRAC);
+
+        greedyUs += timeUs([this] { pack(); });
+        greedyEff += efficiency();
+
+        boxingUs += timeUs([&, this] { output = boxingPacker(input); });
+        validateOutput();
+        boxingEff += efficiency();
+
+        warmUs += timeUs([&, this] { output = cache.pack(input, dabfg::PackerType::WarmStart, 1000); });
+        validateOutput();
+        warmEff += efficiency();
+        warmStarted += cache.wasLastPackWarmStarted() ? 1 : 0;
+      }
+
+      printf("%d, %.2f, %d, %.3f, %d, %.3f, %d, %.3f, %d\n", count, overlap, greedyUs / RUNS, greedyEff / RUNS, boxingUs / RUNS,
+        boxingEff / RUNS, warmUs / RUNS, warmEff / RUNS, warmStarted * 100 / RUNS);
+    }
+}
@@ -108,6 +108,7 @@ size_t dagormem_max_crt_pool_sz = 64 << 20;
 
 size_t dictionary_size_in_kb = 4096;
 size_t sh_group_size_in_kb = 1024;
+String stcode_cpp_filename;
 ShadervarGeneratorMode shadervar_generator_mode = ShadervarGeneratorMode::None;
 std::string shadervars_code_template_filename;
 GeneratedPathInfos generated_path_infos;
@@ -296,6 +297,7 @@ static void showUsage()
     "  -skipvalidation - do not validate the generated code against known capabilities"
     " and constraints\n"
     "  -nodisassembly - no hlsl disassembly output\n"
+    "  -stcodeCpp FILE - write native C++ routines for stcode of built dump to FILE\n"
     "  -sanitize_hash - sanitize hash of strings\n"
     "  -no_sanitize_hash - not sanitize hash\n"
     "  -codeDump  - always dump hlsl/Cg source code to be compiled to shaderlog\n"
@@ -1268,6 +1270,13 @@ int DagorWinMain(bool debugmode)
       dd_mkdir(debug_output_dir);
     }
 #endif
+    else if (dd_stricmp(s, "-stcodeCpp") == 0)
+    {
+      i++;
+      if (i >= __argc)
+        goto usage_err;
+      stcode_cpp_filename = __argv[i];
+    }
     else if (dd_stricmp(s, "-wx") == 0)
     {
       sh_change_mode(SHLOG_WARNING, SHLOG_ERROR);
@@ -16,6 +16,8 @@
 #include <shaders/shLimits.h>
 #include "transcodeShader.h"
 #include "binDumpUtils.h"
+#include "stcodeCpp.h"
+#include <shaders/shStcodeHash.h>
 #include <ioSys/dag_zstdIo.h>
 #include <util/dag_hash.h>
 #if _CROSS_TARGET_DX12
@@ -29,6 +31,8 @@
 using namespace mkbindump;
 using namespace shader_layout;
 
+extern String stcode_cpp_filename;
+
 static const int ZSTD_SH_CLEVEL = 11;
 
 namespace semicooked
@@ -1117,14 +1121,25 @@ bool make_scripted_shaders_dump(const char *dump_name, const char *cache_filenam
 
   // write stcode data
   shaders_dump.stcode.resize(stCode.size());
+  const bool writeStcodeCpp = !stcode_cpp_filename.empty() && !strip_shaders_and_stcode;
+  StcodeHash stcodeHash;
+  Tab<Tab<int>> nativeStcode;
+  if (writeStcodeCpp)
+    nativeStcode.resize(stCode.size());
   for (int i = 0; i < stCode.size(); i++)
   {
     if (stcode_type[i] == 0)
+    {
+      stcodeHash.add({});
       continue;
+    }
     dag::ConstSpan<int> _st = stcode_type[i] < 3 ? ::process_stblkcode(stCode[i], stcode_type[i] == 1) : make_span_const(stCode[i]);
     dag::ConstSpan<int> st = ::transcode_stcode(_st);
 
     shaders_dump.stcode[i] = st;
+    stcodeHash.add(st);
+    if (writeStcodeCpp && stcode_type[i] == 3) // only shclass stcode is executed with ScriptedShaderElement::exec_stcode()
+      nativeStcode[i] = st;
     if (stcode_type[i] == 1)
       stcode_bytes0 += data_size(st);
     else if (stcode_type[i] == 2)
@@ -1483,5 +1498,14 @@ bool make_scripted_shaders_dump(const char *dump_name, const char *cache_filenam
     return false;
 
   bindump::streamWrite(shaders_dump_compressed, file_writer);
+
+  if (writeStcodeCpp)
+  {
+    Tab<dag::ConstSpan<int>> stcodeSpans;
+    stcodeSpans.resize(nativeStcode.size());
+    for (int i = 0; i < nativeStcode.size(); i++)
+      stcodeSpans[i] = nativeStcode[i];
+    write_stcode_cpp(stcode_cpp_filename, cache_filename, stcodeSpans, stcodeHash.val);
+  }
   return true;
 }
@@ -0,0 +1,154 @@
+#include "stcodeCpp.h"
+#include "shLog.h"
+#include <shaders/shOpcode.h>
+#include <shaders/shOpcodeFormat.h>
+#include <shaders/shStcodeHash.h>
+#include <util/dag_string.h>
+#include <EASTL/hash_map.h>
+#include <EASTL/vector.h>
+#include <string.h>
+#include <limits.h>
+#include <stdio.h>
+
+// returns count of data words after instruction or -1 for instruction which exec_stcode_op() doesn't know
+static int get_instruction_data_words(uint32_t opc)
+{
+  switch (shaderopcode::getOp(opc))
+  {
+    case SHCOD_IMM_REAL:
+    case SHCOD_MAKE_VEC: return 1;
+    case SHCOD_IMM_VEC: return 4;
+    case SHCOD_CALL_FUNCTION: return shaderopcode::getOp3p3(opc);
+
+    case SHCOD_GET_GVEC:
+    case SHCOD_GET_GMAT44:
+    case SHCOD_VPR_CONST:
+    case SHCOD_FSH_CONST:
+    case SHCOD_CS_CONST:
+    case SHCOD_IMM_REAL1:
+    case SHCOD_IMM_SVEC1:
+    case SHCOD_GET_GREAL:
+    case SHCOD_MUL_REAL:
+    case SHCOD_GET_VEC:
+    case SHCOD_GET_REAL:
+    case SHCOD_TEXTURE:
+    case SHCOD_TEXTURE_VS:
+    case SHCOD_BUFFER:
+    case SHCOD_CONST_BUFFER:
+    case SHCOD_RWTEX:
+    case SHCOD_RWBUF:
+    case SHCOD_LVIEW:
+    case SHCOD_GET_GTEX:
+    case SHCOD_GET_GBUF:
+    case SHCOD_G_TM:
+    case SHCOD_DIV_REAL:
+    case SHCOD_GET_TEX:
+    case SHCOD_TMWORLD:
+    case SHCOD_COPY_REAL:
+    case SHCOD_COPY_VEC:
+    case SHCOD_SUB_REAL:
+    case SHCOD_ADD_REAL:
+    case SHCOD_SUB_VEC:
+    case SHCOD_MUL_VEC:
+    case SHCOD_GET_INT_TOREAL:
+    case SHCOD_GET_INT:
+    case SHCOD_INVERSE:
+    case SHCOD_ADD_VEC:
+    case SHCOD_DIV_VEC:
+    case SHCOD_GET_GINT:
+    case SHCOD_GET_GINT_TOREAL: return 0;
+  }
+  return -1;
+}
+
+static bool write_routine(String &out, int id, dag::ConstSpan<int> cod)
+{
+  String calls;
+  for (int i = 0; i < cod.size(); i++)
+  {
+    const int dataWords = get_instruction_data_words(cod[i]);
+    if (dataWords < 0 || i + dataWords >= cod.size())
+      return false;
+    calls.aprintf(0, "  exec_stcode_op(st, cod, %d);\n", i);
+    i += dataWords;
+  }
+
+  out.aprintf(0, "void stcode_%d(StcodeExecState &st)\n{\n  static constexpr int cod[] = {", id);
+  for (int i = 0; i < cod.size(); i++)
+  {
+    out.aprintf(0, "%s", i == 0 ? "\n    " : (i % 8 ? ", " : ",\n    "));
+    if (cod[i] == INT_MIN) // -2147483648 literal is not int
+      out.aprintf(0, "-2147483647 - 1");
+    else
+      out.aprintf(0, "%d", cod[i]);
+  }
+  out.aprintf(0, "};\n%s}\n\n", calls.str());
+  return true;
+}
+
+bool write_stcode_cpp(const char *fn, const char *dump_name, dag::ConstSpan<dag::ConstSpan<int>> stcode, uint64_t stcode_hash)
+{
+  if (stcode.empty())
+  {
+    sh_debug(SHLOG_WARNING, "No stcode in '%s', native stcode is not written", dump_name);
+    return false;
+  }
+
+  String out(0,
+    "// Native stcode routines generated by shader compiler for '%s', do not edit.\n"
+    "// Compile into game with $(Root)/prog/engine/shaders in AddIncludes.\n"
+    "#include <stcodeExec.h>\n\n"
+    "namespace\n{\n",
+    dump_name);
+
+  // identical stcode of different shaders shares routine
+  eastl::vector<int> routineIds(stcode.size(), -1);
+  eastl::hash_map<uint64_t, int> uniqueStcode;
+  int uniqueCount = 0;
+  for (int i = 0; i < stcode.size(); i++)
+  {
+    if (stcode[i].empty())
+      continue;
+    StcodeHash hash;
+    hash.add(stcode[i]);
+    auto it = uniqueStcode.find(hash.val);
+    if (it != uniqueStcode.end() && stcode[it->second].size() == stcode[i].size() &&
+        memcmp(stcode[it->second].data(), stcode[i].data(), data_size(stcode[i])) == 0)
+    {
+      routineIds[i] = routineIds[it->second];
+      continue;
+    }
+    if (!write_routine(out, i, stcode[i]))
+    {
+      sh_debug(SHLOG_WARNING, "stcode %d has instructions not supported by native stcode, it will be interpreted", i);
+      continue;
+    }
+    routineIds[i] = i;
+    uniqueStcode.emplace(hash.val, i);
+    uniqueCount++;
+  }
+
+  out.aprintf(0, "const stcode_native_routine_t routines[] = {\n");
+  for (int i = 0; i < stcode.size(); i++)
+    if (routineIds[i] < 0)
+      out.aprintf(0, "  nullptr,\n");
+    else
+      out.aprintf(0, "  &stcode_%d,\n", routineIds[i]);
+  out.aprintf(0,
+    "};\n\n"
+    "StcodeNativeTable table = {0x%016llXull, routines, %d, nullptr};\n"
+    "struct RegisterTable\n{\n  RegisterTable() { register_native_stcode(table); }\n} register_table;\n"
+    "} // namespace\n",
+    (unsigned long long)stcode_hash, (int)stcode.size());
+
+  FILE *fp = fopen(fn, "wt");
+  if (!fp)
+  {
+    sh_debug(SHLOG_ERROR, "Can't write native stcode to '%s'", fn);
+    return false;
+  }
+  fwrite(out.data(), 1, out.length(), fp);
+  fclose(fp);
+  sh_debug(SHLOG_INFO, "  native stcode: %d routines for %d stcode written to '%s'", uniqueCount, (int)stcode.size(), fn);
+  return true;
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+#include <generic/dag_span.h>
+#include <stdint.h>
+
+// Writes C++ source with native routine for each unique stcode executed by ScriptedShaderElement::exec_stcode() (null entries
+// of stcode are skipped, i.e. block stcode). Routines are registered in engine with stcode_hash of dump and used instead of
+// interpreter when loaded dump has the same hash, see prog/engine/shaders/stcodeExec.h
+bool write_stcode_cpp(const char *fn, const char *dump_name, dag::ConstSpan<dag::ConstSpan<int>> stcode, uint64_t stcode_hash);
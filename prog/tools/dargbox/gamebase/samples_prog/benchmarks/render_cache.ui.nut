@@ -0,0 +1,78 @@
+from "%darg/ui_imports.nut" import *
+let math = require("math")
+let cursors = require("samples_prog/_cursors.nut")
+
+//render cost of many static panels that are only moved around, with and without 'renderCache'
+//compare 'darg_renderlist_render' timings in profiler (or toggle it with darg.render_cache console var)
+const panelsNum = 300
+const rowsInPanel = 8
+const perRow = 6
+const panelsInLine = 15
+
+let useCache = Watched(true)
+
+local timeFloat = 0
+gui_scene.setUpdateHandler(function(dt) {
+  timeFloat += dt
+})
+
+let function mkRow(panel_idx, row_idx) {
+  return {
+    flow = FLOW_HORIZONTAL
+    gap = hdpx(2)
+    children = array(perRow).map(@(_, i) {
+      rendObj = ROBJ_BOX
+      size = [hdpx(10), hdpx(10)]
+      fillColor = Color(40 * i, 20 * row_idx, (panel_idx * 7) % 255)
+      borderWidth = hdpx(1)
+      borderColor = Color(200, 200, 200)
+    }).append({
+      rendObj = ROBJ_TEXT
+      text = $"item {panel_idx}.{row_idx}"
+    })
+  }
+}
+
+let function mkPanel(idx) {
+  return @() {
+    watch = useCache
+    renderCache = useCache.value
+    pos = [(idx % panelsInLine) * hdpx(125), (idx / panelsInLine) * hdpx(100)]
+    rendObj = ROBJ_SOLID
+    color = Color(30, 30, 50)
+    padding = hdpx(4)
+    flow = FLOW_VERTICAL
+    children = array(rowsInPanel).map(@(_, r) mkRow(idx, r))
+  }
+}
+
+let function root() {
+  return {
+    size = flex()
+    cursor = cursors.normal
+    children = [
+      {
+        size = flex()
+        children = array(panelsNum).map(@(_, i) mkPanel(i))
+        //moved without rebuild, so panels keep their recorded commands
+        transform = {}
+        behavior = Behaviors.RtPropUpdate
+        update = @() {
+          transform = { translate = [math.sin(timeFloat) * hdpx(20), math.cos(timeFloat) * hdpx(20)] }
+        }
+      }
+      @() {
+        watch = useCache
+        rendObj = ROBJ_TEXT
+        hplace = ALIGN_RIGHT
+        vplace = ALIGN_BOTTOM
+        margin = hdpx(20)
+        text = useCache.value ? "renderCache: on (click to toggle)" : "renderCache: off (click to toggle)"
+        behavior = Behaviors.Button
+        onClick = @() useCache(!useCache.value)
+      }
+    ]
+  }
+}
+
+return root
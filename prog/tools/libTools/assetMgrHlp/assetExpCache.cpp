@@ -605,6 +605,12 @@ void AssetExportCache::sharedDataAddForceRebuildAsset(const char *asset_name_typ
   if (sharedData)
     sharedData->rebuildAssets.addNameId(asset_name_typified);
 }
+bool AssetExportCache::sharedDataIsForcedRebuild(int a_type, const char *asset_name_typified)
+{
+  if (!sharedData)
+    return false;
+  return sharedData->isAlwaysRebuildType(a_type) || sharedData->rebuildAssets.getNameId(asset_name_typified) >= 0;
+}
 void AssetExportCache::setJobSharedMem(void *p)
 {
   if (sharedData)
@@ -21,6 +21,7 @@
 #include <perfMon/dag_cpuFreq.h>
 #include <util/dag_string.h>
 #include "jobSharedMem.h"
+#include "contentCache.h"
 
 static bool reqFastConv = false;
 
@@ -124,11 +125,15 @@ public:
     texconvcache::init(m, appblk, startdir, dabuild_dry_run, reqFastConv);
     debug_ctx("texconvcache::init for reqFastConv=%d", reqFastConv);
 
+    // init content-addressed cache of exported gameres
+    dabuild_content_cache_init(*appBlk.getBlockByNameEx("assets")->getBlockByNameEx("export"), appDir);
+
     return exp_cnt;
   }
   virtual void __stdcall term()
   {
     texconvcache::term();
+    dabuild_content_cache_term();
     mgr = NULL;
     appBlk.reset();
     appDir = NULL;
@@ -18,6 +18,8 @@ static const char *dbg_name();
 #include <libTools/util/makeBindump.h>
 #include <osApiWrappers/dag_direct.h>
 #include <osApiWrappers/dag_symHlp.h>
+#include <osApiWrappers/dag_miscApi.h>
+#include <osApiWrappers/dag_atomic.h>
 #include <debug/dag_debug.h>
 #include <stdlib.h>
 #include <stdio.h>
@@ -102,7 +104,7 @@ public:
 };
 
 static DabuildJobSharedMem *jobMem = NULL;
-static void *jobMemHandle = NULL;
+static intptr_t jobMemHandle = -1;
 static int jobAssignedId = -1;
 static int jobIdBroken = -1;
 static void __cdecl release_job_mem()
@@ -117,9 +119,9 @@ static void __cdecl release_job_mem()
     jobMem->jobCtx[jobAssignedId].result = 0;
     jobMem->changeCtxState(jobMem->jobCtx[jobAssignedId], 4);
   }
-  UnmapViewOfFile(jobMem);
-  CloseHandle(jobMemHandle);
+  DabuildJobSharedMem::closeMapped(jobMem, jobMemHandle);
   jobMem = NULL;
+  jobMemHandle = -1;
   jobAssignedId = -1;
 }
 static void dgs_release_job_mem() { release_job_mem(); }
@@ -150,9 +152,15 @@ static int do_main(bool debugmode)
   dgs_pre_shutdown_handler = dgs_release_job_mem;
   setvbuf(stdout, NULL, _IOFBF, 4096);
   char start_dir[260];
+#if _TARGET_PC_WIN
   if (_fullpath(start_dir, __argv[0], 260))
+#else
+  if (realpath(__argv[0], start_dir))
+#endif
   {
     char *p = strrchr(start_dir, '\\');
+    if (!p)
+      p = strrchr(start_dir, '/');
     if (p)
       *p = '\0';
   }
@@ -162,24 +170,11 @@ static int do_main(bool debugmode)
     debug(dagor_get_build_stamp_str_ex(stamp_buf, sizeof(stamp_buf), "\n", "*", ""));
   }
 
-  String fn(128, "daBuild-shared-mem-%s", __argv[2]);
   int job_id = atoi(__argv[3]);
   jobAssignedId = job_id;
-  jobMemHandle = OpenFileMapping(FILE_MAP_ALL_ACCESS, FALSE, fn);
-
-  if (!jobMemHandle)
-  {
-    debug("failed to open shared memory, hr=%p", GetLastError());
-    return 1;
-  }
-
-  jobMem = (DabuildJobSharedMem *)MapViewOfFile(jobMemHandle, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(DabuildJobSharedMem));
+  jobMem = DabuildJobSharedMem::openMapped(__argv[2], jobMemHandle);
   if (!jobMem)
-  {
-    debug("failed to map view, hr=%p", GetLastError());
-    CloseHandle(jobMemHandle);
     return 1;
-  }
   atexit(release_job_mem);
   if (jobMem->fullMemSize != sizeof(DabuildJobSharedMem))
   {
@@ -249,7 +244,7 @@ static int do_main(bool debugmode)
   IDaBuildInterface *dabuild = get_dabuild_interface();
   if (!dabuild)
   {
-    printf("ERR: cannot load daBuild-dev.dll\n");
+    printf("ERR: cannot load daBuild" DAGOR_DLL "\n");
     return 13;
   }
 
@@ -324,7 +319,7 @@ static int do_main(bool debugmode)
   dabuild_prepare_out_blk(out_blk, mgr, build_blk);
   while (jobMem->pid != 0xFFFFFFFFU)
   {
-    int gen = jobMem->cmdGen;
+    int gen = interlocked_acquire_load(jobMem->cmdGen);
     if (get_time_msec() > last_flush_time + 2000)
     {
       debug_flush(false);
@@ -333,7 +328,7 @@ static int do_main(bool debugmode)
     }
     if (gen == cmdGen)
     {
-      Sleep(100);
+      sleep_msec(100);
       if (get_time_msec() > last_idle_reported_time + idle_report_interval)
       {
         idle_report_interval *= 10;
@@ -529,11 +524,13 @@ static int do_main(bool debugmode)
   if (dabuild)
     dabuild->release();
 
+#if _TARGET_PC_WIN
   if (show_important_warnings && log.impWarnCnt)
     MessageBox(NULL,
       String(2048, "daBuild job%d registered %d serious warnings%s:\n\n%s", job_id, log.impWarnCnt,
         log.impWarnCnt > 20 ? ";\nfirst 20 assets are" : "", log.impWarn.str()),
       "dBuild warnings", MB_OK | MB_ICONSTOP);
+#endif
   return 0;
 }
 
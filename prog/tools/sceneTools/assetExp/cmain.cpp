@@ -21,6 +21,7 @@
 #include <osApiWrappers/dag_direct.h>
 #include <osApiWrappers/dag_symHlp.h>
 #include <osApiWrappers/dag_files.h>
+#include <osApiWrappers/dag_miscApi.h>
 #include <debug/dag_debug.h>
 #include <stdlib.h>
 #include <stdio.h>
@@ -173,11 +174,7 @@ static void __cdecl release_job_mem()
   debug_cp();
   jobMem->pid = 0xFFFFFFFFU;
   AssetExportCache::setJobSharedMem(NULL);
-  HANDLE hMapFile = jobMem->mapHandle;
-  for (int i = 0; i < jobMem->jobCount; i++)
-    CloseHandle(jobMem->jobHandle[i]);
-  UnmapViewOfFile(jobMem);
-  CloseHandle(hMapFile);
+  DabuildJobSharedMem::destroyMapped(jobMem);
   jobMem = NULL;
 }
 static void dgs_release_job_mem() { release_job_mem(); }
@@ -196,9 +193,15 @@ int DagorWinMain(bool debugmode)
   dgs_pre_shutdown_handler = dgs_release_job_mem;
   setvbuf(stdout, NULL, _IOFBF, 4096);
   char start_dir[260];
+#if _TARGET_PC_WIN
   if (_fullpath(start_dir, __argv[0], 260))
+#else
+  if (realpath(__argv[0], start_dir))
+#endif
   {
     char *p = strrchr(start_dir, '\\');
+    if (!p)
+      p = strrchr(start_dir, '/');
     if (p)
       *p = '\0';
   }
@@ -1129,50 +1132,35 @@ int DagorWinMain(bool debugmode)
   {
     AtomicPrintfMutex::init("dabuild", __argv[0]);
 
-    // create file mapping
-    int pid = GetProcessId(GetCurrentProcess());
-    String fn(128, "daBuild-shared-mem-%d", pid);
-    HANDLE hMapFile = CreateFileMapping(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, sizeof(DabuildJobSharedMem), fn);
-    debug("%d jobs: %s -> %p (sz=%d)", jobs, fn.str(), hMapFile, sizeof(DabuildJobSharedMem));
-
-    if (hMapFile)
+    // create shared memory
+    int pid = get_process_uid();
+    debug("%d jobs", jobs);
+    jobMem = DabuildJobSharedMem::createMapped(pid);
+    if (jobMem)
     {
-      jobMem = (DabuildJobSharedMem *)MapViewOfFile(hMapFile, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(DabuildJobSharedMem));
-      if (jobMem)
+      jobMem->jobCount = jobs;
+      jobMem->dryRun = dabuild_dry_run;
+      jobMem->stripD3Dres = dabuild_strip_d3d_res;
+      jobMem->collapsePacks = dabuild_collapse_packs;
+      jobMem->logLevel = quiet ? log.ERROR : log.NOTE;
+      jobMem->nopbar = nopbar;
+      jobMem->quiet = dgs_execute_quiet;
+      jobMem->showImportantWarnings = show_important_warnings;
+      jobMem->expTex = export_tex;
+      jobMem->expRes = export_res;
+      jobMem->forceRebuildAssetIdxCount = force_rebuild_assets.size();
+      G_ASSERTF(jobMem->forceRebuildAssetIdxCount <= countof(DabuildJobSharedMem::forceRebuildAssetIdx),
+        "forceRebuildAssetIdxCount=%d max=%d", jobMem->forceRebuildAssetIdxCount,
+        countof(DabuildJobSharedMem::forceRebuildAssetIdx));
+      mem_copy_to(force_rebuild_assets.getList(), jobMem->forceRebuildAssetIdx);
+      if (int cnt = jobMem->forceRebuildAssetIdxCount)
       {
-        memset(jobMem, 0, sizeof(DabuildJobSharedMem));
-        jobMem->fullMemSize = sizeof(DabuildJobSharedMem);
-        jobMem->mapHandle = hMapFile;
-        jobMem->pid = pid;
-        jobMem->jobCount = jobs;
-        jobMem->dryRun = dabuild_dry_run;
-        jobMem->stripD3Dres = dabuild_strip_d3d_res;
-        jobMem->collapsePacks = dabuild_collapse_packs;
-        jobMem->logLevel = quiet ? log.ERROR : log.NOTE;
-        jobMem->nopbar = nopbar;
-        jobMem->quiet = dgs_execute_quiet;
-        jobMem->showImportantWarnings = show_important_warnings;
-        jobMem->expTex = export_tex;
-        jobMem->expRes = export_res;
-        jobMem->forceRebuildAssetIdxCount = force_rebuild_assets.size();
-        G_ASSERTF(jobMem->forceRebuildAssetIdxCount <= countof(DabuildJobSharedMem::forceRebuildAssetIdx),
-          "forceRebuildAssetIdxCount=%d max=%d", jobMem->forceRebuildAssetIdxCount,
-          countof(DabuildJobSharedMem::forceRebuildAssetIdx));
-        mem_copy_to(force_rebuild_assets.getList(), jobMem->forceRebuildAssetIdx);
-        if (int cnt = jobMem->forceRebuildAssetIdxCount)
-        {
-          log.addMessage(log.NOTE, "force rebuild of %d asset(s):", cnt);
-          for (int i = 0, cnt = jobMem->forceRebuildAssetIdxCount; i < cnt; i++)
-            log.addMessage(log.NOTE, "  [%d] %s", i, mgr.getAsset(jobMem->forceRebuildAssetIdx[i]).getNameTypified());
-        }
-        atexit(release_job_mem);
-        signal(SIGINT, ctrl_break_handler);
-      }
-      else
-      {
-        jobs = 0;
-        CloseHandle(hMapFile);
+        log.addMessage(log.NOTE, "force rebuild of %d asset(s):", cnt);
+        for (int i = 0, cnt = jobMem->forceRebuildAssetIdxCount; i < cnt; i++)
+          log.addMessage(log.NOTE, "  [%d] %s", i, mgr.getAsset(jobMem->forceRebuildAssetIdx[i]).getNameTypified());
       }
+      atexit(release_job_mem);
+      signal(SIGINT, ctrl_break_handler);
     }
     else
       jobs = 0;
@@ -1180,24 +1168,22 @@ int DagorWinMain(bool debugmode)
     if (jobMem)
       AssetExportCache::setJobSharedMem(jobMem);
 
+#if _TARGET_PC_WIN
+    const char *job_exe_ext = ".exe";
+#else
+    const char *job_exe_ext = "";
+#endif
+    String job_exe(260, "%s/%s%s", start_dir, strstr(__argv[0], "-asan-") ? "daBuild-job-asan-dev" : "daBuild-job-dev", job_exe_ext);
+    String pid_str(16, "%d", pid), job_idx_str;
     for (int i = 0; i < jobs; i++)
     {
-      PROCESS_INFORMATION pi;
-      STARTUPINFO si;
-
-      ::ZeroMemory(&si, sizeof(STARTUPINFO));
-      si.cb = sizeof(STARTUPINFO);
-      String cmd(260, "%s\\%s %s %d %d", start_dir, strstr(__argv[0], "-asan-") ? "daBuild-job-asan-dev.exe" : "daBuild-job-dev.exe",
-        arg[0], pid, i);
-      iterate_names(rebuild_types, [&cmd](int, const char *name) { cmd.aprintf(16, " %s", name); });
-
-      if (::CreateProcess(NULL, cmd, NULL, NULL, TRUE, 0, NULL, NULL, &si, &pi)) // DETACHED_PROCESS
-      {
-        CloseHandle(pi.hThread);
-        jobMem->jobHandle[i] = pi.hProcess;
-      }
-      else
-        debug("FAILED to launch process: %s", cmd.str());
+      job_idx_str.printf(16, "%d", i);
+      Tab<const char *> job_args;
+      job_args.push_back(arg[0]);
+      job_args.push_back(pid_str);
+      job_args.push_back(job_idx_str);
+      iterate_names(rebuild_types, [&job_args](int, const char *name) { job_args.push_back(name); });
+      jobMem->jobHandle[i] = DabuildJobSharedMem::startJobProcess(job_exe, job_args.data(), job_args.size());
     }
     if (quiet)
       log.level = log.NOTE;
@@ -1239,11 +1225,13 @@ int DagorWinMain(bool debugmode)
   dabuild->release();
   release_job_mem();
   ATOMIC_PRINTF("\n");
+#if _TARGET_PC_WIN
   if (show_important_warnings && log.impWarnCnt)
     MessageBox(NULL,
       String(2048, "daBuild registered %d serious warnings%s:\n\n%s", log.impWarnCnt,
         log.impWarnCnt > 20 ? ";\nfirst 20 assets are" : "", log.impWarn.str()),
       "dBuild warnings", MB_OK | MB_ICONSTOP);
+#endif
   return !success;
 }
 
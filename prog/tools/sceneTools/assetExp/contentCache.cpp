@@ -0,0 +1,222 @@
+#include "contentCache.h"
+#include "daBuild.h"
+#include <assets/asset.h>
+#include <assets/assetExporter.h>
+#include <libTools/util/makeBindump.h>
+#include <ioSys/dag_dataBlock.h>
+#include <ioSys/dag_memIo.h>
+#include <osApiWrappers/dag_files.h>
+#include <osApiWrappers/dag_direct.h>
+#include <osApiWrappers/dag_miscApi.h>
+#include <perfMon/dag_cpuFreq.h>
+#include <generic/dag_tab.h>
+#include <util/dag_simpleString.h>
+#include <util/dag_string.h>
+#include <debug/dag_debug.h>
+#include <stdlib.h>
+
+static constexpr unsigned CONTENT_CACHE_LABEL = MAKE4C('d', 'c', 'c', '1');
+static constexpr int CONTENT_CACHE_FORMAT_VER = 1; // bump to invalidate all cached data
+
+struct ContentCacheFileHeader
+{
+  unsigned label;
+  unsigned dataLen;
+  unsigned char key[AssetExportCache::HASH_SZ];
+  unsigned char dataHash[AssetExportCache::HASH_SZ];
+};
+
+static bool cc_enabled = false;
+static String cc_local_dir, cc_shared_dir, cc_salt;
+static bool cc_shared_write = false;
+static int cc_hits_local = 0, cc_hits_shared = 0, cc_misses = 0, cc_stored = 0;
+
+void dabuild_content_cache_init(const DataBlock &exp_blk, const char *app_dir)
+{
+  dabuild_content_cache_term();
+
+  const DataBlock *b = exp_blk.getBlockByName("contentCache");
+  const char *shared_env = getenv("DABUILD_SHARED_CACHE");
+  if (!b && !(shared_env && *shared_env))
+    return;
+  if (!b)
+    b = &DataBlock::emptyBlock;
+
+  cc_local_dir.printf(260, "%s/%s/", app_dir, b->getStr("local", String(260, "%s/content", exp_blk.getStr("cache", "/develop/.cache"))));
+  simplify_fname(cc_local_dir);
+  const char *shared = (shared_env && *shared_env) ? shared_env : b->getStr("shared", NULL);
+  if (shared && *shared)
+  {
+    cc_shared_dir.printf(260, "%s/", shared);
+    simplify_fname(cc_shared_dir);
+    if (!dd_dir_exist(cc_shared_dir))
+    {
+      logwarn("content cache: shared dir %s is not accessible, using local dir only", cc_shared_dir);
+      cc_shared_dir = NULL;
+    }
+  }
+  cc_shared_write = b->getBool("sharedWrite", true);
+  cc_salt = b->getStr("salt", "");
+  cc_enabled = true;
+  debug("content cache: local=%s shared=%s%s", cc_local_dir, cc_shared_dir.empty() ? "-" : cc_shared_dir.str(),
+    cc_shared_write ? "" : " (read-only)");
+}
+
+void dabuild_content_cache_term()
+{
+  if (cc_enabled)
+    debug("content cache: %d hits (%d local, %d shared), %d misses, %d stored", cc_hits_local + cc_hits_shared, cc_hits_local,
+      cc_hits_shared, cc_misses, cc_stored);
+  cc_enabled = false;
+  cc_local_dir = NULL;
+  cc_shared_dir = NULL;
+  cc_hits_local = cc_hits_shared = cc_misses = cc_stored = 0;
+}
+
+bool dabuild_content_cache_make_key(DabuildContentKey &out_key, DagorAsset &a, IDagorAssetExporter &exp,
+  mkbindump::BinDumpSaveCB &cwr)
+{
+  out_key.valid = false;
+  if (!cc_enabled || dabuild_dry_run || AssetExportCache::sharedDataIsForcedRebuild(a.getType(), a.getNameTypified()))
+    return false;
+
+  unsigned char *h = out_key.hash;
+  memset(h, 0, AssetExportCache::HASH_SZ);
+  unsigned settings[] = {CONTENT_CACHE_FORMAT_VER, cwr.getTarget(), cwr.WRITE_BE ? 1u : 0u, exp.getGameResClassId(),
+    unsigned(exp.getGameResVersion()), dabuild_strip_d3d_res ? 1u : 0u};
+  AssetExportCache::sharedDataAppendHash(settings, sizeof(settings), h);
+  AssetExportCache::sharedDataAppendHash(cc_salt.str(), cc_salt.length() + 1, h);
+  const char *profile = cwr.getProfile() ? cwr.getProfile() : "";
+  AssetExportCache::sharedDataAppendHash(profile, strlen(profile) + 1, h);
+  AssetExportCache::sharedDataAppendHash(a.getNameTypified(), strlen(a.getNameTypified()) + 1, h);
+
+  DynamicMemGeneralSaveCB props_cwr(tmpmem, 4 << 10, 4 << 10);
+  a.props.saveToTextStream(props_cwr);
+  AssetExportCache::sharedDataAppendHash(props_cwr.data(), props_cwr.size(), h);
+
+  Tab<SimpleString> a_files(tmpmem);
+  exp.gatherSrcDataFiles(a, a_files);
+  if (a.isVirtual())
+    a_files.push_back() = a.getTargetFilePath();
+  for (const SimpleString &fn : a_files)
+  {
+    unsigned char file_hash[AssetExportCache::HASH_SZ];
+    if (!AssetExportCache::sharedDataGetFileHash(fn, file_hash))
+      return false;
+    // relative path keeps keys equal for different checkout locations
+    const char *rel_fn = AssetExportCache::mkRelPath(fn);
+    AssetExportCache::sharedDataAppendHash(rel_fn, strlen(rel_fn) + 1, h);
+    AssetExportCache::sharedDataAppendHash(file_hash, sizeof(file_hash), h);
+  }
+  out_key.valid = true;
+  return true;
+}
+
+static void make_content_fname(String &fn, const char *dir, const DabuildContentKey &key)
+{
+  fn.printf(260, "%s%02x/", dir, key.hash[0]);
+  for (unsigned char c : key.hash)
+    fn.aprintf(4, "%02x", c);
+  fn += ".bin";
+}
+
+static bool read_content_file(const char *fn, const DabuildContentKey &key, Tab<char> &out_data)
+{
+  file_ptr_t fp = df_open(fn, DF_READ | DF_IGNORE_MISSING);
+  if (!fp)
+    return false;
+  ContentCacheFileHeader hdr;
+  bool ok = df_read(fp, &hdr, sizeof(hdr)) == sizeof(hdr) && hdr.label == CONTENT_CACHE_LABEL &&
+            memcmp(hdr.key, key.hash, sizeof(hdr.key)) == 0 && df_length(fp) == sizeof(hdr) + hdr.dataLen;
+  if (ok)
+  {
+    out_data.resize(hdr.dataLen);
+    ok = df_read(fp, out_data.data(), hdr.dataLen) == hdr.dataLen;
+  }
+  df_close(fp);
+  if (ok)
+  {
+    unsigned char data_hash[AssetExportCache::HASH_SZ];
+    AssetExportCache::getDataHash(out_data.data(), out_data.size(), data_hash);
+    ok = memcmp(data_hash, hdr.dataHash, sizeof(data_hash)) == 0;
+  }
+  if (!ok)
+    logwarn("content cache: broken entry %s", fn);
+  return ok;
+}
+
+// writes to temporary file and renames it, so concurrent readers (other jobs or machines) never see partial data
+static bool write_content_file(const char *fn, const DabuildContentKey &key, const void *data, int len)
+{
+  if (dd_file_exist(fn))
+    return true;
+  String tmp_fn(0, "%s.%d.%u.tmp", fn, get_process_uid(), get_time_msec());
+  dd_mkpath(tmp_fn);
+  file_ptr_t fp = df_open(tmp_fn, DF_WRITE | DF_CREATE);
+  if (!fp)
+    return false;
+  ContentCacheFileHeader hdr;
+  hdr.label = CONTENT_CACHE_LABEL;
+  hdr.dataLen = len;
+  memcpy(hdr.key, key.hash, sizeof(hdr.key));
+  AssetExportCache::getDataHash(data, len, hdr.dataHash);
+  bool ok = df_write(fp, &hdr, sizeof(hdr)) == sizeof(hdr) && df_write(fp, data, len) == len;
+  df_close(fp);
+  if (ok && !dd_rename(tmp_fn, fn))
+    ok = dd_file_exist(fn); // entry may be just written by someone else
+  if (dd_file_exist(tmp_fn))
+    dd_erase(tmp_fn);
+  return ok;
+}
+
+bool dabuild_content_cache_fetch(const DabuildContentKey &key, IGenSave &dest)
+{
+  if (!key.valid)
+    return false;
+
+  String fn;
+  Tab<char> data(tmpmem);
+  make_content_fname(fn, cc_local_dir, key);
+  if (read_content_file(fn, key, data))
+    cc_hits_local++;
+  else if (!cc_shared_dir.empty())
+  {
+    String shared_fn;
+    make_content_fname(shared_fn, cc_shared_dir, key);
+    if (!read_content_file(shared_fn, key, data))
+    {
+      cc_misses++;
+      return false;
+    }
+    cc_hits_shared++;
+    write_content_file(fn, key, data.data(), data.size());
+  }
+  else
+  {
+    cc_misses++;
+    return false;
+  }
+  dest.write(data.data(), data.size());
+  return true;
+}
+
+void dabuild_content_cache_store(const DabuildContentKey &key, mkbindump::BinDumpSaveCB &data)
+{
+  if (!key.valid)
+    return;
+
+  int len = data.getSize();
+  void *p = data.makeDataCopy(tmpmem);
+  String fn;
+  make_content_fname(fn, cc_local_dir, key);
+  bool stored = write_content_file(fn, key, p, len);
+  if (!cc_shared_dir.empty() && cc_shared_write)
+  {
+    make_content_fname(fn, cc_shared_dir, key);
+    if (!write_content_file(fn, key, p, len))
+      logwarn("content cache: failed to write %s", fn);
+  }
+  memfree(p, tmpmem);
+  if (stored)
+    cc_stored++;
+}
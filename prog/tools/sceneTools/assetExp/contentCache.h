@@ -0,0 +1,35 @@
+#pragma once
+
+#include <assets/assetExpCache.h>
+
+class DataBlock;
+class DagorAsset;
+class IDagorAssetExporter;
+class IGenSave;
+namespace mkbindump
+{
+class BinDumpSaveCB;
+}
+
+// content-addressed cache of exported gameres data, keyed by hash of asset sources and export settings;
+// configured with assets{export{contentCache{local:t=; shared:t=; sharedWrite:b=yes; salt:t=}}} in application.blk
+// (DABUILD_SHARED_CACHE env var overrides shared dir); lookups go to local dir first, then to shared one
+struct DabuildContentKey
+{
+  unsigned char hash[AssetExportCache::HASH_SZ];
+  bool valid = false;
+};
+
+void dabuild_content_cache_init(const DataBlock &exp_blk, const char *app_dir);
+void dabuild_content_cache_term();
+
+// builds key for asset exported to cwr's target/profile; returns false (and invalid key) when cache is off or asset is forced
+// to be rebuilt or some of its source files are missing
+bool dabuild_content_cache_make_key(DabuildContentKey &out_key, DagorAsset &a, IDagorAssetExporter &exp,
+  mkbindump::BinDumpSaveCB &cwr);
+
+// writes cached data to dest and returns true when found (and verified)
+bool dabuild_content_cache_fetch(const DabuildContentKey &key, IGenSave &dest);
+
+// stores exported data (no-op for invalid key)
+void dabuild_content_cache_store(const DabuildContentKey &key, mkbindump::BinDumpSaveCB &data);
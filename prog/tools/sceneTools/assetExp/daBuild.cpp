@@ -26,8 +26,6 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <sys/stat.h>
-#include <windows.h>
-#undef ERROR
 
 static String stripPrefix;
 #define RELEASE_ASSETS_PACKS()   \
@@ -1561,7 +1559,7 @@ void dabuild_finish_out_blk(DataBlock &dest, DagorAssetMgr &mgr, const DataBlock
             logerr("failed to create mutex %s", dd_get_fname(fn));
             continue;
           }
-          if (WaitForSingleObject(m, 2 * 60 * 1000) != WAIT_OBJECT_0)
+          if (global_mutex_enter_timeout(m, 2 * 60 * 1000) != 0)
           {
             global_mutex_destroy(m, dd_get_fname(fn));
             logerr("failed to wait on mutex %s for 2 min!", dd_get_fname(fn));
@@ -92,6 +92,14 @@ public:
       debug("%s: will optimize tracks, PRSeps=%.5fm, %.5fdeg, %.5f,  resampleR=%d fps", a.getName(), pos_eps, rot_eps, scl_eps,
         rot_resample_freq);
     }
+    PackKeysProps pack;
+    if (props.getBool("packKeys", a.props.getBool("packKeys", false)))
+    {
+      pack.enabled = true;
+      pack.posEps = props.getReal("packPosEps", a.props.getReal("packPosEps", pack.posEps));
+      pack.rotEps = props.getReal("packRotEps", a.props.getReal("packRotEps", pack.rotEps));
+      pack.sclEps = props.getReal("packSclEps", a.props.getReal("packSclEps", pack.sclEps));
+    }
 
     FastNameMap reqNodeMask, charDepNodes;
     bool strip_char_dep = false;
@@ -125,7 +133,7 @@ public:
 
     mkbindump::BinDumpSaveCB cwrDump(128 << 10, cwr.getTarget(), cwr.WRITE_BE);
     bool failed = false;
-    if (!convert(crd, cwrDump, pos_eps, rot_eps, scl_eps, rot_resample_freq, props.getBool("makeAdditive", false),
+    if (!convert(crd, cwrDump, pos_eps, rot_eps, scl_eps, rot_resample_freq, pack, props.getBool("makeAdditive", false),
           props.getStr("additiveRefPose", NULL), reqNodeMask, origSkeletonScene.root,
           autoCompleted ? autoCompletedSkeletonScene.root : nullptr, strip_char_dep, charDepNodes, a, log))
     {
@@ -171,6 +179,11 @@ public:
 
 protected:
   static const int RATE_DIV = 80;
+  struct PackKeysProps
+  {
+    bool enabled = false;
+    float posEps = 0.0005f, rotEps = 0.05f, sclEps = 0.0005f; // meters, degrees, scale units
+  };
   struct AnimDataHeader
   {
     unsigned label;    // MAKE4C('A','N','I','M')
@@ -239,8 +252,9 @@ protected:
 
 
   static bool convert(IGenLoad &crd, mkbindump::BinDumpSaveCB &cwr, float pos_eps, float rot_eps, float scl_eps, int rot_resample_freq,
-    bool make_additive, const char *additive_key_suffix, FastNameMap &req_node_mask, Node *original_skeleton,
-    Node *auto_completed_skeleton, bool strip_for_char_dep, FastNameMap &char_dep_nodes, const DagorAsset &a, ILogWriter &log)
+    const PackKeysProps &pack, bool make_additive, const char *additive_key_suffix, FastNameMap &req_node_mask,
+    Node *original_skeleton, Node *auto_completed_skeleton, bool strip_for_char_dep, FastNameMap &char_dep_nodes, const DagorAsset &a,
+    ILogWriter &log)
   {
     AnimDataHeader hdr;
 
@@ -416,6 +430,7 @@ protected:
         {
           int keyNum = crd.readInt();
           ch.nodeAnim[i].keyOfs = ch.nodeAnim[i].keyTimeOfs = -1;
+          ch.nodeAnim[i].keyFmt = AnimV20::KEYFMT_HERMITE;
           ch.nodeAnim[i].keyNum = keyNum;
           ch.nodeAnim[i].key = keyPool;
           ch.nodeAnim[i].keyTime = timePool;
@@ -674,6 +689,53 @@ protected:
       new_names.reset();
     }
 
+    //
+    // pack PRS tracks to quantized keys
+    //
+    int packed_tracks = 0;
+    if (pack.enabled && auto_completed_skeleton)
+      log.addMessage(ILogWriter::WARNING, "%s: packKeys is not supported with autoComplete, keys are left unpacked",
+        a.getNameTypified());
+    else if (pack.enabled)
+    {
+      int src_keys = 0, dst_keys = 0, src_sz = 0, dst_sz = 0;
+      float max_err[3] = {0, 0, 0}; // pos, rot, scl
+      for (ChannelData &ch : chan)
+      {
+        int err_idx = -1;
+        float eps = 0;
+        switch (ch.channelType)
+        {
+          case AnimV20::CHTYPE_POSITION: err_idx = 0, eps = pack.posEps; break;
+          case AnimV20::CHTYPE_ROTATION: err_idx = 1, eps = pack.rotEps; break;
+          case AnimV20::CHTYPE_SCALE: err_idx = 2, eps = pack.sclEps; break;
+          default: continue; // origin velocities are kept as Hermite keys
+        }
+        const int src_key_sz = ch.dataType == AnimV20::DATATYPE_QUAT ? sizeof(AnimV20::AnimKeyQuat) : sizeof(AnimV20::AnimKeyPoint3);
+        for (int i = 0; i < ch.nodeNum; i++)
+        {
+          ChannelData::Anim &anim = ch.nodeAnim[i];
+          if (!anim.keyNum)
+            continue;
+          void *src_key = anim.key;
+          int *src_time = anim.keyTime;
+          src_keys += anim.keyNum;
+          src_sz += anim.keyNum * src_key_sz;
+          inplace_max(max_err[err_idx], pack_track(ch.dataType, anim, eps, RATE_DIV));
+          dst_keys += anim.keyNum;
+          dst_sz += packed_track_data_size(ch.dataType, anim.keyNum);
+          packed_tracks++;
+
+          if (src_key < timeKeyPool.data() || src_key >= timeKeyPool.data() + timeKeyPool.size())
+            memfree(src_key, tmpmem);
+          if ((void *)src_time < timeKeyPool.data() || (void *)src_time >= timeKeyPool.data() + timeKeyPool.size())
+            memfree(src_time, tmpmem);
+        }
+      }
+      debug("%s: packed %d tracks, keys %d -> %d (%dK -> %dK), max error: pos=%.5fm rot=%.4fdeg scl=%.5f", a.getName(),
+        packed_tracks, src_keys, dst_keys, src_sz >> 10, dst_sz >> 10, max_err[0], max_err[1], max_err[2]);
+    }
+
     //
     // write ANIM v210 dump
     //
@@ -684,7 +746,7 @@ protected:
 
     start_ofs = cwr.tell();
     cwr.writeFourCC(hdr.label);
-    cwr.writeInt32e(make_additive ? 0x221 : 0x220);
+    cwr.writeInt32e((make_additive ? 0x221 : 0x220) | (packed_tracks ? 2 : 0));
     cwr.writeInt32e(16);
     cwr.writeInt32e(0);
 
@@ -721,7 +783,7 @@ protected:
       for (int i = 0; i < ch.nodeNum; i++)
       {
         int last = ch.nodeAnim[i].keyNum - 1;
-        if (last < 0)
+        if (last < 0 || ch.nodeAnim[i].keyFmt != AnimV20::KEYFMT_HERMITE)
           continue;
         switch (ch.dataType)
         {
@@ -857,6 +919,17 @@ protected:
             default: fatal("unsupported dataType=%d", ch.dataType);
           }
         }
+        else if (ch.nodeAnim[i].keyFmt == AnimV20::KEYFMT_PACKED16)
+        {
+          const char *data = (const char *)ch.nodeAnim[i].key;
+          if (ch.dataType == AnimV20::DATATYPE_POINT3X)
+          {
+            cwr.write32ex(data, sizeof(AnimV20::AnimPackedKeyRange));
+            data += sizeof(AnimV20::AnimPackedKeyRange);
+          }
+          cwr.write16ex(data, keyNum * sizeof(AnimV20::AnimPackedKey));
+          cwr.align16();
+        }
         else
         {
           switch (ch.dataType)
@@ -924,7 +997,7 @@ protected:
         cwr.writePtr64e(ch.nodeAnim[i].keyOfs);
         cwr.writePtr64e(ch.nodeAnim[i].keyTimeOfs);
         cwr.writeInt32e(ch.nodeAnim[i].keyNum);
-        cwr.writeInt32e(0);
+        cwr.writeInt32e(ch.nodeAnim[i].keyFmt);
       }
       ch.nodeWtOfs = cwr.tell();
       cwr.write32ex(ch.nodeWt, ch.nodeNum * sizeof(float));
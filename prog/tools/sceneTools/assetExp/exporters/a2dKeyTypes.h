@@ -31,6 +31,7 @@ struct ChannelData
     int *keyTime;
     int keyNum;
     int keyOfs, keyTimeOfs;
+    int keyFmt; // AnimV20::KEYFMT_*
   };
   Anim *nodeAnim = nullptr;
   int nodeNum = 0;
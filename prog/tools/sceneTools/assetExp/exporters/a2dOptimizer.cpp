@@ -805,3 +805,128 @@ vec4f interp_quat(ChannelData::Anim &a, int t)
     }
   return v_ld(&key[keyNum - 1].p.x);
 }
+
+int packed_track_data_size(unsigned data_type, int key_num)
+{
+  int hdr_sz = (data_type == AnimV20::DATATYPE_POINT3X) ? sizeof(AnimV20::AnimPackedKeyRange) : 0;
+  return hdr_sz + key_num * sizeof(AnimV20::AnimPackedKey);
+}
+
+static float packed_key_err(unsigned data_type, vec4f v, vec4f ref)
+{
+  if (data_type == AnimV20::DATATYPE_POINT3X)
+    return v_extract_x(v_length3_x(v_sub(v, ref)));
+  // rotation angle via chord length: acos(dot) is too imprecise near 1 for sub-0.1 degree tolerances
+  vec4f d = v_extract_x(v_dot4_x(v, ref)) < 0 ? v_add(v, ref) : v_sub(v, ref);
+  return 4 * asinf(min(v_extract_x(v_length4_x(d)) * 0.5f, 1.f)) * RAD_TO_DEG;
+}
+
+// must match AnimV20Math::interp_chan_key() for packed keys
+static vec4f interp_packed(unsigned data_type, vec4f a, vec4f b, float t)
+{
+  return data_type == AnimV20::DATATYPE_POINT3X ? v_lerp_vec4f(v_splats(t), a, b) : v_quat_qslerp(t, a, b);
+}
+
+float pack_track(unsigned data_type, ChannelData::Anim &a, float eps, int time_step)
+{
+  static constexpr int MAX_KEY_SPAN = 255;
+  G_ASSERT(a.keyNum > 0 && a.keyFmt == AnimV20::KEYFMT_HERMITE);
+  const bool is_p3 = data_type == AnimV20::DATATYPE_POINT3X;
+
+  // sample source track at output frames, with the same rounded key times and interpolation as used in runtime
+  Tab<int> keyFrame(tmpmem);
+  keyFrame.resize(a.keyNum);
+  for (int i = 0; i < a.keyNum; i++)
+    keyFrame[i] = (a.keyTime[i] + time_step / 2) / time_step;
+  const int frame0 = keyFrame[0], frameNum = keyFrame.back() - frame0 + 1;
+  Tab<vec4f> smp(tmpmem);
+  smp.resize(frameNum);
+  for (int f = 0, j = 0; f < frameNum; f++)
+  {
+    while (j + 1 < a.keyNum && keyFrame[j + 1] <= f + frame0)
+      j++;
+    float t = (j + 1 < a.keyNum) ? float(f + frame0 - keyFrame[j]) / float(keyFrame[j + 1] - keyFrame[j]) : 0.f;
+    if (is_p3)
+    {
+      const OldAnimKeyPoint3 &k = ((const OldAnimKeyPoint3 *)a.key)[j];
+      AnimV20::AnimKeyPoint3 rk;
+      rk.p = v_make_vec4f(k.p.x, k.p.y, k.p.z, 0);
+      rk.k1 = v_make_vec4f(k.k1.x, k.k1.y, k.k1.z, 0);
+      rk.k2 = v_make_vec4f(k.k2.x, k.k2.y, k.k2.z, 0);
+      rk.k3 = v_make_vec4f(k.k3.x, k.k3.y, k.k3.z, 0);
+      smp[f] = AnimV20Math::interp_key(rk, v_splats(t));
+    }
+    else
+    {
+      const OldAnimKeyQuat *k = (const OldAnimKeyQuat *)a.key + j;
+      smp[f] = v_norm4(t != 0.f ? v_quat_qsquad(t, v_ldu(&k[0].p.x), v_ldu(&k[0].b0.x), v_ldu(&k[0].b1.x), v_ldu(&k[1].p.x))
+                                : v_ldu(&k[0].p.x));
+    }
+  }
+
+  // quantize all samples
+  AnimV20::AnimPackedKeyRange range;
+  if (is_p3)
+  {
+    vec3f bmin = smp[0], bmax = smp[0];
+    for (const vec4f &v : smp)
+      bmin = v_min(bmin, v), bmax = v_max(bmax, v);
+    range.ofs = v_perm_xyzd(bmin, v_zero());
+    range.scale = v_perm_xyzd(v_div(v_sub(bmax, bmin), v_splats(65535.f)), v_zero());
+  }
+  Tab<AnimV20::AnimPackedKey> qkey(tmpmem);
+  Tab<vec4f> dec(tmpmem);
+  qkey.resize(frameNum);
+  dec.resize(frameNum);
+  for (int f = 0; f < frameNum; f++)
+  {
+    qkey[f] = is_p3 ? AnimV20Math::encode_packed_key(range, smp[f]) : AnimV20Math::encode_packed_key(smp[f]);
+    dec[f] = is_p3 ? AnimV20Math::decode_packed_key(range, qkey[f]) : AnimV20Math::decode_packed_key(qkey[f]);
+  }
+
+  // greedy key reduction: extend segment while all frames inside are within eps
+  Tab<int> keep(tmpmem);
+  keep.push_back(0);
+  for (int s = 0; s < frameNum - 1;)
+  {
+    int e = s + 1;
+    for (int c = e + 1; c < frameNum && c - s <= MAX_KEY_SPAN; c++)
+    {
+      bool fits = true;
+      for (int f = s + 1; f < c && fits; f++)
+        fits = packed_key_err(data_type, interp_packed(data_type, dec[s], dec[c], float(f - s) / float(c - s)), smp[f]) <= eps;
+      if (!fits)
+        break;
+      e = c;
+    }
+    keep.push_back(e);
+    s = e;
+  }
+
+  float max_err = 0;
+  for (int i = 0; i < keep.size(); i++)
+  {
+    int s = keep[i], e = i + 1 < keep.size() ? keep[i + 1] : s + 1;
+    for (int f = s; f < e; f++)
+      inplace_max(max_err,
+        packed_key_err(data_type, f == s ? dec[s] : interp_packed(data_type, dec[s], dec[e], float(f - s) / float(e - s)), smp[f]));
+  }
+
+  char *data = (char *)memalloc(packed_track_data_size(data_type, keep.size()), tmpmem);
+  AnimV20::AnimPackedKey *dst = (AnimV20::AnimPackedKey *)data;
+  if (is_p3)
+  {
+    memcpy(data, &range, sizeof(range));
+    dst = (AnimV20::AnimPackedKey *)(data + sizeof(range));
+  }
+  a.key = data;
+  a.keyTime = (int *)memalloc(keep.size() * sizeof(int), tmpmem);
+  a.keyNum = keep.size();
+  a.keyFmt = AnimV20::KEYFMT_PACKED16;
+  for (int i = 0; i < keep.size(); i++)
+  {
+    dst[i] = qkey[keep[i]];
+    a.keyTime[i] = (keep[i] + frame0) * time_step;
+  }
+  return max_err;
+}
@@ -3,3 +3,9 @@
 #include "a2dKeyTypes.h"
 
 void optimize_keys(dag::Span<ChannelData> chan, float pos_eps, float rot_eps, float scale_eps, int rot_resample_freq);
+
+// packs Hermite track to AnimV20::KEYFMT_PACKED16: resamples it at output frames (time_step ticks per frame), quantizes samples
+// and drops keys while interpolation of packed keys stays within eps (units for point3, degrees for quat);
+// replaces a.key/a.keyTime/a.keyNum with newly allocated (tmpmem) data (old data is not freed); returns max error at frames
+float pack_track(unsigned data_type, ChannelData::Anim &a, float eps, int time_step);
+int packed_track_data_size(unsigned data_type, int key_num);
@@ -1,9 +1,20 @@
 #include "jobSharedMem.h"
-#include <windows.h>
-#include <intrin.h>
+#include <osApiWrappers/dag_sharedMem.h>
+#include <osApiWrappers/dag_atomic.h>
+#include <osApiWrappers/dag_miscApi.h>
 #include <perfMon/dag_cpuFreq.h>
+#include <generic/dag_tab.h>
+#include <util/dag_string.h>
 #include <debug/dag_debug.h>
 #include <stdio.h>
+#if _TARGET_PC_WIN
+#include <windows.h>
+#else
+#include <spawn.h>
+#include <signal.h>
+#include <sys/wait.h>
+extern char **environ;
+#endif
 
 #include <libTools/util/atomicPrintf.h>
 AtomicPrintfMutex AtomicPrintfMutex::inst;
@@ -21,9 +32,104 @@ void DabuildJobSharedMem::changeCtxState(JobCtx &ctx, int state)
 {
   if (ctx.state >= 4)
     return;
-  _ReadWriteBarrier();
-  ctx.state = state;
-  InterlockedIncrement(&respGen);
+  interlocked_release_store(ctx.state, state);
+  interlocked_increment(respGen);
+}
+
+static String make_shared_mem_name(const char *master_pid_str) { return String(128, "daBuild-shared-mem-%s", master_pid_str); }
+
+DabuildJobSharedMem *DabuildJobSharedMem::createMapped(int master_pid)
+{
+  String fn = make_shared_mem_name(String(16, "%d", master_pid));
+  intptr_t h = -1;
+  DabuildJobSharedMem *m = (DabuildJobSharedMem *)create_global_map_shared_mem(fn, NULL, sizeof(DabuildJobSharedMem), h);
+  debug("shared mem %s -> %p (sz=%d)", fn.str(), m, sizeof(DabuildJobSharedMem));
+  if (!m)
+  {
+    close_global_map_shared_mem(h, NULL, 0);
+    unlink_global_shared_mem(fn);
+    return NULL;
+  }
+  memset(m, 0, sizeof(DabuildJobSharedMem));
+  m->fullMemSize = sizeof(DabuildJobSharedMem);
+  m->mapHandle = h;
+  m->pid = master_pid;
+  return m;
+}
+
+DabuildJobSharedMem *DabuildJobSharedMem::openMapped(const char *master_pid_str, intptr_t &out_handle)
+{
+  String fn = make_shared_mem_name(master_pid_str);
+  out_handle = -1;
+  DabuildJobSharedMem *m = (DabuildJobSharedMem *)open_global_map_shared_mem(fn, NULL, sizeof(DabuildJobSharedMem), out_handle);
+  if (!m)
+  {
+    debug("failed to open shared memory %s", fn.str());
+    close_global_map_shared_mem(out_handle, NULL, 0);
+    out_handle = -1;
+  }
+  return m;
+}
+
+void DabuildJobSharedMem::closeMapped(DabuildJobSharedMem *m, intptr_t handle)
+{
+  close_global_map_shared_mem(handle, m, sizeof(DabuildJobSharedMem));
+}
+
+void DabuildJobSharedMem::destroyMapped(DabuildJobSharedMem *m)
+{
+  String fn = make_shared_mem_name(String(16, "%d", get_process_uid()));
+  intptr_t h = m->mapHandle;
+  for (int i = 0; i < m->jobCount; i++)
+  {
+    if (!m->jobHandle[i])
+      continue;
+#if _TARGET_PC_WIN
+    CloseHandle((HANDLE)m->jobHandle[i]);
+#else
+    int status = 0;
+    waitpid((pid_t)m->jobHandle[i], &status, WNOHANG); // reap already finished jobs, others will see pid=~0 and quit
+#endif
+    m->jobHandle[i] = 0;
+  }
+  close_global_map_shared_mem(h, m, sizeof(DabuildJobSharedMem));
+  unlink_global_shared_mem(fn);
+}
+
+intptr_t DabuildJobSharedMem::startJobProcess(const char *exe_path, const char *const *args, int arg_count)
+{
+#if _TARGET_PC_WIN
+  PROCESS_INFORMATION pi;
+  STARTUPINFO si;
+
+  ::ZeroMemory(&si, sizeof(STARTUPINFO));
+  si.cb = sizeof(STARTUPINFO);
+  String cmd(260, "%s", exe_path);
+  for (int i = 0; i < arg_count; i++)
+    cmd.aprintf(64, " %s", args[i]);
+
+  if (!::CreateProcess(NULL, cmd, NULL, NULL, TRUE, 0, NULL, NULL, &si, &pi)) // DETACHED_PROCESS
+  {
+    debug("FAILED to launch process: %s", cmd.str());
+    return 0;
+  }
+  CloseHandle(pi.hThread);
+  return (intptr_t)pi.hProcess;
+#else
+  Tab<char *> argv;
+  argv.push_back((char *)exe_path);
+  for (int i = 0; i < arg_count; i++)
+    argv.push_back((char *)args[i]);
+  argv.push_back(nullptr);
+
+  pid_t pid = 0;
+  if (int res = posix_spawn(&pid, exe_path, nullptr, nullptr, argv.data(), environ))
+  {
+    debug("FAILED to launch process: %s (err=%d)", exe_path, res);
+    return 0;
+  }
+  return (intptr_t)pid;
+#endif
 }
 
 DabuildJobPool::Ctx *DabuildJobPool::getAvailableJobId(int timeout_msec)
@@ -39,9 +145,8 @@ DabuildJobPool::Ctx *DabuildJobPool::getAvailableJobId(int timeout_msec)
         case 4:
           ATOMIC_PRINTF("ERR: job j%02d become inoperable\n", cJobIdx);
           logerr("job j%02d become inoperable", cJobIdx);
-          _ReadWriteBarrier();
-          m->jobCtx[cJobIdx].state = 5;
-          InterlockedIncrement(&m->respGen);
+          interlocked_release_store(m->jobCtx[cJobIdx].state, 5);
+          interlocked_increment(m->respGen);
           inoperable_jobs++;
           break;
         case 5: inoperable_jobs++; break;
@@ -56,9 +161,9 @@ DabuildJobPool::Ctx *DabuildJobPool::getAvailableJobId(int timeout_msec)
     if (!timeout_msec || inoperable_jobs == jobs)
       return NULL;
 
-    int gen = m->respGen;
+    int gen = interlocked_acquire_load(m->respGen);
     if (gen == respGen)
-      Sleep(100);
+      sleep_msec(100);
     respGen = gen;
 
     if (get_time_msec() > te)
@@ -73,9 +178,9 @@ bool DabuildJobPool::waitAllJobsDone(int timeout_msec, Ctx **out_done)
   static int jobs_in_flight = -1;
   for (;;) // infinite cycle with explicit break
   {
-    int working = 0, gen = m->respGen;
+    int working = 0, gen = interlocked_acquire_load(m->respGen);
     if (gen == respGen)
-      Sleep(100);
+      sleep_msec(100);
     respGen = gen;
 
     for (int i = 0; i < jobs; i++)
@@ -121,9 +226,8 @@ bool DabuildJobPool::waitAllJobsDone(int timeout_msec, Ctx **out_done)
 void DabuildJobPool::startJob(Ctx *ctx, int cmd)
 {
   ctx->cmd = cmd;
-  _ReadWriteBarrier();
-  ctx->state = 1;
-  InterlockedIncrement(&m->cmdGen);
+  interlocked_release_store(ctx->state, 1);
+  interlocked_increment(m->cmdGen);
 }
 
 bool DabuildJobPool::startAllJobs(int broadcast_cmd, unsigned target_code, const char *profile)
@@ -136,9 +240,8 @@ bool DabuildJobPool::startAllJobs(int broadcast_cmd, unsigned target_code, const
       case 0:
         m->jobCtx[i].cmd = broadcast_cmd;
         m->jobCtx[i].setup(target_code, profile);
-        _ReadWriteBarrier();
-        m->jobCtx[i].state = 1;
-        InterlockedIncrement(&m->cmdGen);
+        interlocked_release_store(m->jobCtx[i].state, 1);
+        interlocked_increment(m->cmdGen);
         break;
       case 4: // inoperable
       case 5: break;
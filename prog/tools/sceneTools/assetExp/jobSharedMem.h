@@ -1,12 +1,14 @@
 #pragma once
 
+#include <util/dag_stdint.h>
+
 struct DabuildJobSharedMem
 {
   unsigned fullMemSize;
   unsigned pid;
-  void *mapHandle;
+  intptr_t mapHandle;
   unsigned jobCount;
-  void *jobHandle[64];
+  intptr_t jobHandle[64];
   int logLevel;
   bool quiet;
   bool nopbar;
@@ -16,9 +18,9 @@ struct DabuildJobSharedMem
   bool collapsePacks;
   bool expTex, expRes;
 
-  volatile long cmdGen, respGen;
+  volatile int cmdGen, respGen;
 
-  struct JobCtx
+  struct alignas(4096) JobCtx // each job context occupies its own page, as before with __declspec(align(4096))
   {
     volatile int state; // 0=waiting, 1=assigned, 2=accepted, 3=done, 4=inoperable, 5=inoperable-accepted
     volatile int cmd; // 0=nop, 1=build tex, 2=build texpack, 3=build respack, 7=reload common hash and prepare packs, 9=prepare packs
@@ -27,17 +29,28 @@ struct DabuildJobSharedMem
     volatile char profileName[32];
     volatile int pkgId, packId;
     volatile int donePk, totalPk;
-    volatile __int64 szDiff;
-    volatile __int64 szChangedTotal;
+    volatile int64_t szDiff;
+    volatile int64_t szChangedTotal;
     char data[1024 - 8 * 4 - 8 * 2 - 32];
 
     void setup(unsigned tc, const char *prof);
-  } __declspec(align(4096)) jobCtx[64];
+  };
+  JobCtx jobCtx[64];
 
   unsigned forceRebuildAssetIdxCount, forceRebuildAssetIdx[0x4000 - 1];
 
   void changeCtxState(JobCtx &ctx, int state);
+
+  // shared memory is named after master process id (Win32 file mapping or POSIX shm object)
+  static DabuildJobSharedMem *createMapped(int master_pid);
+  static DabuildJobSharedMem *openMapped(const char *master_pid_str, intptr_t &out_handle);
+  static void closeMapped(DabuildJobSharedMem *m, intptr_t handle);
+  static void destroyMapped(DabuildJobSharedMem *m); // closes job process handles and unlinks shared memory
+
+  // starts job process (args are passed as-is, no quoting); returns process handle (pid on POSIX) or 0 on failure
+  static intptr_t startJobProcess(const char *exe_path, const char *const *args, int arg_count);
 };
+static_assert(sizeof(DabuildJobSharedMem::JobCtx) == 4096, "job contexts are shared between processes and must not share pages");
 
 class DabuildJobPool
 {
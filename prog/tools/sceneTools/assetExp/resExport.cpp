@@ -1,4 +1,5 @@
 #include "daBuild.h"
+#include "contentCache.h"
 #include <libTools/util/conLogWriter.h>
 #include <libTools/util/progressInd.h>
 #include <libTools/util/makeBindump.h>
@@ -389,6 +390,7 @@ public:
 
       int data_ofs, data_len = 0;
 
+      DabuildContentKey cc_key;
       cwr.setOrigin();
       if (fp && c4.getAssetDataPos(nameTypified, data_ofs, data_len))
       {
@@ -396,6 +398,15 @@ public:
         LFileGeneralLoadCB crd(fp);
         copy_stream_to_stream(crd, cwr.getRawWriter(), data_len);
       }
+      else if (dabuild_content_cache_make_key(cc_key, *rrd.asset, *rrd.exp, cwr) &&
+               dabuild_content_cache_fetch(cc_key, cwr.getRawWriter()))
+      {
+        debug("fetched %s from content cache", nameTypified);
+        Tab<SimpleString> a_files(tmpmem);
+        rrd.exp->gatherSrcDataFiles(*rrd.asset, a_files);
+        for (int j = 0; j < a_files.size(); j++)
+          c4.updateFileHash(a_files[j]);
+      }
       else
       {
         static const int CMP_ATTEMPTS_COUNT = 9;
@@ -463,6 +474,7 @@ public:
           if (comparison_passed)
           {
             cwr0.copyDataTo(cwr.getRawWriter());
+            dabuild_content_cache_store(cc_key, cwr0);
             break;
           }
         }
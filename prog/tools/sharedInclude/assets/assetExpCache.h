@@ -80,6 +80,7 @@ public:
   static void sharedDataRemoveRebuildType(int a_type);
   static void sharedDataResetForceRebuildAssetsList();
   static void sharedDataAddForceRebuildAsset(const char *asset_name_typified);
+  static bool sharedDataIsForcedRebuild(int a_type, const char *asset_name_typified);
   static bool sharedDataGetFileHash(const char *fname, unsigned char out_hash[HASH_SZ]);
   static void sharedDataAppendHash(const void *data, size_t data_len, unsigned char inout_hash[HASH_SZ]);
   static bool saveSharedData();
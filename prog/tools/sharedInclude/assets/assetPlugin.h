@@ -48,8 +48,13 @@ typedef void(__stdcall *dabuild_plugin_install_dds_helper_t)(
 #define DABUILD_PLUGIN_INSTALL_DDS_HLP_PROC "_dabuild_plugin_install_dds_helper@4"
 #endif
 
+#if _TARGET_PC_WIN
+#define DAGOR_DLL_EXT ".dll"
+#else
+#define DAGOR_DLL_EXT ".so"
+#endif
 #if DAGOR_DBGLEVEL > 1
-#define DAGOR_DLL "-dbg.dll"
+#define DAGOR_DLL "-dbg" DAGOR_DLL_EXT
 #else
-#define DAGOR_DLL "-dev.dll"
+#define DAGOR_DLL "-dev" DAGOR_DLL_EXT
 #endif